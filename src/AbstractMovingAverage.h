@@ -11,6 +11,7 @@ public:
 	int m_period;
 	double m_total;
 
+	virtual ~AbstractMovingAverage() {}
 	virtual double value()=0;
 	virtual void add(const double value)=0;
 	virtual void clear()=0;
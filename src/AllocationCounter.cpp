@@ -0,0 +1,70 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+namespace {
+	std::atomic<unsigned long long> g_count( 0 );
+	std::atomic<unsigned long long> g_bytes( 0 );
+	// trivial type, no allocation on first use in a thread
+	thread_local unsigned long long t_count = 0;
+
+	inline void* allocate(std::size_t size) {
+		g_count.fetch_add( 1, std::memory_order_relaxed );
+		g_bytes.fetch_add( size, std::memory_order_relaxed );
+		t_count++;
+		return std::malloc( size > 0 ? size : 1 );
+	}
+};
+
+namespace IDEFIX {
+	namespace allocations {
+		unsigned long long count() {
+			return g_count.load( std::memory_order_relaxed );
+		}
+
+		unsigned long long bytes() {
+			return g_bytes.load( std::memory_order_relaxed );
+		}
+
+		unsigned long long thread_count() {
+			return t_count;
+		}
+	};
+};
+
+void* operator new(std::size_t size) {
+	void* p = allocate( size );
+	if ( p == nullptr ) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new( size );
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return allocate( size );
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return allocate( size );
+}
+
+void operator delete(void* p) noexcept {
+	std::free( p );
+}
+
+void operator delete[](void* p) noexcept {
+	std::free( p );
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+	std::free( p );
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+	std::free( p );
+}
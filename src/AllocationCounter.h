@@ -0,0 +1,24 @@
+#ifndef IDEFIX_ALLOCATIONCOUNTER_H
+#define IDEFIX_ALLOCATIONCOUNTER_H
+
+namespace IDEFIX {
+	/*!
+	 * Counts calls of the global operator new.
+	 *
+	 * AllocationCounter.cpp replaces operator new and delete, it is not part
+	 * of idefix_core and is only linked into benchmarks and tests:
+	 *   add_executable(bench tools/bench/main.cpp src/AllocationCounter.cpp)
+	 *
+	 * Without it linked the counters stay 0.
+	 */
+	namespace allocations {
+		// allocations of all threads
+		unsigned long long count();
+		// bytes requested by all threads
+		unsigned long long bytes();
+		// allocations of the calling thread, not disturbed by background threads
+		unsigned long long thread_count();
+	};
+};
+
+#endif
@@ -12,25 +12,61 @@
 #include "MathHelper.h"
 #include "StringHelper.h"
 #include "CSVHandler.h"
+#include "CFGParser.h"
+#include "TimeHelper.h"
 
 namespace IDEFIX {
-	AwesomeStrategy::AwesomeStrategy(const std::string& symbol, AwesomeStrategyConfig& config): m_symbol( symbol ) {
+	/*!
+	 * Load strategy configuration from cfg file like specs/awesome.cfg
+	 *
+	 * @param const std::string& cfg_file
+	 * @return AwesomeStrategyConfig
+	 * @throw IDEFIX::file_not_found
+	 */
+	AwesomeStrategyConfig AwesomeStrategyConfig::load(const std::string& cfg_file) throw( IDEFIX::file_not_found ) {
+		auto scfg = CFGParser( cfg_file );
+
+		AwesomeStrategyConfig config;
+		config.max_short_pos = atoi( scfg.value( "max_short_pos" ).c_str() );
+		config.max_long_pos  = atoi( scfg.value( "max_long_pos" ).c_str() );
+		config.max_pip_risk  = atoi( scfg.value( "max_pip_risk" ).c_str() );
+		config.max_risk      = atof( scfg.value( "max_risk" ).c_str() );
+		config.max_qty       = atof( scfg.value( "max_qty" ).c_str() );
+		config.max_spread    = atof( scfg.value( "max_spread" ).c_str() );
+		config.renko_size    = atof( scfg.value( "renko_size" ).c_str() );
+		config.sma_size      = atoi( scfg.value( "sma_size" ).c_str() );
+		config.wait_bricks   = atoi( scfg.value( "wait_bricks" ).c_str() );
+		config.warm_up_hours = atoi( scfg.value( "warm_up_hours" ).c_str() );
+		config.symbols       = str::explode( scfg.value( "symbols" ), ',' );
+
+		return config;
+	}
+
+	AwesomeStrategy::AwesomeStrategy(const std::string& symbol, AwesomeStrategyConfig& config): m_sma5(nullptr), m_pipeline(nullptr), m_chart(nullptr), m_graph(nullptr), m_renko_node(nullptr), m_sma_node(nullptr), m_symbol( symbol ), m_current_spread(0), m_warming_up(false) {
 		// Constructor
 		// Set config values
 		m_config = &config;
 	}
 
 	AwesomeStrategy::~AwesomeStrategy() {
+		m_graph_connection.disconnect();
+
 		if ( m_chart != nullptr ) {
 			delete m_chart;
 		}
+		if ( m_pipeline != nullptr ) {
+			delete m_pipeline;
+		}
 		if ( m_sma5 != nullptr ) {
 			delete m_sma5;
 		}
 	}
 
 	/*!
-	 * SLOT gets called when fixmanager is ready for initializing
+	 * SLOT gets called when fixmanager is ready for initializing.
+	 * FIXManager emits on_init on every CollateralReport, the chart and the
+	 * sma are created once and keep their state, only the position counts
+	 * are reset because all positions get closed.
 	 */
 	void AwesomeStrategy::on_init() {
 		console()->info("[AwesomeStrategy] on_init {}", get_symbol() );
@@ -38,12 +74,38 @@ namespace IDEFIX {
 		m_short_pos     = 0;		
 		// how many long positions actually?
 		m_long_pos      = 0;
+		// already initialized
+		if ( m_pipeline != nullptr || m_renko_node != nullptr ) {
+			return;
+		}
+		// shared nodes, strategies with the same symbol and sizes share bricks and sma
+		if ( m_graph != nullptr ) {
+			m_renko_node = m_graph->renko( get_symbol(), m_config->renko_size );
+			m_sma_node   = m_graph->sma( m_renko_node, m_config->sma_size );
+			// the sma node is evaluated after the brick node
+			m_graph_connection = m_sma_node->on_update.connect( [this](const IndicatorNode&) {
+				on_bar( m_renko_node->bar() );
+			});
+			return;
+		}
+
+		// one bar pipeline per symbol, more charts can be added via get_pipeline()
+		m_pipeline = new BarPipeline( get_symbol() );
 		// set renko chart periode
-		m_chart = new RenkoChart( m_config->renko_size ); //m_renko_size
+		m_chart = new RenkoChart( *m_pipeline, m_config->renko_size ); //m_renko_size
 		// set sma periode
 		m_sma5 = new SimpleMovingAverage( m_config->sma_size ); //m_sma_size
 		// connect signal
-		m_chart->on_brick.connect( std::bind( &AwesomeStrategy::on_bar, this, std::placeholders::_1 ) );
+		m_chart->on_brick.connect<AwesomeStrategy, &AwesomeStrategy::on_bar>( this );
+	}
+
+	/*!
+	 * Use shared indicator graph instead of an own chart and sma
+	 *
+	 * @param IndicatorGraph* graph
+	 */
+	void AwesomeStrategy::set_graph(IndicatorGraph* graph) {
+		m_graph = graph;
 	}
 
 	/*!
@@ -52,85 +114,116 @@ namespace IDEFIX {
 	 * @param MarketSnapshot& tick
 	 */
 	void AwesomeStrategy::on_tick(const IDEFIX::MarketSnapshot &tick) {
-		// update chart
-		m_chart->on_tick( tick );
+		// update all charts, the shared graph is fed by its owner
+		if ( m_pipeline != nullptr ) {
+			m_pipeline->on_tick( tick );
+		}
 		// set current spread
 		m_current_spread = tick.getSpread();
 	}
 
-	void AwesomeStrategy::on_bar(const Bar &bar) {
-		try {
-			// call external signal on_bar
-			on_bar_signal( bar );
-			// add value to moving average
-			m_sma5->add( ( bar.open_price + bar.close_price ) / 2 );
+	/*!
+	 * Feed history ticks through the chart and the sma before the live ticks
+	 * are connected. Bars update bricks and sma as usual, but no signal is
+	 * emitted. The unfinished brick is kept, the first live tick continues it.
+	 * Must be called after on_init. With a shared graph nothing is replayed,
+	 * the owner of the graph feeds the history once for all its strategies
+	 * and mutes them with set_warming_up.
+	 *
+	 * @param const std::vector<TickRecord>& ticks sorted by time
+	 * @param const double                   point_size
+	 * @return size_t count of created bricks
+	 */
+	size_t AwesomeStrategy::warm_up(const std::vector<TickRecord>& ticks, const double point_size) {
+		// the shared graph is warmed up by its owner
+		if ( m_pipeline == nullptr || ticks.empty() ) {
+			return 0;
+		}
 
-#ifdef CMAKE_USE_HTML_CHARTS
-			// write bar with sma value to log file
-			log_brick( bar, m_sma5->value() );
-#endif
+		const int bricks_before = m_chart->brick_count();
 
-			// check for valid values
-			if ( ! m_sma5->is_valid() ) {
-				console()->info("[AwesomeStrategy] {} Waiting for valid sma.", get_symbol() );
-				return;
-			}
+		MarketSnapshot snapshot;
+		snapshot.setSymbol( get_symbol() );
+		snapshot.setPointSize( point_size );
 
-			int brick_count = m_chart->brick_count();
-			if ( brick_count < m_config->wait_bricks ) {
-				console()->info("[AwesomeStrategy] {} Waiting for minimum bar count ({:d}/{:d})", get_symbol(), brick_count, m_config->wait_bricks );
-				return;
-			}
+		char sending_time[32];
+		long long last_second = -1;
 
-			// ------------------------------
-			// SIGNAL
-			// ------------------------------
+		m_warming_up = true;
+		for ( auto& tick : ticks ) {
+			// most ticks share the second, only the milliseconds change
+			times::ms_to_fix( tick.time_ms, sending_time, last_second );
 
-			auto brick_0 = bar;
-			auto brick_1 = m_chart->at( 1 );
-			auto brick_2 = m_chart->at( 2 );
+			snapshot.setSendingTime( sending_time, 21 );
+			snapshot.setBid( tick.bid );
+			snapshot.setAsk( tick.ask );
 
-			const std::vector<double> open_price  = { brick_0.open_price, brick_1.open_price, brick_2.open_price };
-			const std::vector<double> close_price = { brick_0.close_price, brick_1.close_price, brick_2.close_price };
-			const double last_ma                  = m_sma5->value(); 
+			on_tick( snapshot );
+		}
+		m_warming_up = false;
 
-			// LONG ENTRY
-			if ( isEntry( open_price, close_price, last_ma, Side::LONG ) && m_long_pos < m_config->max_long_pos ) {
-				console()->info("[SignalLong] {:d} {}", m_long_pos, get_symbol() );
+		const int bricks = m_chart->brick_count() - bricks_before;
+		console()->info("[AwesomeStrategy] {} warm up with {:d} ticks, {:d} bricks, sma {}", get_symbol(), ticks.size(), bricks, m_sma5->is_valid() ? "valid" : "not valid" );
 
-				// Signal
-				on_entry_signal( MarketSide::Side_BUY );
-				
-				m_long_pos++;
-			}
-			// LONG EXIT
-			if ( isExit( open_price, close_price, last_ma, Side::LONG ) && m_long_pos > 0 ) {
-				console()->warn("[ExitLong All] {:d} {}", m_long_pos, get_symbol() );
+		return bricks;
+	}
 
-				// Signal
-				on_close_all_signal( get_symbol() );
+	/*!
+	 * Mute the signals while the owner of the shared graph replays history ticks
+	 *
+	 * @param const bool warming_up
+	 */
+	void AwesomeStrategy::set_warming_up(const bool warming_up) {
+		m_warming_up = warming_up;
+	}
 
-				m_long_pos = 0;
-			}
-			// SHORT ENTRY
-			if ( isEntry( open_price, close_price, last_ma, Side::SHORT ) && m_short_pos < m_config->max_short_pos ) {
-				console()->error("[SignalShort] {:d} {}", m_short_pos, get_symbol() );
+	/*!
+	 * True while history ticks are replayed
+	 *
+	 * @return bool
+	 */
+	bool AwesomeStrategy::is_warming_up() const {
+		return m_warming_up;
+	}
 
-				// Signal
-				on_entry_signal( MarketSide::Side_SELL );
+	/*!
+	 * Count of bricks of the own chart or the shared renko node
+	 *
+	 * @return int 0 before on_init
+	 */
+	int AwesomeStrategy::brick_count() {
+		if ( m_renko_node != nullptr ) {
+			return m_renko_node->count();
+		}
+		return m_chart != nullptr ? m_chart->brick_count() : 0;
+	}
 
-				m_short_pos++;
+	/*!
+	 * SLOT gets called if chart creates a new bar
+	 * 
+	 * @param const Bar& bar
+	 */
+	void AwesomeStrategy::on_bar(const Bar &bar) {
+		// keep bricks and sma of the history, but no signals
+		if ( m_warming_up ) {
+			m_bricks.add( bar );
+			if ( m_sma5 != nullptr ) {
+				m_sma5->add( m_bricks.value() );
 			}
-			// SHORT EXIT
-			if( isExit( open_price, close_price, last_ma, Side::SHORT ) && m_short_pos > 0 ) {
-				console()->warn("[ExitShort All] {:d} {}", m_short_pos, get_symbol() );
-
-				// Signal
-				on_close_all_signal( get_symbol() );
+			return;
+		}
 
-				m_short_pos = 0;
+		try {
+			// call external signal on_bar
+			on_bar_signal( bar );
+			// keep last bricks for the signal check
+			m_bricks.add( bar );
+			// add value to moving average, shared sma nodes are updated by the graph
+			if ( m_sma5 != nullptr ) {
+				m_sma5->add( m_bricks.value() );
 			}
 
+			evaluate( bar );
 		} catch( IDEFIX::out_of_range* oor ) {
 			console()->warn("{}", oor->what() );
 		} catch( IDEFIX::element_not_found* enf ) {
@@ -140,6 +233,82 @@ namespace IDEFIX {
 		}
 	}
 
+	/*!
+	 * Check entry and exit rules for the latest bar, errors are caught by on_bar
+	 * 
+	 * @param const Bar& bar
+	 */
+	void AwesomeStrategy::evaluate(const Bar& bar) {
+		const double sma_value = m_sma_node != nullptr ? m_sma_node->value() : m_sma5->value();
+		const bool sma_valid   = m_sma_node != nullptr ? m_sma_node->is_valid() : m_sma5->is_valid();
+
+#ifdef CMAKE_USE_HTML_CHARTS
+		// write bar with sma value to log file
+		log_brick( bar, sma_value );
+#else
+		(void) bar;
+#endif
+
+		// check for valid values
+		if ( ! sma_valid ) {
+			console()->info("[AwesomeStrategy] {} Waiting for valid sma.", get_symbol() );
+			return;
+		}
+
+		int brick_count = m_renko_node != nullptr ? m_renko_node->count() : m_chart->brick_count();
+		if ( brick_count < m_config->wait_bricks ) {
+			console()->info("[AwesomeStrategy] {} Waiting for minimum bar count ({:d}/{:d})", get_symbol(), brick_count, m_config->wait_bricks );
+			return;
+		}
+
+		// ------------------------------
+		// SIGNAL
+		// ------------------------------
+
+		if ( ! m_bricks.is_valid() ) {
+			return;
+		}
+
+		const double last_ma = sma_value;
+
+		// LONG ENTRY
+		if ( isEntry( m_bricks, last_ma, Side::LONG ) && m_long_pos < m_config->max_long_pos ) {
+			console()->info("[SignalLong] {:d} {}", m_long_pos, get_symbol() );
+
+			// Signal
+			on_entry_signal( MarketSide::Side_BUY );
+			
+			m_long_pos++;
+		}
+		// LONG EXIT
+		if ( isExit( m_bricks, last_ma, Side::LONG ) && m_long_pos > 0 ) {
+			console()->warn("[ExitLong All] {:d} {}", m_long_pos, get_symbol() );
+
+			// Signal
+			on_close_all_signal( get_symbol() );
+
+			m_long_pos = 0;
+		}
+		// SHORT ENTRY
+		if ( isEntry( m_bricks, last_ma, Side::SHORT ) && m_short_pos < m_config->max_short_pos ) {
+			console()->error("[SignalShort] {:d} {}", m_short_pos, get_symbol() );
+
+			// Signal
+			on_entry_signal( MarketSide::Side_SELL );
+
+			m_short_pos++;
+		}
+		// SHORT EXIT
+		if( isExit( m_bricks, last_ma, Side::SHORT ) && m_short_pos > 0 ) {
+			console()->warn("[ExitShort All] {:d} {}", m_short_pos, get_symbol() );
+
+			// Signal
+			on_close_all_signal( get_symbol() );
+
+			m_short_pos = 0;
+		}
+	}
+
 	/*!
 	 * SLOT gets called if chart creates a new bar
 	 * 
@@ -332,6 +501,18 @@ namespace IDEFIX {
 		return m_symbol;
 	}
 
+	/*!
+	 * Get bar pipeline of the symbol, nullptr before on_init
+	 *
+	 * @return BarPipeline*
+	 */
+	BarPipeline* AwesomeStrategy::get_pipeline() {
+		if ( m_graph != nullptr ) {
+			return m_graph->pipeline( get_symbol() );
+		}
+		return m_pipeline;
+	}
+
 	/*!
 	 * Save brick to <symbol>_bars.csv in running directory
 	 * 
@@ -374,50 +555,48 @@ namespace IDEFIX {
 		line_ss << sma << ",";
 		line_ss << brick.point_size;
 
-		// write to csv file
-		CSVHandler csv;
-		csv.set_path( "public_html/" );
-		csv.set_filename( symbol_filename_ss.str() );
-		csv.add_line( line_ss.str() );
+		// write to csv file, the handler keeps the file open
+		m_bar_csv.set_path( "public_html/" );
+		m_bar_csv.set_filename( symbol_filename_ss.str() );
+		m_bar_csv.add_line( line_ss.str() );
 
 	}
 
 	/*!
 	 * Test if current values lead to an entry signal
 	 * 
-	 * @param const std::vector<double>  open_price     vector { latest_price, previous_price, previous_previous_price }
-	 * @param const std::vector<double>  close_price    vector { latest_price, previous_price, previous_previous_price }
+	 * @param const indicator::Renko&    bricks         open and close of the last three bricks, 0 is the latest
 	 * @param const double               moving_average last moving average
 	 * @param AwesomeStrategy::Side      side           the side to look for
 	 * @return bool
 	 */
-	bool AwesomeStrategy::isEntry(const std::vector<double> open_price, const std::vector<double> close_price, const double moving_average, const AwesomeStrategy::Side side) {
+	bool AwesomeStrategy::isEntry(const indicator::Renko& bricks, const double moving_average, const AwesomeStrategy::Side side) {
 		bool boolreturn = false;
 		
 		switch( side ) {
 			case AwesomeStrategy::Side::LONG: // long
 			{
-				bool brick_0_long  = open_price[0] < close_price[0];
-				bool brick_1_long  = open_price[1] < close_price[1];
-				bool brick_2_short = open_price[2] > close_price[2];
+				bool brick_0_long  = bricks.is_long( 0 );
+				bool brick_1_long  = bricks.is_long( 1 );
+				bool brick_2_short = bricks.is_short( 2 );
 				
 				boolreturn = ( brick_0_long && brick_1_long && brick_2_short );
 				
 				if ( boolreturn ) {
-					boolreturn = ( ( open_price[0] > moving_average ) && ( close_price[0] > moving_average ) );
+					boolreturn = ( ( bricks.open( 0 ) > moving_average ) && ( bricks.close( 0 ) > moving_average ) );
 				}
 				break;
 			}
 			case AwesomeStrategy::Side::SHORT: // short
 			{
-				bool brick_0_short = open_price[0] > close_price[0];
-				bool brick_1_short = open_price[1] > close_price[1];
-				bool brick_2_long  = open_price[2] < close_price[2];
+				bool brick_0_short = bricks.is_short( 0 );
+				bool brick_1_short = bricks.is_short( 1 );
+				bool brick_2_long  = bricks.is_long( 2 );
 
 				boolreturn = ( brick_0_short && brick_1_short && brick_2_long );
 
 				if ( boolreturn ) {
-					boolreturn = ( ( open_price[0] < moving_average ) && ( close_price[0] < moving_average ) );
+					boolreturn = ( ( bricks.open( 0 ) < moving_average ) && ( bricks.close( 0 ) < moving_average ) );
 				}
 				break;
 			}
@@ -429,37 +608,36 @@ namespace IDEFIX {
 	/*!
 	 * Test if current values lead to an exit signal
 	 * 
-	 * @param const std::vector<double>  open_price     vector { latest_price, previous_price, previous_previous_price }
-	 * @param const std::vector<double>  close_price    vector { latest_price, previous_price, previous_previous_price }
+	 * @param const indicator::Renko&    bricks         open and close of the last three bricks, 0 is the latest
 	 * @param const double               moving_average last moving average
 	 * @param AwesomeStrategy::Side      side           the side to look for
 	 * @return bool
 	 */
-	bool AwesomeStrategy::isExit(const std::vector<double> open_price, const std::vector<double> close_price, const double moving_average, const AwesomeStrategy::Side side) {
+	bool AwesomeStrategy::isExit(const indicator::Renko& bricks, const double moving_average, const AwesomeStrategy::Side side) {
 		bool boolreturn = false;
 
 		switch( side ) {
 			case AwesomeStrategy::Side::LONG: // long
 			{
-				bool brick_0_short = open_price[0] > close_price[0];
-				bool brick_1_long  = open_price[1] < close_price[1];
+				bool brick_0_short = bricks.is_short( 0 );
+				bool brick_1_long  = bricks.is_long( 1 );
 				
 				boolreturn = ( brick_0_short && brick_1_long );
 				
 				if ( boolreturn ) {
-					boolreturn = close_price[0] < moving_average;
+					boolreturn = bricks.close( 0 ) < moving_average;
 				}
 				break;
 			}
 			case AwesomeStrategy::Side::SHORT: // short
 			{
-				bool brick_0_long  = open_price[0] < close_price[0];
-				bool brick_1_short = open_price[1] > close_price[1];
+				bool brick_0_long  = bricks.is_long( 0 );
+				bool brick_1_short = bricks.is_short( 1 );
 
 				boolreturn = ( brick_0_long && brick_1_short );
 
 				if ( boolreturn ) {
-					boolreturn = close_price[0] > moving_average;
+					boolreturn = bricks.close( 0 ) > moving_average;
 				}
 				break;
 			}
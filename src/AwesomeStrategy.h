@@ -4,12 +4,19 @@
 #include "MarketSnapshot.h"
 #include "MarketOrder.h"
 #include "RenkoChart.h"
+#include "BarPipeline.h"
 #include "Account.h"
 #include "SimpleMovingAverage.h"
+#include "IndicatorPipeline.h"
+#include "IndicatorGraph.h"
 #include "Bar.h"
 #include "SignalType.h"
 #include "MarketSide.h"
+#include "Exceptions.h"
+#include "CSVHandler.h"
+#include "TickRecord.h"
 #include <string>
+#include <vector>
 #include <nod/nod.hpp>
 #include <quickfix/Mutex.h>
 #include <quickfix/FixFields.h>
@@ -34,8 +41,12 @@ namespace IDEFIX {
 		double max_spread;
 		// Renko brick size
 		double renko_size;
+		// replay the last hours of journaled ticks before trading, 0 = off
+		int warm_up_hours;
 		// symbols to trade
 		std::vector<std::string> symbols;
+
+		static AwesomeStrategyConfig load(const std::string& cfg_file) throw( IDEFIX::file_not_found );
 	};
 
 	class AwesomeStrategy {
@@ -49,6 +60,10 @@ namespace IDEFIX {
 		AwesomeStrategy(const std::string& symbol, AwesomeStrategyConfig& config);
 		~AwesomeStrategy();
 
+		// use shared renko and sma nodes, must be called before on_init.
+		// The graph gets the ticks from its owner, not from the strategy.
+		void set_graph(IndicatorGraph* graph);
+
 		// Signals
 		nod::signal<void(const MarketSide side)> on_entry_signal;
 		nod::signal<void(const std::string&)> on_close_all_signal;
@@ -60,25 +75,40 @@ namespace IDEFIX {
 		void on_exit();
 		void on_bar(const Bar& bar);
 		void on_market_order(const SignalType type, const MarketOrder& mo);
+
+		size_t warm_up(const std::vector<TickRecord>& ticks, const double point_size);
+		void set_warming_up(const bool warming_up);
+		bool is_warming_up() const;
+		int brick_count();
 		
 		std::string& get_symbol();
 		AwesomeStrategyConfig* get_config();
+		BarPipeline* get_pipeline();
+
+		static bool isEntry(const indicator::Renko& bricks, const double moving_average, const AwesomeStrategy::Side side);
+		static bool isExit(const indicator::Renko& bricks, const double moving_average, const AwesomeStrategy::Side side);
 
 	private:
 		SimpleMovingAverage* m_sma5;
+		BarPipeline* m_pipeline;
 		RenkoChart* m_chart;
+		IndicatorGraph* m_graph;
+		BarNode* m_renko_node;
+		SMANode* m_sma_node;
+		nod::scoped_connection m_graph_connection;
+		indicator::Renko m_bricks;
 		std::string m_symbol;
 		AwesomeStrategyConfig* m_config;
+		CSVHandler m_bar_csv;
 		int m_long_pos;
 		int m_short_pos;
 		double m_current_spread;
+		bool m_warming_up;
 
 		FIX::Mutex m_mutex;
 
 		void log_brick(const Bar& bar, const double sma);
-		// side = 1 long, -1 = short
-		bool isEntry(const std::vector<double> open_price, const std::vector<double> close_price, const double moving_average, const AwesomeStrategy::Side side);
-		bool isExit(const std::vector<double> open_price, const std::vector<double> close_price, const double moving_average, const AwesomeStrategy::Side side);
+		void evaluate(const Bar& bar);
 	};
 };
 
@@ -0,0 +1,227 @@
+#include "BacktestEngine.h"
+#include "TimeHelper.h"
+#include "Console.h"
+#include <chrono>
+#include <algorithm>
+
+namespace IDEFIX {
+	BacktestEngine::BacktestEngine(const std::string& symbol, const AwesomeStrategyConfig& config, const double point_size)
+	: m_symbol( symbol ), m_config( config ), m_point_size( point_size ), m_clock_ms(0), m_equity_peak(0), m_prune_drawdown(0), m_prune_checkpoint(0), m_abort(false) {
+		m_snapshot.setSymbol( symbol );
+		m_snapshot.setPointSize( point_size );
+	}
+
+	BacktestEngine::~BacktestEngine() {}
+
+	/*!
+	 * Register the console logger used by the strategy classes.
+	 * Without verbose mode everything is dropped.
+	 *
+	 * @param const bool verbose
+	 */
+	void BacktestEngine::init_console(const bool verbose) {
+		auto logger = spdlog::get("console");
+		if ( logger == nullptr ) {
+			logger = spdlog::stdout_color_mt( "console" );
+			logger->set_pattern( "%Y-%m-%d %T.%e: %^%v%$" );
+		}
+		logger->set_level( verbose ? spdlog::level::info : spdlog::level::off );
+	}
+
+	/*!
+	 * Simulated clock, time of the current tick in ms since epoch
+	 *
+	 * @return long long
+	 */
+	long long BacktestEngine::now() const {
+		return m_clock_ms;
+	}
+
+	/*!
+	 * Stop hopeless runs early
+	 *
+	 * @param const double max_drawdown stop if the drawdown in points exceeds this, 0 = off
+	 * @param const double checkpoint    stop if there was no trade after this part of the ticks, 0 = off
+	 */
+	void BacktestEngine::set_pruning(const double max_drawdown, const double checkpoint) {
+		m_prune_drawdown   = max_drawdown;
+		m_prune_checkpoint = checkpoint;
+	}
+
+	BacktestResult BacktestEngine::run(const std::vector<TickRecord>& ticks) {
+		return run( ticks.data(), ticks.size() );
+	}
+
+	/*!
+	 * Run a fresh strategy over all ticks
+	 *
+	 * @param const TickRecord* ticks
+	 * @param const size_t      count
+	 * @return BacktestResult
+	 */
+	BacktestResult BacktestEngine::run(const TickRecord* ticks, const size_t count) {
+		m_result        = BacktestResult();
+		m_equity_peak   = 0;
+		m_clock_ms      = 0;
+		m_abort         = false;
+		m_positions.clear();
+
+		const size_t checkpoint = m_prune_checkpoint > 0 ? static_cast<size_t>( count * m_prune_checkpoint ) : count;
+
+		if ( spdlog::get("console") == nullptr ) {
+			init_console();
+		}
+
+		AwesomeStrategy strategy( m_symbol, m_config );
+		strategy.on_entry_signal.connect( [this](const MarketSide side) {
+			open_position( side );
+		});
+		strategy.on_close_all_signal.connect( [this](const std::string&) {
+			close_all();
+		});
+		strategy.on_bar_signal.connect( [this](const Bar&) {
+			m_result.bars++;
+		});
+		strategy.on_init();
+
+		char sending_time[32];
+		long long last_second = -1;
+		size_t count_done     = count;
+		auto start = std::chrono::steady_clock::now();
+
+		for ( size_t i = 0; i < count; i++ ) {
+			const TickRecord& tick = ticks[i];
+
+			m_clock_ms = tick.time_ms;
+
+			// most ticks share the second, only the milliseconds change
+			times::ms_to_fix( tick.time_ms, sending_time, last_second );
+
+			m_snapshot.setSendingTime( sending_time, 21 );
+			m_snapshot.setBid( tick.bid );
+			m_snapshot.setAsk( tick.ask );
+
+			if ( ! m_positions.empty() ) {
+				check_stops();
+			}
+
+			strategy.on_tick( m_snapshot );
+
+			// no trade until the checkpoint, the parameters are hopeless
+			if ( i == checkpoint && m_result.trades == 0 && m_positions.empty() ) {
+				m_abort = true;
+			}
+
+			if ( m_abort ) {
+				m_result.pruned = true;
+				count_done = i + 1;
+				break;
+			}
+		}
+
+		// close open positions at the last price
+		close_all();
+		strategy.on_exit();
+
+		m_result.ticks      = count_done;
+		m_result.elapsed_ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+		return m_result;
+	}
+
+	/*!
+	 * Fill market order at the current price
+	 *
+	 * @param const MarketSide side
+	 */
+	void BacktestEngine::open_position(const MarketSide side) {
+		// close all opposite trades in this symbol
+		close_side( side == MarketSide::Side_BUY ? MarketSide::Side_SELL : MarketSide::Side_BUY );
+
+		if ( m_config.max_spread > 0 && m_snapshot.getSpread() > m_config.max_spread ) {
+			return;
+		}
+
+		Position position;
+		position.side       = side;
+		position.price      = side == MarketSide::Side_BUY ? m_snapshot.getAsk() : m_snapshot.getBid();
+		position.stop_price = 0;
+
+		if ( m_config.max_pip_risk > 0 ) {
+			position.stop_price = side == MarketSide::Side_BUY
+				? m_snapshot.getAsk() - ( m_point_size * m_config.max_pip_risk )
+				: m_snapshot.getBid() + ( m_point_size * m_config.max_pip_risk );
+		}
+
+		m_positions.push_back( position );
+	}
+
+	/*!
+	 * Close position at the current price and update the statistics
+	 *
+	 * @param const size_t index
+	 */
+	void BacktestEngine::close_position(const size_t index) {
+		const Position& position = m_positions[index];
+		const double pl = position.side == MarketSide::Side_BUY
+			? ( m_snapshot.getBid() - position.price ) / m_point_size
+			: ( position.price - m_snapshot.getAsk() ) / m_point_size;
+
+		m_result.trades++;
+		m_result.profit_loss += pl;
+		if ( pl > 0 ) {
+			m_result.wins++;
+		}
+
+		m_equity_peak         = std::max( m_equity_peak, m_result.profit_loss );
+		m_result.max_drawdown = std::max( m_result.max_drawdown, m_equity_peak - m_result.profit_loss );
+
+		if ( m_prune_drawdown > 0 && m_result.max_drawdown > m_prune_drawdown ) {
+			m_abort = true;
+		}
+
+		m_positions.erase( m_positions.begin() + index );
+	}
+
+	/*!
+	 * Close all positions
+	 */
+	void BacktestEngine::close_all() {
+		while ( ! m_positions.empty() ) {
+			close_position( m_positions.size() - 1 );
+		}
+	}
+
+	/*!
+	 * Close all positions of one side
+	 *
+	 * @param const MarketSide side
+	 */
+	void BacktestEngine::close_side(const MarketSide side) {
+		for ( size_t i = m_positions.size(); i > 0; i-- ) {
+			if ( m_positions[i - 1].side == side ) {
+				close_position( i - 1 );
+			}
+		}
+	}
+
+	/*!
+	 * Close positions whose stop loss was hit
+	 */
+	void BacktestEngine::check_stops() {
+		for ( size_t i = m_positions.size(); i > 0; i-- ) {
+			const Position& position = m_positions[i - 1];
+			if ( position.stop_price == 0 ) {
+				continue;
+			}
+
+			const bool hit = position.side == MarketSide::Side_BUY
+				? m_snapshot.getBid() <= position.stop_price
+				: m_snapshot.getAsk() >= position.stop_price;
+
+			if ( hit ) {
+				close_position( i - 1 );
+			}
+		}
+	}
+};
@@ -0,0 +1,76 @@
+#ifndef IDEFIX_BACKTESTENGINE_H
+#define IDEFIX_BACKTESTENGINE_H
+
+#include <string>
+#include <vector>
+#include "TickRecord.h"
+#include "MarketSnapshot.h"
+#include "MarketSide.h"
+#include "AwesomeStrategy.h"
+
+namespace IDEFIX {
+	struct BacktestResult {
+		long ticks;
+		long bars;
+		int trades;
+		int wins;
+		// profit and loss in points
+		double profit_loss;
+		// maximum drawdown of closed trades in points
+		double max_drawdown;
+		double elapsed_ms;
+		// run was stopped early by the pruning rules
+		bool pruned;
+	};
+
+	/*!
+	 * Replays historical ticks through AwesomeStrategy without a FIX session.
+	 * The clock is the time of the current tick, orders are filled immediately
+	 * at the current bid or ask. Like the order path in main.cpp entries close
+	 * the opposite side and get a stop loss of max_pip_risk points,
+	 * entries are skipped if the spread is above max_spread.
+	 */
+	class BacktestEngine {
+	private:
+		struct Position {
+			MarketSide side;
+			double price;
+			double stop_price;
+		};
+
+		std::string m_symbol;
+		AwesomeStrategyConfig m_config;
+		double m_point_size;
+
+		MarketSnapshot m_snapshot;
+		long long m_clock_ms;
+		std::vector<Position> m_positions;
+		BacktestResult m_result;
+		double m_equity_peak;
+
+		// pruning
+		double m_prune_drawdown;
+		double m_prune_checkpoint;
+		bool m_abort;
+
+		void open_position(const MarketSide side);
+		void close_position(const size_t index);
+		void close_all();
+		void close_side(const MarketSide side);
+		void check_stops();
+
+	public:
+		BacktestEngine(const std::string& symbol, const AwesomeStrategyConfig& config, const double point_size = 0.0001);
+		~BacktestEngine();
+
+		BacktestResult run(const std::vector<TickRecord>& ticks);
+		BacktestResult run(const TickRecord* ticks, const size_t count);
+		long long now() const;
+
+		void set_pruning(const double max_drawdown, const double checkpoint = 0.5);
+
+		static void init_console(const bool verbose = false);
+	};
+};
+
+#endif
@@ -0,0 +1,441 @@
+#include "BarBuilder.h"
+#include "MathHelper.h"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+#ifdef CMAKE_SHOW_DEBUG_OUTPUT
+#include "Console.h"
+#endif
+
+namespace IDEFIX {
+	// ---------------------------------------------------------------------------
+	// AbstractBarBuilder
+	// ---------------------------------------------------------------------------
+
+	AbstractBarBuilder::AbstractBarBuilder(): m_store(nullptr), m_series(-1) {}
+
+	AbstractBarBuilder::~AbstractBarBuilder() {}
+
+	/*!
+	 * Write finished bars into the series named like this builder
+	 *
+	 * @param BarStore* store
+	 */
+	void AbstractBarBuilder::attach(BarStore* store) {
+		m_store  = store;
+		m_series = store != nullptr ? store->series( name() ) : -1;
+	}
+
+	/*!
+	 * Return series id in BarStore, -1 if not attached
+	 *
+	 * @return int
+	 */
+	int AbstractBarBuilder::series() const {
+		return m_series;
+	}
+
+	/*!
+	 * Store bar and call signal on_bar
+	 *
+	 * @param const Bar& bar
+	 */
+	void AbstractBarBuilder::emit(const Bar& bar) {
+		if ( m_store != nullptr ) {
+			m_store->add( m_series, bar );
+		}
+		on_bar( bar );
+	}
+
+	/*!
+	 * Open bar with tick
+	 *
+	 * @param Bar&        bar
+	 * @param const Tick& tick
+	 * @param const double period
+	 */
+	void AbstractBarBuilder::begin_bar(Bar& bar, const Tick& tick, const double period) {
+		bar.symbol      = *tick.symbol;
+		bar.open_time   = *tick.sending_time;
+		bar.close_time  = *tick.sending_time;
+		bar.open_price  = tick.bid;
+		bar.close_price = tick.bid;
+		bar.high_price  = tick.bid;
+		bar.low_price   = tick.bid;
+		bar.status      = Bar::STATUS::NOSTATUS;
+		bar.volume      = 1;
+		bar.diff        = 0;
+		bar.period      = period;
+		bar.point_size  = tick.point_size;
+	}
+
+	/*!
+	 * Update open bar with tick
+	 *
+	 * @param Bar&        bar
+	 * @param const Tick& tick
+	 */
+	void AbstractBarBuilder::update_bar(Bar& bar, const Tick& tick) {
+		bar.close_price = tick.bid;
+		bar.close_time  = *tick.sending_time;
+		bar.high_price  = std::max( bar.high_price, tick.bid );
+		bar.low_price   = std::min( bar.low_price, tick.bid );
+		bar.volume++;
+	}
+
+	/*!
+	 * Set status and diff before the bar gets emitted
+	 *
+	 * @param Bar& bar
+	 */
+	void AbstractBarBuilder::finish_bar(Bar& bar) {
+		bar.status = bar.close_price >= bar.open_price ? Bar::STATUS::LONG : Bar::STATUS::SHORT;
+		bar.diff   = Math::get_spread( bar.open_price, bar.close_price, bar.point_size );
+	}
+
+	// ---------------------------------------------------------------------------
+	// TimeBarBuilder
+	// ---------------------------------------------------------------------------
+
+	TimeBarBuilder::TimeBarBuilder(const int period): m_period_ms( period > 0 ? period * 1000LL : 1000LL ), m_bucket(0) {
+		m_current.clear();
+	}
+
+	std::string TimeBarBuilder::name() const {
+		std::ostringstream oss;
+		oss << "time:" << m_period_ms / 1000;
+		return oss.str();
+	}
+
+	/*!
+	 * Close the bar if the tick is in a new period.
+	 * Ticks without a parseable sending time are ignored.
+	 *
+	 * @param const Tick& tick
+	 */
+	void TimeBarBuilder::on_tick(const Tick& tick) {
+		if ( tick.time_ms <= 0 ) {
+			return;
+		}
+
+		const long long bucket = tick.time_ms / m_period_ms;
+
+		if ( m_current.volume > 0 && bucket != m_bucket ) {
+			flush();
+		}
+
+		if ( m_current.volume == 0 ) {
+			begin_bar( m_current, tick, m_period_ms / 1000 );
+			m_bucket = bucket;
+		} else {
+			update_bar( m_current, tick );
+		}
+	}
+
+	/*!
+	 * Emit the open bar, e.g. at the end of a backtest
+	 */
+	void TimeBarBuilder::flush() {
+		if ( m_current.volume == 0 ) {
+			return;
+		}
+
+		finish_bar( m_current );
+		emit( m_current );
+		m_current.clear();
+	}
+
+	void TimeBarBuilder::clear() {
+		m_current.clear();
+		m_bucket = 0;
+	}
+
+	// ---------------------------------------------------------------------------
+	// TickBarBuilder
+	// ---------------------------------------------------------------------------
+
+	TickBarBuilder::TickBarBuilder(const int count): m_count( count > 0 ? count : 1 ) {
+		m_current.clear();
+	}
+
+	std::string TickBarBuilder::name() const {
+		std::ostringstream oss;
+		oss << "tick:" << m_count;
+		return oss.str();
+	}
+
+	void TickBarBuilder::on_tick(const Tick& tick) {
+		if ( m_current.volume == 0 ) {
+			begin_bar( m_current, tick, m_count );
+		} else {
+			update_bar( m_current, tick );
+		}
+
+		if ( m_current.volume >= m_count ) {
+			finish_bar( m_current );
+			emit( m_current );
+			m_current.clear();
+		}
+	}
+
+	void TickBarBuilder::clear() {
+		m_current.clear();
+	}
+
+	// ---------------------------------------------------------------------------
+	// RangeBarBuilder
+	// ---------------------------------------------------------------------------
+
+	RangeBarBuilder::RangeBarBuilder(const double range): m_range( range ) {
+		m_current.clear();
+	}
+
+	std::string RangeBarBuilder::name() const {
+		std::ostringstream oss;
+		oss << "range:" << m_range;
+		return oss.str();
+	}
+
+	/*!
+	 * Close the bar as soon as high - low reaches the range,
+	 * the close price is capped to exactly one range.
+	 *
+	 * @param const Tick& tick
+	 */
+	void RangeBarBuilder::on_tick(const Tick& tick) {
+		if ( m_current.volume == 0 ) {
+			begin_bar( m_current, tick, m_range );
+			return;
+		}
+
+		update_bar( m_current, tick );
+
+		if ( Math::get_spread( m_current.low_price, m_current.high_price, m_current.point_size ) < m_range ) {
+			return;
+		}
+
+		if ( m_current.close_price >= m_current.high_price ) {
+			m_current.close_price = m_current.low_price + ( m_range * m_current.point_size );
+			m_current.high_price  = m_current.close_price;
+		} else {
+			m_current.close_price = m_current.high_price - ( m_range * m_current.point_size );
+			m_current.low_price   = m_current.close_price;
+		}
+
+		finish_bar( m_current );
+		emit( m_current );
+		m_current.clear();
+	}
+
+	void RangeBarBuilder::clear() {
+		m_current.clear();
+	}
+
+	// ---------------------------------------------------------------------------
+	// RenkoBarBuilder
+	// ---------------------------------------------------------------------------
+
+	RenkoBarBuilder::RenkoBarBuilder(const double period): m_period( period ) {
+		m_init_brick.clear();
+		m_last_brick.clear();
+		m_current_brick.clear();
+	}
+
+	std::string RenkoBarBuilder::name() const {
+		std::ostringstream oss;
+		oss << "renko:" << m_period;
+		return oss.str();
+	}
+
+	/*!
+	 * Store, log and signal brick
+	 *
+	 * @param Bar&        brick
+	 * @param const char* label for debug output
+	 */
+	void RenkoBarBuilder::add_brick(Bar& brick, const char* label) {
+#ifdef CMAKE_SHOW_DEBUG_OUTPUT
+		std::stringstream ss_console;
+		ss_console << brick.symbol << " " << label << " " << brick;
+		console()->info("[RenkoBarBuilder] {}", ss_console.str() );
+#else
+		(void) label;
+#endif
+
+		emit( brick );
+		m_last_brick = brick;
+	}
+
+	/*!
+	 * React to on_tick call
+	 *
+	 * @param const Tick& tick
+	 */
+	void RenkoBarBuilder::on_tick(const Tick& tick) {
+		// is this the first brick?
+		if ( m_last_brick.status == Bar::STATUS::NOSTATUS ) {
+			if ( init_brick( tick ) ) {
+				return;
+			}
+		}
+
+		// renko calculation
+		if ( m_current_brick.status == Bar::STATUS::NOSTATUS && m_current_brick.volume == 0 ) {
+			m_current_brick.symbol     = *tick.symbol;
+			m_current_brick.period     = m_period;
+			m_current_brick.open_time  = m_last_brick.close_time;
+			m_current_brick.open_price = m_last_brick.close_price;
+			m_current_brick.low_price  = m_last_brick.close_price;
+			m_current_brick.volume     = 1;
+			m_current_brick.point_size = tick.point_size;
+		}
+
+		// increase volume
+		m_current_brick.volume++;
+
+		// continue trend from close or reverse from open of the last brick
+		const Bar::STATUS last_status = m_last_brick.status;
+		if ( last_status == Bar::STATUS::NOSTATUS ) {
+			return;
+		}
+
+		const bool is_long = last_status == Bar::STATUS::LONG;
+		const double trend_price   = m_last_brick.close_price;
+		const double reverse_price = m_last_brick.open_price;
+
+		const bool trend = is_long
+			? tick.bid > trend_price && Math::get_spread( tick.bid, trend_price, tick.point_size ) >= m_period
+			: tick.bid < trend_price && Math::get_spread( tick.bid, trend_price, tick.point_size ) >= m_period;
+
+		const bool reverse = ! trend && ( is_long
+			? tick.bid < reverse_price && Math::get_spread( tick.bid, reverse_price, tick.point_size ) >= m_period
+			: tick.bid > reverse_price && Math::get_spread( tick.bid, reverse_price, tick.point_size ) >= m_period );
+
+		if ( ! trend && ! reverse ) {
+			return;
+		}
+
+		const double base_price = trend ? trend_price : reverse_price;
+		const bool brick_long   = trend ? is_long : ! is_long;
+
+		m_current_brick.open_time   = trend ? m_last_brick.close_time : m_last_brick.open_time;
+		m_current_brick.open_price  = base_price;
+		m_current_brick.diff        = Math::get_spread( tick.bid, base_price, tick.point_size );
+		m_current_brick.close_price = tick.bid;
+		m_current_brick.close_time  = *tick.sending_time;
+		m_current_brick.status      = brick_long ? Bar::STATUS::LONG : Bar::STATUS::SHORT;
+
+		// correct price and diff if it is != m_period
+		if ( m_current_brick.diff > m_period ) {
+			m_current_brick.close_price = base_price + ( brick_long ? 1 : -1 ) * ( m_period * tick.point_size );
+			m_current_brick.diff        = m_period;
+		}
+
+		m_current_brick.low_price  = brick_long ? m_current_brick.open_price : m_current_brick.close_price;
+		m_current_brick.high_price = brick_long ? m_current_brick.close_price : m_current_brick.open_price;
+
+		add_brick( m_current_brick, is_long
+			? ( brick_long ? "L+LONG " : "L+SHORT" )
+			: ( brick_long ? "S+LONG " : "S+SHORT" ) );
+
+		// reset current brick
+		m_current_brick.clear();
+	}
+
+	/*!
+	 * Add initial brick, the very first
+	 *
+	 * @param const Tick& tick
+	 * @return bool True if a brick was added
+	 */
+	bool RenkoBarBuilder::init_brick(const Tick& tick) {
+		// init first brick
+		if ( m_init_brick.status == Bar::STATUS::NOSTATUS && m_init_brick.volume == 0 ) {
+			m_init_brick.symbol     = *tick.symbol;
+			m_init_brick.period     = m_period;
+			m_init_brick.open_time  = *tick.sending_time;
+			m_init_brick.open_price = tick.bid;
+			m_init_brick.low_price  = tick.bid;
+			m_init_brick.volume     = 1;
+			m_init_brick.point_size = tick.point_size;
+		} else {
+			m_init_brick.volume++;
+		}
+
+		if ( m_init_brick.volume < 2 || tick.bid == m_init_brick.open_price || Math::get_spread( tick.bid, m_init_brick.open_price, tick.point_size ) < m_period ) {
+			return false;
+		}
+
+		const bool brick_long = tick.bid > m_init_brick.open_price;
+
+		m_init_brick.diff        = Math::get_spread( tick.bid, m_init_brick.open_price, tick.point_size );
+		m_init_brick.status      = brick_long ? Bar::STATUS::LONG : Bar::STATUS::SHORT;
+		m_init_brick.close_price = tick.bid;
+		m_init_brick.close_time  = *tick.sending_time;
+
+		if ( m_init_brick.diff > m_period ) {
+			m_init_brick.diff        = m_period;
+			m_init_brick.close_price = m_init_brick.open_price + ( brick_long ? 1 : -1 ) * ( m_period * tick.point_size );
+		}
+
+		if ( brick_long ) {
+			m_init_brick.high_price = m_init_brick.close_price;
+		} else {
+			m_init_brick.high_price = m_init_brick.open_price;
+			m_init_brick.low_price  = m_init_brick.close_price;
+		}
+
+		add_brick( m_init_brick, brick_long ? "0+LONG " : "0+SHORT" );
+		m_init_brick.clear();
+
+		return true;
+	}
+
+	void RenkoBarBuilder::clear() {
+		m_init_brick.clear();
+		m_last_brick.clear();
+		m_current_brick.clear();
+	}
+
+	// ---------------------------------------------------------------------------
+	// HeikinAshiBarBuilder
+	// ---------------------------------------------------------------------------
+
+	HeikinAshiBarBuilder::HeikinAshiBarBuilder(const int period): m_time_bars( period ) {
+		m_last.clear();
+		m_time_bars.on_bar.connect( std::bind( &HeikinAshiBarBuilder::on_time_bar, this, std::placeholders::_1 ) );
+	}
+
+	std::string HeikinAshiBarBuilder::name() const {
+		return "heikinashi:" + m_time_bars.name().substr( 5 );
+	}
+
+	void HeikinAshiBarBuilder::on_tick(const Tick& tick) {
+		m_time_bars.on_tick( tick );
+	}
+
+	/*!
+	 * Calculate Heikin-Ashi bar from the finished time bar
+	 *
+	 * @param const Bar& bar
+	 */
+	void HeikinAshiBarBuilder::on_time_bar(const Bar& bar) {
+		Bar ha = bar;
+		ha.close_price = ( bar.open_price + bar.high_price + bar.low_price + bar.close_price ) / 4;
+		ha.open_price  = m_last.volume > 0
+			? ( m_last.open_price + m_last.close_price ) / 2
+			: ( bar.open_price + bar.close_price ) / 2;
+		ha.high_price  = std::max( bar.high_price, std::max( ha.open_price, ha.close_price ) );
+		ha.low_price   = std::min( bar.low_price, std::min( ha.open_price, ha.close_price ) );
+		finish_bar( ha );
+
+		m_last = ha;
+		emit( ha );
+	}
+
+	void HeikinAshiBarBuilder::clear() {
+		m_time_bars.clear();
+		m_last.clear();
+	}
+};
@@ -0,0 +1,133 @@
+#ifndef IDEFIX_BARBUILDER_H
+#define IDEFIX_BARBUILDER_H
+
+#include <string>
+#include "Bar.h"
+#include "Tick.h"
+#include "BarStore.h"
+#include <nod/nod.hpp>
+
+namespace IDEFIX {
+	/*!
+	 * Base class of all bar builders.
+	 * A builder gets the decoded tick from BarPipeline, writes finished
+	 * bars into its BarStore series and emits on_bar.
+	 */
+	class AbstractBarBuilder {
+	protected:
+		BarStore* m_store;
+		int m_series;
+
+		void emit(const Bar& bar);
+		void begin_bar(Bar& bar, const Tick& tick, const double period);
+		void update_bar(Bar& bar, const Tick& tick);
+		void finish_bar(Bar& bar);
+
+	public:
+		AbstractBarBuilder();
+		virtual ~AbstractBarBuilder();
+
+		// unique name including parameters, e.g. renko:5
+		virtual std::string name() const = 0;
+		virtual void on_tick(const Tick& tick) = 0;
+		virtual void clear() = 0;
+
+		void attach(BarStore* store);
+		int series() const;
+
+		// signals
+		nod::signal<void(const Bar&)> on_bar;
+	};
+
+	/*!
+	 * Time bars, period in seconds
+	 */
+	class TimeBarBuilder: public AbstractBarBuilder {
+	private:
+		long long m_period_ms;
+		long long m_bucket;
+		Bar m_current;
+
+	public:
+		TimeBarBuilder(const int period);
+
+		std::string name() const;
+		void on_tick(const Tick& tick);
+		void clear();
+		void flush();
+	};
+
+	/*!
+	 * Tick count bars
+	 */
+	class TickBarBuilder: public AbstractBarBuilder {
+	private:
+		int m_count;
+		Bar m_current;
+
+	public:
+		TickBarBuilder(const int count);
+
+		std::string name() const;
+		void on_tick(const Tick& tick);
+		void clear();
+	};
+
+	/*!
+	 * Range bars, range in points
+	 */
+	class RangeBarBuilder: public AbstractBarBuilder {
+	private:
+		double m_range;
+		Bar m_current;
+
+	public:
+		RangeBarBuilder(const double range);
+
+		std::string name() const;
+		void on_tick(const Tick& tick);
+		void clear();
+	};
+
+	/*!
+	 * Renko bricks, brick size in points
+	 */
+	class RenkoBarBuilder: public AbstractBarBuilder {
+	private:
+		double m_period;
+
+		Bar m_current_brick;
+		Bar m_last_brick;
+		Bar m_init_brick;
+
+		bool init_brick(const Tick& tick);
+		void add_brick(Bar& brick, const char* label);
+
+	public:
+		RenkoBarBuilder(const double period);
+
+		std::string name() const;
+		void on_tick(const Tick& tick);
+		void clear();
+	};
+
+	/*!
+	 * Heikin-Ashi bars calculated from time bars, period in seconds
+	 */
+	class HeikinAshiBarBuilder: public AbstractBarBuilder {
+	private:
+		TimeBarBuilder m_time_bars;
+		Bar m_last;
+
+		void on_time_bar(const Bar& bar);
+
+	public:
+		HeikinAshiBarBuilder(const int period);
+
+		std::string name() const;
+		void on_tick(const Tick& tick);
+		void clear();
+	};
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "BarPipeline.h"
+
+namespace IDEFIX {
+	BarPipeline::BarPipeline(const std::string& symbol, const size_t capacity): m_symbol( symbol ), m_store( capacity ) {}
+
+	BarPipeline::~BarPipeline() {
+		FIX::Locker lock( m_mutex );
+
+		for ( auto builder : m_builders ) {
+			delete builder;
+		}
+		m_builders.clear();
+	}
+
+	/*!
+	 * Register bar builder, the pipeline takes ownership.
+	 * If a builder with the same name exists already, the new one
+	 * gets deleted and the existing one is returned.
+	 *
+	 * @param AbstractBarBuilder* builder
+	 * @return AbstractBarBuilder* the registered builder
+	 */
+	AbstractBarBuilder* BarPipeline::add(AbstractBarBuilder* builder) {
+		if ( builder == nullptr ) {
+			return nullptr;
+		}
+
+		FIX::Locker lock( m_mutex );
+
+		const std::string name = builder->name();
+		for ( auto b : m_builders ) {
+			if ( b->name() == name ) {
+				delete builder;
+				return b;
+			}
+		}
+
+		builder->attach( &m_store );
+		m_builders.push_back( builder );
+
+		return builder;
+	}
+
+	/*!
+	 * Get registered builder by name
+	 *
+	 * @param const std::string& name e.g. renko:5
+	 * @return AbstractBarBuilder* nullptr if not found
+	 */
+	AbstractBarBuilder* BarPipeline::get(const std::string& name) {
+		FIX::Locker lock( m_mutex );
+
+		for ( auto b : m_builders ) {
+			if ( b->name() == name ) {
+				return b;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/*!
+	 * Return builder count
+	 *
+	 * @return size_t
+	 */
+	size_t BarPipeline::size() {
+		FIX::Locker lock( m_mutex );
+		return m_builders.size();
+	}
+
+	/*!
+	 * Decode snapshot and fan out to all builders.
+	 * Snapshots of other symbols are ignored if the pipeline has a symbol.
+	 *
+	 * @param const MarketSnapshot& snapshot
+	 */
+	void BarPipeline::on_tick(const MarketSnapshot& snapshot) {
+		if ( ! m_symbol.empty() && snapshot.getSymbol() != m_symbol ) {
+			return;
+		}
+
+		on_tick( decode_tick( snapshot ) );
+	}
+
+	/*!
+	 * Fan out decoded tick to all builders
+	 *
+	 * @param const Tick& tick
+	 */
+	void BarPipeline::on_tick(const Tick& tick) {
+		FIX::Locker lock( m_mutex );
+
+		for ( auto b : m_builders ) {
+			b->on_tick( tick );
+		}
+	}
+
+	/*!
+	 * Return symbol, empty if the pipeline accepts all symbols
+	 *
+	 * @return const std::string&
+	 */
+	const std::string& BarPipeline::symbol() const {
+		return m_symbol;
+	}
+
+	/*!
+	 * Return store with the bars of all builders
+	 *
+	 * @return BarStore&
+	 */
+	BarStore& BarPipeline::store() {
+		return m_store;
+	}
+};
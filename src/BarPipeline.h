@@ -0,0 +1,40 @@
+#ifndef IDEFIX_BARPIPELINE_H
+#define IDEFIX_BARPIPELINE_H
+
+#include <string>
+#include <vector>
+#include "MarketSnapshot.h"
+#include "BarBuilder.h"
+#include "BarStore.h"
+#include <quickfix/Mutex.h>
+
+namespace IDEFIX {
+	/*!
+	 * Bar building stage of one symbol.
+	 * Every tick is decoded once and handed to all registered bar builders,
+	 * finished bars of all builders live in one BarStore.
+	 */
+	class BarPipeline {
+	private:
+		FIX::Mutex m_mutex;
+		std::string m_symbol;
+		BarStore m_store;
+		std::vector<AbstractBarBuilder*> m_builders;
+
+	public:
+		BarPipeline(const std::string& symbol = "", const size_t capacity = BarStore::DEFAULT_CAPACITY);
+		~BarPipeline();
+
+		AbstractBarBuilder* add(AbstractBarBuilder* builder);
+		AbstractBarBuilder* get(const std::string& name);
+		size_t size();
+
+		void on_tick(const MarketSnapshot& snapshot);
+		void on_tick(const Tick& tick);
+
+		const std::string& symbol() const;
+		BarStore& store();
+	};
+};
+
+#endif
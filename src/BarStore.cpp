@@ -0,0 +1,170 @@
+#include "BarStore.h"
+
+namespace IDEFIX {
+	BarStore::BarStore(const size_t capacity): m_capacity( capacity > 0 ? capacity : 1 ) {}
+
+	BarStore::~BarStore() {}
+
+	/*!
+	 * Get series id by name, the series will be created if it does not exist
+	 *
+	 * @param const std::string& name
+	 * @return int
+	 */
+	int BarStore::series(const std::string& name) {
+		FIX::Locker lock( m_mutex );
+
+		for ( size_t i = 0; i < m_series.size(); i++ ) {
+			if ( m_series[i].name == name ) {
+				return i;
+			}
+		}
+
+		m_series.push_back( Series() );
+		Series& s = m_series.back();
+		s.name  = name;
+		s.total = 0;
+		s.bars.reserve( m_capacity );
+
+		return m_series.size() - 1;
+	}
+
+	/*!
+	 * Return series name
+	 *
+	 * @param const int series
+	 * @return std::string
+	 * @throw IDEFIX::out_of_range
+	 */
+	std::string BarStore::series_name(const int series) {
+		FIX::Locker lock( m_mutex );
+
+		if ( series < 0 || series >= (int) m_series.size() ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		return m_series[series].name;
+	}
+
+	/*!
+	 * Return series count
+	 *
+	 * @return int
+	 */
+	int BarStore::series_count() {
+		FIX::Locker lock( m_mutex );
+		return m_series.size();
+	}
+
+	/*!
+	 * Add bar to series, the oldest bar will be overwritten if the series is full
+	 *
+	 * @param const int  series
+	 * @param const Bar& bar
+	 */
+	void BarStore::add(const int series, const Bar& bar) {
+		FIX::Locker lock( m_mutex );
+
+		if ( series < 0 || series >= (int) m_series.size() ) {
+			return;
+		}
+
+		Series& s = m_series[series];
+		if ( s.bars.size() < m_capacity ) {
+			s.bars.push_back( bar );
+		} else {
+			s.bars[ s.total % m_capacity ] = bar;
+		}
+		s.total++;
+	}
+
+	/*!
+	 * Get bar at index
+	 * The index is backwards:
+	 * [4,3,2,1,0] 0 is the newest element
+	 *
+	 * @param const int series
+	 * @param const int index
+	 * @return Bar
+	 * @throw IDEFIX::out_of_range if there were never index+1 bars
+	 * @throw IDEFIX::element_not_found if the bar was dropped from the ring
+	 */
+	Bar BarStore::at(const int series, const int index) throw( IDEFIX::out_of_range, IDEFIX::element_not_found ) {
+		FIX::Locker lock( m_mutex );
+
+		if ( series < 0 || series >= (int) m_series.size() || index < 0 ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		const Series& s = m_series[series];
+		if ( (size_t) index >= s.total ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		if ( (size_t) index >= s.bars.size() ) {
+			throw element_not_found(__FILE__, __LINE__);
+		}
+
+		return s.bars[ ( s.total - 1 - index ) % m_capacity ];
+	}
+
+	/*!
+	 * Return how many bars were added to the series
+	 *
+	 * @param const int series
+	 * @return int
+	 */
+	int BarStore::count(const int series) {
+		FIX::Locker lock( m_mutex );
+
+		if ( series < 0 || series >= (int) m_series.size() ) {
+			return 0;
+		}
+
+		return m_series[series].total;
+	}
+
+	/*!
+	 * Return stored bars of series, oldest first
+	 *
+	 * @param const int series
+	 * @return std::vector<Bar>
+	 */
+	std::vector<Bar> BarStore::list(const int series) {
+		FIX::Locker lock( m_mutex );
+
+		std::vector<Bar> result;
+		if ( series < 0 || series >= (int) m_series.size() ) {
+			return result;
+		}
+
+		const Series& s = m_series[series];
+		result.reserve( s.bars.size() );
+		for ( size_t i = s.total - s.bars.size(); i < s.total; i++ ) {
+			result.push_back( s.bars[ i % m_capacity ] );
+		}
+
+		return result;
+	}
+
+	/*!
+	 * Return max bars per series
+	 *
+	 * @return size_t
+	 */
+	size_t BarStore::capacity() const {
+		return m_capacity;
+	}
+
+	/*!
+	 * Remove all bars, series ids stay valid
+	 */
+	void BarStore::clear() {
+		FIX::Locker lock( m_mutex );
+
+		for ( auto& s : m_series ) {
+			s.bars.clear();
+			s.total = 0;
+		}
+	}
+};
@@ -0,0 +1,50 @@
+#ifndef IDEFIX_BARSTORE_H
+#define IDEFIX_BARSTORE_H
+
+#include <vector>
+#include <string>
+#include "Bar.h"
+#include "Exceptions.h"
+#include <quickfix/Mutex.h>
+
+namespace IDEFIX {
+	/*!
+	 * One store for all bars and bricks of a symbol.
+	 * Every bar builder writes into its own series, each series
+	 * is a ring buffer of fixed capacity, DEFAULT_CAPACITY (4096) bars
+	 * unless set otherwise. Older bars are dropped and at() throws
+	 * IDEFIX::element_not_found for them, count() still includes them.
+	 */
+	class BarStore {
+	public:
+		static const size_t DEFAULT_CAPACITY = 4096;
+
+	private:
+		struct Series {
+			std::string name;
+			std::vector<Bar> bars;
+			size_t total;
+		};
+
+		FIX::Mutex m_mutex;
+		size_t m_capacity;
+		std::vector<Series> m_series;
+
+	public:
+		BarStore(const size_t capacity = DEFAULT_CAPACITY);
+		~BarStore();
+
+		int series(const std::string& name);
+		std::string series_name(const int series);
+		int series_count();
+
+		void add(const int series, const Bar& bar);
+		Bar at(const int series, const int index) throw( IDEFIX::out_of_range, IDEFIX::element_not_found );
+		int count(const int series);
+		std::vector<Bar> list(const int series);
+		size_t capacity() const;
+		void clear();
+	};
+};
+
+#endif
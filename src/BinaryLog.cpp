@@ -0,0 +1,433 @@
+#include "BinaryLog.h"
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <quickfix/Utility.h>
+
+namespace IDEFIX {
+	namespace {
+		const char MAGIC[8] = { 'I', 'D', 'F', 'X', 'B', 'L', 'O', 'G' };
+
+		inline int64_t now_ms() {
+			return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+		}
+	};
+
+	/*!
+	 * Open log file for appending
+	 *
+	 * @param const std::string&  filename
+	 * @param const unsigned int  sample     log every sample-th incoming message
+	 * @param const size_t        queue_size rounded up to a power of 2
+	 * @throw FIX::ConfigError
+	 */
+	BinaryLog::BinaryLog(const std::string& filename, const unsigned int sample, const size_t queue_size) throw( FIX::ConfigError )
+		: m_filename( filename ), m_fd( -1 ), m_sample( std::max( 1u, sample ) ), m_incoming( 0 ),
+		  m_mask( 0 ), m_enqueue_pos( 0 ), m_dequeue_pos( 0 ), m_dropped( 0 ), m_wakeup( nullptr ), m_last_write( std::chrono::steady_clock::now() ) {
+
+		size_t size = 2;
+		while ( size < queue_size ) {
+			size *= 2;
+		}
+
+		m_mask  = size - 1;
+		m_cells.reset( new Cell[size] );
+		for ( size_t i = 0; i < size; i++ ) {
+			m_cells[i].sequence.store( i, std::memory_order_relaxed );
+		}
+
+		m_fd = ::open( m_filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+		if ( m_fd < 0 ) {
+			throw FIX::ConfigError( "Could not open " + m_filename + ": " + strerror( errno ) );
+		}
+
+		// new file
+		struct stat st;
+		if ( fstat( m_fd, &st ) == 0 && st.st_size == 0 ) {
+			Header header;
+			memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+			header.version  = VERSION;
+			header.reserved = 0;
+			m_buffer.append( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+		}
+		m_buffer.reserve( FLUSH_SIZE * 2 );
+
+		const size_t slash     = m_filename.find_last_of( '/' );
+		const std::string name = slash == std::string::npos ? m_filename : m_filename.substr( slash + 1 );
+		m_metric_backlog = Metrics::gauge( "idefix_binlog_backlog", Metrics::label( "log", name ) );
+		m_metric_dropped = Metrics::counter( "idefix_binlog_dropped_total", Metrics::label( "log", name ) );
+	}
+
+	BinaryLog::~BinaryLog() {
+		drain( true );
+		if ( m_fd >= 0 ) {
+			::close( m_fd );
+		}
+	}
+
+	void BinaryLog::clear() {}
+
+	void BinaryLog::backup() {}
+
+	void BinaryLog::onIncoming(const std::string& message) {
+		// only the session thread logs incoming messages
+		if ( m_sample > 1 && m_incoming++ % m_sample != 0 ) {
+			return;
+		}
+		push( INCOMING, message );
+	}
+
+	void BinaryLog::onOutgoing(const std::string& message) {
+		push( OUTGOING, message );
+	}
+
+	void BinaryLog::onEvent(const std::string& message) {
+		push( EVENT, message );
+	}
+
+	/*!
+	 * Copy message into the next free cell, the strings of the cells keep
+	 * their capacity, so there is no allocation once the ring is warm.
+	 *
+	 * @param const Kind         kind
+	 * @param const std::string& message
+	 * @return bool false if the ring is full
+	 */
+	bool BinaryLog::push(const Kind kind, const std::string& message) {
+		size_t pos = m_enqueue_pos.load( std::memory_order_relaxed );
+		Cell* cell;
+
+		for ( ;; ) {
+			cell = &m_cells[pos & m_mask];
+			const size_t sequence = cell->sequence.load( std::memory_order_acquire );
+			const intptr_t diff   = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( pos );
+
+			if ( diff == 0 ) {
+				if ( m_enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+					break;
+				}
+			} else if ( diff < 0 ) {
+				m_dropped.fetch_add( 1, std::memory_order_relaxed );
+				return false;
+			} else {
+				pos = m_enqueue_pos.load( std::memory_order_relaxed );
+			}
+		}
+
+		cell->kind    = kind;
+		cell->time_ms = now_ms();
+		cell->data.assign( message );
+		cell->sequence.store( pos + 1, std::memory_order_release );
+
+		if ( m_wakeup != nullptr ) {
+			m_wakeup->notify();
+		}
+
+		return true;
+	}
+
+	/*!
+	 * Move all queued messages into the file buffer, called by the writer thread.
+	 * The buffer is written if it exceeds FLUSH_SIZE or after one second.
+	 *
+	 * @param const bool flush write the buffer in any case
+	 * @return size_t count of messages taken from the ring
+	 */
+	size_t BinaryLog::drain(const bool flush) {
+		size_t count = 0;
+
+		for ( ;; ) {
+			Cell& cell = m_cells[m_dequeue_pos & m_mask];
+			if ( cell.sequence.load( std::memory_order_acquire ) != m_dequeue_pos + 1 ) {
+				break;
+			}
+
+			RecordHeader record;
+			record.size        = cell.data.size();
+			record.kind        = cell.kind;
+			record.reserved[0] = record.reserved[1] = record.reserved[2] = 0;
+			record.time_ms     = cell.time_ms;
+			m_buffer.append( reinterpret_cast<const char*>( &record ), sizeof( RecordHeader ) );
+			m_buffer.append( cell.data );
+
+			cell.sequence.store( m_dequeue_pos + m_mask + 1, std::memory_order_release );
+			m_dequeue_pos++;
+			count++;
+		}
+
+		// messages still queued by the producers
+		m_metric_backlog.set( m_enqueue_pos.load( std::memory_order_relaxed ) - m_dequeue_pos );
+
+		// dropped messages are logged as event
+		const unsigned long dropped = m_dropped.exchange( 0 );
+		if ( dropped > 0 ) {
+			m_metric_dropped.inc( dropped );
+
+			const std::string text = "BinaryLog dropped " + std::to_string( dropped ) + " messages, queue full";
+
+			RecordHeader record;
+			record.size        = text.size();
+			record.kind        = EVENT;
+			record.reserved[0] = record.reserved[1] = record.reserved[2] = 0;
+			record.time_ms     = now_ms();
+			m_buffer.append( reinterpret_cast<const char*>( &record ), sizeof( RecordHeader ) );
+			m_buffer.append( text );
+		}
+
+		if ( flush || m_buffer.size() >= FLUSH_SIZE || std::chrono::steady_clock::now() - m_last_write >= std::chrono::seconds( 1 ) ) {
+			write_buffer();
+		}
+
+		return count;
+	}
+
+	void BinaryLog::write_buffer() {
+		m_last_write = std::chrono::steady_clock::now();
+		if ( m_buffer.empty() || m_fd < 0 ) {
+			return;
+		}
+
+		const char* p    = m_buffer.data();
+		size_t remaining = m_buffer.size();
+		while ( remaining > 0 ) {
+			const ssize_t written = ::write( m_fd, p, remaining );
+			if ( written < 0 ) {
+				if ( errno == EINTR ) {
+					continue;
+				}
+				break;
+			}
+			p         += written;
+			remaining -= written;
+		}
+
+		m_buffer.clear();
+	}
+
+	/*!
+	 * Messages or dropped counts waiting for drain, called by the writer thread
+	 *
+	 * @return bool
+	 */
+	bool BinaryLog::pending() const {
+		return m_enqueue_pos.load( std::memory_order_relaxed ) != m_dequeue_pos || m_dropped.load( std::memory_order_relaxed ) > 0;
+	}
+
+	/*!
+	 * Notify the writer on every message
+	 *
+	 * @param BinaryLogWakeup* wakeup nullptr to disable
+	 */
+	void BinaryLog::set_wakeup(BinaryLogWakeup* wakeup) {
+		m_wakeup = wakeup;
+	}
+
+	/*!
+	 * Dropped messages since the last drain
+	 *
+	 * @return unsigned long
+	 */
+	unsigned long BinaryLog::dropped() const {
+		return m_dropped.load( std::memory_order_relaxed );
+	}
+
+	/*!
+	 * Call callback for every record of a log file until it returns false
+	 *
+	 * @param const std::string&                        filename
+	 * @param const std::function<bool(const Record&)>& callback
+	 * @return size_t count of records
+	 * @throw IDEFIX::file_not_found
+	 * @throw IDEFIX::out_of_range   if the file is no binary log
+	 */
+	size_t BinaryLog::read(const std::string& filename, const std::function<bool(const Record&)>& callback) throw( IDEFIX::file_not_found, IDEFIX::out_of_range ) {
+		const int fd = ::open( filename.c_str(), O_RDONLY );
+		if ( fd < 0 ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		struct stat st;
+		if ( fstat( fd, &st ) != 0 || static_cast<size_t>( st.st_size ) < sizeof( Header ) ) {
+			::close( fd );
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		const size_t size = st.st_size;
+		void* mapped      = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		::close( fd );
+		if ( mapped == MAP_FAILED ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+		madvise( mapped, size, MADV_SEQUENTIAL );
+
+		const char* data = static_cast<const char*>( mapped );
+		Header header;
+		memcpy( &header, data, sizeof( Header ) );
+		if ( memcmp( header.magic, MAGIC, sizeof( MAGIC ) ) != 0 || header.version != VERSION ) {
+			munmap( mapped, size );
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		size_t offset = sizeof( Header );
+		size_t count  = 0;
+		while ( offset + sizeof( RecordHeader ) <= size ) {
+			RecordHeader record_header;
+			memcpy( &record_header, data + offset, sizeof( RecordHeader ) );
+			offset += sizeof( RecordHeader );
+
+			// incomplete last record
+			if ( offset + record_header.size > size ) {
+				break;
+			}
+
+			Record record;
+			record.kind    = static_cast<Kind>( record_header.kind );
+			record.time_ms = record_header.time_ms;
+			record.data    = data + offset;
+			record.size    = record_header.size;
+			offset += record_header.size;
+
+			count++;
+			if ( ! callback( record ) ) {
+				break;
+			}
+		}
+
+		munmap( mapped, size );
+		return count;
+	}
+
+	std::string BinaryLog::kind_name(const Kind kind) {
+		switch ( kind ) {
+			case INCOMING: return "incoming";
+			case OUTGOING: return "outgoing";
+			case EVENT:    return "event";
+		}
+		return "unknown";
+	}
+
+	/*!
+	 * Start writer thread. It drains copies of the log list without the lock
+	 * and sleeps until a producer notifies or one second has passed, which
+	 * writes buffers older than one second.
+	 *
+	 * @param const FIX::SessionSettings& settings
+	 */
+	BinaryLogFactory::BinaryLogFactory(const FIX::SessionSettings& settings): m_settings( settings ), m_running( true ) {
+		m_writer = std::thread( [this]() {
+			std::vector<std::shared_ptr<BinaryLog>> logs;
+			while ( m_running ) {
+				{
+					std::lock_guard<std::mutex> lock( m_mutex );
+					logs.assign( m_logs.begin(), m_logs.end() );
+				}
+
+				size_t count = 0;
+				for ( auto& log : logs ) {
+					count += log->drain();
+				}
+
+				if ( count > 0 ) {
+					continue;
+				}
+
+				// the flag is set before the rings are checked, a producer either
+				// sees it and notifies or its message is found here
+				std::unique_lock<std::mutex> lock( m_wakeup.mutex );
+				m_wakeup.sleeping.store( true, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+
+				bool pending = false;
+				for ( auto& log : logs ) {
+					pending = pending || log->pending();
+				}
+				logs.clear();
+
+				if ( ! pending && m_running ) {
+					m_wakeup.cond.wait_for( lock, std::chrono::seconds( 1 ) );
+				}
+				m_wakeup.sleeping.store( false, std::memory_order_relaxed );
+			}
+		});
+	}
+
+	/*!
+	 * Stop writer thread, all logs are written
+	 */
+	BinaryLogFactory::~BinaryLogFactory() {
+		m_running = false;
+		{
+			std::lock_guard<std::mutex> lock( m_wakeup.mutex );
+			m_wakeup.cond.notify_all();
+		}
+		if ( m_writer.joinable() ) {
+			m_writer.join();
+		}
+
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_logs.clear();
+	}
+
+	BinaryLog* BinaryLogFactory::add(const std::string& path, const std::string& name, const unsigned int sample) {
+		FIX::file_mkdir( path.c_str() );
+		std::shared_ptr<BinaryLog> log( new BinaryLog( FIX::file_appendpath( path, name + ".binlog" ), sample ) );
+		log->set_wakeup( &m_wakeup );
+
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_logs.push_back( log );
+		return log.get();
+	}
+
+	/*!
+	 * Global log for events without session
+	 *
+	 * @return FIX::Log*
+	 */
+	FIX::Log* BinaryLogFactory::create() {
+		const FIX::Dictionary& settings = m_settings.get();
+		return add( settings.has( FIX::FILE_LOG_PATH ) ? settings.getString( FIX::FILE_LOG_PATH ) : ".", "GLOBAL", 1 );
+	}
+
+	/*!
+	 * Log of session
+	 *
+	 * @param const FIX::SessionID& session_ID
+	 * @return FIX::Log*
+	 * @throw FIX::ConfigError
+	 */
+	FIX::Log* BinaryLogFactory::create(const FIX::SessionID& session_ID) {
+		const FIX::Dictionary settings = m_settings.get( session_ID );
+		const unsigned int sample      = settings.has( "BinaryLogSample" ) ? settings.getLong( "BinaryLogSample" ) : 1;
+
+		std::string name = session_ID.getBeginString().getValue() + "-" + session_ID.getSenderCompID().getValue() + "-" + session_ID.getTargetCompID().getValue();
+		if ( ! session_ID.getSessionQualifier().empty() ) {
+			name += "-" + session_ID.getSessionQualifier();
+		}
+
+		return add( settings.getString( FIX::FILE_LOG_PATH ), name, sample );
+	}
+
+	/*!
+	 * Remove log from the writer, its queue is written
+	 *
+	 * @param FIX::Log* log
+	 */
+	void BinaryLogFactory::destroy(FIX::Log* log) {
+		std::shared_ptr<BinaryLog> removed;
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			for ( auto it = m_logs.begin(); it != m_logs.end(); ++it ) {
+				if ( it->get() == log ) {
+					removed = *it;
+					m_logs.erase( it );
+					break;
+				}
+			}
+		}
+		// deleted here or by the writer after its current pass
+	}
+};
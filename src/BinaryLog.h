@@ -0,0 +1,170 @@
+#ifndef IDEFIX_BINARYLOG_H
+#define IDEFIX_BINARYLOG_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+#include <quickfix/Log.h>
+#include <quickfix/SessionSettings.h>
+#include "Exceptions.h"
+#include "Metrics.h"
+
+namespace IDEFIX {
+	/*!
+	 * Wakes the writer thread of BinaryLogFactory. The writer sets sleeping
+	 * before it waits, producers only take the mutex if it is set.
+	 */
+	struct BinaryLogWakeup {
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::atomic<bool> sleeping;
+
+		BinaryLogWakeup(): sleeping( false ) {}
+
+		inline void notify() {
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			if ( sleeping.load( std::memory_order_relaxed ) ) {
+				std::lock_guard<std::mutex> lock( mutex );
+				cond.notify_one();
+			}
+		}
+	};
+
+	/*!
+	 * quickfix Log which copies the raw messages into a lock free ring, a
+	 * background thread of BinaryLogFactory writes them to a binary file.
+	 * The session thread never does I/O and only wakes the writer if it
+	 * sleeps, if the ring is full the message is dropped and counted.
+	 *
+	 * File: Header | Record | Record | ...
+	 * Record: size, kind, time in ms since epoch, raw message
+	 *
+	 * Only every sample-th incoming message is logged, outgoing messages and
+	 * events are always logged. The file is append only, clear and backup
+	 * of quickfix are ignored.
+	 */
+	class BinaryLog: public FIX::Log {
+	public:
+		enum Kind : uint8_t {
+			INCOMING = 0,
+			OUTGOING = 1,
+			EVENT = 2
+		};
+
+		static const uint32_t VERSION = 1;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t reserved;
+		};
+
+		struct RecordHeader {
+			uint32_t size;
+			uint8_t kind;
+			uint8_t reserved[3];
+			int64_t time_ms;
+		};
+
+		struct Record {
+			Kind kind;
+			int64_t time_ms;
+			const char* data;
+			size_t size;
+		};
+
+	private:
+		// Vyukov bounded queue, many producers and the writer thread as consumer
+		struct Cell {
+			std::atomic<size_t> sequence;
+			Kind kind;
+			int64_t time_ms;
+			std::string data;
+		};
+
+		std::string m_filename;
+		int m_fd;
+		unsigned int m_sample;
+		unsigned int m_incoming;
+
+		std::unique_ptr<Cell[]> m_cells;
+		size_t m_mask;
+		std::atomic<size_t> m_enqueue_pos;
+		size_t m_dequeue_pos;
+		std::atomic<unsigned long> m_dropped;
+		BinaryLogWakeup* m_wakeup;
+
+		// writer thread only
+		std::string m_buffer;
+		std::chrono::steady_clock::time_point m_last_write;
+		Metrics::Gauge m_metric_backlog;
+		Metrics::Counter m_metric_dropped;
+
+		bool push(const Kind kind, const std::string& message);
+		void write_buffer();
+
+	public:
+		// defaults of the factory
+		static const size_t QUEUE_SIZE = 1 << 13;
+		static const size_t FLUSH_SIZE = 1 << 16;
+
+		BinaryLog(const std::string& filename, const unsigned int sample = 1, const size_t queue_size = QUEUE_SIZE) throw( FIX::ConfigError );
+		virtual ~BinaryLog();
+
+		void clear();
+		void backup();
+		void onIncoming(const std::string& message);
+		void onOutgoing(const std::string& message);
+		void onEvent(const std::string& message);
+
+		size_t drain(const bool flush = false);
+		bool pending() const;
+		unsigned long dropped() const;
+		void set_wakeup(BinaryLogWakeup* wakeup);
+
+		static size_t read(const std::string& filename, const std::function<bool(const Record&)>& callback) throw( IDEFIX::file_not_found, IDEFIX::out_of_range );
+		static std::string kind_name(const Kind kind);
+	};
+
+	/*!
+	 * Creates BinaryLog for every session and writes all of them
+	 * from one background thread.
+	 *
+	 * Settings of the session:
+	 * FileLogPath=./Logs
+	 * BinaryLogSample=100            log every 100th incoming message, defaults to 1
+	 *
+	 * Files: [FileLogPath]/[BeginString]-[SenderCompID]-[TargetCompID].binlog
+	 *        [FileLogPath]/GLOBAL.binlog
+	 */
+	class BinaryLogFactory: public FIX::LogFactory {
+	private:
+		FIX::SessionSettings m_settings;
+		// the writer drains copies of the list, a destroyed log is deleted after the pass
+		std::list<std::shared_ptr<BinaryLog>> m_logs;
+		std::mutex m_mutex;
+		std::thread m_writer;
+		std::atomic<bool> m_running;
+		BinaryLogWakeup m_wakeup;
+
+		BinaryLog* add(const std::string& path, const std::string& name, const unsigned int sample);
+
+	public:
+		BinaryLogFactory(const FIX::SessionSettings& settings);
+		~BinaryLogFactory();
+
+		FIX::Log* create();
+		FIX::Log* create(const FIX::SessionID& session_ID);
+		void destroy(FIX::Log* log);
+	};
+};
+
+#endif
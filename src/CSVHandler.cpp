@@ -1,9 +1,131 @@
 #include "CSVHandler.h"
-#include <fstream>
-#include <iostream>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 #include "StringHelper.h"
+#include "Metrics.h"
 
 namespace IDEFIX {
+	namespace {
+		/*!
+		 * Open files by path, flush settings and the background writer
+		 */
+		struct CSVRegistry {
+			std::mutex mutex;
+			std::map<std::string, std::shared_ptr<CSVFile>> files;
+			std::atomic<size_t> flush_size;
+			std::atomic<int> flush_interval_ms;
+
+			std::thread writer;
+			std::atomic<bool> running;
+			std::condition_variable wakeup;
+
+			CSVRegistry(): flush_size( CSVHandler::FLUSH_SIZE ), flush_interval_ms( CSVHandler::FLUSH_INTERVAL_MS ), running( false ) {}
+
+			// the files write their buffers when they are destroyed
+			~CSVRegistry() {
+				if ( running ) {
+					running = false;
+					wakeup.notify_all();
+					writer.join();
+				}
+			}
+		};
+
+		CSVRegistry& registry() {
+			static CSVRegistry instance;
+			return instance;
+		}
+
+		// bytes in the buffers of all files
+		Metrics::Gauge& backlog() {
+			static Metrics::Gauge gauge = Metrics::gauge( "idefix_csv_backlog_bytes" );
+			return gauge;
+		}
+	};
+
+	CSVFile::CSVFile(const std::string& filename): m_last_flush( std::chrono::steady_clock::now() ) {
+		m_fd = ::open( filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+		m_buffer.reserve( CSVHandler::flush_size() );
+	}
+
+	CSVFile::~CSVFile() {
+		flush();
+		if ( m_fd >= 0 ) {
+			::close( m_fd );
+		}
+	}
+
+	bool CSVFile::is_open() const {
+		return m_fd >= 0;
+	}
+
+	/*!
+	 * Append line to the buffer, the buffer is written if it exceeds
+	 * the flush size or interval. With the background writer only
+	 * four times the flush size are written here.
+	 *
+	 * @param const std::string& line
+	 * @param const bool         add_endl
+	 * @param const bool         background
+	 */
+	void CSVFile::append(const std::string& line, const bool add_endl, const bool background) {
+		FIX::Locker lock( m_mutex );
+
+		m_buffer.append( line );
+		if ( add_endl ) {
+			m_buffer.push_back( '\n' );
+		}
+		backlog().add( line.size() + ( add_endl ? 1 : 0 ) );
+
+		const size_t size = CSVHandler::flush_size();
+		if ( background ) {
+			if ( m_buffer.size() >= size * 4 ) {
+				write_buffer();
+			}
+		} else if ( m_buffer.size() >= size || std::chrono::steady_clock::now() - m_last_flush >= CSVHandler::flush_interval() ) {
+			write_buffer();
+		}
+	}
+
+	void CSVFile::flush() {
+		FIX::Locker lock( m_mutex );
+		write_buffer();
+	}
+
+	/*!
+	 * Write the whole buffer, the caller holds the lock
+	 */
+	void CSVFile::write_buffer() {
+		m_last_flush = std::chrono::steady_clock::now();
+		if ( m_buffer.empty() || m_fd < 0 ) {
+			return;
+		}
+
+		const char* p    = m_buffer.data();
+		size_t remaining = m_buffer.size();
+		while ( remaining > 0 ) {
+			const ssize_t written = ::write( m_fd, p, remaining );
+			if ( written < 0 ) {
+				if ( errno == EINTR ) {
+					continue;
+				}
+				break;
+			}
+			p         += written;
+			remaining -= written;
+		}
+
+		backlog().add( -static_cast<int64_t>( m_buffer.size() ) );
+		m_buffer.clear();
+	}
+
 	CSVHandler::CSVHandler() {
 
 	}
@@ -14,19 +136,25 @@ namespace IDEFIX {
 
 	/*!
 	 * Set output path without filename
-	 * 
+	 *
 	 * @param const std::string& path
 	 */
 	void CSVHandler::set_path(const std::string &path) {
 		if ( m_path != path ) {
 			m_path = path;
+
+			// concatenate path
+			if ( ! m_path.empty() ) {
+				str::trailingslashit( m_path );
+			}
+			m_file.reset();
 		}
 	}
 
 	/*!
 	 * Set output filename without path
-	 * 
-	 * @param const std::string& name 
+	 *
+	 * @param const std::string& name
 	 */
 	void CSVHandler::set_filename(const std::string &name) {
 		if ( m_filename != name ) {
@@ -34,12 +162,14 @@ namespace IDEFIX {
 
 			// sanitize filename
 			str::replace( m_filename, "/", "" );
+			m_file.reset();
 		}
 	}
 
 	/*!
-	 * Add line to file, if add_endl is not set it defaults to true
-	 * 
+	 * Add line to file, if add_endl is not set it defaults to true.
+	 * The file is opened once and cached, the line is buffered.
+	 *
 	 * @param const std::string& line
 	 * @param const bool         add_endl defaults to true
 	 */
@@ -48,26 +178,141 @@ namespace IDEFIX {
 			return;
 		}
 
-		// concatenate path
-		str::trailingslashit( m_path );
+		if ( m_file == nullptr ) {
+			m_file = open( m_path + m_filename );
+			if ( m_file == nullptr ) {
+				return;
+			}
+		}
 
-		// open file to append
-		m_file.open( m_path + m_filename, std::ios::app | std::ios::out );
+		m_file->append( line, add_endl, has_writer() );
+	}
 
-		// check if everything is ok
-		if ( ! m_file.good() ) {
+	/*!
+	 * Write buffered lines of this file
+	 */
+	void CSVHandler::flush() {
+		if ( m_file != nullptr ) {
+			m_file->flush();
+		}
+	}
+
+	/*!
+	 * Cached file for path, failed opens are not cached
+	 *
+	 * @param const std::string& filename
+	 * @return std::shared_ptr<CSVFile> nullptr if the file can not be opened
+	 */
+	std::shared_ptr<CSVFile> CSVHandler::open(const std::string& filename) {
+		CSVRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+
+		auto it = reg.files.find( filename );
+		if ( it != reg.files.end() ) {
+			return it->second;
+		}
+
+		auto file = std::make_shared<CSVFile>( filename );
+		if ( ! file->is_open() ) {
+			return nullptr;
+		}
+
+		reg.files[filename] = file;
+		return file;
+	}
+
+	/*!
+	 * Buffer size and interval after which the buffer is written
+	 *
+	 * @param const size_t bytes
+	 * @param const int    interval_ms
+	 */
+	void CSVHandler::set_flush(const size_t bytes, const int interval_ms) {
+		registry().flush_size        = bytes;
+		registry().flush_interval_ms = interval_ms;
+	}
+
+	size_t CSVHandler::flush_size() {
+		return registry().flush_size;
+	}
+
+	std::chrono::milliseconds CSVHandler::flush_interval() {
+		return std::chrono::milliseconds( registry().flush_interval_ms );
+	}
+
+	/*!
+	 * Start thread which writes all buffers every flush interval
+	 */
+	void CSVHandler::start_writer() {
+		CSVRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		if ( reg.running ) {
 			return;
 		}
 
-		// write to file
-		m_file << line;
+		reg.running = true;
+		reg.writer  = std::thread( [&reg]() {
+			std::unique_lock<std::mutex> lock( reg.mutex );
+			while ( reg.running ) {
+				reg.wakeup.wait_for( lock, std::chrono::milliseconds( reg.flush_interval_ms ) );
 
-		// add endl
-		if ( add_endl ) {
-			m_file << std::endl;
+				lock.unlock();
+				flush_all();
+				lock.lock();
+			}
+		});
+	}
+
+	/*!
+	 * Stop background writer, buffers are written afterwards by add_line again
+	 */
+	void CSVHandler::stop_writer() {
+		CSVRegistry& reg = registry();
+		{
+			std::lock_guard<std::mutex> lock( reg.mutex );
+			if ( ! reg.running ) {
+				return;
+			}
+			reg.running = false;
+		}
+
+		reg.wakeup.notify_all();
+		reg.writer.join();
+		flush_all();
+	}
+
+	bool CSVHandler::has_writer() {
+		return registry().running;
+	}
+
+	/*!
+	 * Write buffers of all open files
+	 */
+	void CSVHandler::flush_all() {
+		CSVRegistry& reg = registry();
+
+		std::vector<std::shared_ptr<CSVFile>> files;
+		{
+			std::lock_guard<std::mutex> lock( reg.mutex );
+			for ( auto& item : reg.files ) {
+				files.push_back( item.second );
+			}
+		}
+
+		for ( auto& file : files ) {
+			file->flush();
 		}
+	}
+
+	/*!
+	 * Write all buffers and remove the files from the cache,
+	 * a file is closed when its last CSVHandler is gone.
+	 */
+	void CSVHandler::close_all() {
+		flush_all();
 
-		// close file
-		m_file.close();
+		CSVRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		reg.files.clear();
 	}
-};
\ No newline at end of file
+};
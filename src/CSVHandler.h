@@ -2,24 +2,74 @@
 #define IDEFIX_CSVHANDLER_H
 
 #include <string>
-#include <fstream>
-#include <ostream>
+#include <memory>
+#include <chrono>
+#include <quickfix/Mutex.h>
 
 namespace IDEFIX {
+	/*!
+	 * Open csv file with a user space buffer, shared by all
+	 * CSVHandler writing to the same path.
+	 */
+	class CSVFile {
+	private:
+		int m_fd;
+		std::string m_buffer;
+		std::chrono::steady_clock::time_point m_last_flush;
+		FIX::Mutex m_mutex;
+
+		void write_buffer();
+
+	public:
+		CSVFile(const std::string& filename);
+		~CSVFile();
+
+		bool is_open() const;
+		void append(const std::string& line, const bool add_endl, const bool background);
+		void flush();
+	};
+
+	/*!
+	 * Appends lines to csv files.
+	 *
+	 * Files stay open in a cache keyed by path and lines are collected in a
+	 * buffer, which is written if it exceeds the flush size or the flush
+	 * interval has passed. With the background writer the buffers are written
+	 * by its own thread and add_line does no syscall at all, as long as the
+	 * buffer stays below four times the flush size.
+	 * All buffers are written on exit. Callers that must not lose a line,
+	 * like the trade log, call flush after add_line.
+	 */
 	class CSVHandler {
 	public:
+		// defaults for flush size and interval
+		static const size_t FLUSH_SIZE      = 1 << 16;
+		static const int FLUSH_INTERVAL_MS  = 1000;
+
 		CSVHandler();
 		~CSVHandler();
 
 		void set_path(const std::string& path);
 		void set_filename(const std::string& name);
 		void add_line(const std::string& line, const bool add_endl = true);
+		void flush();
+
+		static void set_flush(const size_t bytes, const int interval_ms);
+		static size_t flush_size();
+		static std::chrono::milliseconds flush_interval();
+		static void start_writer();
+		static void stop_writer();
+		static bool has_writer();
+		static void flush_all();
+		static void close_all();
 
 	private:
 		std::string m_path;
 		std::string m_filename;
-		std::ofstream m_file;
+		std::shared_ptr<CSVFile> m_file;
+
+		static std::shared_ptr<CSVFile> open(const std::string& filename);
 	};
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,6 +1,8 @@
 #ifndef IDEFIX_CONSOLE_H
 #define IDEFIX_CONSOLE_H
 
+#include <atomic>
+#include <chrono>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -9,9 +11,58 @@
 // used in RenkoChart.cpp
 
 namespace IDEFIX {
+	// messages in the queue of the async loggers (CMAKE_ASYNC_LOG)
+	static const size_t LOG_QUEUE_SIZE = 8192;
+
 	inline std::shared_ptr<spdlog::logger> console() {
 		return spdlog::get("console");
 	}
+
+	/*!
+	 * Rate limit for one call site, e.g. tick logs:
+	 *
+	 * static LogLimiter limiter( 1000 );
+	 * if ( limiter.allow() ) console()->info( "... {} suppressed", limiter.suppressed() );
+	 *
+	 * At most one message per interval passes, the others are counted.
+	 */
+	class LogLimiter {
+	private:
+		const long long m_interval_ns;
+		std::atomic<long long> m_next_ns;
+		std::atomic<unsigned long> m_suppressed;
+		unsigned long m_last_suppressed;
+
+	public:
+		explicit LogLimiter(const long long interval_ms): m_interval_ns( interval_ms * 1000000 ), m_next_ns( 0 ), m_suppressed( 0 ), m_last_suppressed( 0 ) {}
+
+		/*!
+		 * True for the first call of every interval
+		 *
+		 * @return bool
+		 */
+		inline bool allow() {
+			const long long now = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+			long long next      = m_next_ns.load( std::memory_order_relaxed );
+
+			if ( now < next || ! m_next_ns.compare_exchange_strong( next, now + m_interval_ns ) ) {
+				m_suppressed.fetch_add( 1, std::memory_order_relaxed );
+				return false;
+			}
+
+			m_last_suppressed = m_suppressed.exchange( 0 );
+			return true;
+		}
+
+		/*!
+		 * Suppressed calls before the last allowed one
+		 *
+		 * @return unsigned long
+		 */
+		inline unsigned long suppressed() const {
+			return m_last_suppressed;
+		}
+	};
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,666 @@
+#include "EventJournal.h"
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <quickfix/Values.h>
+
+namespace IDEFIX {
+	namespace {
+		const char MAGIC[8] = { 'I', 'D', 'F', 'X', 'J', 'R', 'N', 'L' };
+
+		inline size_t align8(const size_t size) {
+			return ( size + 7 ) & ~static_cast<size_t>( 7 );
+		}
+	};
+
+	EventJournal::EventJournal(const std::string& filename): m_filename( filename ), m_fd( -1 ), m_index_fd( -1 ), m_writable( false ), m_data( nullptr ), m_mapped( 0 ), m_max_time_ms( std::numeric_limits<int64_t>::min() ), m_max_size( DEFAULT_MAX_SIZE ) {}
+
+	EventJournal::~EventJournal() {
+		close();
+	}
+
+	EventJournal::Header* EventJournal::header() const {
+		return reinterpret_cast<Header*>( m_data );
+	}
+
+	/*!
+	 * Map the first size bytes of the file. Every record of the mapping
+	 * fits into the reserved index, so append never allocates for it.
+	 *
+	 * @param const size_t size
+	 * @throw IDEFIX::out_of_range
+	 */
+	void EventJournal::map(const size_t size) throw( IDEFIX::out_of_range ) {
+		unmap();
+
+		void* data = mmap( nullptr, size, m_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0 );
+		if ( data == MAP_FAILED ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		m_data   = static_cast<char*>( data );
+		m_mapped = size;
+		m_index.reserve( m_mapped / align8( sizeof( RecordHeader ) ) / INDEX_STEP + 1 );
+	}
+
+	void EventJournal::unmap() {
+		if ( m_data != nullptr ) {
+			munmap( m_data, m_mapped );
+			m_data   = nullptr;
+			m_mapped = 0;
+		}
+	}
+
+	/*!
+	 * Enlarge file and mapping to at least needed bytes
+	 *
+	 * @param const size_t needed
+	 * @throw IDEFIX::out_of_range
+	 */
+	void EventJournal::grow(const size_t needed) throw( IDEFIX::out_of_range ) {
+		size_t size = std::max( m_mapped * 2, m_mapped + GROW_SIZE );
+		while ( size < needed ) {
+			size *= 2;
+		}
+
+		if ( ftruncate( m_fd, size ) != 0 ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+		map( size );
+	}
+
+	/*!
+	 * Write the header of a new journal into the empty file,
+	 * a stale index file is emptied
+	 *
+	 * @param const uint64_t last_seq sequence number before the first record
+	 * @throw IDEFIX::out_of_range
+	 */
+	void EventJournal::create(const uint64_t last_seq) throw( IDEFIX::out_of_range ) {
+		grow( GROW_SIZE );
+
+		Header* h = header();
+		memcpy( h->magic, MAGIC, sizeof( MAGIC ) );
+		h->version     = VERSION;
+		h->header_size = align8( sizeof( Header ) );
+		h->end_offset  = h->header_size;
+		h->last_seq    = last_seq;
+		h->count       = 0;
+
+		m_index.clear();
+		m_max_time_ms = std::numeric_limits<int64_t>::min();
+
+		if ( m_index_fd >= 0 && ftruncate( m_index_fd, 0 ) != 0 ) {
+			// the entries don't match the first record, open drops them
+		}
+	}
+
+	/*!
+	 * Open the index file next to the journal, a writable journal creates it
+	 */
+	void EventJournal::open_index() {
+		const std::string filename = m_filename + ".index";
+		m_index_fd = ::open( filename.c_str(), m_writable ? O_RDWR | O_CREAT | O_APPEND : O_RDONLY, 0644 );
+	}
+
+	/*!
+	 * Open or create the journal
+	 *
+	 * @param const bool writable false to read only
+	 * @throw IDEFIX::file_not_found
+	 * @throw IDEFIX::out_of_range   if the file is no journal
+	 */
+	void EventJournal::open(const bool writable) throw( IDEFIX::file_not_found, IDEFIX::out_of_range ) {
+		FIX::Locker lock( m_mutex );
+		if ( m_data != nullptr ) {
+			return;
+		}
+
+		m_writable = writable;
+		m_fd       = ::open( m_filename.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644 );
+		if ( m_fd < 0 ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		struct stat st;
+		if ( fstat( m_fd, &st ) != 0 ) {
+			::close( m_fd );
+			m_fd = -1;
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		// without index file the records are scanned
+		open_index();
+
+		try {
+			const size_t size = st.st_size;
+
+			// new journal
+			if ( size == 0 ) {
+				if ( ! writable ) {
+					throw out_of_range(__FILE__, __LINE__);
+				}
+
+				create( 0 );
+				return;
+			}
+
+			if ( size < sizeof( Header ) ) {
+				throw out_of_range(__FILE__, __LINE__);
+			}
+
+			map( size );
+
+			const Header* h = header();
+			if ( memcmp( h->magic, MAGIC, sizeof( MAGIC ) ) != 0 || h->version != VERSION || h->end_offset > size || h->end_offset < h->header_size ) {
+				throw out_of_range(__FILE__, __LINE__);
+			}
+
+			build_index();
+		} catch ( IDEFIX::out_of_range& e ) {
+			unmap();
+			::close( m_fd );
+			m_fd = -1;
+			if ( m_index_fd >= 0 ) {
+				::close( m_index_fd );
+				m_index_fd = -1;
+			}
+			throw;
+		}
+	}
+
+	/*!
+	 * Unmap and close, a writable journal is truncated to its used size
+	 */
+	void EventJournal::close() {
+		FIX::Locker lock( m_mutex );
+		if ( m_data == nullptr ) {
+			return;
+		}
+
+		const size_t end = header()->end_offset;
+		unmap();
+
+		m_index.clear();
+		m_max_time_ms = std::numeric_limits<int64_t>::min();
+
+		if ( m_writable ) {
+			if ( ftruncate( m_fd, end ) != 0 ) {
+				// keep the preallocated size, the header knows the end
+			}
+		}
+
+		::close( m_fd );
+		m_fd = -1;
+		if ( m_index_fd >= 0 ) {
+			::close( m_index_fd );
+			m_index_fd = -1;
+		}
+	}
+
+	bool EventJournal::is_open() const {
+		FIX::Locker lock( m_mutex );
+		return m_data != nullptr;
+	}
+
+	/*!
+	 * Schedule writing of the mapped pages
+	 */
+	void EventJournal::sync() {
+		FIX::Locker lock( m_mutex );
+		if ( m_data != nullptr && m_writable ) {
+			msync( m_data, header()->end_offset, MS_ASYNC );
+		}
+	}
+
+	/*!
+	 * Size in bytes at which rotate_if_full starts a new journal
+	 *
+	 * @param const size_t size 0 = never
+	 */
+	void EventJournal::set_max_size(const size_t size) {
+		FIX::Locker lock( m_mutex );
+		m_max_size = size;
+	}
+
+	/*!
+	 * Move a writable journal of at least max size to filename.1 and its
+	 * index to filename.1.index, an older rotated journal is replaced. The
+	 * new journal goes on with the sequence numbers. Call it when a session
+	 * starts, restore and warm up read the current journal only.
+	 *
+	 * @return bool true if a new journal was started
+	 */
+	bool EventJournal::rotate_if_full() {
+		FIX::Locker lock( m_mutex );
+		if ( m_data == nullptr || ! m_writable || m_max_size == 0 || header()->end_offset < m_max_size ) {
+			return false;
+		}
+
+		const uint64_t last_seq = header()->last_seq;
+		close();
+
+		const std::string rotated = m_filename + ".1";
+		if ( std::rename( m_filename.c_str(), rotated.c_str() ) != 0 ) {
+			// keep appending to the full journal
+			try {
+				open();
+			} catch ( ... ) {}
+			return false;
+		}
+		std::rename( ( m_filename + ".index" ).c_str(), ( rotated + ".index" ).c_str() );
+
+		m_fd = ::open( m_filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 );
+		if ( m_fd < 0 ) {
+			return false;
+		}
+		open_index();
+
+		try {
+			create( last_seq );
+		} catch ( IDEFIX::out_of_range& e ) {
+			unmap();
+			::close( m_fd );
+			m_fd = -1;
+			if ( m_index_fd >= 0 ) {
+				::close( m_index_fd );
+				m_index_fd = -1;
+			}
+			return false;
+		}
+		return true;
+	}
+
+	/*!
+	 * Append one event
+	 *
+	 * @param const Type      type
+	 * @param const Direction direction
+	 * @param const char*     data
+	 * @param const size_t    size
+	 * @param const int64_t   time_ms   0 = now
+	 * @return uint64_t sequence number, 0 if the journal is not writable
+	 */
+	uint64_t EventJournal::append(const Type type, const Direction direction, const char* data, const size_t size, const int64_t time_ms) {
+		FIX::Locker lock( m_mutex );
+		if ( m_data == nullptr || ! m_writable ) {
+			return 0;
+		}
+
+		const size_t total = align8( sizeof( RecordHeader ) + size );
+		if ( header()->end_offset + total > m_mapped ) {
+			try {
+				grow( header()->end_offset + total );
+			} catch ( IDEFIX::out_of_range& e ) {
+				return 0;
+			}
+		}
+
+		Header* h = header();
+		RecordHeader* record = reinterpret_cast<RecordHeader*>( m_data + h->end_offset );
+		record->size      = size;
+		record->type      = type;
+		record->direction = direction;
+		record->reserved  = 0;
+		record->seq       = h->last_seq + 1;
+		record->time_ms   = time_ms != 0 ? time_ms : now_ms();
+		memcpy( record + 1, data, size );
+		if ( index( h->count, record->seq, record->time_ms, h->end_offset ) && m_index_fd >= 0 ) {
+			// an entry behind the end of a crashed writer is dropped by open
+			if ( ::write( m_index_fd, &m_index.back(), sizeof( IndexEntry ) ) != sizeof( IndexEntry ) ) {
+				// open scans the records after the last valid entry
+			}
+		}
+
+		// the record is complete before it becomes visible
+		h->last_seq    = record->seq;
+		h->count      += 1;
+		h->end_offset += total;
+
+		return record->seq;
+	}
+
+	/*!
+	 * Append raw FIX message, the type is taken from MsgType
+	 *
+	 * @param const FIX::Message& message
+	 * @param const Direction     direction
+	 * @return uint64_t sequence number
+	 */
+	uint64_t EventJournal::append_message(const FIX::Message& message, const Direction direction) {
+		const std::string raw = message.toString();
+		return append( type_of( message.getHeader().getField( FIX::FIELD::MsgType ), direction ), direction, raw.data(), raw.size() );
+	}
+
+	/*!
+	 * Append quote as bid, ask and symbol
+	 *
+	 * @param const std::string& symbol
+	 * @param const double       bid
+	 * @param const double       ask
+	 * @return uint64_t sequence number
+	 */
+	uint64_t EventJournal::append_quote(const std::string& symbol, const double bid, const double ask) {
+		char buffer[64];
+		const size_t length = std::min<size_t>( symbol.size(), sizeof( buffer ) - 2 * sizeof( double ) );
+
+		memcpy( buffer, &bid, sizeof( double ) );
+		memcpy( buffer + sizeof( double ), &ask, sizeof( double ) );
+		memcpy( buffer + 2 * sizeof( double ), symbol.data(), length );
+
+		return append( QUOTE, INBOUND, buffer, 2 * sizeof( double ) + length );
+	}
+
+	/*!
+	 * Count of events
+	 *
+	 * @return size_t
+	 */
+	size_t EventJournal::size() const {
+		FIX::Locker lock( m_mutex );
+		return m_data != nullptr ? header()->count : 0;
+	}
+
+	uint64_t EventJournal::last_seq() const {
+		FIX::Locker lock( m_mutex );
+		return m_data != nullptr ? header()->last_seq : 0;
+	}
+
+	/*!
+	 * Keep every INDEX_STEP th record in the index, called for every record in order.
+	 * The capacity is reserved by map.
+	 *
+	 * @param const uint64_t number  count of records before this one
+	 * @param const uint64_t seq
+	 * @param const int64_t  time_ms
+	 * @param const size_t   offset
+	 * @return bool true if the record was indexed
+	 */
+	bool EventJournal::index(const uint64_t number, const uint64_t seq, const int64_t time_ms, const size_t offset) {
+		const bool indexed = number % INDEX_STEP == 0;
+		if ( indexed ) {
+			IndexEntry entry;
+			entry.seq         = seq;
+			entry.max_time_ms = m_max_time_ms;
+			entry.offset      = offset;
+			m_index.push_back( entry );
+		}
+		m_max_time_ms = std::max( m_max_time_ms, time_ms );
+		return indexed;
+	}
+
+	/*!
+	 * Index the records of an opened journal, once. The entries of the index
+	 * file are kept as long as they match their records, only the records
+	 * from the last entry on are scanned. A writable journal rewrites the
+	 * index file with the valid entries.
+	 */
+	void EventJournal::build_index() {
+		m_index.clear();
+		m_max_time_ms = std::numeric_limits<int64_t>::min();
+
+		const Header* h  = header();
+		const size_t end = std::min<size_t>( h->end_offset, m_mapped );
+		size_t offset    = h->header_size;
+		uint64_t number  = 0;
+
+		// entry n belongs to record n * INDEX_STEP, the sequence numbers of a journal have no gaps
+		struct stat st;
+		if ( m_index_fd >= 0 && offset + sizeof( RecordHeader ) <= end && fstat( m_index_fd, &st ) == 0 ) {
+			const uint64_t first_seq = reinterpret_cast<const RecordHeader*>( m_data + offset )->seq;
+			const size_t count       = std::min<size_t>( st.st_size / sizeof( IndexEntry ), m_index.capacity() );
+
+			m_index.resize( count );
+			const ssize_t bytes = pread( m_index_fd, m_index.data(), count * sizeof( IndexEntry ), 0 );
+			size_t valid = bytes > 0 ? bytes / sizeof( IndexEntry ) : 0;
+			for ( size_t i = 0; i < valid; i++ ) {
+				const IndexEntry& entry = m_index[i];
+				if ( entry.seq != first_seq + i * INDEX_STEP || entry.offset < h->header_size || entry.offset + sizeof( RecordHeader ) > end
+					|| reinterpret_cast<const RecordHeader*>( m_data + entry.offset )->seq != entry.seq ) {
+					valid = i;
+					break;
+				}
+			}
+			m_index.resize( valid );
+		}
+
+		// the tail is scanned from the last entry on, which is indexed again
+		if ( ! m_index.empty() ) {
+			m_max_time_ms = m_index.back().max_time_ms;
+			offset        = m_index.back().offset;
+			m_index.pop_back();
+			number        = m_index.size() * INDEX_STEP;
+		}
+
+		while ( offset + sizeof( RecordHeader ) <= end ) {
+			const RecordHeader* record = reinterpret_cast<const RecordHeader*>( m_data + offset );
+			const size_t total         = align8( sizeof( RecordHeader ) + record->size );
+			if ( offset + total > end ) {
+				break;
+			}
+			index( number++, record->seq, record->time_ms, offset );
+			offset += total;
+		}
+
+		if ( m_writable && m_index_fd >= 0 ) {
+			if ( ftruncate( m_index_fd, 0 ) != 0 || ::write( m_index_fd, m_index.data(), m_index.size() * sizeof( IndexEntry ) ) < 0 ) {
+				// the next open scans more records
+			}
+		}
+	}
+
+	/*!
+	 * Offset of the last indexed record which can be the first of a scan,
+	 * all records before it have seq < from_seq and time_ms < from_ms.
+	 * m_mutex is locked by the caller.
+	 *
+	 * @param const uint64_t from_seq
+	 * @param const int64_t  from_ms
+	 * @return size_t
+	 */
+	size_t EventJournal::start_offset(const uint64_t from_seq, const int64_t from_ms) const {
+		auto it = std::partition_point( m_index.begin(), m_index.end(), [from_seq, from_ms](const IndexEntry& entry) {
+			return entry.seq <= from_seq && entry.max_time_ms < from_ms;
+		});
+		return it == m_index.begin() ? header()->header_size : ( it - 1 )->offset;
+	}
+
+	/*!
+	 * Call callback for every complete record from the start offset until it
+	 * returns false. The records are read from an own read only mapping, the
+	 * lock is only held to take it, so append goes on during the scan.
+	 *
+	 * @param const uint64_t                                   from_seq
+	 * @param const int64_t                                    from_ms
+	 * @param const std::function<bool(const RecordHeader*)>& callback
+	 */
+	void EventJournal::scan(const uint64_t from_seq, const int64_t from_ms, const std::function<bool(const RecordHeader*)>& callback) const {
+		size_t begin      = 0;
+		size_t end        = 0;
+		size_t map_offset = 0;
+		void* data        = MAP_FAILED;
+		{
+			FIX::Locker lock( m_mutex );
+			if ( m_data == nullptr ) {
+				return;
+			}
+
+			begin = start_offset( from_seq, from_ms );
+			end   = std::min<size_t>( header()->end_offset, m_mapped );
+			if ( begin >= end ) {
+				return;
+			}
+
+			// records below end are complete and never change
+			map_offset = begin & ~( static_cast<size_t>( sysconf( _SC_PAGESIZE ) ) - 1 );
+			data       = mmap( nullptr, end - map_offset, PROT_READ, MAP_SHARED, m_fd, map_offset );
+			if ( data == MAP_FAILED ) {
+				return;
+			}
+		}
+
+		const char* records = static_cast<const char*>( data ) + ( begin - map_offset );
+		const size_t length = end - begin;
+		size_t offset       = 0;
+
+		while ( offset + sizeof( RecordHeader ) <= length ) {
+			const RecordHeader* record = reinterpret_cast<const RecordHeader*>( records + offset );
+			const size_t total         = align8( sizeof( RecordHeader ) + record->size );
+			if ( offset + total > length ) {
+				break;
+			}
+			offset += total;
+
+			if ( ! callback( record ) ) {
+				break;
+			}
+		}
+
+		munmap( data, end - map_offset );
+	}
+
+	/*!
+	 * Call callback for every event with from_seq <= seq <= to_seq
+	 * until it returns false
+	 *
+	 * @param const std::function<bool(const Event&)>& callback
+	 * @param const uint64_t                           from_seq
+	 * @param const uint64_t                           to_seq
+	 * @return size_t count of visited events
+	 */
+	size_t EventJournal::for_each(const std::function<bool(const Event&)>& callback, const uint64_t from_seq, const uint64_t to_seq) const {
+		size_t count = 0;
+
+		scan( from_seq, std::numeric_limits<int64_t>::max(), [&](const RecordHeader* record) {
+			if ( record->seq < from_seq ) {
+				return true;
+			}
+			if ( record->seq > to_seq ) {
+				return false;
+			}
+
+			Event event;
+			event.seq       = record->seq;
+			event.time_ms   = record->time_ms;
+			event.type      = static_cast<Type>( record->type );
+			event.direction = static_cast<Direction>( record->direction );
+			event.data      = reinterpret_cast<const char*>( record + 1 );
+			event.size      = record->size;
+
+			count++;
+			return callback( event );
+		});
+
+		return count;
+	}
+
+	/*!
+	 * Append all quotes of symbol with time_ms >= from_ms and seq <= to_seq to ticks.
+	 * Only the record header is read for other events, no string is created.
+	 *
+	 * @param const std::string&       symbol
+	 * @param const int64_t            from_ms ms since epoch
+	 * @param std::vector<TickRecord>& ticks
+	 * @param const uint64_t           to_seq  last sequence number
+	 * @return size_t count of appended ticks
+	 */
+	size_t EventJournal::quotes(const std::string& symbol, const int64_t from_ms, std::vector<TickRecord>& ticks, const uint64_t to_seq) const {
+		const size_t before = ticks.size();
+
+		scan( std::numeric_limits<uint64_t>::max(), from_ms, [&](const RecordHeader* record) {
+			if ( record->seq > to_seq ) {
+				return false;
+			}
+			if ( record->type != QUOTE || record->time_ms < from_ms || record->size != 2 * sizeof( double ) + symbol.size() ) {
+				return true;
+			}
+
+			const char* data = reinterpret_cast<const char*>( record + 1 );
+			if ( memcmp( data + 2 * sizeof( double ), symbol.data(), symbol.size() ) != 0 ) {
+				return true;
+			}
+
+			TickRecord tick;
+			tick.time_ms = record->time_ms;
+			memcpy( &tick.bid, data, sizeof( double ) );
+			memcpy( &tick.ask, data + sizeof( double ), sizeof( double ) );
+			ticks.push_back( tick );
+			return true;
+		});
+
+		return ticks.size() - before;
+	}
+
+	/*!
+	 * Journal type of a FIX message
+	 *
+	 * @param const std::string& msg_type
+	 * @param const Direction    direction
+	 * @return Type
+	 */
+	EventJournal::Type EventJournal::type_of(const std::string& msg_type, const Direction direction) {
+		if ( msg_type == FIX::MsgType_ExecutionReport ) {
+			return EXECUTION_REPORT;
+		}
+		if ( msg_type == FIX::MsgType_PositionReport ) {
+			return POSITION_REPORT;
+		}
+		if ( msg_type == FIX::MsgType_CollateralReport ) {
+			return COLLATERAL_REPORT;
+		}
+		if ( msg_type == FIX::MsgType_MarketDataSnapshotFullRefresh ) {
+			return QUOTE;
+		}
+		if ( direction == OUTBOUND && ( msg_type == FIX::MsgType_NewOrderSingle || msg_type == FIX::MsgType_NewOrderList
+			|| msg_type == FIX::MsgType_OrderCancelRequest || msg_type == FIX::MsgType_OrderCancelReplaceRequest ) ) {
+			return ORDER;
+		}
+		return MESSAGE;
+	}
+
+	std::string EventJournal::type_name(const Type type) {
+		switch ( type ) {
+			case QUOTE:             return "quote";
+			case EXECUTION_REPORT:  return "execution_report";
+			case POSITION_REPORT:   return "position_report";
+			case COLLATERAL_REPORT: return "collateral_report";
+			case ORDER:             return "order";
+			case MESSAGE:           return "message";
+		}
+		return "unknown";
+	}
+
+	/*!
+	 * Read quote event
+	 *
+	 * @param const Event& event
+	 * @param std::string& symbol
+	 * @param double&      bid
+	 * @param double&      ask
+	 * @return bool false if the event is no quote
+	 */
+	bool EventJournal::parse_quote(const Event& event, std::string& symbol, double& bid, double& ask) {
+		if ( event.type != QUOTE || event.size < 2 * sizeof( double ) ) {
+			return false;
+		}
+
+		memcpy( &bid, event.data, sizeof( double ) );
+		memcpy( &ask, event.data + sizeof( double ), sizeof( double ) );
+		symbol.assign( event.data + 2 * sizeof( double ), event.size - 2 * sizeof( double ) );
+		return true;
+	}
+
+	/*!
+	 * Wall clock in ms since epoch
+	 *
+	 * @return int64_t
+	 */
+	int64_t EventJournal::now_ms() {
+		return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+	}
+};
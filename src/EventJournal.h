@@ -0,0 +1,147 @@
+#ifndef IDEFIX_EVENTJOURNAL_H
+#define IDEFIX_EVENTJOURNAL_H
+
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <quickfix/Message.h>
+#include <quickfix/Mutex.h>
+#include "Exceptions.h"
+#include "TickRecord.h"
+
+namespace IDEFIX {
+	/*!
+	 * Append only binary journal of all FIX application events.
+	 *
+	 * Header | Record | Record | ...
+	 *
+	 * Every record has a sequence number, the time it was appended, a type and
+	 * a direction. Quotes are stored as bid, ask and symbol, all other events
+	 * as the raw FIX message. Records are 8 byte aligned.
+	 *
+	 * The file is mapped into memory and grows in steps, the header holds the
+	 * end of the last complete record, so a crashed writer leaves a readable
+	 * journal. The file is truncated to its used size on close.
+	 *
+	 * Every INDEX_STEP records the sequence number and offset are kept in
+	 * memory and appended to the index file next to the journal, for_each
+	 * and quotes start at the nearest indexed record. They scan their own
+	 * read only mapping of the complete records, append is not blocked while
+	 * they run. open reads the index file and scans only the records after
+	 * its last entry.
+	 *
+	 * rotate_if_full moves a journal of at least max size to filename.1
+	 * and starts a new one, the sequence numbers go on.
+	 */
+	class EventJournal {
+	public:
+		static const uint32_t VERSION = 1;
+
+		enum Type : uint16_t {
+			QUOTE = 1,
+			EXECUTION_REPORT = 2,
+			POSITION_REPORT = 3,
+			COLLATERAL_REPORT = 4,
+			ORDER = 5,
+			MESSAGE = 6
+		};
+
+		enum Direction : uint8_t {
+			INBOUND = 0,
+			OUTBOUND = 1
+		};
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t header_size;
+			uint64_t end_offset;
+			uint64_t last_seq;
+			uint64_t count;
+		};
+
+		struct RecordHeader {
+			uint32_t size;
+			uint16_t type;
+			uint8_t direction;
+			uint8_t reserved;
+			uint64_t seq;
+			int64_t time_ms;
+		};
+
+		struct Event {
+			uint64_t seq;
+			int64_t time_ms;
+			Type type;
+			Direction direction;
+			const char* data;
+			size_t size;
+		};
+
+	private:
+		struct IndexEntry {
+			uint64_t seq;
+			// latest time of all records before offset
+			int64_t max_time_ms;
+			uint64_t offset;
+		};
+
+		std::string m_filename;
+		int m_fd;
+		int m_index_fd;
+		bool m_writable;
+		char* m_data;
+		size_t m_mapped;
+		mutable FIX::Mutex m_mutex;
+		std::vector<IndexEntry> m_index;
+		int64_t m_max_time_ms;
+		size_t m_max_size;
+
+		Header* header() const;
+		void map(const size_t size) throw( IDEFIX::out_of_range );
+		void grow(const size_t needed) throw( IDEFIX::out_of_range );
+		void create(const uint64_t last_seq) throw( IDEFIX::out_of_range );
+		void unmap();
+		bool index(const uint64_t number, const uint64_t seq, const int64_t time_ms, const size_t offset);
+		void open_index();
+		void build_index();
+		size_t start_offset(const uint64_t from_seq, const int64_t from_ms) const;
+		void scan(const uint64_t from_seq, const int64_t from_ms, const std::function<bool(const RecordHeader*)>& callback) const;
+
+	public:
+		// the file grows in steps of at least this size
+		static const size_t GROW_SIZE = 1 << 24;
+		// every nth record is indexed
+		static const size_t INDEX_STEP = 4096;
+		// journals are rotated at this size by default
+		static const size_t DEFAULT_MAX_SIZE = static_cast<size_t>( 1 ) << 30;
+
+		EventJournal(const std::string& filename);
+		~EventJournal();
+
+		void open(const bool writable = true) throw( IDEFIX::file_not_found, IDEFIX::out_of_range );
+		void close();
+		bool is_open() const;
+		void sync();
+		void set_max_size(const size_t size);
+		bool rotate_if_full();
+
+		uint64_t append(const Type type, const Direction direction, const char* data, const size_t size, const int64_t time_ms = 0);
+		uint64_t append_message(const FIX::Message& message, const Direction direction);
+		uint64_t append_quote(const std::string& symbol, const double bid, const double ask);
+
+		size_t size() const;
+		uint64_t last_seq() const;
+		size_t for_each(const std::function<bool(const Event&)>& callback, const uint64_t from_seq = 0, const uint64_t to_seq = std::numeric_limits<uint64_t>::max()) const;
+		size_t quotes(const std::string& symbol, const int64_t from_ms, std::vector<TickRecord>& ticks, const uint64_t to_seq = std::numeric_limits<uint64_t>::max()) const;
+
+		static Type type_of(const std::string& msg_type, const Direction direction);
+		static std::string type_name(const Type type);
+		static bool parse_quote(const Event& event, std::string& symbol, double& bid, double& ask);
+		static int64_t now_ms();
+	};
+};
+
+#endif
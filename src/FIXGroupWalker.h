@@ -0,0 +1,151 @@
+#ifndef IDEFIX_FIXGROUPWALKER_H
+#define IDEFIX_FIXGROUPWALKER_H
+
+#include <string>
+#include <map>
+#include <cstdlib>
+#include <quickfix/FieldMap.h>
+#include <quickfix/FixFields.h>
+#include <quickfix/FixValues.h>
+#include "FXCMFields.h"
+#include "MarketDetail.h"
+#include "MarketSnapshot.h"
+
+namespace IDEFIX {
+	namespace fixgroup {
+		/*!
+		 * Call callback for every instance of a repeating group, by reference.
+		 * Unlike getGroup there is no copy of the group FieldMap.
+		 *
+		 * @param const FIX::FieldMap& map
+		 * @param const int            field counter tag of the group, e.g. NoRelatedSym
+		 * @param Callback             callback void(const FIX::FieldMap&)
+		 * @return size_t count of groups
+		 */
+		template<typename Callback>
+		inline size_t for_each(const FIX::FieldMap& map, const int field, Callback callback) {
+			for ( auto it = map.g_begin(); it != map.g_end(); ++it ) {
+				if ( it->first != field ) {
+					continue;
+				}
+
+				for ( const FIX::FieldMap* group : it->second ) {
+					callback( *group );
+				}
+				return it->second.size();
+			}
+			return 0;
+		}
+
+		/*!
+		 * Fill MarketDetail from one NoRelatedSym group of SecurityList or
+		 * TradingSessionStatus, every field is visited once
+		 *
+		 * @param const FIX::FieldMap& group
+		 * @param MarketDetail&        detail
+		 */
+		inline void read_market_detail(const FIX::FieldMap& group, MarketDetail& detail) {
+			for ( auto it = group.begin(); it != group.end(); ++it ) {
+				const std::string& value = it->second.getString();
+				const char* c_str        = value.c_str();
+
+				switch ( it->first ) {
+					case FIX::FIELD::Symbol:                         detail.setSymbol( value ); break;
+					case FIX::FIELD::Currency:                       detail.setCurrency( value ); break;
+					case FIX::FIELD::Factor:                         detail.setFactor( strtod( c_str, nullptr ) ); break;
+					case FIX::FIELD::ContractMultiplier:             detail.setContractMultiplier( strtod( c_str, nullptr ) ); break;
+					case FIX::FIELD::Product:                        detail.setProduct( atoi( c_str ) ); break;
+					case FIX::FIELD::RoundLot:                       detail.setRoundlot( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SYM_ID:               detail.setSymID( atoi( c_str ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SYM_PRECISION:        detail.setSymPrecision( atoi( c_str ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SYM_POINT_SIZE:       detail.setSymPointsize( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SYM_INTEREST_BUY:     detail.setSymInterestBuy( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SYM_INTEREST_SELL:    detail.setSymInterestSell( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SYM_SORT_ORDER:       detail.setSymSortOrder( atoi( c_str ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_SUBSCRIPTION_STATUS:  detail.setSubscriptionStatus( value ); break;
+					case FXCM_FIX_FIELDS::FXCM_FIELD_PRODUCT_ID:     detail.setFieldProductID( atoi( c_str ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_COND_DIST_STOP:       detail.setCondDistStop( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_COND_DIST_LIMIT:      detail.setCondDistLimit( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_COND_DIST_ENTRY_STOP: detail.setCondDistEntryStop( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_COND_DIST_ENTRY_LIMIT: detail.setCondDistEntryLimit( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_MAX_QUANTITY:         detail.setMaxQuantity( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_MIN_QUANTITY:         detail.setMinQuantity( strtod( c_str, nullptr ) ); break;
+					case FXCM_FIX_FIELDS::FXCM_TRADING_STATUS:       detail.setTradingStatus( value ); break;
+				}
+			}
+		}
+
+		/*!
+		 * Read all market details of a TradingSessionStatus or SecurityList
+		 *
+		 * @param const FIX::FieldMap&             message
+		 * @param std::map<std::string, MarketDetail>& details details[symbol]
+		 * @return size_t count of groups
+		 */
+		inline size_t read_market_details(const FIX::FieldMap& message, std::map<std::string, MarketDetail>& details) {
+			return for_each( message, FIX::FIELD::NoRelatedSym, [&details](const FIX::FieldMap& group) {
+				MarketDetail detail;
+				read_market_detail( group, detail );
+				details[detail.getSymbol()] = std::move( detail );
+			});
+		}
+
+		/*!
+		 * Set bid, ask, session high and low of a snapshot from the NoMDEntries
+		 * groups of MarketDataSnapshotFullRefresh, nothing is copied
+		 *
+		 * @param const FIX::FieldMap& message
+		 * @param MarketSnapshot&      snapshot
+		 * @return size_t count of groups
+		 */
+		inline size_t read_md_entries(const FIX::FieldMap& message, MarketSnapshot& snapshot) {
+			return for_each( message, FIX::FIELD::NoMDEntries, [&snapshot](const FIX::FieldMap& group) {
+				char type    = 0;
+				double price = 0;
+
+				for ( auto it = group.begin(); it != group.end(); ++it ) {
+					if ( it->first == FIX::FIELD::MDEntryType ) {
+						type = it->second.getString()[0];
+					} else if ( it->first == FIX::FIELD::MDEntryPx ) {
+						price = strtod( it->second.getString().c_str(), nullptr );
+					}
+				}
+
+				switch ( type ) {
+					case FIX::MDEntryType_BID:                        snapshot.setBid( price ); break;
+					case FIX::MDEntryType_OFFER:                      snapshot.setAsk( price ); break;
+					case FIX::MDEntryType_TRADING_SESSION_HIGH_PRICE: snapshot.setSessionHigh( price ); break;
+					case FIX::MDEntryType_TRADING_SESSION_LOW_PRICE:  snapshot.setSessionLow( price ); break;
+				}
+			});
+		}
+
+		/*!
+		 * Read all FXCM system parameters (FXCMNoParam 9016) of a TradingSessionStatus
+		 *
+		 * @param const FIX::FieldMap&                message
+		 * @param std::map<std::string, std::string>& params params[name] = value
+		 * @return size_t count of groups
+		 */
+		inline size_t read_params(const FIX::FieldMap& message, std::map<std::string, std::string>& params) {
+			return for_each( message, FXCM_FIX_FIELDS::FXCM_NO_PARAMS, [&params](const FIX::FieldMap& group) {
+				const std::string* name  = nullptr;
+				const std::string* value = nullptr;
+
+				for ( auto it = group.begin(); it != group.end(); ++it ) {
+					if ( it->first == FXCM_FIX_FIELDS::FXCM_PARAM_NAME ) {
+						name = &it->second.getString();
+					} else if ( it->first == FXCM_FIX_FIELDS::FXCM_PARAM_VALUE ) {
+						value = &it->second.getString();
+					}
+				}
+
+				if ( name != nullptr ) {
+					params[*name] = value != nullptr ? *value : std::string();
+				}
+			});
+		}
+	};
+};
+
+#endif
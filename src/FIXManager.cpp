@@ -4,9 +4,12 @@
  */
 #include "Exceptions.h"
 #include "FIXManager.h"
+#include "FIXGroupWalker.h"
 #include "MathHelper.h"
 #include "spdlog/sinks/daily_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
+#include "spdlog/async.h"
+#include "Console.h"
 #include "CSVHandler.h"
 #include <quickfix/Utility.h>
 #include <quickfix/Dictionary.h>
@@ -15,13 +18,33 @@
 #include <exception>
 
 namespace IDEFIX {
+namespace {
+  // journal sequence number of the tick on_tick emits on this thread
+  thread_local uint64_t t_tick_journal_seq = 0;
+};
+
 /*!
  * Constructs FIXManager and starts a FIX Session from settings file
  *
  * @param const std::string settingsFile The FIX settings file
  */
-FIXManager::FIXManager(): m_is_exiting( false ) {
+FIXManager::FIXManager(): m_psettings( nullptr ), m_pstore_factory( nullptr ), m_plog_factory( nullptr ), m_pinitiator( nullptr ), m_is_exiting( false ), m_journal( nullptr ), m_restoring( false ), m_positions_restored( false ), m_accounts_requested( false ) {
+
+  // check if folder trades exists, if not create it
+  file_mkdir( "trades/" );
 
+#ifdef CMAKE_ASYNC_LOG
+  // formatting of the pattern and I/O in the logger thread. The console never
+  // blocks the caller, the oldest messages are dropped if the queue is full.
+  // The trade log blocks instead of losing trades.
+  spdlog::init_thread_pool( LOG_QUEUE_SIZE, 1 );
+#ifndef CMAKE_RELEASE_LOG
+  m_console = spdlog::create_async_nb<spdlog::sinks::stdout_color_sink_mt>( "console" );
+#else
+  m_console = spdlog::create_async_nb<spdlog::sinks::daily_file_sink_mt>( "console", "release.log", 0, 0 );
+#endif
+  m_tradelog = spdlog::create_async<spdlog::sinks::daily_file_sink_mt>( "tradelog", "trades/trades.log", 0, 0 );
+#else
 #ifndef CMAKE_RELEASE_LOG
   // set up console
   m_console = spdlog::stdout_color_mt( "console" );
@@ -30,18 +53,35 @@ FIXManager::FIXManager(): m_is_exiting( false ) {
   m_console = spdlog::daily_logger_mt( "console", "release.log", 0, 0 );
 #endif
 
-  // set console pattern
-  m_console->set_pattern( "%Y-%m-%d %T.%e: %^%v%$" );
-  
-  // check if folder trades exists, if not create it
-  file_mkdir( "trades/" );
-
   // set up trade log
   m_tradelog = spdlog::daily_logger_mt("tradelog", "trades/trades.log", 0, 0 );
+#endif
+
+  // set console pattern
+  m_console->set_pattern( "%Y-%m-%d %T.%e: %^%v%$" );
   // set tradelog pattern
   m_tradelog->set_pattern( "%Y-%m-%d %T.%e,%v" );
   // flush logger every
   spdlog::flush_every( chrono::seconds( 3 ) );
+  // trade csv files, one per symbol
+  m_trades_csv.set_path( "public_html/" );
+
+  // metrics, registered once, see Metrics::open
+  const char* sessions[]   = { "market", "order" };
+  const char* directions[] = { "in", "out" };
+  for ( int s = 0; s < 2; s++ ) {
+    for ( int d = 0; d < 2; d++ ) {
+      m_metric_messages[s][d] = Metrics::counter( "idefix_messages_total", Metrics::label( "session", sessions[s] ) + "," + Metrics::label( "direction", directions[d] ) );
+    }
+  }
+  m_metric_on_tick             = Metrics::histogram( "idefix_on_tick_seconds" );
+  m_metric_mutex_wait          = Metrics::histogram( "idefix_mutex_wait_seconds", Metrics::label( "mutex", "fixmanager" ) );
+  m_metric_mutex_hold          = Metrics::histogram( "idefix_mutex_hold_seconds", Metrics::label( "mutex", "fixmanager" ) );
+  m_metric_orders_sent         = Metrics::counter( "idefix_orders_sent_total" );
+  m_metric_orders_acked        = Metrics::counter( "idefix_orders_acked_total" );
+  m_metric_rejects_order       = Metrics::counter( "idefix_rejects_total", Metrics::label( "type", "order" ) );
+  m_metric_rejects_market_data = Metrics::counter( "idefix_rejects_total", Metrics::label( "type", "market_data" ) );
+  m_metric_rejects_session     = Metrics::counter( "idefix_rejects_total", Metrics::label( "type", "session" ) );
   
 }
 
@@ -86,6 +126,19 @@ void FIXManager::onLogon(const SessionID &sessionID) {
     setOrderSessionID(sessionID);
     console()->info( "[onLogon] {} (OrderSession)", getOrderSessionID().toString() );
   }
+
+  // With a warm market cache we don't wait for TradingSessionStatus, the accounts
+  // are queried as soon as both sessions are logged on. TradingSessionStatus
+  // updates the cache when it arrives.
+  bool is_warm = false;
+  {
+    TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+    is_warm = m_market_cache != nullptr && ! m_market_details.empty() && ! m_system_params.empty();
+  }
+  if ( is_warm && isLoggedOn( getOrderSessionID() ) && isLoggedOn( getMarketSessionID() ) && ! m_accounts_requested.exchange( true ) ) {
+    console()->info( "[onLogon] market cache is warm, query accounts" );
+    queryAccounts();
+  }
 }
 
 // Notifies you when an FIX session is no longer online. This could happen during a normal logout
@@ -100,6 +153,8 @@ void FIXManager::onLogout(const SessionID &session_ID) {
     console()->info( "[onLogout] {} (OrderSession)", session_ID.toString() );
   }
 
+  m_accounts_requested = false;
+
 }
 
 // Provides you with a peak at the administrative messages that are being sent from your FIX engine
@@ -108,6 +163,8 @@ void FIXManager::toAdmin(Message &message, const SessionID &session_ID) {
   // If the Admin message being sent to FXCM is of type Logon(A), we want
   // to set the Username and Password fields. We want to catch this message as it
   // is going out.
+  messageCounter( session_ID, true ).inc();
+
   string msg_type = message.getHeader().getField(FIELD::MsgType);
   if(msg_type == "A"){
     // Get both username and password from our settings file. Then set these
@@ -126,6 +183,8 @@ void FIXManager::toAdmin(Message &message, const SessionID &session_ID) {
 // A callback for application messages that you are being sent to a counterparty
 void FIXManager::toApp(Message &message, const SessionID &session_ID)
   throw( FIX::DoNotSend ) {
+  messageCounter( session_ID, true ).inc();
+
   // All messages sent to FXCM must contain the TargetSubID field (both Administrative and
   // Application messages).
   string sub_ID = m_psettings->get().getString("TargetSubID");
@@ -135,9 +194,11 @@ void FIXManager::toApp(Message &message, const SessionID &session_ID)
 // Notifies you when an administrative message is sent from FXCM to your FIX engine.
 void FIXManager::fromAdmin(const Message &message, const SessionID &session_ID)
   throw( FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon ) {
-  
+  messageCounter( session_ID, false ).inc();
+
   string msgtype = message.getHeader().getField(FIELD::MsgType);
   if(MsgType_Reject == msgtype){
+    m_metric_rejects_session.inc();
     string text = message.getField(FIELD::Text);
     string tagID = message.getField(371); // RefTagID
     string msgType = message.getField(372); // RefMsgType
@@ -156,7 +217,12 @@ void FIXManager::fromApp(const Message &message, const SessionID &session_ID)
   // Call MessageCracker.crack method to handle the message by one of our
   // overloaded onMessage methods below
   // 
+  messageCounter( session_ID, false ).inc();
+
   string msgtype = message.getHeader().getField(FIELD::MsgType);
+  if(MsgType_Reject == msgtype || MsgType_BusinessMessageReject == msgtype){
+    m_metric_rejects_session.inc();
+  }
   if(MsgType_Reject == msgtype){
     string text = message.getField(FIELD::Text);
     string tagID = message.getField(371); // RefTagID
@@ -164,6 +230,16 @@ void FIXManager::fromApp(const Message &message, const SessionID &session_ID)
 
     console()->warn( "[fromApp:Reject] tagID {} msgType {}: {}", tagID, msgType, text );
   }
+
+  // quotes are journaled after decoding, see onMessage(MarketDataSnapshotFullRefresh)
+  if ( m_journal != nullptr && ! m_restoring && msgtype != MsgType_MarketDataSnapshotFullRefresh ) {
+    // a full journal is rotated at a session status, the new one starts with it for restore
+    if ( msgtype == MsgType_TradingSessionStatus ) {
+      m_journal->rotate_if_full();
+    }
+    m_journal->append_message( message, EventJournal::INBOUND );
+  }
+
   crack(message, session_ID);
 }
 
@@ -182,51 +258,33 @@ void FIXManager::onMessage(const FIX44::TradingSessionStatus& tss, const Session
   // Within the TradingSessionStatus message is an embeded SecurityList. From SecurityList we can see
   // the list of available trading securities and information relevant to each; e.g., point sizes,
   // minimum and maximum order quantities by security, etc.
-  int symbols_count = IntConvertor::convert( tss.getField( FIELD::NoRelatedSym ) );
-  for(int i = 1; i <= symbols_count; i++){
-    // Get the NoRelatedSym group and for each, print out the Symbol value
-    FIX44::SecurityList::NoRelatedSym symbols_group;
-    tss.getGroup(i, symbols_group);
-
-    MarketDetail marketDetail;
-    marketDetail.setSymbol( symbols_group.getField( FIELD::Symbol ) );
-    marketDetail.setCurrency( symbols_group.getField( FIELD::Currency ) );
-    marketDetail.setFactor( DoubleConvertor::convert( symbols_group.getField( FIELD::Factor ) ) );
-    marketDetail.setContractMultiplier( DoubleConvertor::convert( symbols_group.getField( FIELD::ContractMultiplier ) ) );
-    marketDetail.setProduct( IntConvertor::convert( symbols_group.getField( FIELD::Product ) ) );
-    marketDetail.setRoundlot( DoubleConvertor::convert( symbols_group.getField( FIELD::RoundLot ) ) );
-
-    // FXCM related
-    marketDetail.setSymID( IntConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SYM_ID ) ) );
-    marketDetail.setSymPrecision( IntConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SYM_PRECISION ) ) );
-    marketDetail.setSymPointsize( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SYM_POINT_SIZE ) ) );
-    marketDetail.setSymInterestBuy( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SYM_INTEREST_BUY ) ) );
-    marketDetail.setSymInterestSell( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SYM_INTEREST_SELL ) ) );
-    marketDetail.setSymSortOrder( IntConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SYM_SORT_ORDER ) ) );
-    marketDetail.setSubscriptionStatus( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_SUBSCRIPTION_STATUS ) );
-    marketDetail.setFieldProductID( IntConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_FIELD_PRODUCT_ID ) ) );
-    marketDetail.setCondDistStop( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_COND_DIST_STOP ) ) );
-    marketDetail.setCondDistLimit( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_COND_DIST_LIMIT ) ) );
-    marketDetail.setCondDistEntryStop( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_COND_DIST_ENTRY_STOP ) ) );
-    marketDetail.setCondDistEntryLimit( DoubleConvertor::convert( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_COND_DIST_ENTRY_LIMIT ) ) );
-    marketDetail.setTradingStatus( symbols_group.getField( FXCM_FIX_FIELDS::FXCM_TRADING_STATUS ) );
-
-    addMarketDetail( marketDetail );
-  }
+  map<std::string, MarketDetail> details;
+  map<std::string, std::string> params;
+
+  // One pass over the fields of every group, the groups are not copied.
+  fixgroup::read_market_details( tss, details );
 
   // Also within TradingSessionStatus are FXCM system parameters. This includes important information
   // such as account base currency, server time zone, the time at which the trading day ends, and more.
-  // Read field FXCMNoParam (9016) which shows us how many system parameters are in the message
-  int params_count = IntConvertor::convert( tss.getField( FXCM_NO_PARAMS ) ); // FXCMNoParam (9016)
-  for( int i = 1; i < params_count; i++ ) {
-    // For each parameter, print out both the name of the parameter and the value of the parameter.
-    // FXCMParamName (9017) is the name of the parameter and FXCMParamValue(9018) is of course the value
-    FIX::FieldMap field_map = tss.getGroupRef( i, FXCM_NO_PARAMS );
-    addSysParam( field_map.getField( FXCM_PARAM_NAME ), field_map.getField( FXCM_PARAM_VALUE ) );
-  }
- 
-  // Request accounts under our login
-  queryAccounts();
+  // FXCMNoParam (9016) groups with FXCMParamName (9017) and FXCMParamValue (9018)
+  fixgroup::read_params( tss, params );
+
+  // replace cached details and params, the snapshot is written if something changed
+  const size_t changes = applyMarketSnapshot( details, params );
+  if ( m_market_cache != nullptr && changes > 0 ) {
+    try {
+      TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+      m_market_cache->save( m_market_details, m_system_params );
+      console()->info( "[onMessage::TradingSessionStatus] {} changes, market cache saved", changes );
+    } catch ( IDEFIX::file_not_found& e ) {
+      console()->warn( "[onMessage::TradingSessionStatus] can not write {}", m_market_cache->filename() );
+    }
+  }
+
+  // Request accounts under our login, unless it was done on logon from the warm cache
+  if ( ! m_accounts_requested.exchange( false ) ) {
+    queryAccounts();
+  }
 
   // ** Note on Text(58)
   // You will notice that Text(58) field is always set to "Market is closed. Any trading functionality
@@ -270,33 +328,26 @@ void FIXManager::onMessage(const FIX44::CollateralReport &cr, const SessionID &s
   account->setMinTradeSize( DoubleConvertor::convert( cr.getField( FIELD::Quantity ) ) );
 
   // The CollateralReport NoPartyIDs group can be inspected for additional information such as AccountName
-  // or HedgingStatus
-  FIX44::CollateralReport::NoPartyIDs group;
-  cr.getGroup(1, group); // CollateralReport will only have 1 NoPartyIDs group
-
-  // Get the number of NoPartySubIDs repeating groups
-  int number_subID = IntConvertor::convert( group.getField( FIELD::NoPartySubIDs ) );
-
-  // for each group, print out both the PartySubIDType and the PartySubID (the value)
-  for(int u = 1; u <= number_subID; u++){
-    FIX44::CollateralReport::NoPartyIDs::NoPartySubIDs sub_group;
-    group.getGroup(u, sub_group);
-
-    string sub_type = sub_group.getField(FIELD::PartySubIDType);
-    string sub_value = sub_group.getField(FIELD::PartySubID);
-    // hedging
-    if( sub_type == "4000" ){
-      account->setHedging( (sub_value == "0" ? false : true ) );
-    } 
-    // securities account id
-    else if ( sub_type == "2" ) {
-      account->setSecuritiesAccountID( sub_value );
-    }
-    // Person lastname
-    else if ( sub_type == "22" ) {
-      account->setPerson( sub_value );
-    }
-  }
+  // or HedgingStatus. CollateralReport will only have 1 NoPartyIDs group, the groups are read without copies.
+  fixgroup::for_each( cr, FIELD::NoPartyIDs, [&account](const FIX::FieldMap& group) {
+    // for each NoPartySubIDs group, check both the PartySubIDType and the PartySubID (the value)
+    fixgroup::for_each( group, FIELD::NoPartySubIDs, [&account](const FIX::FieldMap& sub_group) {
+      const string& sub_type  = sub_group.getFieldRef( FIELD::PartySubIDType ).getString();
+      const string& sub_value = sub_group.getFieldRef( FIELD::PartySubID ).getString();
+      // hedging
+      if( sub_type == "4000" ){
+        account->setHedging( (sub_value == "0" ? false : true ) );
+      } 
+      // securities account id
+      else if ( sub_type == "2" ) {
+        account->setSecuritiesAccountID( sub_value );
+      }
+      // Person lastname
+      else if ( sub_type == "22" ) {
+        account->setPerson( sub_value );
+      }
+    });
+  });
 
   // get base currency from system parameters
   account->setCurrency( getSysParam("BASE_CRNCY") );
@@ -315,7 +366,7 @@ void FIXManager::onMessage(const FIX44::CollateralReport &cr, const SessionID &s
   }
 
   // check if we are already initialized
-  if ( m_symbol_subscriptions.empty() && ! isExiting() ) {
+  if ( m_symbol_subscriptions.empty() && ! isExiting() && ! m_restoring ) {
     // call init
     onInit();
   }
@@ -332,6 +383,13 @@ void FIXManager::onMessage(const FIX44::RequestForPositionsAck &ack, const Sessi
   ack.get( posReqStatus );
   ack.get( posReqResult );
 
+  // the PositionReports of the session follow, they replace the restored positions
+  if ( m_positions_restored && ! m_restoring ) {
+    TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+    m_list_marketorders.clear();
+    m_positions_restored = false;
+  }
+
   // No Positions found
   if ( posReqStatus == FIX::PosReqStatus_REJECTED && posReqResult == FIX::PosReqResult_NO_POSITIONS_FOUND_THAT_MATCH_CRITERIA ) {
     // clear positions
@@ -393,8 +451,10 @@ void FIXManager::onMessage(const FIX44::PositionReport& pr, const SessionID& ses
     marketOrder.setSendingTime( pr.getField( FXCM_FIX_FIELDS::FXCM_POS_OPEN_TIME ) );
 
     // set precision
-    auto marketDetail = getMarketDetails( marketOrder.getSymbol() );
-    marketOrder.setPrecision( marketDetail->getSymPrecision() );
+    int precision = 5;
+    double point_size = 0.0001;
+    getSymbolPrecision( marketOrder.getSymbol(), precision, point_size );
+    marketOrder.setPrecision( precision );
 
     // add order to list
     addMarketOrder( marketOrder );
@@ -414,6 +474,8 @@ void FIXManager::onMessage(const FIX44::PositionReport& pr, const SessionID& ses
  * @param session_ID [description]
  */
 void FIXManager::onMessage(const FIX44::MarketDataRequestReject &mdr, const SessionID &session_ID) {
+  m_metric_rejects_market_data.inc();
+
   // If MarketDataRequestReject is returned as the result of a MarketDataRequest message
   // print out the contents of the Text field but first check that it is set
   if ( mdr.isSetField( FIELD::Text ) ) {
@@ -436,48 +498,39 @@ void FIXManager::onMessage(const FIX44::MarketDataRequestReject &mdr, const Sess
 void FIXManager::onMessage(const FIX44::MarketDataSnapshotFullRefresh &mds, const SessionID &session_ID) {
   // Get symbol name of the snapshot; e.g. EUR/USD. Our example only subscribes to EUR/USD so
   // this is the only possible value
-  string symbol = mds.getField(FIELD::Symbol);
-  string entry_date = mds.getHeader().getField(FIELD::SendingTime);
+  const string& symbol = mds.getField(FIELD::Symbol);
+  const string& entry_date = mds.getHeader().getField(FIELD::SendingTime);
 
-  MarketSnapshot snapshot;
+  // One snapshot per thread is reused, its strings keep their capacity and
+  // a quote does not allocate. Slots get it by reference during on_tick.
+  static thread_local MarketSnapshot snapshot;
   snapshot.setSymbol( symbol );
-  snapshot.setSendingTime( entry_date );
+  snapshot.setSendingTime( entry_date.c_str(), entry_date.size() );
+  snapshot.setBid( 0 );
+  snapshot.setAsk( 0 );
+  snapshot.setSessionHigh( 0 );
+  snapshot.setSessionLow( 0 );
+  snapshot.setSpread( 0 );
+
   // set precision
-  auto marketDetail = getMarketDetails( symbol );
-  snapshot.setPrecision( marketDetail->getSymPrecision() );
-  snapshot.setPointSize( marketDetail->getSymPointsize() );
+  int precision     = 5;
+  double point_size = 0.0001;
+  getSymbolPrecision( symbol, precision, point_size );
+  snapshot.setPrecision( precision );
+  snapshot.setPointSize( point_size );
 
   // For each MDEntry in the message, inspect the NoMDEntries group for the presence of either the Bid or Ask
-  // (Offer) type
-  int entry_count = IntConvertor::convert( mds.getField( FIELD::NoMDEntries ) );
-  for(int i = 1; i <= entry_count; i++){
-    FIX44::MarketDataSnapshotFullRefresh::NoMDEntries group;
-    mds.getGroup( i, group );
-    string entry_type = group.getField( FIELD::MDEntryType );
-    // 0 Bid
-    if(entry_type == MDEntryType( MDEntryType_BID ).getString() ){
-      double bid = DoubleConvertor::convert( group.getField( FIELD::MDEntryPx ) );
-      snapshot.setBid( bid );
-    } 
-    // 1 Ask
-    else if(entry_type == MDEntryType( MDEntryType_OFFER ).getString() ) {
-      double ask = DoubleConvertor::convert( group.getField( FIELD::MDEntryPx ) );
-      snapshot.setAsk( ask );
-    } 
-    // 7 Session High
-    else if(entry_type == MDEntryType( MDEntryType_TRADING_SESSION_HIGH_PRICE ).getString() ) {
-      double high = DoubleConvertor::convert( group.getField( FIELD::MDEntryPx) );
-      snapshot.setSessionHigh( high );
-    }
-    // 8 Session Low
-    else if(entry_type == MDEntryType( MDEntryType_TRADING_SESSION_LOW_PRICE ).getString() ) {
-      double low = DoubleConvertor::convert( group.getField( FIELD::MDEntryPx) );
-      snapshot.setSessionLow( low );
-    }
+  // (Offer) type, session high and session low. The groups are read in place, see FIXGroupWalker.h
+  fixgroup::read_md_entries( mds, snapshot );
+
+  t_tick_journal_seq = 0;
+  if ( m_journal != nullptr && ! m_restoring ) {
+    t_tick_journal_seq = m_journal->append_quote( symbol, snapshot.getBid(), snapshot.getAsk() );
   }
 
-  // Add market snapshot for symbol snapshot.getSymbol()
-  addMarketSnapshot( snapshot );
+  // Add market snapshot for symbol snapshot.getSymbol(),
+  // the tick counter of the market is incremented after the lock
+  addMarketSnapshot( snapshot ).inc();
   // handle market snapshot
   onMarketSnapshot( snapshot );
 }
@@ -517,6 +570,12 @@ void FIXManager::onMessage(const FIX44::ExecutionReport& er, const SessionID& se
   er.get( symbol );
   er.get( account );
 
+  if ( execType == FIX::ExecType_NEW ) {
+    m_metric_orders_acked.inc();
+  } else if ( execType == FIX::ExecType_REJECTED ) {
+    m_metric_rejects_order.inc();
+  }
+
   
   // If we have a new market order with fxcm position id.
   if ( ! fxcm_pos_id.empty() ) {
@@ -535,9 +594,11 @@ void FIXManager::onMessage(const FIX44::ExecutionReport& er, const SessionID& se
     marketOrder.setTakePrice( 0 );
     marketOrder.setClosePrice( 0 );
 
-    auto md = getMarketDetails( symbol.getValue() );
-    marketOrder.setPrecision( md->getSymPrecision() );
-    marketOrder.setPointSize( md->getSymPointsize() );
+    int precision = 5;
+    double point_size = 0.0001;
+    getSymbolPrecision( symbol.getValue(), precision, point_size );
+    marketOrder.setPrecision( precision );
+    marketOrder.setPointSize( point_size );
 
     // MassOrderStatus
     if ( execType == FIX::ExecType_NEW ) { // FIX::ExecType_ORDER_STATUS
@@ -654,8 +715,18 @@ void FIXManager::connect(const std::string settingsFile) {
     on_before_session_start();
 
     m_psettings = new SessionSettings( settingsFile );
-    m_pstore_factory = new FileStoreFactory(*m_psettings);
-    m_plog_factory = new FileLogFactory(*m_psettings);
+    // MappedStore=Y keeps the sent messages in memory mapped segments
+    if ( m_psettings->get().has( "MappedStore" ) && m_psettings->get().getBool( "MappedStore" ) ) {
+      m_pstore_factory = new MappedStoreFactory(*m_psettings);
+    } else {
+      m_pstore_factory = new FileStoreFactory(*m_psettings);
+    }
+    // BinaryLog=Y writes the messages in the background, see tools/binlog
+    if ( m_psettings->get().has( "BinaryLog" ) && m_psettings->get().getBool( "BinaryLog" ) ) {
+      m_plog_factory = new BinaryLogFactory(*m_psettings);
+    } else {
+      m_plog_factory = new FileLogFactory(*m_psettings);
+    }
     m_pinitiator = new SocketInitiator(*this, *m_pstore_factory, *m_psettings, *m_plog_factory/* Optional*/);
     m_pinitiator->start();
   } catch( ConfigError& error ){
@@ -674,7 +745,9 @@ void FIXManager::disconnect() {
     on_before_session_end();
 
     // call stop method of socket initiator
-    m_pinitiator->stop();  
+    if ( m_pinitiator != nullptr ) {
+      m_pinitiator->stop();
+    }
   } catch( ConfigError& error ) {
     console()->error( "[disconnect:exception] unknown error." );
     on_error( __FUNCTION__, error.what() );
@@ -689,7 +762,7 @@ void FIXManager::disconnect() {
 void FIXManager::queryTradingStatus() {
   try {
     auto request = FIXFactory::TradingSessionStatusRequest( nextRequestID() );
-    Session::sendToTarget( request, getOrderSessionID() );  
+    send( request, getOrderSessionID() );  
   } catch( SessionNotFound& e ) {
     console()->error( "[queryTradingStatus] SessionNotFound");
     on_error( __FUNCTION__, "SessionNotFound" );
@@ -706,7 +779,7 @@ void FIXManager::queryAccounts(){
     // Request CollateralReport message. We will receive a CollateralReport for each
     // account under our login
     auto request = FIXFactory::CollateralInquiry( nextRequestID() );
-    Session::sendToTarget(request, getOrderSessionID());  
+    send(request, getOrderSessionID());  
   } catch( SessionNotFound& e ) {
     console()->error( "[queryTradingStatus] SessionNotFound");
     on_error( __FUNCTION__, "SessionNotFound" );
@@ -727,7 +800,7 @@ void FIXManager::queryAccounts(){
 void FIXManager::subscribeMarketData(const std::string symbol) {
   console()->info( "[subscribeMarketData] {}", symbol );
   auto request = FIXFactory::MarketDataRequest( symbol, SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES );
-  Session::sendToTarget( request, getMarketSessionID() );
+  send( request, getMarketSessionID() );
 
   // add to subscriptions
   addSubscription( symbol );
@@ -737,8 +810,9 @@ void FIXManager::subscribeMarketData(const std::string symbol) {
   if ( ! counterPair.empty() && counterPair != symbol ) {
     if ( m_list_market.find( counterPair ) == m_list_market.end() ) {
       console()->info( "[subscribeMarketData] {} for price conversion of {}", counterPair, symbol );
+      registerMarket( counterPair );
       auto request2 = FIXFactory::MarketDataRequest( counterPair, SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES );
-      Session::sendToTarget( request2, getMarketSessionID() );  
+      send( request2, getMarketSessionID() );  
     }
   }
 }
@@ -748,7 +822,7 @@ void FIXManager::unsubscribeMarketData(const std::string symbol) {
   console()->info( "[unsubscribeMarketData] {}", symbol );
 
   auto request = FIXFactory::MarketDataRequest( symbol, SubscriptionRequestType_DISABLE_PREVIOUS_SNAPSHOT_PLUS_UPDATE_REQUEST );
-  Session::sendToTarget( request, getMarketSessionID() );
+  send( request, getMarketSessionID() );
 
   removeSubscription( symbol );
 
@@ -759,7 +833,7 @@ void FIXManager::unsubscribeMarketData(const std::string symbol) {
     if ( m_list_market.find( counterPair ) != m_list_market.end() ) {
       console()->info( "[unsubscribeMarketData] {} for price conversion of {}", counterPair, symbol );
       auto request2 = FIXFactory::MarketDataRequest( symbol, SubscriptionRequestType_DISABLE_PREVIOUS_SNAPSHOT_PLUS_UPDATE_REQUEST );
-      Session::sendToTarget( request2, getMarketSessionID() );
+      send( request2, getMarketSessionID() );
     }
   }
 }
@@ -775,24 +849,24 @@ void FIXManager::marketOrder(const MarketOrder& marketOrder, const FIXFactory::S
     // normal market order.
     if ( orderType == FIXFactory::SingleOrderType::MARKET_ORDER ) {
       auto request = FIXFactory::NewOrderSingle( nextOrderID(), marketOrder );
-      Session::sendToTarget( request, getOrderSessionID() );  
+      send( request, getOrderSessionID() );  
     } 
     // market order with stoploss (OCO)
     else if ( orderType == FIXFactory::SingleOrderType::MARKET_ORDER_SL ) {
       const std::vector<std::string> reqIDs = { nextOrderID(), nextOrderID(), nextOrderID() };
       auto olist = FIXFactory::NewOrderList( reqIDs, marketOrder );
-      Session::sendToTarget( olist, getOrderSessionID() );
+      send( olist, getOrderSessionID() );
     }
     // market order with stoploss and takeprofit (ELS)
     else if ( orderType == FIXFactory::SingleOrderType::MARKET_ORDER_SL_TP ) {
       const std::vector<std::string> reqIDs = { nextOrderID(), nextOrderID(), nextOrderID(), nextOrderID() };
       auto olist = FIXFactory::NewOrderList( reqIDs, marketOrder );
-      Session::sendToTarget( olist, getOrderSessionID() );
+      send( olist, getOrderSessionID() );
     }
     // stop order
     else if ( orderType == FIXFactory::SingleOrderType::STOPORDER ) {
       auto request = FIXFactory::NewOrderSingle( nextOrderID(), marketOrder, orderType );
-      Session::sendToTarget( request, getOrderSessionID() );
+      send( request, getOrderSessionID() );
     }
     // not found
     else {
@@ -820,6 +894,142 @@ string FIXManager::nextOrderID() {
   return m_reqid_manager.nextOrderID();
 }
 
+/*!
+ * Send message to the FIX session or to the outbound hook if set
+ *
+ * @param Message& message
+ * @param const SessionID& session_ID
+ */
+void FIXManager::send(Message& message, const SessionID& session_ID) {
+  // requests caused by restored messages are answered already
+  if ( m_restoring ) {
+    return;
+  }
+
+  if ( m_journal != nullptr ) {
+    m_journal->append_message( message, EventJournal::OUTBOUND );
+  }
+
+  if ( EventJournal::type_of( message.getHeader().getField( FIELD::MsgType ), EventJournal::OUTBOUND ) == EventJournal::ORDER ) {
+    m_metric_orders_sent.inc();
+  }
+
+  if ( m_outbound ) {
+    m_outbound( message );
+    return;
+  }
+
+  Session::sendToTarget( message, session_ID );
+}
+
+/*!
+ * Route all outgoing application messages to the hook instead of the FIX session,
+ * used by SimulatedBroker. Pass nullptr to send to the session again.
+ *
+ * @param std::function<void(const Message&)> outbound
+ */
+void FIXManager::setOutbound(std::function<void(const Message&)> outbound) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  m_outbound = outbound;
+}
+
+/*!
+ * Append all inbound and outbound application messages to the journal.
+ * Pass nullptr to stop journaling.
+ *
+ * @param EventJournal* journal opened writable, owned by the caller
+ */
+void FIXManager::setJournal(EventJournal* journal) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  m_journal = journal;
+}
+
+/*!
+ * Journal sequence number of the tick, valid in on_tick slots
+ *
+ * @return uint64_t 0 if the tick was not journaled
+ */
+uint64_t FIXManager::getTickJournalSeq() const {
+  return t_tick_journal_seq;
+}
+
+/*!
+ * Rebuild account, market details and positions from the inbound messages of the
+ * last session in a journal, without round trips to FXCM. A session begins with
+ * its TradingSessionStatus, older events are skipped. The messages go through the
+ * normal onMessage handlers, nothing is sent, no trade is logged and onInit is not
+ * called. The restored positions are replaced by the PositionReports of the next
+ * session, positions closed meanwhile don't stay.
+ *
+ * @param const EventJournal&        journal
+ * @param const FIX::DataDictionary& dictionary to decode the repeating groups
+ * @return size_t count of restored messages
+ */
+size_t FIXManager::restore(const EventJournal& journal, const FIX::DataDictionary& dictionary) {
+  size_t count = 0;
+
+  // start of the last session
+  const std::string tss = std::string( 1, '\x01' ) + "35=" + MsgType_TradingSessionStatus + '\x01';
+  uint64_t from_seq     = 0;
+  journal.for_each( [&](const EventJournal::Event& event) {
+    if ( event.direction == EventJournal::INBOUND && event.type == EventJournal::MESSAGE
+      && std::search( event.data, event.data + event.size, tss.begin(), tss.end() ) != event.data + event.size ) {
+      from_seq = event.seq;
+    }
+    return true;
+  });
+
+  m_restoring = true;
+
+  journal.for_each( [&](const EventJournal::Event& event) {
+    if ( event.direction != EventJournal::INBOUND || event.type == EventJournal::QUOTE ) {
+      return true;
+    }
+
+    try {
+      Message message( std::string( event.data, event.size ), dictionary, false );
+      const Header& header = message.getHeader();
+      SessionID session_ID( header.getField( FIELD::BeginString ), header.getField( FIELD::TargetCompID ), header.getField( FIELD::SenderCompID ) );
+
+      crack( message, session_ID );
+      count++;
+    } catch ( FIX::Exception& e ) {
+      console()->warn( "[restore] seq {}: {}", event.seq, e.what() );
+    }
+    return true;
+  }, from_seq );
+
+  m_restoring = false;
+  m_positions_restored = ! m_list_marketorders.empty();
+  console()->info( "[restore] {} messages from seq {}, {} positions", count, from_seq, m_list_marketorders.size() );
+
+  return count;
+}
+
+/*!
+ * Load market details and system params of the last TradingSessionStatus from
+ * a snapshot, they are available before the first logon. The snapshot is
+ * updated whenever TradingSessionStatus brings changes.
+ *
+ * @param const std::string& filename
+ * @return size_t count of loaded market details
+ */
+size_t FIXManager::setMarketCache(const std::string& filename) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  m_market_cache = std::make_shared<MarketCache>( filename );
+
+  try {
+    m_market_cache->load( m_market_details, m_system_params );
+    console()->info( "[setMarketCache] {} markets and {} params from {}", m_market_details.size(), m_system_params.size(), filename );
+  } catch ( IDEFIX::file_not_found& e ) {
+    console()->info( "[setMarketCache] no snapshot {} yet", filename );
+  } catch ( IDEFIX::out_of_range& e ) {
+    console()->warn( "[setMarketCache] {} is damaged and will be replaced", filename );
+  }
+
+  return m_market_details.size();
+}
+
 // Get the settings dictionary for the session
 const FIX::Dictionary* FIXManager::getSessionSettingsPtr(const SessionID& session_ID){
   const FIX::Dictionary* pSettings = m_pinitiator->getSessionSettings(session_ID);
@@ -838,6 +1048,28 @@ bool FIXManager::isOrderSession(const SessionID& session_ID){
   return pSettings->has("OrderSession") && pSettings->getBool("OrderSession");
 }
 
+/*!
+ * Check if the session exists and is logged on
+ *
+ * @param const SessionID& session_ID
+ * @return bool
+ */
+bool FIXManager::isLoggedOn(const SessionID& session_ID) const {
+  Session* session = Session::lookupSession( session_ID );
+  return session != nullptr && session->isLoggedOn();
+}
+
+/*!
+ * Message counter of the market data or order session
+ *
+ * @param const SessionID& session_ID
+ * @param const bool       outgoing
+ * @return Metrics::Counter&
+ */
+Metrics::Counter& FIXManager::messageCounter(const SessionID& session_ID, const bool outgoing) {
+  return m_metric_messages[ session_ID == m_market_sessionID ? 0 : 1 ][ outgoing ? 1 : 0 ];
+}
+
 /*!
  * Handle everything which relys on a new market snapshot
  * 
@@ -848,6 +1080,7 @@ void FIXManager::onMarketSnapshot(const MarketSnapshot& snapshot) {
   processMarketOrders( snapshot );
 
   // signal
+  Metrics::Timer timer( m_metric_on_tick );
   on_tick( snapshot );
 
 } // - onMarketSnapshot
@@ -858,7 +1091,7 @@ void FIXManager::onMarketSnapshot(const MarketSnapshot& snapshot) {
  * @param const MarketSnapshot& snapshot The market snapshot.
  */
 void FIXManager::processMarketOrders(const MarketSnapshot& snapshot) {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if ( isExiting() ) return;
   
   if ( m_list_marketorders.empty() ) return;
@@ -871,8 +1104,8 @@ void FIXManager::processMarketOrders(const MarketSnapshot& snapshot) {
   for ( auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ) {
     // handle only positions with the same symbol trading
     if ( it->second.getSymbol() == snapshot.getSymbol() ) {
-      // the position (MarketOrder)
-      auto position = it->second;
+      // the position (MarketOrder), updated in place
+      MarketOrder& position = it->second;
 
       // -----------------------------------------------------------------------------------------------------------------------
       // Calculate Pip & Profit/Loss Value
@@ -888,13 +1121,13 @@ void FIXManager::processMarketOrders(const MarketSnapshot& snapshot) {
       }
       // calculate pip value for EUR account
       else if ( accountCurrency == "EUR" ) {
-        // get EUR/USD snapshot
-        auto eurusd_snapshot = getLatestSnapshot( "EUR/USD" );
+        // get EUR/USD ask
+        const double eurusd_ask = getLatestAsk( "EUR/USD" );
 
         // AUD/USD, EUR/USD, GBP/USD, NZD/USD, ...
         if ( snapshot.getQuoteCurrency() == "USD" ) {
           // calculate pip value
-          pip_value = Math::get_pip_value( snapshot, position.getQty(), accountCurrency, eurusd_snapshot->getAsk(), position.getSide() );
+          pip_value = Math::get_pip_value( snapshot, position.getQty(), accountCurrency, eurusd_ask, position.getSide() );
         }
         // USD/CAD, USD/CHF, USD/JPY...
         else if ( snapshot.getBaseCurrency() == "USD" ) {
@@ -903,24 +1136,18 @@ void FIXManager::processMarketOrders(const MarketSnapshot& snapshot) {
 
           // USD/CAD use EUR/CAD
           if ( snapshot.getQuoteCurrency() == "CAD" ) {
-            // get latest snapshot for EUR/CAD
-            auto eurcad_snapshot = getLatestSnapshot( "EUR/CAD" );
-            // set conversion price
-            conversion_price = eurcad_snapshot->getAsk();
+            // set conversion price from latest EUR/CAD
+            conversion_price = getLatestAsk( "EUR/CAD" );
           }
           // USD/CHF use EUR/CHF
           else if ( snapshot.getQuoteCurrency() == "CHF" ) {
-            // get latest snapshot for EUR/CHF
-            auto eurchf_snapshot = getLatestSnapshot( "EUR/CHF" );
-            // set conversion price
-            conversion_price = eurchf_snapshot->getAsk();
+            // set conversion price from latest EUR/CHF
+            conversion_price = getLatestAsk( "EUR/CHF" );
           }
           // USD/JPY use EUR/JPY
           else if ( snapshot.getQuoteCurrency() == "JPY" ) {
-            // get latest snapshot for EUR/JPY
-            auto eurjpy_snapshot = getLatestSnapshot( "EUR/JPY" );
-            // set conversion price
-            conversion_price = eurjpy_snapshot->getAsk();
+            // set conversion price from latest EUR/JPY
+            conversion_price = getLatestAsk( "EUR/JPY" );
           }
 
           // calculate pip value with conversion price
@@ -932,7 +1159,6 @@ void FIXManager::processMarketOrders(const MarketSnapshot& snapshot) {
       const double profitloss = Math::get_profit_loss( pip_value, snapshot, position );
       
       // update position
-      it->second.setProfitLoss( profitloss );
       position.setProfitLoss( profitloss );
 
       // Signal
@@ -973,48 +1199,66 @@ void FIXManager::processMarketOrders(const MarketSnapshot& snapshot) {
 }
 
 /*!
- * Returns last market snapshot for symbol
+ * Returns a copy of the last market snapshot for symbol, see
+ * Registry::latestSnapshot to read it without a copy
  * @param  symbol symbol
  * @return std::shared_ptr<MarketSnapshot> 
  */
 std::shared_ptr<MarketSnapshot> FIXManager::getLatestSnapshot(const string symbol) {
-  FIX::Locker lock( m_mutex );
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
 
-  auto market = getMarket( symbol );
-  if( market->isValid() ){
-    return std::make_shared<MarketSnapshot>( market->getLatestSnapshot() );
+  map<string, Market>::iterator it = m_list_market.find( symbol );
+  if( it != m_list_market.end() && ! it->second.isEmpty() ){
+    return std::make_shared<MarketSnapshot>( it->second.latest() );
   }
 
   return nullptr;
 }
 
+/*!
+ * Returns ask of the last market snapshot for symbol, without a copy
+ * @param  symbol symbol
+ * @return double 0 if there is no snapshot
+ */
+double FIXManager::getLatestAsk(const std::string& symbol) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+
+  map<string, Market>::iterator it = m_list_market.find( symbol );
+  if( it != m_list_market.end() && ! it->second.isEmpty() ){
+    return it->second.latest().getAsk();
+  }
+
+  return 0;
+}
+
 /*!
  * Send request to close all positions for symbol
  * @param symbol sring
  */
 void FIXManager::closeAllPositions(const string symbol){
-  if( m_list_marketorders.empty() ) return;
+  auto positions = getMarketOrders( [&symbol](const MarketOrder& position) {
+    return position.getSymbol() == symbol;
+  });
+  if ( positions.empty() ) return;
 
   console()->info( "[closeAllPositions] {}", symbol );
-  
-  for ( auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ) {
-    if ( it->second.getSymbol() == symbol ){
-      closePosition( it->second );
-    }
+
+  for ( auto& position : positions ) {
+    closePosition( position );
   }
 }
 
 void FIXManager::closeAllPositions(const std::string symbol, const char side) {
-  if ( m_list_marketorders.empty() ) return;
+  auto positions = getMarketOrders( [&symbol, side](const MarketOrder& position) {
+    return position.getSymbol() == symbol && position.getSide() == side;
+  });
+  if ( positions.empty() ) return;
 
   console()->info( "[closeAllPositions] {} {}", symbol, side );
 
-  for ( auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ) {
-    if ( it->second.getSymbol() == symbol && it->second.getSide() == side ){
-      closePosition( it->second );
-    }
+  for ( auto& position : positions ) {
+    closePosition( position );
   }
-
 }
 
 /*!
@@ -1023,17 +1267,19 @@ void FIXManager::closeAllPositions(const std::string symbol, const char side) {
  */
 void FIXManager::closePosition(const IDEFIX::MarketOrder &marketOrder){
   try {
-    auto marketDetail = getMarketDetails( marketOrder.getSymbol() );
+    int precision = 5;
+    double point_size = 0.0001;
+    getSymbolPrecision( marketOrder.getSymbol(), precision, point_size );
 
     std::ostringstream oss;
     oss << " - {} P&L {:.";
-    oss << marketDetail->getSymPrecision();
+    oss << precision;
     oss << "f} {}";
 
     console()->info( oss.str().c_str(), marketOrder.getPosID(), marketOrder.getProfitLoss(), getAccount()->getCurrency() );
 
     auto request = FIXFactory::NewOrderSingle( nextOrderID(), marketOrder, FIXFactory::SingleOrderType::CLOSEORDER );
-    Session::sendToTarget(request, getOrderSessionID());  
+    send(request, getOrderSessionID());  
   } catch(std::exception& e){
     on_error( __FUNCTION__, e.what() );
     console()->error( "[closePosition:exception] {}", e.what() );
@@ -1045,13 +1291,14 @@ void FIXManager::closePosition(const IDEFIX::MarketOrder &marketOrder){
  * @param std::string symbol Close only positions for this symbol.
  */
 void FIXManager::closeWinners(const string symbol) {
-  if ( m_list_marketorders.empty() ) return;
+  auto positions = getMarketOrders( [&symbol](const MarketOrder& position) {
+    return position.getSymbol() == symbol && position.getProfitLoss() > 0;
+  });
+  if ( positions.empty() ) return;
 
   console()->info( "[closeWinners]" );
-  for ( auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ) {
-    if ( it->second.getSymbol() == symbol && it->second.getProfitLoss() > 0 ) {
-      closePosition( it->second );
-    }
+  for ( auto& position : positions ) {
+    closePosition( position );
   }
 }
 
@@ -1060,13 +1307,14 @@ void FIXManager::closeWinners(const string symbol) {
  * @param std::string symbol Close only positions for this symbol.
  */
 void FIXManager::closeLoosers(const std::string symbol) {
-  if ( m_list_marketorders.empty() ) return;
+  auto positions = getMarketOrders( [&symbol](const MarketOrder& position) {
+    return position.getSymbol() == symbol && position.getProfitLoss() < 0;
+  });
+  if ( positions.empty() ) return;
 
   console()->info( "[closeLoosers]" );
-  for ( auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ) {
-    if ( it->second.getSymbol() == symbol && it->second.getProfitLoss() < 0 ) {
-      closePosition( it->second );
-    }
+  for ( auto& position : positions ) {
+    closePosition( position );
   }
 }
 
@@ -1079,7 +1327,7 @@ void FIXManager::closeLoosers(const std::string symbol) {
 void FIXManager::queryPositionReport(const FIX::PosReqType type){
   try {
     auto request = FIXFactory::RequestForPositions( nextRequestID(), getAccountID(), type);
-    Session::sendToTarget(request, getOrderSessionID());
+    send(request, getOrderSessionID());
   } catch( std::exception& e ){
     console()->error( "[queryPositionReport:exception] {}", e.what() );
   }
@@ -1091,7 +1339,7 @@ void FIXManager::queryPositionReport(const FIX::PosReqType type){
 void FIXManager::queryOrderMassStatus() {
   try {
     auto request = FIXFactory::OrderMassStatusRequest( nextRequestID(), getAccountID() );  
-    Session::sendToTarget( request, getOrderSessionID() );
+    send( request, getOrderSessionID() );
   } catch( std::exception& e ){
     console()->error( "[queryOrderMassStatus:exception] {}", e.what() );
   }
@@ -1144,12 +1392,13 @@ void FIXManager::setOrderSessionID(const FIX::SessionID &session_ID){
 }
 
 /*!
- * Returns the market for given symbol
+ * Returns a copy of the market for given symbol with all its snapshots,
+ * see Registry::market to read it without a copy
  * @param  symbol [description]
  * @return std::shared_ptr<Market>|nullptr
  */
 std::shared_ptr<Market> FIXManager::getMarket(const string& symbol) {
-  FIX::Locker lock( m_mutex );
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   map<string, Market>::iterator it = m_list_market.find( symbol );
   if( it != m_list_market.end() ){
     // found market
@@ -1164,28 +1413,44 @@ std::shared_ptr<Market> FIXManager::getMarket(const string& symbol) {
  * @param Market market
  */
 void FIXManager::addMarket(const Market market){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if( m_list_market.count(market.getSymbol()) == 0 ){
     // add market
     m_list_market.insert( pair<string, Market>(market.getSymbol(), market) );
   }
 }
 
+/*!
+ * Add an empty market with its tick counter, the counter is resolved
+ * once here and not on every tick
+ * @param const std::string& symbol
+ */
+void FIXManager::registerMarket(const std::string& symbol) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  auto it = m_list_market.find( symbol );
+  if ( it == m_list_market.end() ) {
+    it = m_list_market.insert( pair<string, Market>( symbol, Market( symbol ) ) ).first;
+    it->second.setTickCounter( Metrics::counter( "idefix_ticks_total", Metrics::label( "symbol", symbol ) ) );
+  }
+}
+
 /*!
  * Adds a snapshot to the market list
  * @param snapshot [description]
+ * @return Metrics::Counter tick counter of the market
  */
-void FIXManager::addMarketSnapshot(const MarketSnapshot snapshot){
-  FIX::Locker lock(m_mutex);
+Metrics::Counter FIXManager::addMarketSnapshot(const MarketSnapshot& snapshot){
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   map<string, Market>::iterator marketIterator = m_list_market.find( snapshot.getSymbol() );
-  if( marketIterator != m_list_market.end() ){
-    // found market, add snapshot
-    marketIterator->second.add(snapshot);
-  } else {
-    // add market with snapshot
-    Market market(snapshot);
-    addMarket(market);
+  if( marketIterator == m_list_market.end() ){
+    // quote of a symbol which was never subscribed
+    registerMarket( snapshot.getSymbol() );
+    marketIterator = m_list_market.find( snapshot.getSymbol() );
   }
+
+  // add snapshot
+  marketIterator->second.add(snapshot);
+  return marketIterator->second.getTickCounter();
 }
 
 /*!
@@ -1193,7 +1458,7 @@ void FIXManager::addMarketSnapshot(const MarketSnapshot snapshot){
  * @param marketOrder [description]
  */
 void FIXManager::addMarketOrder(const MarketOrder marketOrder){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   map<string, MarketOrder>::iterator moIterator = m_list_marketorders.find(marketOrder.getPosID());
   if( moIterator == m_list_marketorders.end() ){
     // posID not found
@@ -1207,7 +1472,7 @@ void FIXManager::addMarketOrder(const MarketOrder marketOrder){
  * @param posID FXCM position id
  */
 void FIXManager::removeMarketOrder(const string posID){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   map<string, MarketOrder>::iterator moIterator = m_list_marketorders.find(posID);
   if( moIterator != m_list_marketorders.end() ){
     // Send update signal
@@ -1223,7 +1488,7 @@ void FIXManager::removeMarketOrder(const string posID){
  * @param const bool isUnsolicited set to true to update stop loss or take profit
  */
 void FIXManager::updateMarketOrder(const MarketOrder& rH, const bool isUnsolicited){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   map<string, MarketOrder>::iterator moIterator = m_list_marketorders.find( rH.getPosID() );
   if( moIterator != m_list_marketorders.end() ){
     // original order
@@ -1265,18 +1530,17 @@ void FIXManager::updateMarketOrder(const MarketOrder& rH, const bool isUnsolicit
 }
 
 /*!
- * Returns the market order by fxcm_pos_id
+ * Returns a copy of the market order by fxcm_pos_id, see Registry::marketOrder
+ * to read it without a copy
  * @param const std::string fxcm_pos_id 
  * 
  * @return std::shared_ptr<MarketOrder>|nullptr
  */
 std::shared_ptr<MarketOrder> FIXManager::getMarketOrder(const std::string fxcm_pos_id) const {
-  FIX::Locker lock( m_mutex );
-  for(auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ){
-    if( it->second.getPosID() == fxcm_pos_id ){
-      return std::make_shared<MarketOrder>( it->second );
-      break;
-    }
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  auto it = m_list_marketorders.find( fxcm_pos_id );
+  if ( it != m_list_marketorders.end() ) {
+    return std::make_shared<MarketOrder>( it->second );
   }
   return nullptr;
 }
@@ -1288,7 +1552,7 @@ std::shared_ptr<MarketOrder> FIXManager::getMarketOrder(const std::string fxcm_p
  * @return std::shared_ptr<MarketOrder>|nullptr
  */
 std::shared_ptr<MarketOrder> FIXManager::getMarketOrder(const ClOrdID clOrdID) const {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   for(auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ){
     if( it->second.getClOrdID() == clOrdID ){
       return std::make_shared<MarketOrder>( it->second );
@@ -1298,12 +1562,31 @@ std::shared_ptr<MarketOrder> FIXManager::getMarketOrder(const ClOrdID clOrdID) c
   return nullptr;
 }
 
+/*!
+ * Returns copies of the open positions matching filter. The close* methods
+ * run on strategy threads too, they copy under the lock and send the close
+ * orders after it is released, the FIX thread may remove positions meanwhile.
+ *
+ * @param const std::function<bool(const MarketOrder&)>& filter
+ * @return std::vector<MarketOrder>
+ */
+std::vector<MarketOrder> FIXManager::getMarketOrders(const std::function<bool(const MarketOrder&)>& filter) const {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  std::vector<MarketOrder> positions;
+  for ( auto it = m_list_marketorders.begin(); it != m_list_marketorders.end(); ++it ) {
+    if ( filter( it->second ) ) {
+      positions.push_back( it->second );
+    }
+  }
+  return positions;
+}
+
 /*!
  * Add market detail object to list
  * @param const MarketDetail& marketDetail
  */
 void FIXManager::addMarketDetail(const MarketDetail& marketDetail){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if ( m_market_details.count(marketDetail.getSymbol()) == 0 ) {
     // add market detail
     m_market_details.insert( pair<std::string, MarketDetail>(marketDetail.getSymbol(), marketDetail) );
@@ -1311,30 +1594,152 @@ void FIXManager::addMarketDetail(const MarketDetail& marketDetail){
 }
 
 /*!
- * Get MarketDetail for symbol
+ * Replace market details and system params with those of a TradingSessionStatus
+ *
+ * @param map<std::string, MarketDetail>& details emptied
+ * @param map<std::string, std::string>&  params  emptied
+ * @return size_t count of added, changed and removed entries
+ */
+size_t FIXManager::applyMarketSnapshot(map<std::string, MarketDetail>& details, map<std::string, std::string>& params) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+  size_t changes = 0;
+
+  for ( auto& item : details ) {
+    auto it = m_market_details.find( item.first );
+    if ( it == m_market_details.end() || it->second != item.second ) {
+      changes++;
+    }
+  }
+  for ( auto& item : m_market_details ) {
+    if ( details.find( item.first ) == details.end() ) {
+      changes++;
+    }
+  }
+
+  for ( auto& item : params ) {
+    auto it = m_system_params.find( item.first );
+    if ( it == m_system_params.end() || it->second != item.second ) {
+      changes++;
+    }
+  }
+  for ( auto& item : m_system_params ) {
+    if ( params.find( item.first ) == params.end() ) {
+      changes++;
+    }
+  }
+
+  m_market_details.swap( details );
+  m_system_params.swap( params );
+  details.clear();
+  params.clear();
+
+  return changes;
+}
+
+/*!
+ * Get a copy of the MarketDetail for symbol, see Registry::marketDetail
+ * to read it without a copy
  * @param const std::string& symbol
  * @return std::shared_ptr<MarketDetail>
  */
 std::shared_ptr<MarketDetail> FIXManager::getMarketDetails(const std::string& symbol) {
-  FIX::Locker lock(m_mutex);
-  
-  for(auto it = m_market_details.begin(); it != m_market_details.end(); ++it) {
-    if( it->first == symbol ) {
-      return std::make_shared<MarketDetail>( it->second );
-      break;
-    }
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+
+  auto it = m_market_details.find( symbol );
+  if ( it != m_market_details.end() ) {
+    return std::make_shared<MarketDetail>( it->second );
   }
 
   return nullptr;
 }
 
+/*!
+ * Copy precision and point size of a symbol, unlike getMarketDetails
+ * without a copy of the MarketDetail
+ *
+ * @param const std::string& symbol
+ * @param int&               precision  unchanged if the symbol is unknown
+ * @param double&            point_size unchanged if the symbol is unknown
+ * @return bool
+ */
+bool FIXManager::getSymbolPrecision(const std::string& symbol, int& precision, double& point_size) {
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
+
+  auto it = m_market_details.find( symbol );
+  if ( it == m_market_details.end() ) {
+    return false;
+  }
+
+  precision  = it->second.getSymPrecision();
+  point_size = it->second.getSymPointsize();
+  return true;
+}
+
+/*!
+ * Lock FIXManager for const access without copies
+ * @param const FIXManager& fixmanager
+ */
+FIXManager::Registry::Registry(const FIXManager& fixmanager)
+  : m_fixmanager( fixmanager ), m_lock( fixmanager.m_mutex, fixmanager.m_metric_mutex_wait, fixmanager.m_metric_mutex_hold ) {}
+
+/*!
+ * Returns the market detail for symbol
+ * @param const std::string& symbol
+ * @return const MarketDetail*|nullptr
+ */
+const MarketDetail* FIXManager::Registry::marketDetail(const std::string& symbol) const {
+  auto it = m_fixmanager.m_market_details.find( symbol );
+  return it != m_fixmanager.m_market_details.end() ? &it->second : nullptr;
+}
+
+/*!
+ * Returns the market for symbol
+ * @param const std::string& symbol
+ * @return const Market*|nullptr
+ */
+const Market* FIXManager::Registry::market(const std::string& symbol) const {
+  auto it = m_fixmanager.m_list_market.find( symbol );
+  return it != m_fixmanager.m_list_market.end() ? &it->second : nullptr;
+}
+
+/*!
+ * Returns the last market snapshot for symbol
+ * @param const std::string& symbol
+ * @return const MarketSnapshot*|nullptr
+ */
+const MarketSnapshot* FIXManager::Registry::latestSnapshot(const std::string& symbol) const {
+  auto it = m_fixmanager.m_list_market.find( symbol );
+  if ( it == m_fixmanager.m_list_market.end() || it->second.isEmpty() ) {
+    return nullptr;
+  }
+  return &it->second.latest();
+}
+
+/*!
+ * Returns the open position by fxcm_pos_id
+ * @param const std::string& pos_id
+ * @return const MarketOrder*|nullptr
+ */
+const MarketOrder* FIXManager::Registry::marketOrder(const std::string& pos_id) const {
+  auto it = m_fixmanager.m_list_marketorders.find( pos_id );
+  return it != m_fixmanager.m_list_marketorders.end() ? &it->second : nullptr;
+}
+
+/*!
+ * Returns the account
+ * @return const Account*|nullptr before the CollateralReport
+ */
+const Account* FIXManager::Registry::account() const {
+  return m_fixmanager.m_account.get();
+}
+
 /*!
  * Insert key,value pair to system params
  * @param key   [description]
  * @param value [description]
  */
 void FIXManager::addSysParam(const string key, const string value){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   // check if the key already exisits
   auto it = m_system_params.find(key);
   if( it == m_system_params.end() ){
@@ -1348,7 +1753,7 @@ void FIXManager::addSysParam(const string key, const string value){
  * @return     [description]
  */
 string FIXManager::getSysParam(const string key){
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   string value;
   auto it = m_system_params.find(key);
   if( it != m_system_params.end() ){
@@ -1361,7 +1766,7 @@ string FIXManager::getSysParam(const string key){
  * Show system parameter list
  */
 void FIXManager::showSysParamList() {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if( m_system_params.empty() ) return;
 
   console()->info( "[System Parameters]" );
@@ -1374,7 +1779,7 @@ void FIXManager::showSysParamList() {
  * Show available market list 
  */
 void FIXManager::showAvailableMarketList() {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if ( m_market_details.empty() ) return;
 
   console()->info( "[Available Markets]" );
@@ -1389,7 +1794,7 @@ void FIXManager::showAvailableMarketList() {
  * @param const std::string symbol
  */
 void FIXManager::showMarketDetail(const string symbol) {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if ( m_market_details.empty() ) return;
 
   auto it = m_market_details.find( symbol );
@@ -1404,10 +1809,10 @@ void FIXManager::showMarketDetail(const string symbol) {
  * Call this, if you want to handle things after login, establishing sessions and receiving collateral report
  */
 void FIXManager::onInit() {
-  FIX::Locker lock( m_mutex );
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if ( ! isExiting() ) {
     // output 
-    console()->info( "[INFO] - Press 0 to exit! -" );
+    console()->info( "[INFO] - Press 0 to exit, 1 for strategy stats! -" );
   }
 
   // signal
@@ -1420,7 +1825,7 @@ void FIXManager::onInit() {
  * Call this, if you want to handle things before exiting
  */
 void FIXManager::onExit() {
-  FIX::Locker lock( m_mutex );
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
 
   if ( ! isExiting() ) return;
 
@@ -1433,10 +1838,12 @@ void FIXManager::onExit() {
  * @param const std::string symbol
  */
 void FIXManager::addSubscription(const string symbol) {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   if ( std::find( m_symbol_subscriptions.begin(), m_symbol_subscriptions.end(), symbol ) == m_symbol_subscriptions.end() ) {
     m_symbol_subscriptions.push_back( symbol );
   }
+  // register the market and its tick counter before the first quote arrives
+  registerMarket( symbol );
 }
 
 /*!
@@ -1444,7 +1851,7 @@ void FIXManager::addSubscription(const string symbol) {
  * @param const std::string symbol
  */
 void FIXManager::removeSubscription(const string symbol) {
-  FIX::Locker lock(m_mutex);
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   auto it = std::find( m_symbol_subscriptions.begin(), m_symbol_subscriptions.end(), symbol );
   if ( it != m_symbol_subscriptions.end() ) {
     m_symbol_subscriptions.erase( it );
@@ -1457,7 +1864,7 @@ void FIXManager::removeSubscription(const string symbol) {
  * @return std::shared_ptr<spdlog::logger>
  */
 std::shared_ptr<spdlog::logger> FIXManager::console() {
-  FIX::Locker lock( m_mutex );
+  // set once in the constructor, no lock needed
   return m_console;
 }
 
@@ -1467,7 +1874,10 @@ std::shared_ptr<spdlog::logger> FIXManager::console() {
  * @param const MarketOrder& marketOrder
  */
 void FIXManager::tradelog(const MarketOrder& marketOrder) {
-  FIX::Locker lock( m_mutex );
+  // trades of restored messages are logged already
+  if ( m_restoring ) return;
+
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
   
   try {
     std::stringstream filename_ss;
@@ -1511,11 +1921,11 @@ void FIXManager::tradelog(const MarketOrder& marketOrder) {
     // set qty
     line_ss << marketOrder.getQty();
 
-    // output
-    CSVHandler csv;
-    csv.set_path( "public_html/" );
-    csv.set_filename( filename_ss.str() );
-    csv.add_line( line_ss.str() );
+    // output, the file stays open in the CSVHandler cache, but unlike
+    // bar and tick csv files a trade is written at once and not batched
+    m_trades_csv.set_filename( filename_ss.str() );
+    m_trades_csv.add_line( line_ss.str() );
+    m_trades_csv.flush();
   } catch ( std::exception& e ) {
     on_error( __FUNCTION__, e.what() );
   } catch ( ... ) {
@@ -1555,7 +1965,7 @@ void FIXManager::setExiting(const bool status) {
  * @return bool
  */
 bool FIXManager::hasOpenPositions(const std::string symbol) {
-  FIX::Locker lock( m_mutex );
+  TimedLocker<FIX::Mutex> lock( m_mutex, m_metric_mutex_wait, m_metric_mutex_hold );
 
   if ( m_list_marketorders.empty() ) return false;
 
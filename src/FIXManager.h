@@ -12,6 +12,8 @@
 #include <utility>
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <atomic>
 #include <quickfix/Application.h>
 #include <quickfix/FileLog.h>
 #include <quickfix/FileStore.h>
@@ -43,6 +45,13 @@
 #include "Account.h"
 #include "Pairs.h"
 #include "SignalType.h"
+#include "EventJournal.h"
+#include "MappedStore.h"
+#include "BinaryLog.h"
+#include "MarketCache.h"
+#include "FastSignal.h"
+#include "Metrics.h"
+#include "CSVHandler.h"
 
 #include <nod/nod.hpp>
 
@@ -63,9 +72,9 @@ private:
   // Pointer to SessionSettings from SessionSettingsFile
   SessionSettings *m_psettings;
   // Pointer to File Store Factory
-  FileStoreFactory *m_pstore_factory;
+  MessageStoreFactory *m_pstore_factory;
   // Pointer to File Log Factory
-  FileLogFactory *m_plog_factory;
+  LogFactory *m_plog_factory;
   // Pointer to Socket
   SocketInitiator *m_pinitiator;
   // RequestID Manager
@@ -75,6 +84,8 @@ private:
   std::shared_ptr<spdlog::logger> m_console;
   // tradelog logger
   std::shared_ptr<spdlog::logger> m_tradelog;
+  // trade csv, guarded by m_mutex and flushed on every trade
+  CSVHandler m_trades_csv;
 
   // the session id for market data, such as tick prices
   SessionID m_market_sessionID;
@@ -95,18 +106,41 @@ private:
   vector<std::string> m_symbol_subscriptions;
 
   // if the app is exiting, don't log tick data etc anymore
-  bool m_is_exiting;
+  std::atomic<bool> m_is_exiting;
+  // outgoing messages go here instead of the session, see setOutbound
+  std::function<void(const Message&)> m_outbound;
+  // all application events are appended here, see setJournal
+  EventJournal* m_journal;
+  // state is rebuilt from the journal, nothing is sent or journaled
+  std::atomic<bool> m_restoring;
+  // positions come from the journal until the first RequestForPositionsAck of the session
+  std::atomic<bool> m_positions_restored;
+  // snapshot of market details and system params, see setMarketCache
+  std::shared_ptr<MarketCache> m_market_cache;
+  // accounts were queried on logon from the warm market cache
+  std::atomic<bool> m_accounts_requested;
+
+  // metrics, messages[market|order][in|out], the tick counter of a symbol is kept with its Market
+  Metrics::Counter m_metric_messages[2][2];
+  Metrics::Histogram m_metric_on_tick;
+  mutable Metrics::Histogram m_metric_mutex_wait;
+  mutable Metrics::Histogram m_metric_mutex_hold;
+  Metrics::Counter m_metric_orders_sent;
+  Metrics::Counter m_metric_orders_acked;
+  Metrics::Counter m_metric_rejects_order;
+  Metrics::Counter m_metric_rejects_market_data;
+  Metrics::Counter m_metric_rejects_session;
   
 public:
-  // signals
+  // signals, FastSignal for the events of every tick
   // on_tick
-  nod::signal<void(const MarketSnapshot&)> on_tick;
+  FastSignal<const MarketSnapshot&> on_tick;
   // on_init
   nod::signal<void()> on_init;
   // on_exit
   nod::signal<void()> on_exit;
   // on_update_marketorder
-  nod::signal<void(const MarketOrder&, const MarketOrder::Status)> on_update_marketorder;
+  FastSignal<const MarketOrder&, const MarketOrder::Status> on_update_marketorder;
   // on_error
   nod::signal<void(const std::string& sender, const std::string& message)> on_error;
   // on_before_session_start
@@ -114,7 +148,7 @@ public:
   // on_before_session_end
   nod::signal<void()> on_before_session_end;
   // on_account_change
-  nod::signal<void(std::shared_ptr<IDEFIX::Account>)> on_account_change;
+  FastSignal<std::shared_ptr<IDEFIX::Account>> on_account_change;
   // on_market_order
   nod::signal<void(const SignalType type, const MarketOrder&)> on_market_order;
   
@@ -162,7 +196,40 @@ public:
   void closeWinners(const std::string symbol);
   void closeLoosers(const std::string symbol);
 
-  // Public Getter & Setter
+  /*!
+   * Const access to the market details, markets, positions and the account
+   * FIXManager owns, without copies.
+   *
+   * Holds m_mutex as long as it lives, the returned pointers are valid until
+   * the Registry is destroyed. Keep it in a small scope, copy the fields you
+   * need and don't send or wait while holding it, every tick waits for it.
+   * The get...() methods return copies which outlive the lock.
+   *
+   *   {
+   *     FIXManager::Registry registry( fixmanager );
+   *     auto detail = registry.marketDetail( "EUR/USD" );
+   *     point_size  = detail != nullptr ? detail->getSymPointsize() : 0.0001;
+   *   }
+   */
+  class Registry {
+  private:
+    const FIXManager& m_fixmanager;
+    TimedLocker<FIX::Mutex> m_lock;
+
+  public:
+    explicit Registry(const FIXManager& fixmanager);
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    const MarketDetail* marketDetail(const std::string& symbol) const;
+    const Market* market(const std::string& symbol) const;
+    const MarketSnapshot* latestSnapshot(const std::string& symbol) const;
+    const MarketOrder* marketOrder(const std::string& pos_id) const;
+    const Account* account() const;
+  };
+
+  // Public Getter & Setter, these return copies
   std::shared_ptr<MarketSnapshot> getLatestSnapshot(const std::string symbol);
   std::shared_ptr<MarketDetail> getMarketDetails(const std::string& symbol);
   std::shared_ptr<Account> getAccount();
@@ -184,6 +251,12 @@ public:
   void connect(const std::string settingsFile);
   void disconnect();
 
+  void setOutbound(std::function<void(const Message&)> outbound);
+  void setJournal(EventJournal* journal);
+  uint64_t getTickJournalSeq() const;
+  size_t restore(const EventJournal& journal, const FIX::DataDictionary& dictionary);
+  size_t setMarketCache(const std::string& filename);
+
 private:
   void onInit();
   void onExit();
@@ -195,9 +268,13 @@ private:
   std::string nextRequestID();
   std::string nextOrderID();
 
+  void send(Message& message, const SessionID& session_ID);
+
   const FIX::Dictionary* getSessionSettingsPtr(const SessionID& session_ID);
   bool isMarketDataSession(const SessionID& session_ID);
   bool isOrderSession(const SessionID& session_ID);
+  bool isLoggedOn(const SessionID& session_ID) const;
+  Metrics::Counter& messageCounter(const SessionID& session_ID, const bool outgoing);
   
   void setAccount(std::shared_ptr<Account> account);
 
@@ -208,15 +285,20 @@ private:
   void setOrderSessionID(const SessionID& session_ID);
 
   void addMarket(const Market market);
-  void addMarketSnapshot(const MarketSnapshot snapshot);
+  void registerMarket(const std::string& symbol);
+  Metrics::Counter addMarketSnapshot(const MarketSnapshot& snapshot);
   void addMarketOrder(const MarketOrder marketOrder);
   void removeMarketOrder(const std::string posID);
   void updateMarketOrder(const MarketOrder& marketOrder, const bool isUnsolicited = false);
 
   std::shared_ptr<MarketOrder> getMarketOrder(const std::string fxcm_pos_id) const;
   std::shared_ptr<MarketOrder> getMarketOrder(const ClOrdID clOrdID) const;
+  std::vector<MarketOrder> getMarketOrders(const std::function<bool(const MarketOrder&)>& filter) const;
 
   void addMarketDetail(const MarketDetail& marketDetail);
+  bool getSymbolPrecision(const std::string& symbol, int& precision, double& point_size);
+  double getLatestAsk(const std::string& symbol);
+  size_t applyMarketSnapshot(map<std::string, MarketDetail>& details, map<std::string, std::string>& params);
 
   void addSysParam(const std::string key, const std::string value);
   std::string getSysParam(const std::string key);
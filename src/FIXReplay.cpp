@@ -0,0 +1,163 @@
+#include "FIXReplay.h"
+#include "TimeHelper.h"
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <quickfix/Message.h>
+#include <quickfix/SessionID.h>
+
+namespace IDEFIX {
+	/*!
+	 * @param const std::string& sender SenderCompID of inbound messages, empty = all messages
+	 */
+	FIXReplay::FIXReplay(const std::string& sender): m_sender( sender ) {}
+
+	FIXReplay::~FIXReplay() {}
+
+	/*!
+	 * Read inbound messages of a message log, the records of
+	 * all loaded files stay ordered by time.
+	 *
+	 * @param const std::string& filename
+	 * @return size_t count of read messages
+	 * @throw IDEFIX::file_not_found
+	 */
+	size_t FIXReplay::load(const std::string& filename) throw( IDEFIX::file_not_found ) {
+		std::ifstream file( filename );
+		if ( ! file.is_open() ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		const size_t start = m_records.size();
+		const bool merge   = start > 0;
+
+		std::string line;
+		Record record;
+		while ( std::getline( file, line ) ) {
+			if ( ! parse_line( line, record.time_ms, record.raw ) ) {
+				continue;
+			}
+			if ( ! m_sender.empty() && get_field( record.raw, "49" ) != m_sender ) {
+				continue;
+			}
+			m_records.push_back( record );
+		}
+
+		if ( merge ) {
+			std::stable_sort( m_records.begin(), m_records.end(), [](const Record& a, const Record& b) {
+				return a.time_ms < b.time_ms;
+			});
+		}
+
+		return m_records.size() - start;
+	}
+
+	size_t FIXReplay::size() const {
+		return m_records.size();
+	}
+
+	/*!
+	 * Decode every message and pass it to the application
+	 *
+	 * @param FIX::Application&          application
+	 * @param const FIX::DataDictionary& dictionary
+	 * @param const double               speed        0 = as fast as possible, 1 = original timing, 2 = twice as fast ...
+	 * @return FIXReplayResult
+	 */
+	FIXReplayResult FIXReplay::replay(FIX::Application& application, const FIX::DataDictionary& dictionary, const double speed) const {
+		FIXReplayResult result = FIXReplayResult();
+
+		long long first_time = 0;
+		for ( auto& record : m_records ) {
+			if ( record.time_ms > 0 ) {
+				first_time = record.time_ms;
+				break;
+			}
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for ( auto& record : m_records ) {
+			if ( speed > 0 && record.time_ms > 0 ) {
+				const auto due = start + std::chrono::microseconds( static_cast<long long>( ( record.time_ms - first_time ) * 1000 / speed ) );
+				std::this_thread::sleep_until( due );
+			}
+
+			try {
+				FIX::Message message( record.raw, dictionary, false );
+
+				// sessions of the counterparty are seen from our side
+				const FIX::Header& header = message.getHeader();
+				FIX::SessionID session_ID( header.getField( FIX::FIELD::BeginString ), header.getField( FIX::FIELD::TargetCompID ), header.getField( FIX::FIELD::SenderCompID ) );
+
+				FIX::MsgType msg_type;
+				header.getField( msg_type );
+				if ( FIX::Message::isAdminMsgType( msg_type ) ) {
+					application.fromAdmin( message, session_ID );
+					result.admin++;
+				} else {
+					application.fromApp( message, session_ID );
+					result.app++;
+				}
+			} catch ( FIX::Exception& e ) {
+				result.errors++;
+			}
+
+			result.messages++;
+		}
+
+		result.elapsed_ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+		return result;
+	}
+
+	/*!
+	 * Split log line into timestamp and raw message
+	 *
+	 * @param const std::string& line     yyyymmdd-HH:MM:SS.sss : 8=FIX...
+	 * @param long long&         time_ms  0 if the line has no timestamp
+	 * @param std::string&       raw
+	 * @return bool false if the line holds no message
+	 */
+	bool FIXReplay::parse_line(const std::string& line, long long& time_ms, std::string& raw) {
+		if ( line.compare( 0, 2, "8=" ) == 0 ) {
+			time_ms = 0;
+			raw     = line;
+		} else {
+			const size_t pos = line.find( " : 8=" );
+			if ( pos == std::string::npos ) {
+				return false;
+			}
+
+			time_ms = times::fix_to_ms( line.substr( 0, pos ) );
+			raw     = line.substr( pos + 3 );
+		}
+
+		// Windows line endings
+		if ( ! raw.empty() && raw.back() == '\r' ) {
+			raw.pop_back();
+		}
+
+		return true;
+	}
+
+	/*!
+	 * Value of a tag in a raw message without decoding it
+	 *
+	 * @param const std::string& raw
+	 * @param const std::string& tag
+	 * @return std::string empty if not found
+	 */
+	std::string FIXReplay::get_field(const std::string& raw, const std::string& tag) {
+		const std::string key = '\x01' + tag + "=";
+
+		size_t pos = raw.find( key );
+		if ( pos == std::string::npos ) {
+			return "";
+		}
+
+		pos += key.size();
+		const size_t end = raw.find( '\x01', pos );
+		return raw.substr( pos, end == std::string::npos ? std::string::npos : end - pos );
+	}
+};
@@ -0,0 +1,57 @@
+#ifndef IDEFIX_FIXREPLAY_H
+#define IDEFIX_FIXREPLAY_H
+
+#include <string>
+#include <vector>
+#include <quickfix/Application.h>
+#include <quickfix/DataDictionary.h>
+#include "Exceptions.h"
+
+namespace IDEFIX {
+	struct FIXReplayResult {
+		size_t messages;
+		size_t admin;
+		size_t app;
+		size_t errors;
+		double elapsed_ms;
+	};
+
+	/*!
+	 * Replays recorded FIX messages in process.
+	 *
+	 * Reads the message logs written by quickfix's FileLogFactory, one message per line:
+	 *
+	 * 20180422-21:02:52.801 : 8=FIX.4.4|9=...|35=W|...
+	 *
+	 * Only inbound messages are kept, these are the messages with SenderCompID of
+	 * the counterparty. Lines without timestamp are accepted, they are replayed at
+	 * once. Logs of several sessions are merged by time.
+	 *
+	 * Every message is decoded with the data dictionary and passed to fromAdmin or
+	 * fromApp of the application, at the original timing or as fast as possible.
+	 */
+	class FIXReplay {
+	private:
+		struct Record {
+			long long time_ms;
+			std::string raw;
+		};
+
+		std::string m_sender;
+		std::vector<Record> m_records;
+
+	public:
+		FIXReplay(const std::string& sender = "FXCM");
+		~FIXReplay();
+
+		size_t load(const std::string& filename) throw( IDEFIX::file_not_found );
+		size_t size() const;
+
+		FIXReplayResult replay(FIX::Application& application, const FIX::DataDictionary& dictionary, const double speed = 0) const;
+
+		static bool parse_line(const std::string& line, long long& time_ms, std::string& raw);
+		static std::string get_field(const std::string& raw, const std::string& tag);
+	};
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "FXCMAcceptor.h"
+#include "Console.h"
+#include <quickfix/Session.h>
+
+namespace IDEFIX {
+	FXCMAcceptor::FXCMAcceptor(const FIX::SessionSettings& settings, const std::string& account_id, const double balance, const std::string& currency)
+	: m_settings( settings ), m_broker( [this](FIX::Message& message) { reply( message ); }, account_id, balance, currency ),
+	  m_market_logon(false), m_order_logon(false), m_received(0), m_sent(0) {
+		m_broker.start();
+	}
+
+	FXCMAcceptor::~FXCMAcceptor() {}
+
+	void FXCMAcceptor::add_symbol(const std::string& symbol, const double point_size, const int precision) {
+		FIX::Locker lock( m_mutex );
+		m_broker.add_symbol( symbol, point_size, precision );
+	}
+
+	/*!
+	 * New quote, fills pending orders and sends the snapshot
+	 * if the symbol is subscribed
+	 *
+	 * @param const std::string& symbol
+	 * @param const TickRecord&  tick
+	 */
+	void FXCMAcceptor::on_tick(const std::string& symbol, const TickRecord& tick) {
+		Outbox outbox;
+		{
+			FIX::Locker lock( m_mutex );
+			m_broker.on_tick( symbol, tick );
+			outbox.swap( m_outbox );
+		}
+		send( outbox );
+	}
+
+	/*!
+	 * Both sessions are logged on
+	 *
+	 * @return bool
+	 */
+	bool FXCMAcceptor::is_logged_on() const {
+		return m_market_logon && m_order_logon;
+	}
+
+	unsigned long long FXCMAcceptor::received() const {
+		return m_received;
+	}
+
+	unsigned long long FXCMAcceptor::sent() const {
+		return m_sent;
+	}
+
+	/*!
+	 * Reply function of the broker, called with the lock held
+	 *
+	 * @param FIX::Message& message
+	 */
+	void FXCMAcceptor::reply(FIX::Message& message) {
+		const std::string msg_type = message.getHeader().getField( FIX::FIELD::MsgType );
+		const bool market_data     = msg_type == FIX::MsgType_MarketDataSnapshotFullRefresh || msg_type == FIX::MsgType_MarketDataRequestReject;
+
+		if ( market_data ) {
+			m_outbox.push_back( std::make_pair( m_market_session, message ) );
+		} else {
+			// answer on the requesting session, fills of stop and limit orders on the order session
+			m_outbox.push_back( std::make_pair( m_request_session.getBeginString().getValue().empty() ? m_order_session : m_request_session, message ) );
+		}
+	}
+
+	/*!
+	 * Send collected replies, without the lock
+	 *
+	 * @param Outbox& outbox
+	 */
+	void FXCMAcceptor::send(Outbox& outbox) {
+		for ( auto& item : outbox ) {
+			try {
+				if ( FIX::Session::sendToTarget( item.second, item.first ) ) {
+					m_sent++;
+				}
+			} catch ( FIX::SessionNotFound& e ) {
+				console()->warn( "[FXCMAcceptor] session not found {}", item.first.toString() );
+			}
+		}
+	}
+
+	/*!
+	 * FXCM sub id of the session, SenderSubID in the settings
+	 *
+	 * @param const FIX::SessionID& session_ID
+	 * @return std::string
+	 */
+	std::string FXCMAcceptor::sub_id(const FIX::SessionID& session_ID) const {
+		const FIX::Dictionary& dict = m_settings.get( session_ID );
+		return dict.has( "SenderSubID" ) ? dict.getString( "SenderSubID" ) : "";
+	}
+
+	void FXCMAcceptor::onCreate(const FIX::SessionID& session_ID) {}
+
+	void FXCMAcceptor::onLogon(const FIX::SessionID& session_ID) {
+		const FIX::Dictionary& dict = m_settings.get( session_ID );
+		const bool market_data      = dict.has( "MarketDataSession" ) && dict.getBool( "MarketDataSession" );
+
+		FIX::Locker lock( m_mutex );
+		if ( market_data ) {
+			m_market_session = session_ID;
+			m_market_logon   = true;
+		} else {
+			m_order_session = session_ID;
+			m_order_logon   = true;
+		}
+		console()->info( "[onLogon] {}{}", session_ID.toString(), market_data ? " (MarketSession)" : " (OrderSession)" );
+	}
+
+	void FXCMAcceptor::onLogout(const FIX::SessionID& session_ID) {
+		FIX::Locker lock( m_mutex );
+		if ( session_ID == m_market_session ) {
+			m_market_logon = false;
+		}
+		if ( session_ID == m_order_session ) {
+			m_order_logon = false;
+		}
+		console()->info( "[onLogout] {}", session_ID.toString() );
+	}
+
+	void FXCMAcceptor::toAdmin(FIX::Message& message, const FIX::SessionID& session_ID) {
+		const std::string id = sub_id( session_ID );
+		if ( ! id.empty() ) {
+			message.getHeader().setField( FIX::SenderSubID( id ) );
+		}
+	}
+
+	void FXCMAcceptor::toApp(FIX::Message& message, const FIX::SessionID& session_ID)
+		throw( FIX::DoNotSend ) {
+		const std::string id = sub_id( session_ID );
+		if ( ! id.empty() ) {
+			message.getHeader().setField( FIX::SenderSubID( id ) );
+		}
+	}
+
+	/*!
+	 * FXCM rejects logons without the TargetSubID of the account
+	 */
+	void FXCMAcceptor::fromAdmin(const FIX::Message& message, const FIX::SessionID& session_ID)
+		throw( FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon ) {
+		if ( message.getHeader().getField( FIX::FIELD::MsgType ) != FIX::MsgType_Logon ) {
+			return;
+		}
+
+		const std::string id = sub_id( session_ID );
+		if ( id.empty() ) {
+			return;
+		}
+
+		if ( ! message.getHeader().isSetField( FIX::FIELD::TargetSubID ) || message.getHeader().getField( FIX::FIELD::TargetSubID ) != id ) {
+			throw FIX::RejectLogon( "TargetSubID " + id + " required" );
+		}
+	}
+
+	/*!
+	 * Requests of both sessions are handled at once at the current prices
+	 */
+	void FXCMAcceptor::fromApp(const FIX::Message& message, const FIX::SessionID& session_ID)
+		throw( FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType ) {
+		m_received++;
+
+		Outbox outbox;
+		{
+			FIX::Locker lock( m_mutex );
+			m_request_session = session_ID;
+			m_broker.on_message( message );
+			m_broker.process();
+			m_request_session = FIX::SessionID();
+			outbox.swap( m_outbox );
+		}
+		send( outbox );
+	}
+};
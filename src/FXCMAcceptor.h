@@ -0,0 +1,76 @@
+#ifndef IDEFIX_FXCMACCEPTOR_H
+#define IDEFIX_FXCMACCEPTOR_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <quickfix/Application.h>
+#include <quickfix/Message.h>
+#include <quickfix/SessionID.h>
+#include <quickfix/SessionSettings.h>
+#include <quickfix/Mutex.h>
+#include "SimulatedBroker.h"
+#include "TickRecord.h"
+
+namespace IDEFIX {
+	/*!
+	 * FIX acceptor speaking the FXCM dialect, stand-in for the FXCM servers
+	 * configured in specs/local.cfg.
+	 *
+	 * The requests of both sessions are answered by a SimulatedBroker.
+	 * Market data goes to the session with MarketDataSession=Y, everything
+	 * else to the order session. Logons without the TargetSubID configured
+	 * as SenderSubID of the session are rejected like FXCM does, outgoing
+	 * messages carry the SenderSubID.
+	 *
+	 * Replies are collected under the lock and sent afterwards, so the
+	 * quote thread never waits for a session while holding the broker.
+	 */
+	class FXCMAcceptor : public FIX::Application {
+	private:
+		typedef std::vector<std::pair<FIX::SessionID, FIX::Message>> Outbox;
+
+		FIX::SessionSettings m_settings;
+		FIX::Mutex m_mutex;
+		SimulatedBroker m_broker;
+		Outbox m_outbox;
+
+		FIX::SessionID m_market_session;
+		FIX::SessionID m_order_session;
+		FIX::SessionID m_request_session;
+		std::atomic<bool> m_market_logon;
+		std::atomic<bool> m_order_logon;
+		std::atomic<unsigned long long> m_received;
+		std::atomic<unsigned long long> m_sent;
+
+		void reply(FIX::Message& message);
+		void send(Outbox& outbox);
+		std::string sub_id(const FIX::SessionID& session_ID) const;
+
+	public:
+		FXCMAcceptor(const FIX::SessionSettings& settings, const std::string& account_id = "SIMULATED", const double balance = 50000, const std::string& currency = "USD");
+		~FXCMAcceptor();
+
+		void add_symbol(const std::string& symbol, const double point_size = 0.0001, const int precision = 5);
+		void on_tick(const std::string& symbol, const TickRecord& tick);
+
+		bool is_logged_on() const;
+		unsigned long long received() const;
+		unsigned long long sent() const;
+
+		// FIX::Application
+		void onCreate(const FIX::SessionID& session_ID);
+		void onLogon(const FIX::SessionID& session_ID);
+		void onLogout(const FIX::SessionID& session_ID);
+		void toAdmin(FIX::Message& message, const FIX::SessionID& session_ID);
+		void toApp(FIX::Message& message, const FIX::SessionID& session_ID)
+			throw( FIX::DoNotSend );
+		void fromAdmin(const FIX::Message& message, const FIX::SessionID& session_ID)
+			throw( FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::RejectLogon );
+		void fromApp(const FIX::Message& message, const FIX::SessionID& session_ID)
+			throw( FIX::FieldNotFound, FIX::IncorrectDataFormat, FIX::IncorrectTagValue, FIX::UnsupportedMessageType );
+	};
+};
+
+#endif
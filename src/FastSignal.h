@@ -0,0 +1,201 @@
+#ifndef IDEFIX_FASTSIGNAL_H
+#define IDEFIX_FASTSIGNAL_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <type_traits>
+
+namespace IDEFIX {
+	/*!
+	 * Signal for hot path events like ticks and bricks, the slots are
+	 * usually connected once during init.
+	 *
+	 * The slots are a contiguous array of function pointer and context.
+	 * Emitting loads the array with one atomic read, there is no lock,
+	 * no copy of the slot list and no std::function. connect and
+	 * disconnect publish a new array (copy on write), arrays are kept
+	 * until the signal is destroyed, so an emit in another thread never
+	 * sees a freed array.
+	 *
+	 * Slots can be bound at compile time, the call is then a direct call:
+	 *   signal.connect<MyClass, &MyClass::method>( object );
+	 *   signal.connect<&function>();
+	 * or any callable like a lambda:
+	 *   signal.connect( [](const Bar& bar) { ... } );
+	 *
+	 * nod::signal stays for rare control events (on_init, on_exit, ...),
+	 * which need scoped connections or are connected at any time.
+	 */
+	template<typename... Args>
+	class FastSignal {
+	public:
+		typedef void (*Function)(void*, Args...);
+
+		struct Slot {
+			Function function;
+			void* context;
+			size_t id;
+		};
+
+	private:
+		typedef std::vector<Slot> Slots;
+
+		std::atomic<const Slots*> m_slots;
+		// every published array and every callable, freed on destruction
+		std::vector<std::unique_ptr<Slots>> m_arrays;
+		std::vector<std::shared_ptr<void>> m_callables;
+		std::mutex m_mutex;
+		size_t m_next_id;
+
+		template<void (*F)(Args...)>
+		static void call_function(void*, Args... args) {
+			F( args... );
+		}
+
+		template<typename C, void (C::*M)(Args...)>
+		static void call_member(void* context, Args... args) {
+			( static_cast<C*>( context )->*M )( args... );
+		}
+
+		template<typename F>
+		static void call_callable(void* context, Args... args) {
+			( *static_cast<F*>( context ) )( args... );
+		}
+
+		/*!
+		 * Publish a copy of the current slots with one slot added or removed
+		 *
+		 * @param const Slot*  add    slot to add or nullptr
+		 * @param const size_t remove id of the slot to remove or 0
+		 */
+		void publish(const Slot* add, const size_t remove) {
+			const Slots* current = m_slots.load( std::memory_order_relaxed );
+
+			std::unique_ptr<Slots> slots( new Slots() );
+			slots->reserve( ( current != nullptr ? current->size() : 0 ) + 1 );
+			if ( current != nullptr ) {
+				for ( auto& slot : *current ) {
+					if ( slot.id != remove ) {
+						slots->push_back( slot );
+					}
+				}
+			}
+			if ( add != nullptr ) {
+				slots->push_back( *add );
+			}
+
+			m_slots.store( slots.get(), std::memory_order_release );
+			m_arrays.push_back( std::move( slots ) );
+		}
+
+	public:
+		FastSignal(): m_slots( nullptr ), m_next_id( 1 ) {}
+
+		FastSignal(const FastSignal&) = delete;
+		FastSignal& operator=(const FastSignal&) = delete;
+
+		/*!
+		 * Connect function pointer with context
+		 *
+		 * @param Function function called as function( context, args... )
+		 * @param void*    context
+		 * @return size_t  id for disconnect
+		 */
+		size_t connect(Function function, void* context) {
+			std::lock_guard<std::mutex> lock( m_mutex );
+
+			Slot slot;
+			slot.function = function;
+			slot.context  = context;
+			slot.id       = m_next_id++;
+			publish( &slot, 0 );
+
+			return slot.id;
+		}
+
+		/*!
+		 * Connect free function at compile time
+		 *
+		 * @return size_t id for disconnect
+		 */
+		template<void (*F)(Args...)>
+		size_t connect() {
+			return connect( &FastSignal::call_function<F>, nullptr );
+		}
+
+		/*!
+		 * Connect member function at compile time
+		 *
+		 * @param C* object
+		 * @return size_t id for disconnect
+		 */
+		template<typename C, void (C::*M)(Args...)>
+		size_t connect(C* object) {
+			return connect( &FastSignal::call_member<C, M>, object );
+		}
+
+		/*!
+		 * Connect callable like a lambda, a copy is owned by the signal
+		 *
+		 * @param F&& callable
+		 * @return size_t id for disconnect
+		 */
+		template<typename F>
+		size_t connect(F&& callable) {
+			typedef typename std::decay<F>::type Callable;
+
+			std::shared_ptr<Callable> copy = std::make_shared<Callable>( std::forward<F>( callable ) );
+			{
+				std::lock_guard<std::mutex> lock( m_mutex );
+				m_callables.push_back( copy );
+			}
+			return connect( &FastSignal::call_callable<Callable>, copy.get() );
+		}
+
+		/*!
+		 * Remove slot, a running emit may still call it once
+		 *
+		 * @param const size_t id
+		 */
+		void disconnect(const size_t id) {
+			std::lock_guard<std::mutex> lock( m_mutex );
+			publish( nullptr, id );
+		}
+
+		/*!
+		 * Call all slots in the order they were connected
+		 */
+		inline void operator()(Args... args) const {
+			const Slots* slots = m_slots.load( std::memory_order_acquire );
+			if ( slots == nullptr ) {
+				return;
+			}
+
+			const Slot* slot = slots->data();
+			const Slot* end  = slot + slots->size();
+			for ( ; slot != end; ++slot ) {
+				slot->function( slot->context, args... );
+			}
+		}
+
+		/*!
+		 * True if there is no slot, use it to skip preparing the arguments
+		 *
+		 * @return bool
+		 */
+		inline bool empty() const {
+			const Slots* slots = m_slots.load( std::memory_order_acquire );
+			return slots == nullptr || slots->empty();
+		}
+
+		size_t slot_count() const {
+			const Slots* slots = m_slots.load( std::memory_order_acquire );
+			return slots != nullptr ? slots->size() : 0;
+		}
+	};
+};
+
+#endif
@@ -0,0 +1,354 @@
+#include "FileAdapter.h"
+#include "TimeHelper.h"
+#include "TickArchive.h"
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace IDEFIX {
+	FileAdapter::FileAdapter(const std::string& filename, const unsigned int threads): m_filename( filename ), m_threads( threads ) {}
+
+	FileAdapter::~FileAdapter() {}
+
+	/*!
+	 * Threads used to parse csv files, 0 = all cores
+	 *
+	 * @param const unsigned int threads
+	 */
+	void FileAdapter::set_threads(const unsigned int threads) {
+		m_threads = threads;
+	}
+
+	/*!
+	 * Read the whole file and append all ticks.
+	 * Binary tick archives are detected and read by TickArchive.
+	 *
+	 * @param std::vector<TickRecord>& ticks
+	 * @return size_t count of parsed ticks
+	 * @throw IDEFIX::file_not_found if the file is missing or a corrupt archive
+	 */
+	size_t FileAdapter::load(std::vector<TickRecord>& ticks) throw( IDEFIX::file_not_found ) {
+		if ( TickArchive::is_archive( m_filename ) ) {
+			TickArchive archive( m_filename );
+			const size_t start = ticks.size();
+			try {
+				archive.open();
+				return archive.load( ticks );
+			} catch ( IDEFIX::out_of_range& e ) {
+				// no ticks of a corrupt block are kept
+				ticks.resize( start );
+				throw file_not_found(__FILE__, __LINE__);
+			}
+		}
+
+		const int fd = ::open( m_filename.c_str(), O_RDONLY );
+		if ( fd < 0 ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		struct stat st;
+		if ( fstat( fd, &st ) != 0 || st.st_size <= 0 ) {
+			::close( fd );
+			return 0;
+		}
+
+		const size_t size = st.st_size;
+		void* data = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		::close( fd );
+		if ( data == MAP_FAILED ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+		madvise( data, size, MADV_WILLNEED );
+
+		unsigned int threads = m_threads;
+		if ( threads == 0 ) {
+			threads = std::max( 1u, std::thread::hardware_concurrency() );
+		}
+
+		const size_t count = parse( static_cast<const char*>( data ), size, ticks, threads );
+		munmap( data, size );
+
+		return count;
+	}
+
+	/*!
+	 * Parse csv buffer, UTF-8/ASCII or UTF-16LE. The buffer is split
+	 * into one chunk per thread at line boundaries.
+	 *
+	 * @param const char*              data
+	 * @param size_t                   size
+	 * @param std::vector<TickRecord>& ticks
+	 * @param unsigned int             threads
+	 * @return size_t count of parsed ticks
+	 */
+	size_t FileAdapter::parse(const char* data, size_t size, std::vector<TickRecord>& ticks, unsigned int threads) {
+		const bool utf16      = is_utf16( data, size );
+		// a tick line has at least 35 characters
+		const size_t per_tick = utf16 ? 70 : 35;
+
+		threads = std::max( 1u, std::min<unsigned int>( threads, size / MIN_CHUNK_SIZE ) );
+
+		if ( threads == 1 ) {
+			ticks.reserve( ticks.size() + size / per_tick );
+			return utf16 ? parse_utf16( data, data + size, ticks ) : parse_ascii( data, data + size, ticks );
+		}
+
+		// chunk boundaries behind a newline, UTF-16 chunks start at even offsets
+		const char* end = data + size;
+		std::vector<const char*> bounds( 1, data );
+		for ( unsigned int i = 1; i < threads; i++ ) {
+			const char* p = std::max( data + size / threads * i, bounds.back() );
+			while ( true ) {
+				p = find_newline( p, end );
+				if ( p >= end || ! utf16 || ( p - data ) % 2 == 0 ) {
+					break;
+				}
+				p++;
+			}
+			p = std::min( end, p + ( utf16 ? 2 : 1 ) );
+			bounds.push_back( p );
+		}
+		bounds.push_back( end );
+
+		std::vector<std::vector<TickRecord>> parts( threads );
+		std::vector<std::thread> pool;
+		for ( unsigned int i = 0; i < threads; i++ ) {
+			pool.push_back( std::thread( [&, i]() {
+				parts[i].reserve( ( bounds[i + 1] - bounds[i] ) / per_tick );
+				if ( utf16 ) {
+					parse_utf16( bounds[i], bounds[i + 1], parts[i] );
+				} else {
+					parse_ascii( bounds[i], bounds[i + 1], parts[i] );
+				}
+			}));
+		}
+		for ( auto& t : pool ) {
+			t.join();
+		}
+
+		size_t count = 0;
+		for ( auto& part : parts ) {
+			count += part.size();
+		}
+
+		ticks.reserve( ticks.size() + count );
+		for ( auto& part : parts ) {
+			ticks.insert( ticks.end(), part.begin(), part.end() );
+		}
+
+		return count;
+	}
+
+	/*!
+	 * Parse 8 bit csv lines
+	 *
+	 * @param const char*              begin
+	 * @param const char*              end
+	 * @param std::vector<TickRecord>& ticks
+	 * @return size_t count of parsed ticks
+	 */
+	size_t FileAdapter::parse_ascii(const char* begin, const char* end, std::vector<TickRecord>& ticks) {
+		size_t count = 0;
+		TickRecord tick;
+
+		for ( const char* p = begin; p < end; ) {
+			const char* line_end = find_newline( p, end );
+
+			if ( parse_line( p, line_end, tick ) ) {
+				ticks.push_back( tick );
+				count++;
+			}
+
+			p = line_end + 1;
+		}
+
+		return count;
+	}
+
+	/*!
+	 * Parse UTF-16LE csv lines. The text is narrowed piece by piece
+	 * into a small buffer, lines crossing a piece are carried over.
+	 *
+	 * @param const char*              begin
+	 * @param const char*              end
+	 * @param std::vector<TickRecord>& ticks
+	 * @return size_t count of parsed ticks
+	 */
+	size_t FileAdapter::parse_utf16(const char* begin, const char* end, std::vector<TickRecord>& ticks) {
+		// input bytes per piece and longest line which is carried over
+		const size_t PIECE    = 1 << 16;
+		const size_t MAX_LINE = 256;
+
+		std::vector<char> buffer( PIECE / 2 + MAX_LINE );
+		size_t carry = 0;
+		size_t count = 0;
+
+		while ( end - begin >= 2 ) {
+			const size_t bytes  = std::min<size_t>( PIECE, end - begin ) & ~static_cast<size_t>( 1 );
+			const size_t length = carry + narrow( begin, bytes, buffer.data() + carry );
+			begin += bytes;
+
+			// parse complete lines, keep the rest for the next piece
+			const char* text = buffer.data();
+			const char* last = text + length;
+			if ( end - begin >= 2 ) {
+				while ( last > text && last[-1] != '\n' ) {
+					last--;
+				}
+			}
+
+			count += parse_ascii( text, last, ticks );
+
+			carry = text + length - last;
+			if ( carry > MAX_LINE ) {
+				carry = 0;
+			}
+			memmove( buffer.data(), last, carry );
+		}
+
+		return count;
+	}
+
+	/*!
+	 * UTF-16LE files start with a byte order mark or have
+	 * a NUL byte after the first character.
+	 *
+	 * @param const char*  data
+	 * @param const size_t size
+	 * @return bool
+	 */
+	bool FileAdapter::is_utf16(const char* data, const size_t size) {
+		if ( size < 2 ) {
+			return false;
+		}
+
+		const unsigned char b0 = data[0];
+		const unsigned char b1 = data[1];
+		return ( b0 == 0xFF && b1 == 0xFE ) || ( b0 != 0 && b1 == 0 );
+	}
+
+	/*!
+	 * Find next newline, 16 bytes at once with SSE2
+	 *
+	 * @param const char* p
+	 * @param const char* end
+	 * @return const char* newline or end
+	 */
+	const char* FileAdapter::find_newline(const char* p, const char* end) {
+#ifdef __SSE2__
+		const __m128i newline = _mm_set1_epi8( '\n' );
+		while ( end - p >= 16 ) {
+			const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+			const int mask      = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, newline ) );
+			if ( mask != 0 ) {
+				return p + __builtin_ctz( mask );
+			}
+			p += 16;
+		}
+#endif
+		while ( p < end && *p != '\n' ) {
+			p++;
+		}
+		return p;
+	}
+
+	/*!
+	 * Narrow UTF-16LE to 8 bit, 16 characters at once with SSE2.
+	 * Characters above 0xFF become 0xFF or NUL (byte order mark),
+	 * they never appear in tick lines.
+	 *
+	 * @param const char*  src
+	 * @param const size_t size  bytes, even
+	 * @param char*        out   room for size / 2 characters
+	 * @return size_t written characters
+	 */
+	size_t FileAdapter::narrow(const char* src, const size_t size, char* out) {
+		size_t i = 0;
+		size_t o = 0;
+
+#ifdef __SSE2__
+		for ( ; i + 32 <= size; i += 32, o += 16 ) {
+			const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			const __m128i hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i + 16 ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( out + o ), _mm_packus_epi16( lo, hi ) );
+		}
+#endif
+		// same saturation as _mm_packus_epi16
+		for ( ; i + 1 < size; i += 2 ) {
+			const int16_t c = static_cast<int16_t>( static_cast<unsigned char>( src[i] ) | ( static_cast<unsigned char>( src[i + 1] ) << 8 ) );
+			out[o++] = static_cast<char>( c < 0 ? 0 : ( c > 0xFF ? 0xFF : c ) );
+		}
+
+		return o;
+	}
+
+	/*!
+	 * Parse one line MM/DD/YYYY HH:MM:SS.sss,bid,ask
+	 *
+	 * @param const char*  begin
+	 * @param const char*  end   newline or end of data
+	 * @param TickRecord&  tick
+	 * @return bool false for the header and malformed lines
+	 */
+	bool FileAdapter::parse_line(const char* begin, const char* end, TickRecord& tick) {
+		if ( end - begin < 27 || begin[0] < '0' || begin[0] > '9' || begin[2] != '/' || begin[23] != ',' ) {
+			return false;
+		}
+
+		tick.time_ms = times::fxcm_to_ms( begin );
+
+		const char* p = begin + 24;
+		tick.bid = parse_price( p, end );
+		if ( p >= end || *p != ',' ) {
+			return false;
+		}
+
+		p++;
+		tick.ask = parse_price( p, end );
+
+		return tick.bid > 0 && tick.ask > 0;
+	}
+
+	/*!
+	 * Parse positive decimal number, p points behind the number afterwards
+	 *
+	 * @param const char*& p
+	 * @param const char*  end
+	 * @return double
+	 */
+	double FileAdapter::parse_price(const char*& p, const char* end) {
+		static const double powers[] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+
+		long long integer = 0;
+		while ( p < end && *p >= '0' && *p <= '9' ) {
+			integer = integer * 10 + ( *p - '0' );
+			p++;
+		}
+
+		if ( p >= end || *p != '.' ) {
+			return integer;
+		}
+		p++;
+
+		long long fraction = 0;
+		int digits = 0;
+		while ( p < end && *p >= '0' && *p <= '9' ) {
+			if ( digits < 10 ) {
+				fraction = fraction * 10 + ( *p - '0' );
+				digits++;
+			}
+			p++;
+		}
+
+		// one division, same result as strtod for prices
+		return ( integer * powers[digits] + fraction ) / powers[digits];
+	}
+};
@@ -0,0 +1,48 @@
+#ifndef IDEFIX_FILEADAPTER_H
+#define IDEFIX_FILEADAPTER_H
+
+#include <string>
+#include <vector>
+#include "TickRecord.h"
+#include "Exceptions.h"
+
+namespace IDEFIX {
+	/*!
+	 * Reads FXCM tick data csv files as downloaded by scripts/tickdatadl.sh
+	 *
+	 * DateTime,Bid,Ask
+	 * 04/22/2018 21:02:52.801,1.22789,1.22782
+	 *
+	 * The file is mapped into memory and split into chunks at line boundaries,
+	 * every chunk is parsed by its own thread. UTF-16 files are narrowed while
+	 * parsing, there is no need to run scripts/convert.sh first.
+	 * Files converted by tools/tickconvert are loaded from the TickArchive.
+	 */
+	class FileAdapter {
+	private:
+		std::string m_filename;
+		unsigned int m_threads;
+
+	public:
+		// files below this size are parsed by one thread
+		static const size_t MIN_CHUNK_SIZE = 1 << 22;
+
+		FileAdapter(const std::string& filename, const unsigned int threads = 0);
+		~FileAdapter();
+
+		void set_threads(const unsigned int threads);
+		size_t load(std::vector<TickRecord>& ticks) throw( IDEFIX::file_not_found );
+
+		static size_t parse(const char* data, size_t size, std::vector<TickRecord>& ticks, unsigned int threads = 1);
+		static size_t parse_ascii(const char* begin, const char* end, std::vector<TickRecord>& ticks);
+		static size_t parse_utf16(const char* begin, const char* end, std::vector<TickRecord>& ticks);
+		static bool parse_line(const char* begin, const char* end, TickRecord& tick);
+		static double parse_price(const char*& p, const char* end);
+
+		static bool is_utf16(const char* data, const size_t size);
+		static const char* find_newline(const char* p, const char* end);
+		static size_t narrow(const char* src, const size_t size, char* out);
+	};
+};
+
+#endif
@@ -0,0 +1,325 @@
+#include "IndicatorGraph.h"
+#include <sstream>
+
+namespace IDEFIX {
+	// ---------------------------------------------------------------------------
+	// IndicatorNode
+	// ---------------------------------------------------------------------------
+
+	IndicatorNode::IndicatorNode(const std::string& symbol): m_symbol( symbol ), m_dirty(false), m_updates(0) {}
+
+	IndicatorNode::~IndicatorNode() {}
+
+	/*!
+	 * Node expression including all inputs, e.g. sma(5,renko(5))
+	 *
+	 * @return std::string
+	 */
+	std::string IndicatorNode::expression() const {
+		std::string expr = type() + "(" + params();
+		for ( auto input : m_inputs ) {
+			expr += "," + input->expression();
+		}
+		return expr + ")";
+	}
+
+	/*!
+	 * Unique key of the node, e.g. EUR/USD:sma(5,renko(5))
+	 *
+	 * @return std::string
+	 */
+	std::string IndicatorNode::key() const {
+		return m_symbol + ":" + expression();
+	}
+
+	const std::string& IndicatorNode::symbol() const {
+		return m_symbol;
+	}
+
+	/*!
+	 * How often the node was updated
+	 *
+	 * @return int
+	 */
+	int IndicatorNode::updates() const {
+		return m_updates;
+	}
+
+	// ---------------------------------------------------------------------------
+	// BarNode
+	// ---------------------------------------------------------------------------
+
+	BarNode::BarNode(BarPipeline& pipeline, AbstractBarBuilder* builder): IndicatorNode( pipeline.symbol() ), m_builder( builder ), m_store( &pipeline.store() ) {
+		m_bar.clear();
+		m_connection = m_builder->on_bar.connect( [this](const Bar& bar) {
+			m_bar   = bar;
+			m_dirty = true;
+		});
+	}
+
+	BarNode::~BarNode() {
+		m_connection.disconnect();
+	}
+
+	std::string BarNode::type() const {
+		const std::string name = m_builder->name();
+		return name.substr( 0, name.find( ':' ) );
+	}
+
+	std::string BarNode::params() const {
+		const std::string name = m_builder->name();
+		const size_t pos = name.find( ':' );
+		return pos == std::string::npos ? "" : name.substr( pos + 1 );
+	}
+
+	bool BarNode::evaluate() {
+		return true;
+	}
+
+	double BarNode::value() const {
+		return ( m_bar.open_price + m_bar.close_price ) / 2;
+	}
+
+	bool BarNode::is_valid() const {
+		return m_bar.volume > 0;
+	}
+
+	/*!
+	 * Last finished bar
+	 *
+	 * @return const Bar&
+	 */
+	const Bar& BarNode::bar() const {
+		return m_bar;
+	}
+
+	/*!
+	 * Count of bars built for this node
+	 *
+	 * @return int
+	 */
+	int BarNode::count() const {
+		return m_store->count( m_builder->series() );
+	}
+
+	/*!
+	 * Get bar at backwards index, 0 is the newest
+	 *
+	 * @param const int index
+	 * @return Bar
+	 * @throw IDEFIX::out_of_range
+	 * @throw IDEFIX::element_not_found
+	 */
+	Bar BarNode::at(const int index) const throw( IDEFIX::out_of_range, IDEFIX::element_not_found ) {
+		return m_store->at( m_builder->series(), index );
+	}
+
+	// ---------------------------------------------------------------------------
+	// SMANode
+	// ---------------------------------------------------------------------------
+
+	SMANode::SMANode(IndicatorNode* input, const int period): IndicatorNode( input->symbol() ), m_period( period ), m_sma( period ) {
+		m_inputs.push_back( input );
+	}
+
+	std::string SMANode::type() const {
+		return "sma";
+	}
+
+	std::string SMANode::params() const {
+		std::ostringstream oss;
+		oss << m_period;
+		return oss.str();
+	}
+
+	bool SMANode::evaluate() {
+		m_sma.add( m_inputs[0]->value() );
+		return true;
+	}
+
+	double SMANode::value() const {
+		return m_sma.value();
+	}
+
+	bool SMANode::is_valid() const {
+		return m_sma.is_valid();
+	}
+
+	// ---------------------------------------------------------------------------
+	// IndicatorGraph
+	// ---------------------------------------------------------------------------
+
+	IndicatorGraph::IndicatorGraph() {}
+
+	IndicatorGraph::~IndicatorGraph() {
+		FIX::Locker lock( m_mutex );
+
+		// dependents first, bar nodes before their pipelines
+		for ( auto it = m_nodes.rbegin(); it != m_nodes.rend(); ++it ) {
+			delete *it;
+		}
+		m_nodes.clear();
+
+		for ( auto& p : m_pipelines ) {
+			delete p.second;
+		}
+		m_pipelines.clear();
+	}
+
+	/*!
+	 * Add node to the graph, the graph takes ownership.
+	 * If a node with the same key exists, the new node gets deleted
+	 * and the existing one is returned.
+	 *
+	 * @param IndicatorNode* node
+	 * @return IndicatorNode*
+	 */
+	IndicatorNode* IndicatorGraph::add(IndicatorNode* node) {
+		if ( node == nullptr ) {
+			return nullptr;
+		}
+
+		FIX::Locker lock( m_mutex );
+
+		const std::string key = node->key();
+		IndicatorNode* existing = find( key );
+		if ( existing != nullptr ) {
+			delete node;
+			return existing;
+		}
+
+		for ( auto input : node->m_inputs ) {
+			input->m_dependents.push_back( node );
+		}
+		m_nodes.push_back( node );
+
+		return node;
+	}
+
+	/*!
+	 * Find node by key
+	 *
+	 * @param const std::string& key e.g. EUR/USD:renko(5)
+	 * @return IndicatorNode* nullptr if not found
+	 */
+	IndicatorNode* IndicatorGraph::find(const std::string& key) {
+		FIX::Locker lock( m_mutex );
+
+		for ( auto node : m_nodes ) {
+			if ( node->key() == key ) {
+				return node;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/*!
+	 * Get bar source node, the builder is registered in the symbol's pipeline
+	 *
+	 * @param const std::string&  symbol
+	 * @param AbstractBarBuilder* builder, the graph takes ownership
+	 * @return BarNode*
+	 */
+	BarNode* IndicatorGraph::bars(const std::string& symbol, AbstractBarBuilder* builder) {
+		FIX::Locker lock( m_mutex );
+
+		BarPipeline* p = pipeline( symbol );
+		builder = p->add( builder );
+
+		return static_cast<BarNode*>( add( new BarNode( *p, builder ) ) );
+	}
+
+	/*!
+	 * Get renko brick node
+	 *
+	 * @param const std::string& symbol
+	 * @param const double       brick_size in points
+	 * @return BarNode*
+	 */
+	BarNode* IndicatorGraph::renko(const std::string& symbol, const double brick_size) {
+		return bars( symbol, new RenkoBarBuilder( brick_size ) );
+	}
+
+	/*!
+	 * Get simple moving average node over input
+	 *
+	 * @param IndicatorNode* input
+	 * @param const int      period
+	 * @return SMANode*
+	 */
+	SMANode* IndicatorGraph::sma(IndicatorNode* input, const int period) {
+		return static_cast<SMANode*>( add( new SMANode( input, period ) ) );
+	}
+
+	/*!
+	 * Get pipeline of symbol, it will be created if it does not exist
+	 *
+	 * @param const std::string& symbol
+	 * @return BarPipeline*
+	 */
+	BarPipeline* IndicatorGraph::pipeline(const std::string& symbol) {
+		FIX::Locker lock( m_mutex );
+
+		auto it = m_pipelines.find( symbol );
+		if ( it != m_pipelines.end() ) {
+			return it->second;
+		}
+
+		BarPipeline* p = new BarPipeline( symbol );
+		m_pipelines[symbol] = p;
+
+		return p;
+	}
+
+	/*!
+	 * Return node count
+	 *
+	 * @return size_t
+	 */
+	size_t IndicatorGraph::size() {
+		FIX::Locker lock( m_mutex );
+		return m_nodes.size();
+	}
+
+	/*!
+	 * Feed tick into the symbol's pipeline once and
+	 * evaluate all nodes which became dirty
+	 *
+	 * @param const MarketSnapshot& tick
+	 */
+	void IndicatorGraph::on_tick(const MarketSnapshot& tick) {
+		FIX::Locker lock( m_mutex );
+
+		auto it = m_pipelines.find( tick.getSymbol() );
+		if ( it == m_pipelines.end() ) {
+			return;
+		}
+
+		it->second->on_tick( tick );
+		evaluate();
+	}
+
+	/*!
+	 * Evaluate dirty nodes in topological order and signal updates
+	 */
+	void IndicatorGraph::evaluate() {
+		for ( auto node : m_nodes ) {
+			if ( ! node->m_dirty ) {
+				continue;
+			}
+
+			node->m_dirty = false;
+			if ( ! node->evaluate() ) {
+				continue;
+			}
+
+			node->m_updates++;
+			for ( auto dependent : node->m_dependents ) {
+				dependent->m_dirty = true;
+			}
+
+			node->on_update( *node );
+		}
+	}
+};
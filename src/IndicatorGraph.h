@@ -0,0 +1,132 @@
+#ifndef IDEFIX_INDICATORGRAPH_H
+#define IDEFIX_INDICATORGRAPH_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "Bar.h"
+#include "BarPipeline.h"
+#include "MarketSnapshot.h"
+#include "SimpleMovingAverage.h"
+#include <quickfix/Mutex.h>
+#include <nod/nod.hpp>
+
+namespace IDEFIX {
+	class IndicatorGraph;
+
+	/*!
+	 * Node of the indicator graph, unique by (symbol, type, params).
+	 * A node is dirty if one of its inputs changed and gets evaluated
+	 * after all its inputs.
+	 */
+	class IndicatorNode {
+		friend class IndicatorGraph;
+
+	protected:
+		std::string m_symbol;
+		std::vector<IndicatorNode*> m_inputs;
+		std::vector<IndicatorNode*> m_dependents;
+		bool m_dirty;
+		int m_updates;
+
+		std::string expression() const;
+
+	public:
+		IndicatorNode(const std::string& symbol);
+		virtual ~IndicatorNode();
+
+		// indicator type, e.g. renko, sma
+		virtual std::string type() const = 0;
+		// parameters, e.g. 5
+		virtual std::string params() const = 0;
+		// update the node from its inputs, return true if dependents have to be evaluated
+		virtual bool evaluate() = 0;
+		// current output value
+		virtual double value() const = 0;
+		virtual bool is_valid() const = 0;
+
+		std::string key() const;
+		const std::string& symbol() const;
+		int updates() const;
+
+		// signals
+		nod::signal<void(const IndicatorNode&)> on_update;
+	};
+
+	/*!
+	 * Source node, bars of one builder in the symbol's BarPipeline.
+	 * Value is the middle of the last bar.
+	 */
+	class BarNode: public IndicatorNode {
+	private:
+		AbstractBarBuilder* m_builder;
+		BarStore* m_store;
+		Bar m_bar;
+		nod::scoped_connection m_connection;
+
+	public:
+		BarNode(BarPipeline& pipeline, AbstractBarBuilder* builder);
+		~BarNode();
+
+		std::string type() const;
+		std::string params() const;
+		bool evaluate();
+		double value() const;
+		bool is_valid() const;
+
+		const Bar& bar() const;
+		int count() const;
+		Bar at(const int index) const throw( IDEFIX::out_of_range, IDEFIX::element_not_found );
+	};
+
+	/*!
+	 * Simple moving average over the value of the input node
+	 */
+	class SMANode: public IndicatorNode {
+	private:
+		int m_period;
+		mutable SimpleMovingAverage m_sma;
+
+	public:
+		SMANode(IndicatorNode* input, const int period);
+
+		std::string type() const;
+		std::string params() const;
+		bool evaluate();
+		double value() const;
+		bool is_valid() const;
+	};
+
+	/*!
+	 * Indicator graph shared by all strategies.
+	 * Nodes are de-duplicated by key, every symbol has one BarPipeline,
+	 * so identical bricks and averages are calculated only once.
+	 */
+	class IndicatorGraph {
+	private:
+		FIX::Mutex m_mutex;
+		std::map<std::string, BarPipeline*> m_pipelines;
+		// in topological order, inputs are always added before their dependents
+		std::vector<IndicatorNode*> m_nodes;
+
+		void evaluate();
+
+	public:
+		IndicatorGraph();
+		~IndicatorGraph();
+
+		IndicatorNode* add(IndicatorNode* node);
+		IndicatorNode* find(const std::string& key);
+
+		BarNode* bars(const std::string& symbol, AbstractBarBuilder* builder);
+		BarNode* renko(const std::string& symbol, const double brick_size);
+		SMANode* sma(IndicatorNode* input, const int period);
+
+		BarPipeline* pipeline(const std::string& symbol);
+		size_t size();
+
+		void on_tick(const MarketSnapshot& tick);
+	};
+};
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef IDEFIX_INDICATORPIPELINE_H
+#define IDEFIX_INDICATORPIPELINE_H
+
+#include <tuple>
+#include <cstddef>
+#include "Bar.h"
+
+namespace IDEFIX {
+	namespace indicator {
+		/*!
+		 * Open and close prices of the last N bricks, index 0 is the newest.
+		 * The state is stored inline, add() does not allocate.
+		 */
+		template<int N>
+		class BrickWindow {
+		private:
+			double m_open[N];
+			double m_close[N];
+			int m_count;
+
+		public:
+			static const int size = N;
+
+			BrickWindow() {
+				clear();
+			}
+
+			inline void add(const double open_price, const double close_price) {
+				for ( int i = N - 1; i > 0; i-- ) {
+					m_open[i]  = m_open[i - 1];
+					m_close[i] = m_close[i - 1];
+				}
+				m_open[0]  = open_price;
+				m_close[0] = close_price;
+				if ( m_count < N ) {
+					m_count++;
+				}
+			}
+
+			inline void add(const Bar& bar) {
+				add( bar.open_price, bar.close_price );
+			}
+
+			inline double open(const int index) const {
+				return m_open[index];
+			}
+
+			inline double close(const int index) const {
+				return m_close[index];
+			}
+
+			inline bool is_long(const int index) const {
+				return m_open[index] < m_close[index];
+			}
+
+			inline bool is_short(const int index) const {
+				return m_open[index] > m_close[index];
+			}
+
+			// value passed to the next stages: middle of the newest brick
+			inline double value() const {
+				return ( m_open[0] + m_close[0] ) / 2;
+			}
+
+			inline bool is_valid() const {
+				return m_count == N;
+			}
+
+			inline void clear() {
+				for ( int i = 0; i < N; i++ ) {
+					m_open[i]  = 0;
+					m_close[i] = 0;
+				}
+				m_count = 0;
+			}
+		};
+
+		// renko source stage, keeps the three bricks AwesomeStrategy looks at
+		typedef BrickWindow<3> Renko;
+
+		/*!
+		 * Simple moving average with compile time period,
+		 * same semantics as SimpleMovingAverage without virtual calls.
+		 */
+		template<int N>
+		class SMA {
+		private:
+			double m_values[N];
+			int m_pos;
+			double m_total;
+
+		public:
+			static const int period = N;
+
+			SMA() {
+				clear();
+			}
+
+			inline void add(const double value) {
+				m_total         -= m_values[m_pos];
+				m_total         += value;
+				m_values[m_pos]  = value;
+				m_pos            = ( m_pos + 1 ) % N;
+			}
+
+			inline double value() const {
+				return m_total / N;
+			}
+
+			inline bool is_valid() const {
+				for ( int i = 0; i < N; i++ ) {
+					if ( m_values[i] == 0 ) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			inline void clear() {
+				for ( int i = 0; i < N; i++ ) {
+					m_values[i] = 0;
+				}
+				m_pos   = 0;
+				m_total = 0;
+			}
+		};
+
+		// recursive helpers over the stage tuple
+		template<std::size_t I, std::size_t COUNT>
+		struct Stages {
+			template<typename T>
+			static inline void add(T& stages, const double value) {
+				std::get<I>( stages ).add( value );
+				Stages<I + 1, COUNT>::add( stages, value );
+			}
+
+			template<typename T>
+			static inline bool is_valid(const T& stages) {
+				return std::get<I>( stages ).is_valid() && Stages<I + 1, COUNT>::is_valid( stages );
+			}
+
+			template<typename T>
+			static inline void clear(T& stages) {
+				std::get<I>( stages ).clear();
+				Stages<I + 1, COUNT>::clear( stages );
+			}
+		};
+
+		template<std::size_t COUNT>
+		struct Stages<COUNT, COUNT> {
+			template<typename T>
+			static inline void add(T&, const double) {}
+
+			template<typename T>
+			static inline bool is_valid(const T&) {
+				return true;
+			}
+
+			template<typename T>
+			static inline void clear(T&) {}
+		};
+
+		/*!
+		 * Fused indicator pipeline, e.g. Pipeline<Renko, SMA<5>, SMA<10>>.
+		 * The source gets the bar, all following stages get source.value().
+		 * Stage types are known at compile time, so the whole per brick
+		 * update is inlined into on_bar().
+		 */
+		template<typename Source, typename... Indicators>
+		class Pipeline {
+		private:
+			Source m_source;
+			std::tuple<Indicators...> m_indicators;
+
+			typedef Stages<0, sizeof...(Indicators)> stages;
+
+		public:
+			template<std::size_t I>
+			struct stage {
+				typedef typename std::tuple_element<I, std::tuple<Indicators...> >::type type;
+			};
+
+			inline void on_bar(const Bar& bar) {
+				m_source.add( bar );
+				stages::add( m_indicators, m_source.value() );
+			}
+
+			inline const Source& source() const {
+				return m_source;
+			}
+
+			template<std::size_t I>
+			inline const typename stage<I>::type& get() const {
+				return std::get<I>( m_indicators );
+			}
+
+			inline bool is_valid() const {
+				return m_source.is_valid() && stages::is_valid( m_indicators );
+			}
+
+			inline void clear() {
+				m_source.clear();
+				stages::clear( m_indicators );
+			}
+		};
+	}; // - ns indicator
+}; // - ns IDEFIX
+
+#endif
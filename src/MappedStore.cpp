@@ -0,0 +1,393 @@
+#include "MappedStore.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <quickfix/Utility.h>
+
+namespace IDEFIX {
+	namespace {
+		const char MAGIC[8] = { 'I', 'D', 'F', 'X', 'M', 'S', 'T', 'R' };
+
+		inline uint64_t align8(const uint64_t size) {
+			return ( size + 7 ) & ~static_cast<uint64_t>( 7 );
+		}
+
+		std::string error_text(const std::string& what, const std::string& filename) {
+			return what + " " + filename + ": " + strerror( errno );
+		}
+	};
+
+	/*!
+	 * Open or create store file
+	 *
+	 * @param const std::string& filename
+	 * @param const Durability   durability
+	 * @param const uint64_t     segment_size rounded up to the page size, only used for new files
+	 * @throw FIX::ConfigError
+	 */
+	MappedStore::MappedStore(const std::string& filename, const Durability durability, const uint64_t segment_size) throw( FIX::ConfigError )
+		: m_filename( filename ), m_durability( durability ), m_segment_size( 0 ), m_fd( -1 ) {
+		open( segment_size );
+	}
+
+	MappedStore::~MappedStore() {
+		// messages of every segment, the header is in the first one
+		if ( m_durability != DURABILITY_NONE ) {
+			for ( auto segment : m_segments ) {
+				msync( segment, m_segment_size, MS_SYNC );
+			}
+		}
+		close();
+	}
+
+	void MappedStore::close() {
+		for ( auto segment : m_segments ) {
+			munmap( segment, m_segment_size );
+		}
+		m_segments.clear();
+
+		if ( m_fd >= 0 ) {
+			::close( m_fd );
+			m_fd = -1;
+		}
+	}
+
+	MappedStore::Header* MappedStore::header() const {
+		return reinterpret_cast<Header*>( m_segments.front() );
+	}
+
+	void MappedStore::open(const uint64_t segment_size) throw( FIX::ConfigError ) {
+		m_fd = ::open( m_filename.c_str(), O_RDWR | O_CREAT, 0644 );
+		if ( m_fd < 0 ) {
+			throw FIX::ConfigError( error_text( "Could not open", m_filename ) );
+		}
+
+		try {
+			struct stat st;
+			if ( fstat( m_fd, &st ) != 0 ) {
+				throw FIX::ConfigError( error_text( "Could not stat", m_filename ) );
+			}
+
+			// new store
+			if ( st.st_size == 0 ) {
+				const uint64_t page = sysconf( _SC_PAGESIZE );
+				m_segment_size      = std::max( page, ( segment_size + page - 1 ) / page * page );
+				add_segment();
+
+				Header* h = header();
+				memcpy( h->magic, MAGIC, sizeof( MAGIC ) );
+				h->version      = VERSION;
+				h->header_size  = align8( sizeof( Header ) );
+				h->segment_size = m_segment_size;
+				h->end_offset   = h->header_size;
+				h->next_sender  = 1;
+				h->next_target  = 1;
+				set_creation_time();
+				sync_header();
+				return;
+			}
+
+			Header existing;
+			if ( static_cast<size_t>( st.st_size ) < sizeof( Header ) || pread( m_fd, &existing, sizeof( Header ), 0 ) != sizeof( Header )
+				|| memcmp( existing.magic, MAGIC, sizeof( MAGIC ) ) != 0 || existing.version != VERSION
+				|| existing.segment_size == 0 || st.st_size % existing.segment_size != 0 ) {
+				throw FIX::ConfigError( "No message store " + m_filename );
+			}
+
+			// map the existing segments
+			m_segment_size = existing.segment_size;
+			for ( uint64_t offset = 0; offset < static_cast<uint64_t>( st.st_size ); offset += m_segment_size ) {
+				void* data = mmap( nullptr, m_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, offset );
+				if ( data == MAP_FAILED ) {
+					throw FIX::ConfigError( error_text( "Could not map", m_filename ) );
+				}
+				m_segments.push_back( static_cast<char*>( data ) );
+			}
+		} catch ( FIX::ConfigError& e ) {
+			close();
+			throw;
+		} catch ( FIX::IOException& e ) {
+			close();
+			throw FIX::ConfigError( e.what() );
+		}
+
+		load();
+	}
+
+	/*!
+	 * Enlarge file by one segment and map it
+	 *
+	 * @throw FIX::IOException
+	 */
+	void MappedStore::add_segment() throw( FIX::IOException ) {
+		const uint64_t offset = m_segments.size() * m_segment_size;
+		if ( ftruncate( m_fd, offset + m_segment_size ) != 0 ) {
+			throw FIX::IOException( error_text( "Could not grow", m_filename ) );
+		}
+
+		void* data = mmap( nullptr, m_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, offset );
+		if ( data == MAP_FAILED ) {
+			throw FIX::IOException( error_text( "Could not map", m_filename ) );
+		}
+		m_segments.push_back( static_cast<char*>( data ) );
+	}
+
+	/*!
+	 * Rebuild index of sequence numbers, newer records win
+	 */
+	void MappedStore::load() {
+		m_index.clear();
+
+		const Header* h  = header();
+		const uint64_t end = std::min<uint64_t>( h->end_offset, m_segments.size() * m_segment_size );
+		uint64_t offset    = h->header_size;
+
+		while ( offset + sizeof( Record ) <= end ) {
+			const uint64_t in_segment = offset % m_segment_size;
+			const Record* record      = reinterpret_cast<const Record*>( m_segments[offset / m_segment_size] + in_segment );
+
+			// rest of the segment is unused
+			if ( record->seq == 0 || in_segment + sizeof( Record ) + record->size > m_segment_size ) {
+				offset += m_segment_size - in_segment;
+				continue;
+			}
+
+			if ( record->seq >= m_index.size() ) {
+				m_index.resize( record->seq + 1, 0 );
+			}
+			m_index[record->seq] = offset;
+			offset += align8( sizeof( Record ) + record->size );
+		}
+	}
+
+	/*!
+	 * Write range of a segment according to the durability
+	 *
+	 * @param const char*  data
+	 * @param const size_t size
+	 */
+	void MappedStore::sync(const char* data, const size_t size) const {
+		if ( m_durability == DURABILITY_NONE ) {
+			return;
+		}
+
+		// msync needs a page aligned address
+		static const uintptr_t page = sysconf( _SC_PAGESIZE );
+		const uintptr_t start = reinterpret_cast<uintptr_t>( data ) & ~( page - 1 );
+		msync( reinterpret_cast<void*>( start ), reinterpret_cast<uintptr_t>( data ) + size - start, m_durability == DURABILITY_SYNC ? MS_SYNC : MS_ASYNC );
+	}
+
+	void MappedStore::sync_header() const {
+		sync( m_segments.front(), sizeof( Header ) );
+	}
+
+	void MappedStore::set_creation_time() {
+		const auto now = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+		header()->creation_time = now / 1000;
+		header()->creation_ms   = now % 1000;
+	}
+
+	/*!
+	 * Store sent message
+	 *
+	 * @param int                seq
+	 * @param const std::string& message
+	 * @return bool false if the message is larger than a segment
+	 * @throw FIX::IOException
+	 */
+	bool MappedStore::set(int seq, const std::string& message) throw( FIX::IOException ) {
+		const uint64_t total = align8( sizeof( Record ) + message.size() );
+		if ( seq <= 0 || total > m_segment_size - header()->header_size ) {
+			return false;
+		}
+
+		Header* h       = header();
+		uint64_t offset = h->end_offset;
+
+		// start the next segment if the record does not fit
+		const uint64_t in_segment = offset % m_segment_size;
+		if ( offset < m_segments.size() * m_segment_size && in_segment + total > m_segment_size ) {
+			if ( in_segment + sizeof( Record ) <= m_segment_size ) {
+				reinterpret_cast<Record*>( m_segments[offset / m_segment_size] + in_segment )->seq = 0;
+			}
+			offset += m_segment_size - in_segment;
+		}
+		if ( offset >= m_segments.size() * m_segment_size ) {
+			add_segment();
+		}
+
+		char* data     = m_segments[offset / m_segment_size] + offset % m_segment_size;
+		Record* record = reinterpret_cast<Record*>( data );
+		record->seq    = seq;
+		record->size   = message.size();
+		memcpy( record + 1, message.data(), message.size() );
+		sync( data, sizeof( Record ) + message.size() );
+
+		// the record is complete before it becomes visible
+		h->end_offset = offset + total;
+		sync_header();
+
+		if ( static_cast<size_t>( seq ) >= m_index.size() ) {
+			m_index.resize( std::max<size_t>( seq + 1, m_index.size() * 2 ), 0 );
+		}
+		m_index[seq] = offset;
+
+		return true;
+	}
+
+	/*!
+	 * Copy stored messages begin <= seq <= end for a resend request
+	 *
+	 * @param int                       begin
+	 * @param int                       end
+	 * @param std::vector<std::string>& messages
+	 * @throw FIX::IOException
+	 */
+	void MappedStore::get(int begin, int end, std::vector<std::string>& messages) const throw( FIX::IOException ) {
+		messages.clear();
+		if ( begin < 1 ) {
+			begin = 1;
+		}
+
+		const int last = std::min<int>( end, static_cast<int>( m_index.size() ) - 1 );
+		for ( int seq = begin; seq <= last; seq++ ) {
+			const uint64_t offset = m_index[seq];
+			if ( offset == 0 ) {
+				continue;
+			}
+
+			const Record* record = reinterpret_cast<const Record*>( m_segments[offset / m_segment_size] + offset % m_segment_size );
+			messages.emplace_back( reinterpret_cast<const char*>( record + 1 ), record->size );
+		}
+	}
+
+	int MappedStore::getNextSenderMsgSeqNum() const throw( FIX::IOException ) {
+		return header()->next_sender;
+	}
+
+	int MappedStore::getNextTargetMsgSeqNum() const throw( FIX::IOException ) {
+		return header()->next_target;
+	}
+
+	void MappedStore::setNextSenderMsgSeqNum(int value) throw( FIX::IOException ) {
+		header()->next_sender = value;
+		sync_header();
+	}
+
+	void MappedStore::setNextTargetMsgSeqNum(int value) throw( FIX::IOException ) {
+		header()->next_target = value;
+		sync_header();
+	}
+
+	void MappedStore::incrNextSenderMsgSeqNum() throw( FIX::IOException ) {
+		header()->next_sender++;
+		sync_header();
+	}
+
+	void MappedStore::incrNextTargetMsgSeqNum() throw( FIX::IOException ) {
+		header()->next_target++;
+		sync_header();
+	}
+
+	FIX::UtcTimeStamp MappedStore::getCreationTime() const throw( FIX::IOException ) {
+		return FIX::UtcTimeStamp( static_cast<time_t>( header()->creation_time ), header()->creation_ms );
+	}
+
+	/*!
+	 * Drop all messages and start with sequence number 1,
+	 * the segments stay allocated
+	 *
+	 * @throw FIX::IOException
+	 */
+	void MappedStore::reset() throw( FIX::IOException ) {
+		Header* h      = header();
+		h->end_offset  = h->header_size;
+		h->next_sender = 1;
+		h->next_target = 1;
+		set_creation_time();
+		sync_header();
+
+		m_index.clear();
+	}
+
+	void MappedStore::refresh() throw( FIX::IOException ) {
+		load();
+	}
+
+	/*!
+	 * Count of stored messages
+	 *
+	 * @return size_t
+	 */
+	size_t MappedStore::size() const {
+		size_t count = 0;
+		for ( auto offset : m_index ) {
+			if ( offset != 0 ) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	/*!
+	 * none, async or sync
+	 *
+	 * @param const std::string& value
+	 * @return Durability async if unknown
+	 */
+	MappedStore::Durability MappedStore::parse_durability(const std::string& value) {
+		if ( value == "none" || value == "NONE" ) {
+			return DURABILITY_NONE;
+		}
+		if ( value == "sync" || value == "SYNC" ) {
+			return DURABILITY_SYNC;
+		}
+		return DURABILITY_ASYNC;
+	}
+
+	MappedStoreFactory::MappedStoreFactory(const FIX::SessionSettings& settings): m_settings( settings ), m_durability( MappedStore::DURABILITY_ASYNC ), m_segment_size( MappedStore::SEGMENT_SIZE ) {}
+
+	MappedStoreFactory::MappedStoreFactory(const std::string& path, const MappedStore::Durability durability, const uint64_t segment_size)
+		: m_path( path ), m_durability( durability ), m_segment_size( segment_size ) {}
+
+	/*!
+	 * Create store for session
+	 *
+	 * @param const FIX::SessionID& session_ID
+	 * @return FIX::MessageStore*
+	 * @throw FIX::ConfigError
+	 */
+	FIX::MessageStore* MappedStoreFactory::create(const FIX::SessionID& session_ID) {
+		std::string path                   = m_path;
+		MappedStore::Durability durability = m_durability;
+		uint64_t segment_size              = m_segment_size;
+
+		if ( path.empty() ) {
+			const FIX::Dictionary settings = m_settings.get( session_ID );
+			path = settings.getString( FIX::FILE_STORE_PATH );
+			if ( settings.has( "MappedStoreSync" ) ) {
+				durability = MappedStore::parse_durability( settings.getString( "MappedStoreSync" ) );
+			}
+			if ( settings.has( "MappedStoreSegmentSize" ) ) {
+				segment_size = settings.getLong( "MappedStoreSegmentSize" );
+			}
+		}
+
+		FIX::file_mkdir( path.c_str() );
+
+		std::string prefix = session_ID.getBeginString().getValue() + "-" + session_ID.getSenderCompID().getValue() + "-" + session_ID.getTargetCompID().getValue();
+		if ( ! session_ID.getSessionQualifier().empty() ) {
+			prefix += "-" + session_ID.getSessionQualifier();
+		}
+
+		return new MappedStore( FIX::file_appendpath( path, prefix + ".mstore" ), durability, segment_size );
+	}
+
+	void MappedStoreFactory::destroy(FIX::MessageStore* store) {
+		delete store;
+	}
+};
@@ -0,0 +1,127 @@
+#ifndef IDEFIX_MAPPEDSTORE_H
+#define IDEFIX_MAPPEDSTORE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <quickfix/MessageStore.h>
+#include <quickfix/SessionSettings.h>
+
+namespace IDEFIX {
+	/*!
+	 * quickfix MessageStore in a memory mapped file.
+	 *
+	 * One file per session: [path]/[BeginString]-[SenderCompID]-[TargetCompID].mstore
+	 *
+	 * Header | Record | Record | ... | Segment 2 | ...
+	 *
+	 * The file grows in preallocated segments, every segment is mapped on its
+	 * own and never moves, so sending a message is a memcpy into the mapping.
+	 * A record is the sequence number, the size and the raw message, 8 byte
+	 * aligned. A record never crosses a segment, a zero sequence number marks
+	 * the unused rest of a segment. The sequence numbers live in the header.
+	 *
+	 * An index from sequence number to offset is rebuilt on open, resend
+	 * requests are copied straight from the mapping.
+	 */
+	class MappedStore: public FIX::MessageStore {
+	public:
+		enum Durability {
+			// the kernel writes the pages whenever it wants
+			DURABILITY_NONE,
+			// msync( MS_ASYNC ) after every change
+			DURABILITY_ASYNC,
+			// msync( MS_SYNC ) after every change
+			DURABILITY_SYNC
+		};
+
+		static const uint32_t VERSION = 1;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t header_size;
+			uint64_t segment_size;
+			uint64_t end_offset;
+			int32_t next_sender;
+			int32_t next_target;
+			int64_t creation_time;
+			int32_t creation_ms;
+			int32_t reserved;
+		};
+
+		struct Record {
+			uint32_t seq;
+			uint32_t size;
+		};
+
+	private:
+		std::string m_filename;
+		Durability m_durability;
+		uint64_t m_segment_size;
+		int m_fd;
+		std::vector<char*> m_segments;
+		// offset of every sequence number, 0 = not stored
+		std::vector<uint64_t> m_index;
+
+		Header* header() const;
+		void open(const uint64_t segment_size) throw( FIX::ConfigError );
+		void close();
+		void add_segment() throw( FIX::IOException );
+		void load();
+		void sync(const char* data, const size_t size) const;
+		void sync_header() const;
+		void set_creation_time();
+
+	public:
+		// defaults of the factory
+		static const uint64_t SEGMENT_SIZE = 1 << 22;
+
+		MappedStore(const std::string& filename, const Durability durability = DURABILITY_ASYNC, const uint64_t segment_size = SEGMENT_SIZE) throw( FIX::ConfigError );
+		virtual ~MappedStore();
+
+		bool set(int seq, const std::string& message) throw( FIX::IOException );
+		void get(int begin, int end, std::vector<std::string>& messages) const throw( FIX::IOException );
+
+		int getNextSenderMsgSeqNum() const throw( FIX::IOException );
+		int getNextTargetMsgSeqNum() const throw( FIX::IOException );
+		void setNextSenderMsgSeqNum(int value) throw( FIX::IOException );
+		void setNextTargetMsgSeqNum(int value) throw( FIX::IOException );
+		void incrNextSenderMsgSeqNum() throw( FIX::IOException );
+		void incrNextTargetMsgSeqNum() throw( FIX::IOException );
+
+		FIX::UtcTimeStamp getCreationTime() const throw( FIX::IOException );
+
+		void reset() throw( FIX::IOException );
+		void refresh() throw( FIX::IOException );
+
+		size_t size() const;
+
+		static Durability parse_durability(const std::string& value);
+	};
+
+	/*!
+	 * Creates MappedStore for every session.
+	 *
+	 * Settings of the session:
+	 * FileStorePath=./Store
+	 * MappedStoreSync=none|async|sync        defaults to async
+	 * MappedStoreSegmentSize=4194304         bytes, used for new files only
+	 */
+	class MappedStoreFactory: public FIX::MessageStoreFactory {
+	private:
+		FIX::SessionSettings m_settings;
+		std::string m_path;
+		MappedStore::Durability m_durability;
+		uint64_t m_segment_size;
+
+	public:
+		MappedStoreFactory(const FIX::SessionSettings& settings);
+		MappedStoreFactory(const std::string& path, const MappedStore::Durability durability = MappedStore::DURABILITY_ASYNC, const uint64_t segment_size = MappedStore::SEGMENT_SIZE);
+
+		FIX::MessageStore* create(const FIX::SessionID& session_ID);
+		void destroy(FIX::MessageStore* store);
+	};
+};
+
+#endif
@@ -4,22 +4,36 @@
 #include <string>
 #include <vector>
 #include "MarketSnapshot.h"
+#include "Metrics.h"
 
 using namespace std;
 
 namespace IDEFIX {
 class Market {
+public:
+	// count of snapshots kept per market, older snapshots are overwritten
+	static const size_t HISTORY = 256;
+
 private:
 	std::string m_symbol;
+	// ring buffer, m_next is the slot of the next snapshot
 	std::vector<MarketSnapshot> m_snapshots;
+	size_t m_next;
+	// idefix_ticks_total of the symbol, registered with the market
+	Metrics::Counter m_ticks;
+
+	// Returns snapshot by age, 0 is the oldest
+	inline const MarketSnapshot& at(const size_t index) const {
+		return m_snapshots.size() < HISTORY ? m_snapshots[index] : m_snapshots[( m_next + index ) % HISTORY];
+	}
 
 public:
 	// Constructs a new Market without identifier
-	explicit Market(){}
+	explicit Market(): m_next(0) {}
 	// Constructs a new Market with empty snapshot list
-	explicit Market(const string& symbol): m_symbol(symbol){}
+	explicit Market(const string& symbol): m_symbol(symbol), m_next(0) {}
 	// Constructs a new Market with snapshot symbol and first entry
-	explicit Market(const MarketSnapshot& snapshot): m_symbol(snapshot.getSymbol()) {
+	explicit Market(const MarketSnapshot& snapshot): m_symbol(snapshot.getSymbol()), m_next(0) {
 		add(snapshot);
 	}
 	inline ~Market(){}
@@ -29,20 +43,43 @@ public:
 		return m_symbol;
 	}
 
-	// Returns all snapshots as vector
+	// Sets the tick counter, see FIXManager::registerMarket
+	inline void setTickCounter(const Metrics::Counter& counter) {
+		m_ticks = counter;
+	}
+
+	// Returns the tick counter, a copy can be incremented without a lock
+	inline Metrics::Counter getTickCounter() const {
+		return m_ticks;
+	}
+
+	// Returns the kept snapshots as vector, oldest first
 	inline vector<MarketSnapshot> getSnapshots() {
-		return m_snapshots;
+		return getRange( 0 );
 	}
 
-	// add new snapshot to the end of the list
-	inline void add(const MarketSnapshot snapshot){
-		m_snapshots.push_back(snapshot);
+	// add new snapshot to the end of the list, once the history is full
+	// the oldest slot is assigned, its strings keep their capacity
+	inline void add(const MarketSnapshot& snapshot){
+		if ( m_snapshots.size() < HISTORY ) {
+			if ( m_snapshots.capacity() < HISTORY ) {
+				m_snapshots.reserve( HISTORY );
+			}
+			m_snapshots.push_back(snapshot);
+		} else {
+			m_snapshots[m_next] = snapshot;
+		}
+		m_next = ( m_next + 1 ) % HISTORY;
 	}
 
 	// Returns latest market snapshot
 	inline MarketSnapshot getLatestSnapshot() const {
-		auto snapshot = m_snapshots.back();
-		return snapshot;
+		return latest();
+	}
+
+	// Returns latest market snapshot without a copy
+	inline const MarketSnapshot& latest() const {
+		return m_snapshots[( m_next + HISTORY - 1 ) % HISTORY];
 	}
 
 	// Returns the size of the snapshot list
@@ -68,13 +105,13 @@ public:
 	 * @return std::vector<MarketSnapshot>
 	 */
 	inline std::vector<MarketSnapshot> getRange(const int from_start) {
+		std::vector<MarketSnapshot> result;
 		if ( isEmpty() ) {
-			return m_snapshots;
+			return result;
 		}
 
 		auto list_size      = getSize();
 		int list_from_start = from_start;
-		std::vector<MarketSnapshot> result;
 
 		// if from_start is negative, we use last element index - from_start
 		// like size()-3 means [0,1,2,3,>>4<<,5,6] = 4
@@ -88,7 +125,7 @@ public:
 
 		// loop through array begining at from_start index
 		for ( int i = list_from_start; i < list_size; i++ ) {
-			result.push_back( m_snapshots.at( i ) );
+			result.push_back( at( i ) );
 		}
 
 		return result;
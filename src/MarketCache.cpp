@@ -0,0 +1,191 @@
+#include "MarketCache.h"
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+namespace IDEFIX {
+	namespace {
+		const char MAGIC[8] = { 'I', 'D', 'F', 'X', 'M', 'K', 'T', 'C' };
+
+		template<typename T>
+		inline void write_value(std::string& out, const T value) {
+			out.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+		}
+
+		inline void write_string(std::string& out, const std::string& value) {
+			write_value<uint32_t>( out, value.size() );
+			out.append( value );
+		}
+
+		/*!
+		 * Bounds checked reader of the snapshot
+		 */
+		class Reader {
+		private:
+			const std::string& m_data;
+			size_t m_offset;
+
+		public:
+			Reader(const std::string& data, const size_t offset): m_data( data ), m_offset( offset ) {}
+
+			template<typename T>
+			T value() throw( IDEFIX::out_of_range ) {
+				if ( m_offset + sizeof( T ) > m_data.size() ) {
+					throw out_of_range(__FILE__, __LINE__);
+				}
+				T result;
+				memcpy( &result, m_data.data() + m_offset, sizeof( T ) );
+				m_offset += sizeof( T );
+				return result;
+			}
+
+			std::string string() throw( IDEFIX::out_of_range ) {
+				const uint32_t size = value<uint32_t>();
+				if ( m_offset + size > m_data.size() ) {
+					throw out_of_range(__FILE__, __LINE__);
+				}
+				std::string result( m_data, m_offset, size );
+				m_offset += size;
+				return result;
+			}
+		};
+	};
+
+	MarketCache::MarketCache(const std::string& filename): m_filename( filename ) {}
+
+	std::string MarketCache::filename() const {
+		return m_filename;
+	}
+
+	/*!
+	 * Read snapshot, details and params are replaced
+	 *
+	 * @param std::map<std::string, MarketDetail>& details
+	 * @param std::map<std::string, std::string>&  params
+	 * @return int64_t time the snapshot was saved in ms since epoch
+	 * @throw IDEFIX::file_not_found
+	 * @throw IDEFIX::out_of_range   if the file is no snapshot or truncated
+	 */
+	int64_t MarketCache::load(std::map<std::string, MarketDetail>& details, std::map<std::string, std::string>& params) const throw( IDEFIX::file_not_found, IDEFIX::out_of_range ) {
+		std::ifstream file( m_filename.c_str(), std::ios::in | std::ios::binary );
+		if ( ! file.is_open() ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+		const std::string data( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+		Header header;
+		if ( data.size() < sizeof( Header ) ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+		memcpy( &header, data.data(), sizeof( Header ) );
+		if ( memcmp( header.magic, MAGIC, sizeof( MAGIC ) ) != 0 || header.version != VERSION ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		Reader reader( data, sizeof( Header ) );
+		std::map<std::string, MarketDetail> loaded_details;
+		std::map<std::string, std::string> loaded_params;
+
+		for ( uint32_t i = 0; i < header.detail_count; i++ ) {
+			MarketDetail detail;
+			detail.setSymbol( reader.string() );
+			detail.setCurrency( reader.string() );
+			detail.setFactor( reader.value<double>() );
+			detail.setContractMultiplier( reader.value<double>() );
+			detail.setProduct( reader.value<int32_t>() );
+			detail.setRoundlot( reader.value<double>() );
+			detail.setSymID( reader.value<int32_t>() );
+			detail.setSymPrecision( reader.value<int32_t>() );
+			detail.setSymPointsize( reader.value<double>() );
+			detail.setSymInterestBuy( reader.value<double>() );
+			detail.setSymInterestSell( reader.value<double>() );
+			detail.setSymSortOrder( reader.value<int32_t>() );
+			detail.setSubscriptionStatus( reader.string() );
+			detail.setFieldProductID( reader.value<int32_t>() );
+			detail.setCondDistStop( reader.value<double>() );
+			detail.setCondDistLimit( reader.value<double>() );
+			detail.setCondDistEntryStop( reader.value<double>() );
+			detail.setCondDistEntryLimit( reader.value<double>() );
+			detail.setMaxQuantity( reader.value<double>() );
+			detail.setMinQuantity( reader.value<double>() );
+			detail.setTradingStatus( reader.string() );
+
+			loaded_details[detail.getSymbol()] = detail;
+		}
+
+		for ( uint32_t i = 0; i < header.param_count; i++ ) {
+			const std::string key = reader.string();
+			loaded_params[key]    = reader.string();
+		}
+
+		details.swap( loaded_details );
+		params.swap( loaded_params );
+
+		return header.saved_ms;
+	}
+
+	/*!
+	 * Write snapshot
+	 *
+	 * @param const std::map<std::string, MarketDetail>& details
+	 * @param const std::map<std::string, std::string>&  params
+	 * @throw IDEFIX::file_not_found if the file can not be written
+	 */
+	void MarketCache::save(const std::map<std::string, MarketDetail>& details, const std::map<std::string, std::string>& params) const throw( IDEFIX::file_not_found ) {
+		Header header;
+		memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+		header.version      = VERSION;
+		header.detail_count = details.size();
+		header.param_count  = params.size();
+		header.reserved     = 0;
+		header.saved_ms     = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+
+		std::string data;
+		data.reserve( sizeof( Header ) + details.size() * 192 + params.size() * 48 );
+		data.append( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+
+		for ( auto& item : details ) {
+			const MarketDetail& detail = item.second;
+			write_string( data, detail.getSymbol() );
+			write_string( data, detail.getCurrency() );
+			write_value<double>( data, detail.getFactor() );
+			write_value<double>( data, detail.getContractMultiplier() );
+			write_value<int32_t>( data, detail.getProduct() );
+			write_value<double>( data, detail.getRoundlot() );
+			write_value<int32_t>( data, detail.getSymID() );
+			write_value<int32_t>( data, detail.getSymPrecision() );
+			write_value<double>( data, detail.getSymPointsize() );
+			write_value<double>( data, detail.getSymInterestBuy() );
+			write_value<double>( data, detail.getSymInterestSell() );
+			write_value<int32_t>( data, detail.getSymSortOrder() );
+			write_string( data, detail.getSubscriptionStatus() );
+			write_value<int32_t>( data, detail.getFieldProductID() );
+			write_value<double>( data, detail.getCondDistStop() );
+			write_value<double>( data, detail.getCondDistLimit() );
+			write_value<double>( data, detail.getCondDistEntryStop() );
+			write_value<double>( data, detail.getCondDistEntryLimit() );
+			write_value<double>( data, detail.getMaxQuantity() );
+			write_value<double>( data, detail.getMinQuantity() );
+			write_string( data, detail.getTradingStatus() );
+		}
+
+		for ( auto& item : params ) {
+			write_string( data, item.first );
+			write_string( data, item.second );
+		}
+
+		const std::string tmp_filename = m_filename + ".tmp";
+		{
+			std::ofstream file( tmp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+			if ( ! file.is_open() || ! file.write( data.data(), data.size() ) ) {
+				throw file_not_found(__FILE__, __LINE__);
+			}
+		}
+
+		if ( std::rename( tmp_filename.c_str(), m_filename.c_str() ) != 0 ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+	}
+};
@@ -0,0 +1,47 @@
+#ifndef IDEFIX_MARKETCACHE_H
+#define IDEFIX_MARKETCACHE_H
+
+#include <string>
+#include <map>
+#include <cstdint>
+#include "MarketDetail.h"
+#include "Exceptions.h"
+
+namespace IDEFIX {
+	/*!
+	 * Binary snapshot of the SecurityList (MarketDetail per symbol) and the
+	 * FXCM system parameters of the last TradingSessionStatus.
+	 *
+	 * Header | MarketDetail | ... | Param | ...
+	 *
+	 * Strings are stored with a 32 bit length, numbers as they are in memory.
+	 * The file is written to filename.tmp and renamed, a reader never sees
+	 * a partial snapshot.
+	 */
+	class MarketCache {
+	public:
+		static const uint32_t VERSION = 1;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t detail_count;
+			uint32_t param_count;
+			uint32_t reserved;
+			int64_t saved_ms;
+		};
+
+	private:
+		std::string m_filename;
+
+	public:
+		MarketCache(const std::string& filename);
+
+		std::string filename() const;
+
+		int64_t load(std::map<std::string, MarketDetail>& details, std::map<std::string, std::string>& params) const throw( IDEFIX::file_not_found, IDEFIX::out_of_range );
+		void save(const std::map<std::string, MarketDetail>& details, const std::map<std::string, std::string>& params) const throw( IDEFIX::file_not_found );
+	};
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <ostream>
+#include <sstream>
 #include <iomanip>
 
 namespace IDEFIX {
@@ -52,7 +53,9 @@ private:
 	// tag 9096
 	std::string m_trading_status;
 public:
-	explicit MarketDetail() {}
+	explicit MarketDetail(): m_factor( 0 ), m_contractmultiplier( 0 ), m_product( 0 ), m_roundlot( 0 ), m_sym_id( 0 ), m_sym_precision( 0 ),
+		m_sym_point_size( 0 ), m_sym_interest_buy( 0 ), m_sym_interest_sell( 0 ), m_sym_sort_order( 0 ), m_field_product_id( 0 ),
+		m_cond_dist_stop( 0 ), m_cond_dist_limit( 0 ), m_cond_dist_entry_stop( 0 ), m_cond_dist_entry_limit( 0 ), m_max_quantity( 0 ), m_min_quantity( 0 ) {}
 	inline ~MarketDetail() {}
 
 	inline std::string getSymbol() const { return m_symbol; }
@@ -230,6 +233,22 @@ public:
 	}
 };
 
+inline bool operator==(const IDEFIX::MarketDetail& lhs, const IDEFIX::MarketDetail& rhs) {
+	return lhs.getSymbol() == rhs.getSymbol() && lhs.getCurrency() == rhs.getCurrency() && lhs.getFactor() == rhs.getFactor()
+		&& lhs.getContractMultiplier() == rhs.getContractMultiplier() && lhs.getProduct() == rhs.getProduct() && lhs.getRoundlot() == rhs.getRoundlot()
+		&& lhs.getSymID() == rhs.getSymID() && lhs.getSymPrecision() == rhs.getSymPrecision() && lhs.getSymPointsize() == rhs.getSymPointsize()
+		&& lhs.getSymInterestBuy() == rhs.getSymInterestBuy() && lhs.getSymInterestSell() == rhs.getSymInterestSell()
+		&& lhs.getSymSortOrder() == rhs.getSymSortOrder() && lhs.getSubscriptionStatus() == rhs.getSubscriptionStatus()
+		&& lhs.getFieldProductID() == rhs.getFieldProductID() && lhs.getCondDistStop() == rhs.getCondDistStop()
+		&& lhs.getCondDistLimit() == rhs.getCondDistLimit() && lhs.getCondDistEntryStop() == rhs.getCondDistEntryStop()
+		&& lhs.getCondDistEntryLimit() == rhs.getCondDistEntryLimit() && lhs.getMaxQuantity() == rhs.getMaxQuantity()
+		&& lhs.getMinQuantity() == rhs.getMinQuantity() && lhs.getTradingStatus() == rhs.getTradingStatus();
+}
+
+inline bool operator!=(const IDEFIX::MarketDetail& lhs, const IDEFIX::MarketDetail& rhs) {
+	return ! ( lhs == rhs );
+}
+
 inline std::ostream& operator<<(std::ostream& out, const IDEFIX::MarketDetail& md) {
 	out << md.toString();
 	return out;
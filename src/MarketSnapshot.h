@@ -33,20 +33,25 @@ public:
 	}
 	
 	inline ~MarketSnapshot() {}
-	inline string getSymbol() const {
+	inline const string& getSymbol() const {
 		return m_symbol;
 	}
-	inline void setSymbol(const string symbol) {
+	inline void setSymbol(const string& symbol) {
 		if( m_symbol != symbol ) {
 			m_symbol = symbol;
 			setBaseAndQuote( symbol );
 		}
 	}
-	inline void setBaseAndQuote(const std::string symbol) {
-		// set base and quote currency
-		auto parts = str::explode( symbol, '/' );
-		m_base_currency  = parts[0];
-		m_quote_currency = parts[1];
+	// set base and quote currency, assign keeps the capacity of the strings
+	inline void setBaseAndQuote(const std::string& symbol) {
+		const size_t slash = symbol.find( '/' );
+		if ( slash == std::string::npos ) {
+			m_base_currency.assign( symbol );
+			m_quote_currency.clear();
+			return;
+		}
+		m_base_currency.assign( symbol, 0, slash );
+		m_quote_currency.assign( symbol, slash + 1, std::string::npos );
 	}
 	inline double getBid() const {
 		return m_bid;
@@ -98,14 +103,18 @@ public:
 			m_precision = precision;
 		}
 	}
-	inline string getSendingTime() const {
+	inline const string& getSendingTime() const {
 		return m_sending_time;
 	}
-	inline void setSendingTime(const string sending_time){
+	inline void setSendingTime(const string& sending_time){
 		if( m_sending_time != sending_time ){
 			m_sending_time = sending_time;
 		}
 	}
+	// set sending time without a temporary string, keeps the capacity
+	inline void setSendingTime(const char* sending_time, const size_t length){
+		m_sending_time.assign( sending_time, length );
+	}
 	inline bool isValid() const {
 		return ( ! getSymbol().empty() && getBid() > 0 && getAsk() > 0 && getSpread() >= 0 );
 	}
@@ -121,18 +130,18 @@ public:
 	 * Get quote currency of forex pair
 	 * GBP/USD, USD is quote
 	 * 
-	 * @return std::string
+	 * @return const std::string&
 	 */
-	inline std::string getQuoteCurrency() const {
+	inline const std::string& getQuoteCurrency() const {
 		return m_quote_currency;
 	}
 	/*!
 	 * Get base currency of forex pair
 	 * GBP/USD, GBP is base
 	 * 
-	 * @return std::string
+	 * @return const std::string&
 	 */
-	inline std::string getBaseCurrency() const {
+	inline const std::string& getBaseCurrency() const {
 		return m_base_currency;
 	}
 
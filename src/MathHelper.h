@@ -15,14 +15,14 @@ namespace IDEFIX {
 		 * https://www.myfxbook.com/forex-calculators/pip-calculator
 		 * https://www.thebalance.com/calculating-pip-value-in-forex-pairs-1031022
 		 * 
-		 * @param const MarketSnapshot      snapshot         The current market snapshot.
+		 * @param const MarketSnapshot&     snapshot         The current market snapshot.
 		 * @param const double              pos_qty          The current position qty.
-		 * @param const std::string         account_currency The account currency in capital letters. Default is USD
+		 * @param const std::string&        account_currency The account currency in capital letters. Default is USD
 		 * @param const double              conversion_price The conversion_price for snapshot if it does not contain account_currency. eg. ACC=USD, Snapshot=EUR/GBP => USD/GBP
 		 * @param const char				side 			 The side of the current position.
 		 * @return double
 		 */
-		inline double get_pip_value(const MarketSnapshot snapshot, const double pos_qty, const std::string account_currency = "USD", const double conversion_price = 0, const char side = FIX::Side_BUY) {
+		inline double get_pip_value(const MarketSnapshot& snapshot, const double pos_qty, const std::string& account_currency = "USD", const double conversion_price = 0, const char side = FIX::Side_BUY) {
 			
 			// Whatever currency the account is, when that currency is listed second in a pair the pip values are fixed. 
 			// For example, if you have a Canadian dollar (CAD) account, any pair that is XXX/CAD, such as the USD/CAD 
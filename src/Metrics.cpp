@@ -0,0 +1,369 @@
+#include "Metrics.h"
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace IDEFIX {
+	namespace {
+		const char MAGIC[8] = { 'I', 'D', 'F', 'X', 'M', 'E', 'T', 'R' };
+
+		inline size_t segment_size(const uint32_t capacity) {
+			return sizeof( Metrics::Header ) + capacity * sizeof( Metrics::Entry );
+		}
+
+		inline void init_header(Metrics::Header* header, const uint32_t capacity) {
+			memcpy( header->magic, MAGIC, sizeof( MAGIC ) );
+			header->version  = Metrics::VERSION;
+			header->capacity = capacity;
+			header->pid      = getpid();
+			header->start_ms = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+			header->count.store( 0, std::memory_order_release );
+		}
+
+		/*!
+		 * Segment of the process and the Prometheus writer
+		 */
+		struct MetricsRegistry {
+			std::mutex mutex;
+			Metrics::Header* header;
+			std::string name;
+
+			std::thread writer;
+			std::atomic<bool> running;
+			std::condition_variable wakeup;
+
+			MetricsRegistry(): header( nullptr ), running( false ) {}
+
+			// the segment stays mapped, handles may be used until the process ends
+			~MetricsRegistry() {
+				if ( running ) {
+					running = false;
+					wakeup.notify_all();
+					writer.join();
+				}
+			}
+		};
+
+		MetricsRegistry& registry() {
+			static MetricsRegistry instance;
+			return instance;
+		}
+
+		std::string labels_with(const char* labels, const std::string& extra) {
+			std::string result = "{";
+			result += labels;
+			if ( labels[0] != '\0' && ! extra.empty() ) {
+				result += ",";
+			}
+			result += extra;
+			result += "}";
+			return result == "{}" ? "" : result;
+		}
+	};
+
+	const char* Metrics::DEFAULT_NAME = "/idefix.metrics";
+
+	/*!
+	 * Create shared memory segment, an old segment of the same name is replaced
+	 *
+	 * @param const std::string& name     like /idefix.metrics
+	 * @param const uint32_t     capacity count of metrics
+	 * @return bool false if metrics are registered already or shm is not available
+	 */
+	bool Metrics::open(const std::string& name, const uint32_t capacity) {
+		MetricsRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		if ( reg.header != nullptr ) {
+			return reg.name == name;
+		}
+
+		const size_t size = segment_size( capacity );
+		const int fd      = shm_open( name.c_str(), O_CREAT | O_RDWR, 0644 );
+		if ( fd < 0 ) {
+			return false;
+		}
+
+		// truncate to 0 first, every entry starts zeroed
+		if ( ftruncate( fd, 0 ) != 0 || ftruncate( fd, size ) != 0 ) {
+			::close( fd );
+			return false;
+		}
+
+		void* mapped = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+		::close( fd );
+		if ( mapped == MAP_FAILED ) {
+			return false;
+		}
+
+		reg.header = static_cast<Header*>( mapped );
+		reg.name   = name;
+		init_header( reg.header, capacity );
+
+		return true;
+	}
+
+	/*!
+	 * Remove the segment name, readers can't attach anymore.
+	 * The memory stays mapped until the process ends.
+	 */
+	void Metrics::close() {
+		MetricsRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		if ( ! reg.name.empty() ) {
+			shm_unlink( reg.name.c_str() );
+			reg.name.clear();
+		}
+	}
+
+	/*!
+	 * Register metric, the same name and labels return the same entry
+	 *
+	 * @param const std::string& name
+	 * @param const std::string& labels
+	 * @param const Type         type
+	 * @return Entry* nullptr if the segment is full
+	 */
+	Metrics::Entry* Metrics::add(const std::string& name, const std::string& labels, const Type type) {
+		MetricsRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+
+		// no segment, private memory
+		if ( reg.header == nullptr ) {
+			void* mapped = mmap( nullptr, segment_size( DEFAULT_CAPACITY ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+			if ( mapped == MAP_FAILED ) {
+				return nullptr;
+			}
+			reg.header = static_cast<Header*>( mapped );
+			init_header( reg.header, DEFAULT_CAPACITY );
+		}
+
+		Header* header       = reg.header;
+		const uint32_t count = header->count.load( std::memory_order_relaxed );
+		Entry* entries       = reinterpret_cast<Entry*>( header + 1 );
+
+		for ( uint32_t i = 0; i < count; i++ ) {
+			if ( entries[i].type == type && name.compare( 0, NAME_SIZE - 1, entries[i].name ) == 0 && labels.compare( 0, LABELS_SIZE - 1, entries[i].labels ) == 0 ) {
+				return &entries[i];
+			}
+		}
+
+		if ( count >= header->capacity ) {
+			return nullptr;
+		}
+
+		Entry* entry = &entries[count];
+		strncpy( entry->name, name.c_str(), NAME_SIZE - 1 );
+		strncpy( entry->labels, labels.c_str(), LABELS_SIZE - 1 );
+		entry->type = type;
+
+		// readers see the entry after it is complete
+		header->count.store( count + 1, std::memory_order_release );
+
+		return entry;
+	}
+
+	Metrics::Counter Metrics::counter(const std::string& name, const std::string& labels) {
+		return Counter( add( name, labels, COUNTER ) );
+	}
+
+	Metrics::Gauge Metrics::gauge(const std::string& name, const std::string& labels) {
+		return Gauge( add( name, labels, GAUGE ) );
+	}
+
+	Metrics::Histogram Metrics::histogram(const std::string& name, const std::string& labels) {
+		return Histogram( add( name, labels, HISTOGRAM ) );
+	}
+
+	/*!
+	 * Prometheus label key="value"
+	 *
+	 * @param const std::string& key
+	 * @param const std::string& value
+	 * @return std::string
+	 */
+	std::string Metrics::label(const std::string& key, const std::string& value) {
+		return key + "=\"" + value + "\"";
+	}
+
+	/*!
+	 * Write Prometheus text file every interval, the file is replaced at once
+	 *
+	 * @param const std::string& filename like metrics/idefix.prom
+	 * @param const int          interval_ms
+	 */
+	void Metrics::start_writer(const std::string& filename, const int interval_ms) {
+		MetricsRegistry& reg = registry();
+		std::lock_guard<std::mutex> lock( reg.mutex );
+		if ( reg.running ) {
+			return;
+		}
+
+		reg.running = true;
+		reg.writer  = std::thread( [&reg, filename, interval_ms]() {
+			const std::string tmp_filename = filename + ".tmp";
+
+			std::unique_lock<std::mutex> lock( reg.mutex );
+			while ( reg.running ) {
+				reg.wakeup.wait_for( lock, std::chrono::milliseconds( interval_ms ) );
+
+				lock.unlock();
+				{
+					std::ofstream file( tmp_filename.c_str(), std::ios::out | std::ios::trunc );
+					write_prometheus( file );
+				}
+				std::rename( tmp_filename.c_str(), filename.c_str() );
+				lock.lock();
+			}
+		});
+	}
+
+	void Metrics::stop_writer() {
+		MetricsRegistry& reg = registry();
+		{
+			std::lock_guard<std::mutex> lock( reg.mutex );
+			if ( ! reg.running ) {
+				return;
+			}
+			reg.running = false;
+		}
+
+		reg.wakeup.notify_all();
+		reg.writer.join();
+	}
+
+	void Metrics::write_prometheus(std::ostream& out) {
+		const Header* header = nullptr;
+		{
+			MetricsRegistry& reg = registry();
+			std::lock_guard<std::mutex> lock( reg.mutex );
+			header = reg.header;
+		}
+
+		if ( header != nullptr ) {
+			write_prometheus( out, header );
+		}
+	}
+
+	/*!
+	 * Write all metrics of a segment in Prometheus text format,
+	 * entries of the same name are grouped
+	 *
+	 * @param std::ostream& out
+	 * @param const Header* header
+	 */
+	void Metrics::write_prometheus(std::ostream& out, const Header* header) {
+		const uint32_t count = header->count.load( std::memory_order_acquire );
+
+		std::vector<std::string> names;
+		std::map<std::string, std::vector<uint32_t>> groups;
+		for ( uint32_t i = 0; i < count; i++ ) {
+			const std::string name = entry( header, i )->name;
+			if ( groups.find( name ) == groups.end() ) {
+				names.push_back( name );
+			}
+			groups[name].push_back( i );
+		}
+
+		static const char* TYPE_NAMES[] = { "counter", "gauge", "histogram" };
+
+		char number[32];
+		for ( auto& name : names ) {
+			const std::vector<uint32_t>& indexes = groups[name];
+			const Type type = static_cast<Type>( entry( header, indexes.front() )->type );
+			out << "# TYPE " << name << " " << TYPE_NAMES[type < 3 ? type : 0] << "\n";
+
+			for ( uint32_t index : indexes ) {
+				const Entry* e = entry( header, index );
+
+				if ( type != HISTOGRAM ) {
+					out << name << labels_with( e->labels, "" ) << " " << e->value.load( std::memory_order_relaxed ) << "\n";
+					continue;
+				}
+
+				uint64_t cumulative = 0;
+				for ( size_t b = 0; b < BUCKETS; b++ ) {
+					cumulative += e->buckets[b].load( std::memory_order_relaxed );
+					if ( b < BUCKETS - 1 ) {
+						snprintf( number, sizeof( number ), "%g", bucket_bound( b ) );
+					} else {
+						strcpy( number, "+Inf" );
+					}
+					out << name << "_bucket" << labels_with( e->labels, "le=\"" + std::string( number ) + "\"" ) << " " << cumulative << "\n";
+				}
+
+				snprintf( number, sizeof( number ), "%.9f", e->sum.load( std::memory_order_relaxed ) / 1e9 );
+				out << name << "_sum" << labels_with( e->labels, "" ) << " " << number << "\n";
+				out << name << "_count" << labels_with( e->labels, "" ) << " " << e->count.load( std::memory_order_relaxed ) << "\n";
+			}
+		}
+	}
+
+	/*!
+	 * Map segment of another process read only
+	 *
+	 * @param const std::string& name
+	 * @param size_t&            size mapped size, needed for detach
+	 * @return const Header*     nullptr if there is no segment
+	 */
+	const Metrics::Header* Metrics::attach(const std::string& name, size_t& size) {
+		const int fd = shm_open( name.c_str(), O_RDONLY, 0 );
+		if ( fd < 0 ) {
+			return nullptr;
+		}
+
+		struct stat st;
+		if ( fstat( fd, &st ) != 0 || static_cast<size_t>( st.st_size ) < sizeof( Header ) ) {
+			::close( fd );
+			return nullptr;
+		}
+
+		size         = st.st_size;
+		void* mapped = mmap( nullptr, size, PROT_READ, MAP_SHARED, fd, 0 );
+		::close( fd );
+		if ( mapped == MAP_FAILED ) {
+			return nullptr;
+		}
+
+		const Header* header = static_cast<const Header*>( mapped );
+		if ( memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) != 0 || header->version != VERSION || segment_size( header->capacity ) > size ) {
+			munmap( mapped, size );
+			return nullptr;
+		}
+
+		return header;
+	}
+
+	void Metrics::detach(const Header* header, const size_t size) {
+		if ( header != nullptr ) {
+			munmap( const_cast<Header*>( header ), size );
+		}
+	}
+
+	const Metrics::Entry* Metrics::entry(const Header* header, const uint32_t index) {
+		return reinterpret_cast<const Entry*>( header + 1 ) + index;
+	}
+
+	/*!
+	 * Upper bound of a histogram bucket in seconds
+	 *
+	 * @param const size_t index
+	 * @return double
+	 */
+	double Metrics::bucket_bound(const size_t index) {
+		if ( index >= BUCKETS - 1 ) {
+			return std::numeric_limits<double>::infinity();
+		}
+		return std::ldexp( 1e-6, index );
+	}
+};
@@ -0,0 +1,192 @@
+#ifndef IDEFIX_METRICS_H
+#define IDEFIX_METRICS_H
+
+#include <string>
+#include <ostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace IDEFIX {
+	/*!
+	 * In-process registry of counters, gauges and histograms.
+	 *
+	 * All metrics live in one shared memory segment (/dev/shm/idefix.metrics),
+	 * which tools/metrics reads live, and a background thread writes them as
+	 * Prometheus text file. Open the segment before the first metric is
+	 * registered, otherwise the metrics stay in private memory.
+	 *
+	 * Segment: Header | Entry | Entry | ...
+	 *
+	 * Registering takes a lock and is done once, the handles point into the
+	 * segment, updating a counter or gauge is one relaxed atomic add.
+	 * Histograms count durations in ns in buckets of 1us, 2us, 4us ... 16ms
+	 * and +Inf.
+	 */
+	class Metrics {
+	public:
+		static const uint32_t VERSION = 1;
+		static const size_t BUCKETS = 16;
+		static const size_t NAME_SIZE = 48;
+		static const size_t LABELS_SIZE = 80;
+
+		enum Type : uint8_t {
+			COUNTER = 0,
+			GAUGE = 1,
+			HISTOGRAM = 2
+		};
+
+		struct Entry {
+			char name[NAME_SIZE];
+			char labels[LABELS_SIZE];
+			uint8_t type;
+			uint8_t reserved[7];
+			std::atomic<int64_t> value;
+			std::atomic<uint64_t> count;
+			std::atomic<uint64_t> sum;
+			std::atomic<uint64_t> buckets[BUCKETS];
+		};
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t capacity;
+			std::atomic<uint32_t> count;
+			uint32_t pid;
+			int64_t start_ms;
+		};
+
+		class Counter {
+		private:
+			Entry* m_entry;
+		public:
+			Counter(): m_entry( nullptr ) {}
+			explicit Counter(Entry* entry): m_entry( entry ) {}
+
+			inline void inc(const int64_t n = 1) {
+				if ( m_entry != nullptr ) {
+					m_entry->value.fetch_add( n, std::memory_order_relaxed );
+				}
+			}
+		};
+
+		class Gauge {
+		private:
+			Entry* m_entry;
+		public:
+			Gauge(): m_entry( nullptr ) {}
+			explicit Gauge(Entry* entry): m_entry( entry ) {}
+
+			inline void set(const int64_t value) {
+				if ( m_entry != nullptr ) {
+					m_entry->value.store( value, std::memory_order_relaxed );
+				}
+			}
+
+			inline void add(const int64_t n) {
+				if ( m_entry != nullptr ) {
+					m_entry->value.fetch_add( n, std::memory_order_relaxed );
+				}
+			}
+		};
+
+		class Histogram {
+		private:
+			Entry* m_entry;
+		public:
+			Histogram(): m_entry( nullptr ) {}
+			explicit Histogram(Entry* entry): m_entry( entry ) {}
+
+			inline void observe(const uint64_t ns) {
+				if ( m_entry != nullptr ) {
+					m_entry->buckets[Metrics::bucket( ns )].fetch_add( 1, std::memory_order_relaxed );
+					m_entry->count.fetch_add( 1, std::memory_order_relaxed );
+					m_entry->sum.fetch_add( ns, std::memory_order_relaxed );
+				}
+			}
+		};
+
+		/*!
+		 * Observes the time from construction to destruction
+		 */
+		class Timer {
+		private:
+			Histogram& m_histogram;
+			std::chrono::steady_clock::time_point m_start;
+		public:
+			Timer(Histogram& histogram): m_histogram( histogram ), m_start( std::chrono::steady_clock::now() ) {}
+			~Timer() {
+				m_histogram.observe( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - m_start ).count() );
+			}
+		};
+
+		static const char* DEFAULT_NAME;
+		static const uint32_t DEFAULT_CAPACITY = 1024;
+
+		static bool open(const std::string& name = DEFAULT_NAME, const uint32_t capacity = DEFAULT_CAPACITY);
+		static void close();
+
+		static Counter counter(const std::string& name, const std::string& labels = "");
+		static Gauge gauge(const std::string& name, const std::string& labels = "");
+		static Histogram histogram(const std::string& name, const std::string& labels = "");
+		static std::string label(const std::string& key, const std::string& value);
+
+		static void start_writer(const std::string& filename, const int interval_ms = 1000);
+		static void stop_writer();
+		static void write_prometheus(std::ostream& out);
+		static void write_prometheus(std::ostream& out, const Header* header);
+
+		static const Header* attach(const std::string& name, size_t& size);
+		static void detach(const Header* header, const size_t size);
+		static const Entry* entry(const Header* header, const uint32_t index);
+		static double bucket_bound(const size_t index);
+
+		/*!
+		 * Bucket of a duration, bucket i counts durations up to 2^i us
+		 *
+		 * @param const uint64_t ns
+		 * @return size_t
+		 */
+		static inline size_t bucket(const uint64_t ns) {
+			const uint64_t us = ( ns + 999 ) / 1000;
+			if ( us <= 1 ) {
+				return 0;
+			}
+			const size_t index = 64 - __builtin_clzll( us - 1 );
+			return index < BUCKETS - 1 ? index : BUCKETS - 1;
+		}
+
+	private:
+		static Entry* add(const std::string& name, const std::string& labels, const Type type);
+	};
+
+	/*!
+	 * Lock guard which observes the time waiting for the lock and
+	 * the time holding it, works with FIX::Mutex and std::mutex
+	 */
+	template<typename Mutex>
+	class TimedLocker {
+	private:
+		Mutex& m_mutex;
+		Metrics::Histogram& m_hold;
+		std::chrono::steady_clock::time_point m_locked;
+
+	public:
+		TimedLocker(Mutex& mutex, Metrics::Histogram& wait, Metrics::Histogram& hold): m_mutex( mutex ), m_hold( hold ) {
+			const auto start = std::chrono::steady_clock::now();
+			m_mutex.lock();
+			m_locked = std::chrono::steady_clock::now();
+			wait.observe( std::chrono::duration_cast<std::chrono::nanoseconds>( m_locked - start ).count() );
+		}
+
+		~TimedLocker() {
+			m_hold.observe( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - m_locked ).count() );
+			m_mutex.unlock();
+		}
+
+		TimedLocker(const TimedLocker&) = delete;
+		TimedLocker& operator=(const TimedLocker&) = delete;
+	};
+};
+
+#endif
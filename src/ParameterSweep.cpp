@@ -0,0 +1,250 @@
+#include "ParameterSweep.h"
+#include "StringHelper.h"
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+namespace IDEFIX {
+	/*!
+	 * Parse range definition name=from:to:step, name=from:to or name=value
+	 *
+	 * @param const std::string& definition
+	 * @return SweepRange
+	 * @throw IDEFIX::out_of_range if the definition is malformed
+	 */
+	SweepRange SweepRange::parse(const std::string& definition) throw( IDEFIX::out_of_range ) {
+		auto parts = str::explode( definition, '=' );
+		if ( parts.size() != 2 || parts[0].empty() || parts[1].empty() ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		auto values = str::explode( parts[1], ':' );
+		if ( values.empty() || values.size() > 3 ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		SweepRange range;
+		range.name = parts[0];
+		range.from = atof( values[0].c_str() );
+		range.to   = values.size() > 1 ? atof( values[1].c_str() ) : range.from;
+		range.step = values.size() > 2 ? atof( values[2].c_str() ) : 1;
+
+		if ( range.step <= 0 || range.to < range.from ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		return range;
+	}
+
+	ParameterSweep::ParameterSweep(const std::string& symbol, const AwesomeStrategyConfig& config, const double point_size)
+	: m_symbol( symbol ), m_config( config ), m_point_size( point_size ), m_prune_drawdown(0), m_prune_checkpoint(0) {}
+
+	/*!
+	 * Add parameter range
+	 *
+	 * @param const SweepRange& range
+	 * @throw IDEFIX::out_of_range if the parameter name is unknown
+	 */
+	void ParameterSweep::add_range(const SweepRange& range) throw( IDEFIX::out_of_range ) {
+		AwesomeStrategyConfig test;
+		if ( ! set_value( test, range.name, range.from ) ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		m_ranges.push_back( range );
+	}
+
+	/*!
+	 * Prune runs, see BacktestEngine::set_pruning
+	 *
+	 * @param const double max_drawdown
+	 * @param const double checkpoint
+	 */
+	void ParameterSweep::set_pruning(const double max_drawdown, const double checkpoint) {
+		m_prune_drawdown   = max_drawdown;
+		m_prune_checkpoint = checkpoint;
+	}
+
+	/*!
+	 * Set strategy parameter by cfg name
+	 *
+	 * @param AwesomeStrategyConfig& config
+	 * @param const std::string&     name
+	 * @param const double           value
+	 * @return bool false if the name is unknown
+	 */
+	bool ParameterSweep::set_value(AwesomeStrategyConfig& config, const std::string& name, const double value) {
+		if ( name == "renko_size" ) {
+			config.renko_size = value;
+		} else if ( name == "sma_size" ) {
+			config.sma_size = static_cast<int>( value );
+		} else if ( name == "wait_bricks" ) {
+			config.wait_bricks = static_cast<int>( value );
+		} else if ( name == "max_pip_risk" ) {
+			config.max_pip_risk = static_cast<int>( value );
+		} else if ( name == "max_spread" ) {
+			config.max_spread = value;
+		} else if ( name == "max_long_pos" ) {
+			config.max_long_pos = static_cast<int>( value );
+		} else if ( name == "max_short_pos" ) {
+			config.max_short_pos = static_cast<int>( value );
+		} else {
+			return false;
+		}
+
+		return true;
+	}
+
+	/*!
+	 * All parameter combinations
+	 *
+	 * @return std::vector<AwesomeStrategyConfig>
+	 */
+	std::vector<AwesomeStrategyConfig> ParameterSweep::combinations() const {
+		std::vector<AwesomeStrategyConfig> result( 1, m_config );
+
+		for ( auto& range : m_ranges ) {
+			std::vector<AwesomeStrategyConfig> next;
+			// small epsilon, 0.1 steps do not add up exactly
+			for ( double value = range.from; value <= range.to + range.step * 1e-9; value += range.step ) {
+				for ( auto config : result ) {
+					set_value( config, range.name, value );
+					next.push_back( config );
+				}
+			}
+			result.swap( next );
+		}
+
+		return result;
+	}
+
+	/*!
+	 * Run all combinations in parallel
+	 *
+	 * @param const std::vector<TickRecord>& ticks   shared by all threads
+	 * @param unsigned int                   threads 0 = all cores
+	 * @return std::vector<SweepResult> ranked, best first
+	 */
+	std::vector<SweepResult> ParameterSweep::run(const std::vector<TickRecord>& ticks, unsigned int threads) {
+		auto configs = combinations();
+
+		std::vector<SweepResult> results( configs.size() );
+		if ( configs.empty() ) {
+			return results;
+		}
+
+		if ( threads == 0 ) {
+			threads = std::max( 1u, std::thread::hardware_concurrency() );
+		}
+		threads = std::min<unsigned int>( threads, configs.size() );
+
+		// the strategies log to console, create it before the threads start
+		BacktestEngine::init_console( false );
+
+		// one job queue per thread, round robin
+		struct Queue {
+			std::mutex mutex;
+			std::deque<size_t> jobs;
+		};
+		std::vector<Queue> queues( threads );
+		for ( size_t i = 0; i < configs.size(); i++ ) {
+			queues[ i % threads ].jobs.push_back( i );
+		}
+
+		auto worker = [&](const unsigned int id) {
+			while ( true ) {
+				size_t job   = 0;
+				bool has_job = false;
+
+				// own queue from the back
+				{
+					std::lock_guard<std::mutex> lock( queues[id].mutex );
+					if ( ! queues[id].jobs.empty() ) {
+						job = queues[id].jobs.back();
+						queues[id].jobs.pop_back();
+						has_job = true;
+					}
+				}
+
+				// steal from the front of the other queues
+				for ( unsigned int i = 1; ! has_job && i < threads; i++ ) {
+					Queue& victim = queues[ ( id + i ) % threads ];
+					std::lock_guard<std::mutex> lock( victim.mutex );
+					if ( ! victim.jobs.empty() ) {
+						job = victim.jobs.front();
+						victim.jobs.pop_front();
+						has_job = true;
+					}
+				}
+
+				if ( ! has_job ) {
+					return;
+				}
+
+				BacktestEngine engine( m_symbol, configs[job], m_point_size );
+				engine.set_pruning( m_prune_drawdown, m_prune_checkpoint );
+
+				results[job].config = configs[job];
+				results[job].result = engine.run( ticks );
+			}
+		};
+
+		std::vector<std::thread> pool;
+		for ( unsigned int i = 0; i < threads; i++ ) {
+			pool.push_back( std::thread( worker, i ) );
+		}
+		for ( auto& t : pool ) {
+			t.join();
+		}
+
+		sort( results );
+
+		return results;
+	}
+
+	/*!
+	 * Rank results, finished runs by profit and loss, pruned runs last
+	 *
+	 * @param std::vector<SweepResult>& results
+	 */
+	void ParameterSweep::sort(std::vector<SweepResult>& results) {
+		std::stable_sort( results.begin(), results.end(), [](const SweepResult& l, const SweepResult& r) {
+			if ( l.result.pruned != r.result.pruned ) {
+				return ! l.result.pruned;
+			}
+			return l.result.profit_loss > r.result.profit_loss;
+		});
+	}
+
+	/*!
+	 * Write ranked results table
+	 *
+	 * @param const std::string&              filename
+	 * @param const std::vector<SweepResult>& results
+	 */
+	void ParameterSweep::write_csv(const std::string& filename, const std::vector<SweepResult>& results) {
+		std::ofstream file( filename.c_str(), std::ios::out | std::ios::trunc );
+		if ( ! file.good() ) {
+			return;
+		}
+
+		file << "rank,renko_size,sma_size,wait_bricks,max_pip_risk,max_spread,max_long_pos,max_short_pos,"
+			 << "trades,wins,profit_loss,max_drawdown,bars,ticks,pruned" << std::endl;
+
+		int rank = 1;
+		for ( auto& r : results ) {
+			file << rank++ << ","
+				 << r.config.renko_size << "," << r.config.sma_size << "," << r.config.wait_bricks << ","
+				 << r.config.max_pip_risk << "," << r.config.max_spread << ","
+				 << r.config.max_long_pos << "," << r.config.max_short_pos << ","
+				 << r.result.trades << "," << r.result.wins << ","
+				 << r.result.profit_loss << "," << r.result.max_drawdown << ","
+				 << r.result.bars << "," << r.result.ticks << ","
+				 << ( r.result.pruned ? 1 : 0 ) << std::endl;
+		}
+	}
+};
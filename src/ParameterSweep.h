@@ -0,0 +1,59 @@
+#ifndef IDEFIX_PARAMETERSWEEP_H
+#define IDEFIX_PARAMETERSWEEP_H
+
+#include <string>
+#include <vector>
+#include "TickRecord.h"
+#include "BacktestEngine.h"
+#include "AwesomeStrategy.h"
+#include "Exceptions.h"
+
+namespace IDEFIX {
+	/*!
+	 * Parameter range like renko_size=5:20:5 (from:to:step) or sma_size=3
+	 */
+	struct SweepRange {
+		std::string name;
+		double from;
+		double to;
+		double step;
+
+		static SweepRange parse(const std::string& definition) throw( IDEFIX::out_of_range );
+	};
+
+	struct SweepResult {
+		AwesomeStrategyConfig config;
+		BacktestResult result;
+	};
+
+	/*!
+	 * Runs a backtest for every combination of the parameter ranges.
+	 * The ticks are shared read only by all threads, every thread owns a
+	 * queue of jobs and steals from the others when its queue is empty.
+	 */
+	class ParameterSweep {
+	private:
+		std::string m_symbol;
+		AwesomeStrategyConfig m_config;
+		double m_point_size;
+		std::vector<SweepRange> m_ranges;
+
+		double m_prune_drawdown;
+		double m_prune_checkpoint;
+
+	public:
+		ParameterSweep(const std::string& symbol, const AwesomeStrategyConfig& config, const double point_size = 0.0001);
+
+		void add_range(const SweepRange& range) throw( IDEFIX::out_of_range );
+		void set_pruning(const double max_drawdown, const double checkpoint = 0.5);
+
+		std::vector<AwesomeStrategyConfig> combinations() const;
+		std::vector<SweepResult> run(const std::vector<TickRecord>& ticks, unsigned int threads = 0);
+
+		static bool set_value(AwesomeStrategyConfig& config, const std::string& name, const double value);
+		static void sort(std::vector<SweepResult>& results);
+		static void write_csv(const std::string& filename, const std::vector<SweepResult>& results);
+	};
+};
+
+#endif
@@ -2,39 +2,46 @@
 #define IDEFIX_RENKO_CHART_H
 
 #include <vector>
-#include "RenkoBrick.h"
+#include "Bar.h"
+#include "BarPipeline.h"
 #include "MarketSnapshot.h"
 #include "Exceptions.h"
+#include "FastSignal.h"
 #include <quickfix/Mutex.h>
 #include <nod/nod.hpp>
 
 namespace IDEFIX {
+	/*!
+	 * Renko chart on top of BarPipeline.
+	 * Either owns a pipeline or registers its RenkoBarBuilder in a shared one,
+	 * in that case the ticks are fed to the shared pipeline and not to the chart.
+	 * The bricks live in the BarStore ring of the pipeline, only the last 4096
+	 * bricks are kept by default. brick_count() counts all bricks, but at(i)
+	 * throws IDEFIX::element_not_found for older bricks.
+	 */
 	class RenkoChart {
 	private:
-		FIX::Mutex m_mutex;
-		double m_period;
-		std::vector<RenkoBrick> m_bricks;
+		BarPipeline* m_pipeline;
+		bool m_owns_pipeline;
+		AbstractBarBuilder* m_builder;
+		nod::scoped_connection m_connection;
 
-		RenkoBrick m_current_brick;
-		RenkoBrick m_last_brick;
-		RenkoBrick m_init_brick;
+		void init(const double period);
 
 	public:
 		RenkoChart();
 		RenkoChart(const double period);
+		RenkoChart(BarPipeline& pipeline, const double period);
 		~RenkoChart();
 
 		void on_tick(const MarketSnapshot& tick);
-		std::vector<RenkoBrick> brick_list();
+		std::vector<Bar> brick_list();
 		int brick_count();
-		RenkoBrick at(const int index) throw( IDEFIX::out_of_range, IDEFIX::element_not_found );
+		Bar at(const int index) throw( IDEFIX::out_of_range, IDEFIX::element_not_found );
 
 		// signals
-		nod::signal<void(const RenkoBrick&)> on_brick;
-
-	private:
-		bool init_brick(const MarketSnapshot& tick);
+		FastSignal<const Bar&> on_brick;
 	};
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,632 @@
+#include "SimulatedBroker.h"
+#include "TimeHelper.h"
+#include "Console.h"
+#include <quickfix/FieldConvertors.h>
+
+namespace IDEFIX {
+	SimulatedBroker::SimulatedBroker(FIXManager& manager, const std::string& account_id, const double balance, const std::string& currency)
+	: m_manager( &manager ), m_session( "FIX.4.4", "IDEFIX", "FXCM" ), m_account_id( account_id ), m_currency( currency ),
+	  m_balance( balance ), m_time_ms(0), m_next_id(1000000), m_started(false), m_trades(0), m_wins(0), m_profit_loss(0) {}
+
+	SimulatedBroker::SimulatedBroker(Reply reply, const std::string& account_id, const double balance, const std::string& currency)
+	: m_manager( nullptr ), m_reply( reply ), m_session( "FIX.4.4", "IDEFIX", "FXCM" ), m_account_id( account_id ), m_currency( currency ),
+	  m_balance( balance ), m_time_ms(0), m_next_id(1000000), m_started(false), m_trades(0), m_wins(0), m_profit_loss(0) {}
+
+	SimulatedBroker::~SimulatedBroker() {
+		stop();
+	}
+
+	/*!
+	 * Add tradeable symbol, must be called before start
+	 *
+	 * @param const std::string& symbol     like EUR/USD
+	 * @param const double       point_size
+	 * @param const int          precision
+	 */
+	void SimulatedBroker::add_symbol(const std::string& symbol, const double point_size, const int precision) {
+		if ( find_symbol( symbol ) != nullptr ) {
+			return;
+		}
+
+		Symbol s;
+		s.name       = symbol;
+		s.point_size = point_size;
+		s.precision  = precision;
+		s.bid        = 0;
+		s.ask        = 0;
+		s.subscribed = false;
+		m_symbols.push_back( s );
+	}
+
+	/*!
+	 * Attach to FIXManager and run the logon sequence:
+	 * TradingSessionStatus, CollateralReport and position reports.
+	 * Without FIXManager the client sends the requests itself.
+	 */
+	void SimulatedBroker::start() {
+		if ( m_started ) {
+			return;
+		}
+
+		m_started = true;
+		if ( m_manager == nullptr ) {
+			return;
+		}
+
+		m_manager->setOutbound( [this](const FIX::Message& message) {
+			on_message( message );
+		});
+
+		send_trading_session_status();
+		process();
+	}
+
+	/*!
+	 * Detach from FIXManager, outgoing messages go to the session again
+	 */
+	void SimulatedBroker::stop() {
+		if ( ! m_started ) {
+			return;
+		}
+
+		if ( m_manager != nullptr ) {
+			m_manager->setOutbound( nullptr );
+		}
+		m_started = false;
+	}
+
+	/*!
+	 * Outbound hook of FIXManager, requests are queued
+	 *
+	 * @param const FIX::Message& message
+	 */
+	void SimulatedBroker::on_message(const FIX::Message& message) {
+		m_requests.push_back( message );
+	}
+
+	/*!
+	 * Handle all queued requests, including the requests sent
+	 * by FIXManager while handling the replies.
+	 */
+	void SimulatedBroker::process() {
+		while ( ! m_requests.empty() ) {
+			FIX::Message request = m_requests.front();
+			m_requests.pop_front();
+			handle( request );
+		}
+	}
+
+	/*!
+	 * New price for symbol: handle queued requests at this price,
+	 * fill stop and limit orders and send the snapshot.
+	 *
+	 * @param const std::string& symbol
+	 * @param const TickRecord&  tick
+	 */
+	void SimulatedBroker::on_tick(const std::string& symbol, const TickRecord& tick) {
+		Symbol* s = find_symbol( symbol );
+		if ( s == nullptr ) {
+			return;
+		}
+
+		m_time_ms = tick.time_ms;
+		s->bid    = tick.bid;
+		s->ask    = tick.ask;
+
+		process();
+		check_orders( *s );
+
+		if ( s->subscribed ) {
+			send_snapshot( *s );
+		}
+	}
+
+	/*!
+	 * Replay ticks of one symbol
+	 *
+	 * @param const std::string&             symbol
+	 * @param const std::vector<TickRecord>& ticks
+	 */
+	void SimulatedBroker::replay(const std::string& symbol, const std::vector<TickRecord>& ticks) {
+		for ( auto& tick : ticks ) {
+			on_tick( symbol, tick );
+		}
+		process();
+	}
+
+	/*!
+	 * Answer one request like FXCM
+	 *
+	 * @param const FIX::Message& request
+	 */
+	void SimulatedBroker::handle(const FIX::Message& request) {
+		const std::string msg_type = request.getHeader().getField( FIX::FIELD::MsgType );
+
+		try {
+			if ( msg_type == FIX::MsgType_TradingSessionStatusRequest ) {
+				send_trading_session_status();
+			}
+			else if ( msg_type == FIX::MsgType_CollateralInquiry ) {
+				send_collateral_report();
+			}
+			else if ( msg_type == FIX::MsgType_RequestForPositions ) {
+				send_position_reports();
+			}
+			else if ( msg_type == FIX::MsgType_OrderMassStatusRequest ) {
+				send_order_status();
+			}
+			else if ( msg_type == FIX::MsgType_MarketDataRequest ) {
+				FIX44::MarketDataRequest::NoRelatedSym group;
+				request.getGroup( 1, group );
+
+				Symbol* s = find_symbol( group.getField( FIX::FIELD::Symbol ) );
+				if ( s == nullptr ) {
+					FIX44::MarketDataRequestReject reject;
+					reject.setField( FIX::MDReqID( request.getField( FIX::FIELD::MDReqID ) ) );
+					reject.setField( FIX::Text( "Unknown symbol " + group.getField( FIX::FIELD::Symbol ) ) );
+					deliver( reject );
+					return;
+				}
+
+				s->subscribed = request.getField( FIX::FIELD::SubscriptionRequestType )[0] == FIX::SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES;
+				if ( s->subscribed && s->bid > 0 ) {
+					send_snapshot( *s );
+				}
+			}
+			else if ( msg_type == FIX::MsgType_NewOrderSingle ) {
+				const char ord_type = request.getField( FIX::FIELD::OrdType )[0];
+
+				// order for an existing position: close or set stop
+				if ( request.isSetField( FXCM_FIX_FIELDS::FXCM_POS_ID ) ) {
+					const std::string pos_id = request.getField( FXCM_FIX_FIELDS::FXCM_POS_ID );
+
+					size_t index = 0;
+					while ( index < m_positions.size() && m_positions[index].pos_id != pos_id ) {
+						index++;
+					}
+					if ( index == m_positions.size() ) {
+						reject( request, "Position not found " + pos_id );
+						return;
+					}
+
+					Position& position = m_positions[index];
+					if ( ord_type == FIX::OrdType_STOP ) {
+						position.stop_price   = FIX::DoubleConvertor::convert( request.getField( FIX::FIELD::StopPx ) );
+						position.stop_clordid = request.getField( FIX::FIELD::ClOrdID );
+						send_execution_report( position, FIX::ExecType_NEW, FIX::OrdStatus_NEW, FIX::OrdType_STOP, request.getField( FIX::FIELD::Side )[0], position.stop_price, position.stop_clordid );
+					} else {
+						const Symbol* s = find_symbol( position.symbol );
+						close_position( index, FIX::OrdType_MARKET, position.side == FIX::Side_BUY ? s->bid : s->ask, request.getField( FIX::FIELD::ClOrdID ) );
+					}
+				}
+				else if ( ord_type == FIX::OrdType_MARKET ) {
+					open_position( request, 0, "", 0, "" );
+				}
+				else {
+					reject( request, "Only market orders and orders with FXCM_POS_ID are supported." );
+				}
+			}
+			else if ( msg_type == FIX::MsgType_NewOrderList ) {
+				const int count = request.groupCount( FIX::FIELD::NoOrders );
+
+				FIX44::NewOrderList::NoOrders entry;
+				double stop_price  = 0;
+				double limit_price = 0;
+				std::string stop_clordid;
+				std::string limit_clordid;
+				bool has_entry = false;
+
+				for ( int i = 1; i <= count; i++ ) {
+					FIX44::NewOrderList::NoOrders leg;
+					request.getGroup( i, leg );
+
+					const char ord_type = leg.getField( FIX::FIELD::OrdType )[0];
+					if ( ord_type == FIX::OrdType_MARKET ) {
+						entry     = leg;
+						has_entry = true;
+					} else if ( ord_type == FIX::OrdType_STOP ) {
+						stop_price   = FIX::DoubleConvertor::convert( leg.getField( FIX::FIELD::StopPx ) );
+						stop_clordid = leg.getField( FIX::FIELD::ClOrdID );
+					} else if ( ord_type == FIX::OrdType_LIMIT ) {
+						limit_price   = FIX::DoubleConvertor::convert( leg.getField( FIX::FIELD::Price ) );
+						limit_clordid = leg.getField( FIX::FIELD::ClOrdID );
+					}
+				}
+
+				if ( has_entry ) {
+					open_position( entry, stop_price, stop_clordid, limit_price, limit_clordid );
+				}
+			}
+		} catch ( FIX::Exception& e ) {
+			console()->error( "[SimulatedBroker] {} {}", msg_type, e.what() );
+		}
+	}
+
+	/*!
+	 * Pass reply to FIXManager like a message from FXCM
+	 * or to the reply function
+	 *
+	 * @param FIX::Message& reply
+	 */
+	void SimulatedBroker::deliver(FIX::Message& reply) {
+		reply.getHeader().setField( FIX::FIELD::SendingTime, sending_time() );
+
+		if ( m_manager == nullptr ) {
+			m_reply( reply );
+			return;
+		}
+
+		try {
+			m_manager->fromApp( reply, m_session );
+		} catch ( FIX::Exception& e ) {
+			console()->error( "[SimulatedBroker] deliver {}", e.what() );
+		}
+	}
+
+	/*!
+	 * Fill stop and limit legs crossed by the current price
+	 *
+	 * @param const Symbol& symbol
+	 */
+	void SimulatedBroker::check_orders(const Symbol& symbol) {
+		for ( size_t i = m_positions.size(); i > 0; i-- ) {
+			const Position& p = m_positions[i - 1];
+			if ( p.symbol != symbol.name ) {
+				continue;
+			}
+
+			// long positions close at bid, short positions at ask
+			const double price = p.side == FIX::Side_BUY ? symbol.bid : symbol.ask;
+			const bool stop_hit  = p.stop_price > 0 && ( p.side == FIX::Side_BUY ? price <= p.stop_price : price >= p.stop_price );
+			const bool limit_hit = p.limit_price > 0 && ( p.side == FIX::Side_BUY ? price >= p.limit_price : price <= p.limit_price );
+
+			if ( stop_hit ) {
+				close_position( i - 1, FIX::OrdType_STOP, price, p.stop_clordid );
+			} else if ( limit_hit ) {
+				close_position( i - 1, FIX::OrdType_LIMIT, price, p.limit_clordid );
+			}
+		}
+	}
+
+	/*!
+	 * Fill market order at bid or ask and place the stop and limit legs
+	 *
+	 * @param const FIX::FieldMap& order  NewOrderSingle or the market leg of a NewOrderList
+	 * @param const double         stop_price
+	 * @param const std::string&   stop_clordid
+	 * @param const double         limit_price
+	 * @param const std::string&   limit_clordid
+	 */
+	void SimulatedBroker::open_position(const FIX::FieldMap& order, const double stop_price, const std::string& stop_clordid, const double limit_price, const std::string& limit_clordid) {
+		const Symbol* s = find_symbol( order.getField( FIX::FIELD::Symbol ) );
+		if ( s == nullptr || s->bid <= 0 ) {
+			reject( order, "No price for symbol." );
+			return;
+		}
+
+		Position p;
+		p.pos_id        = next_id();
+		p.order_id      = next_id();
+		p.symbol        = s->name;
+		p.side          = order.getField( FIX::FIELD::Side )[0];
+		p.qty           = FIX::DoubleConvertor::convert( order.getField( FIX::FIELD::OrderQty ) );
+		p.price         = p.side == FIX::Side_BUY ? s->ask : s->bid;
+		p.open_time     = sending_time();
+		p.clordid       = order.getField( FIX::FIELD::ClOrdID );
+		p.stop_price    = stop_price;
+		p.stop_clordid  = stop_clordid;
+		p.limit_price   = limit_price;
+		p.limit_clordid = limit_clordid;
+
+		m_positions.push_back( p );
+
+		const char opposide = p.side == FIX::Side_BUY ? FIX::Side_SELL : FIX::Side_BUY;
+		send_execution_report( p, FIX::ExecType_TRADE, FIX::OrdStatus_FILLED, FIX::OrdType_MARKET, p.side, p.price, p.clordid );
+		if ( p.stop_price > 0 ) {
+			send_execution_report( p, FIX::ExecType_NEW, FIX::OrdStatus_NEW, FIX::OrdType_STOP, opposide, p.stop_price, p.stop_clordid );
+		}
+		if ( p.limit_price > 0 ) {
+			send_execution_report( p, FIX::ExecType_NEW, FIX::OrdStatus_NEW, FIX::OrdType_LIMIT, opposide, p.limit_price, p.limit_clordid );
+		}
+	}
+
+	/*!
+	 * Close position, the remaining stop or limit leg is canceled (OCO)
+	 *
+	 * @param const size_t       index
+	 * @param const char         ord_type  OrdType of the closing order
+	 * @param const double       price
+	 * @param const std::string  clordid   by value, the stop and limit ids of the erased position are passed in
+	 */
+	void SimulatedBroker::close_position(const size_t index, const char ord_type, const double price, const std::string clordid) {
+		const Position p = m_positions[index];
+		m_positions.erase( m_positions.begin() + index );
+
+		// profit and loss in quote currency
+		const double pl = ( p.side == FIX::Side_BUY ? price - p.price : p.price - price ) * p.qty;
+		m_balance     += pl;
+		m_profit_loss += pl;
+		m_trades++;
+		if ( pl > 0 ) {
+			m_wins++;
+		}
+
+		const char opposide = p.side == FIX::Side_BUY ? FIX::Side_SELL : FIX::Side_BUY;
+		send_execution_report( p, FIX::ExecType_TRADE, FIX::OrdStatus_FILLED, ord_type, opposide, price, clordid );
+
+		if ( p.stop_price > 0 && ord_type != FIX::OrdType_STOP ) {
+			send_execution_report( p, FIX::ExecType_CANCELED, FIX::OrdStatus_CANCELED, FIX::OrdType_STOP, opposide, p.stop_price, p.stop_clordid );
+		}
+		if ( p.limit_price > 0 && ord_type != FIX::OrdType_LIMIT ) {
+			send_execution_report( p, FIX::ExecType_CANCELED, FIX::OrdStatus_CANCELED, FIX::OrdType_LIMIT, opposide, p.limit_price, p.limit_clordid );
+		}
+		// FIXManager removes a position on the fill of its stop or limit or on the cancel
+		// of its orders, a market close of a position without them is a cancel as well
+		if ( ord_type == FIX::OrdType_MARKET && p.stop_price <= 0 && p.limit_price <= 0 ) {
+			send_execution_report( p, FIX::ExecType_CANCELED, FIX::OrdStatus_CANCELED, FIX::OrdType_MARKET, opposide, price, clordid );
+		}
+	}
+
+	/*!
+	 * Rejected order, FXCM_POS_ID is empty so FIXManager skips it
+	 *
+	 * @param const FIX::FieldMap& order
+	 * @param const std::string&   text
+	 */
+	void SimulatedBroker::reject(const FIX::FieldMap& order, const std::string& text) {
+		FIX44::ExecutionReport er;
+		er.setField( FIX::OrderID( "NONE" ) );
+		er.setField( FIX::ExecID( next_id() ) );
+		er.setField( FIX::ExecType( FIX::ExecType_REJECTED ) );
+		er.setField( FIX::OrdStatus( FIX::OrdStatus_REJECTED ) );
+		er.setField( FIX::OrdType( order.isSetField( FIX::FIELD::OrdType ) ? order.getField( FIX::FIELD::OrdType )[0] : FIX::OrdType_MARKET ) );
+		er.setField( FIX::ClOrdID( order.isSetField( FIX::FIELD::ClOrdID ) ? order.getField( FIX::FIELD::ClOrdID ) : "" ) );
+		er.setField( FIX::Side( order.isSetField( FIX::FIELD::Side ) ? order.getField( FIX::FIELD::Side )[0] : FIX::Side_BUY ) );
+		er.setField( FIX::Symbol( order.isSetField( FIX::FIELD::Symbol ) ? order.getField( FIX::FIELD::Symbol ) : "" ) );
+		er.setField( FIX::Account( m_account_id ) );
+		er.setField( FIX::LastQty( 0 ) );
+		er.setField( FIX::LastPx( 0 ) );
+		er.setField( FIX::CumQty( 0 ) );
+		er.setField( FIX::LeavesQty( 0 ) );
+		er.setField( FIX::AvgPx( 0 ) );
+		er.setField( FIX::Text( text ) );
+		er.setField( FXCM_FIX_FIELDS::FXCM_POS_ID, "" );
+		deliver( er );
+	}
+
+	/*!
+	 * Market status, security list and system parameters
+	 */
+	void SimulatedBroker::send_trading_session_status() {
+		FIX44::TradingSessionStatus tss;
+		tss.setField( FIX::TradingSessionID( "FXCM" ) );
+		tss.setField( FIX::TradSesStatus( FIX::TradSesStatus_OPEN ) );
+
+		for ( size_t i = 0; i < m_symbols.size(); i++ ) {
+			const Symbol& s = m_symbols[i];
+
+			FIX44::SecurityList::NoRelatedSym group;
+			group.setField( FIX::Symbol( s.name ) );
+			group.setField( FIX::Currency( s.name.substr( 0, 3 ) ) );
+			group.setField( FIX::Factor( 1 ) );
+			group.setField( FIX::ContractMultiplier( 1 ) );
+			group.setField( FIX::Product( FIX::Product_CURRENCY ) );
+			group.setField( FIX::RoundLot( 1000 ) );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SYM_ID, FIX::IntConvertor::convert( i + 1 ) );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SYM_PRECISION, FIX::IntConvertor::convert( s.precision ) );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SYM_POINT_SIZE, FIX::DoubleConvertor::convert( s.point_size ) );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SYM_INTEREST_BUY, "0" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SYM_INTEREST_SELL, "0" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SYM_SORT_ORDER, FIX::IntConvertor::convert( i + 1 ) );
+			group.setField( FXCM_FIX_FIELDS::FXCM_SUBSCRIPTION_STATUS, "T" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_FIELD_PRODUCT_ID, "1" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_COND_DIST_STOP, "0" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_COND_DIST_LIMIT, "0" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_COND_DIST_ENTRY_STOP, "0" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_COND_DIST_ENTRY_LIMIT, "0" );
+			group.setField( FXCM_FIX_FIELDS::FXCM_TRADING_STATUS, "O" );
+			tss.addGroup( group );
+		}
+
+		FIX::Group param( FXCM_FIX_FIELDS::FXCM_NO_PARAMS, FXCM_FIX_FIELDS::FXCM_PARAM_NAME );
+		param.setField( FXCM_FIX_FIELDS::FXCM_PARAM_NAME, "BASE_CRNCY" );
+		param.setField( FXCM_FIX_FIELDS::FXCM_PARAM_VALUE, m_currency );
+		tss.addGroup( param );
+		param.setField( FXCM_FIX_FIELDS::FXCM_PARAM_NAME, "SERVER_TIME_ZONE" );
+		param.setField( FXCM_FIX_FIELDS::FXCM_PARAM_VALUE, "UTC" );
+		tss.addGroup( param );
+
+		deliver( tss );
+	}
+
+	/*!
+	 * Account balance
+	 */
+	void SimulatedBroker::send_collateral_report() {
+		FIX44::CollateralReport cr;
+		cr.setField( FIX::CollRptID( next_id() ) );
+		cr.setField( FIX::CollStatus( FIX::CollStatus_ASSIGNED ) );
+		cr.setField( FIX::Account( m_account_id ) );
+		cr.setField( FIX::CashOutstanding( m_balance ) );
+		cr.setField( FIX::MarginRatio( 0 ) );
+		cr.setField( FIX::Quantity( 1000 ) );
+		cr.setField( FXCM_FIX_FIELDS::FXCM_USED_MARGIN, "0" );
+
+		FIX44::CollateralReport::NoPartyIDs party;
+		party.setField( FIX::PartyID( "FXCM ID" ) );
+		party.setField( FIX::PartyIDSource( 'D' ) );
+		party.setField( FIX::PartyRole( 3 ) );
+
+		FIX44::CollateralReport::NoPartyIDs::NoPartySubIDs sub;
+		sub.setField( FIX::PartySubIDType( 4000 ) );
+		sub.setField( FIX::PartySubID( "0" ) );
+		party.addGroup( sub );
+		sub.setField( FIX::PartySubIDType( 2 ) );
+		sub.setField( FIX::PartySubID( m_account_id ) );
+		party.addGroup( sub );
+		sub.setField( FIX::PartySubIDType( 22 ) );
+		sub.setField( FIX::PartySubID( "Simulated" ) );
+		party.addGroup( sub );
+
+		cr.addGroup( party );
+		deliver( cr );
+	}
+
+	/*!
+	 * PositionReport for every open position or
+	 * RequestForPositionsAck if there is none
+	 */
+	void SimulatedBroker::send_position_reports() {
+		if ( m_positions.empty() ) {
+			FIX44::RequestForPositionsAck ack;
+			ack.setField( FIX::PosMaintRptID( next_id() ) );
+			ack.setField( FIX::PosReqStatus( FIX::PosReqStatus_REJECTED ) );
+			ack.setField( FIX::PosReqResult( FIX::PosReqResult_NO_POSITIONS_FOUND_THAT_MATCH_CRITERIA ) );
+			ack.setField( FIX::Account( m_account_id ) );
+			ack.setField( FIX::Text( "No positions found" ) );
+			deliver( ack );
+			return;
+		}
+
+		// copy, FIXManager may send requests while handling the reports
+		const std::vector<Position> positions = m_positions;
+		for ( auto& p : positions ) {
+			FIX44::PositionReport pr;
+			pr.setField( FIX::PosMaintRptID( next_id() ) );
+			pr.setField( FIX::PosReqType( FIX::PosReqType_POSITIONS ) );
+			pr.setField( FIX::Account( m_account_id ) );
+			pr.setField( FIX::Symbol( p.symbol ) );
+			pr.setField( FIX::SettlPrice( p.price ) );
+			pr.setField( FIX::ClOrdID( p.clordid ) );
+			pr.setField( FIX::OrderID( p.order_id ) );
+			pr.setField( FXCM_FIX_FIELDS::FXCM_POS_ID, p.pos_id );
+			pr.setField( FXCM_FIX_FIELDS::FXCM_POS_OPEN_TIME, p.open_time );
+
+			FIX44::PositionReport::NoPositions group;
+			if ( p.side == FIX::Side_BUY ) {
+				group.setField( FIX::LongQty( p.qty ) );
+			} else {
+				group.setField( FIX::ShortQty( p.qty ) );
+			}
+			pr.addGroup( group );
+
+			deliver( pr );
+		}
+	}
+
+	/*!
+	 * Order status of all stop and limit legs, answer to OrderMassStatusRequest
+	 */
+	void SimulatedBroker::send_order_status() {
+		const std::vector<Position> positions = m_positions;
+		for ( auto& p : positions ) {
+			const char opposide = p.side == FIX::Side_BUY ? FIX::Side_SELL : FIX::Side_BUY;
+			if ( p.stop_price > 0 ) {
+				send_execution_report( p, FIX::ExecType_NEW, FIX::OrdStatus_NEW, FIX::OrdType_STOP, opposide, p.stop_price, p.stop_clordid );
+			}
+			if ( p.limit_price > 0 ) {
+				send_execution_report( p, FIX::ExecType_NEW, FIX::OrdStatus_NEW, FIX::OrdType_LIMIT, opposide, p.limit_price, p.limit_clordid );
+			}
+		}
+	}
+
+	/*!
+	 * Bid and ask of symbol
+	 *
+	 * @param const Symbol& symbol
+	 */
+	void SimulatedBroker::send_snapshot(const Symbol& symbol) {
+		FIX44::MarketDataSnapshotFullRefresh mds;
+		mds.setField( FIX::MDReqID( "Request_" + symbol.name ) );
+		mds.setField( FIX::Symbol( symbol.name ) );
+
+		FIX44::MarketDataSnapshotFullRefresh::NoMDEntries entry;
+		entry.setField( FIX::MDEntryType( FIX::MDEntryType_BID ) );
+		entry.setField( FIX::MDEntryPx( symbol.bid ) );
+		mds.addGroup( entry );
+		entry.setField( FIX::MDEntryType( FIX::MDEntryType_OFFER ) );
+		entry.setField( FIX::MDEntryPx( symbol.ask ) );
+		mds.addGroup( entry );
+
+		deliver( mds );
+	}
+
+	/*!
+	 * ExecutionReport for a position in the shape FXCM sends it,
+	 * the price of stop and limit orders is in LastPx.
+	 *
+	 * @param const Position&    position
+	 * @param const char         exec_type
+	 * @param const char         ord_status
+	 * @param const char         ord_type
+	 * @param const char         side
+	 * @param const double       price
+	 * @param const std::string& clordid
+	 */
+	void SimulatedBroker::send_execution_report(const Position& position, const char exec_type, const char ord_status, const char ord_type, const char side, const double price, const std::string& clordid) {
+		const bool filled = ord_status == FIX::OrdStatus_FILLED;
+
+		FIX44::ExecutionReport er;
+		er.setField( FIX::OrderID( position.order_id ) );
+		er.setField( FIX::ExecID( next_id() ) );
+		er.setField( FIX::ExecType( exec_type ) );
+		er.setField( FIX::OrdStatus( ord_status ) );
+		er.setField( FIX::OrdType( ord_type ) );
+		er.setField( FIX::ClOrdID( clordid ) );
+		er.setField( FIX::Side( side ) );
+		er.setField( FIX::Symbol( position.symbol ) );
+		er.setField( FIX::Account( m_account_id ) );
+		er.setField( FIX::OrderQty( position.qty ) );
+		er.setField( FIX::LastQty( position.qty ) );
+		er.setField( FIX::LastPx( price ) );
+		er.setField( FIX::CumQty( filled ? position.qty : 0 ) );
+		er.setField( FIX::LeavesQty( filled ? 0 : position.qty ) );
+		er.setField( FIX::AvgPx( filled ? price : 0 ) );
+		er.setField( FXCM_FIX_FIELDS::FXCM_POS_ID, position.pos_id );
+		deliver( er );
+	}
+
+	SimulatedBroker::Symbol* SimulatedBroker::find_symbol(const std::string& name) {
+		for ( auto& s : m_symbols ) {
+			if ( s.name == name ) {
+				return &s;
+			}
+		}
+		return nullptr;
+	}
+
+	std::string SimulatedBroker::next_id() {
+		return FIX::IntConvertor::convert( m_next_id++ );
+	}
+
+	/*!
+	 * Simulated clock as FIX UTCTimestamp, time of the last tick
+	 *
+	 * @return std::string
+	 */
+	std::string SimulatedBroker::sending_time() const {
+		char buffer[32];
+		times::ms_to_fix( m_time_ms, buffer );
+		return buffer;
+	}
+
+	size_t SimulatedBroker::open_positions() const {
+		return m_positions.size();
+	}
+
+	int SimulatedBroker::trades() const {
+		return m_trades;
+	}
+
+	int SimulatedBroker::wins() const {
+		return m_wins;
+	}
+
+	double SimulatedBroker::balance() const {
+		return m_balance;
+	}
+
+	double SimulatedBroker::profit_loss() const {
+		return m_profit_loss;
+	}
+};
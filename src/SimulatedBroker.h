@@ -0,0 +1,123 @@
+#ifndef IDEFIX_SIMULATEDBROKER_H
+#define IDEFIX_SIMULATEDBROKER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <quickfix/Message.h>
+#include <quickfix/SessionID.h>
+#include "FIXManager.h"
+#include "TickRecord.h"
+
+namespace IDEFIX {
+	/*!
+	 * In process FXCM broker for backtests and load tests.
+	 *
+	 * The broker is attached to FIXManager::setOutbound and answers the requests
+	 * with the messages FXCM would send: TradingSessionStatus, CollateralReport,
+	 * PositionReport, MarketDataSnapshotFullRefresh and ExecutionReport.
+	 * The replies are passed to FIXManager::fromApp, so the normal onMessage
+	 * handlers build the account, positions and snapshots.
+	 *
+	 * Everything is driven by on_tick: requests received during a tick are
+	 * handled at the start of the next tick of the symbol, market orders are
+	 * filled at bid or ask, stop and limit legs of a NewOrderList are OCO and
+	 * filled at the first tick crossing their price. Position and order ids
+	 * are sequential, so every run is deterministic.
+	 *
+	 * Constructed with a reply function instead of FIXManager, the replies are
+	 * passed to this function, e.g. to send them over a FIX session.
+	 */
+	class SimulatedBroker {
+	public:
+		typedef std::function<void(FIX::Message&)> Reply;
+
+	private:
+		struct Symbol {
+			std::string name;
+			double point_size;
+			int precision;
+			double bid;
+			double ask;
+			bool subscribed;
+		};
+
+		struct Position {
+			std::string pos_id;
+			std::string symbol;
+			char side;
+			double qty;
+			double price;
+			std::string open_time;
+			std::string clordid;
+			std::string order_id;
+			// stop and limit legs, 0 = not set
+			double stop_price;
+			std::string stop_clordid;
+			double limit_price;
+			std::string limit_clordid;
+		};
+
+		FIXManager* m_manager;
+		Reply m_reply;
+		FIX::SessionID m_session;
+		std::deque<FIX::Message> m_requests;
+		std::vector<Symbol> m_symbols;
+		std::vector<Position> m_positions;
+
+		std::string m_account_id;
+		std::string m_currency;
+		double m_balance;
+		long long m_time_ms;
+		long m_next_id;
+		bool m_started;
+
+		// statistics of closed positions
+		int m_trades;
+		int m_wins;
+		double m_profit_loss;
+
+		void handle(const FIX::Message& request);
+		void deliver(FIX::Message& reply);
+		void check_orders(const Symbol& symbol);
+
+		void open_position(const FIX::FieldMap& order, const double stop_price, const std::string& stop_clordid, const double limit_price, const std::string& limit_clordid);
+		void close_position(const size_t index, const char ord_type, const double price, const std::string clordid);
+		void reject(const FIX::FieldMap& order, const std::string& text);
+
+		void send_trading_session_status();
+		void send_collateral_report();
+		void send_position_reports();
+		void send_order_status();
+		void send_snapshot(const Symbol& symbol);
+		void send_execution_report(const Position& position, const char exec_type, const char ord_status, const char ord_type, const char side, const double price, const std::string& clordid);
+
+		Symbol* find_symbol(const std::string& name);
+		std::string next_id();
+		std::string sending_time() const;
+
+	public:
+		SimulatedBroker(FIXManager& manager, const std::string& account_id = "SIMULATED", const double balance = 50000, const std::string& currency = "USD");
+		SimulatedBroker(Reply reply, const std::string& account_id = "SIMULATED", const double balance = 50000, const std::string& currency = "USD");
+		~SimulatedBroker();
+
+		void add_symbol(const std::string& symbol, const double point_size = 0.0001, const int precision = 5);
+
+		void start();
+		void stop();
+		void process();
+
+		void on_message(const FIX::Message& message);
+		void on_tick(const std::string& symbol, const TickRecord& tick);
+		void replay(const std::string& symbol, const std::vector<TickRecord>& ticks);
+
+		size_t open_positions() const;
+		int trades() const;
+		int wins() const;
+		double balance() const;
+		double profit_loss() const;
+	};
+};
+
+#endif
@@ -0,0 +1,575 @@
+#include "StrategyHost.h"
+#include <ctime>
+#include <algorithm>
+#include "Console.h"
+#include "MathHelper.h"
+#include "MarketOrder.h"
+#include "FIXFactory.h"
+#include "TimeHelper.h"
+
+namespace IDEFIX {
+	namespace {
+		/*!
+		 * Cpu time of the calling thread in ns
+		 *
+		 * @return long long
+		 */
+		inline long long thread_cpu_ns() {
+			struct timespec ts;
+			clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+			return static_cast<long long>( ts.tv_sec ) * 1000000000LL + ts.tv_nsec;
+		}
+	};
+
+	/*!
+	 * @param FIXManager&        fixmanager
+	 * @param const unsigned int workers    0 = one per core, at most one per symbol
+	 */
+	StrategyHost::StrategyHost(FIXManager& fixmanager, const unsigned int workers)
+		: m_fixmanager( fixmanager ), m_journal( nullptr ), m_worker_count( workers ), m_tick_connection( 0 ), m_running( false ) {}
+
+	StrategyHost::~StrategyHost() {
+		stop();
+	}
+
+	/*!
+	 * Add one strategy for every symbol of a strategy cfg file like specs/awesome.cfg
+	 *
+	 * @param const std::string& cfg_file
+	 * @return size_t count of added strategies
+	 * @throw IDEFIX::file_not_found
+	 */
+	size_t StrategyHost::load(const std::string& cfg_file) throw( IDEFIX::file_not_found ) {
+		const AwesomeStrategyConfig config = AwesomeStrategyConfig::load( cfg_file );
+
+		size_t count = 0;
+		for ( auto& symbol : config.symbols ) {
+			if ( ! symbol.empty() ) {
+				add( symbol, config );
+				count++;
+			}
+		}
+		return count;
+	}
+
+	/*!
+	 * Add strategy, must be called before start
+	 *
+	 * @param const std::string&           symbol
+	 * @param const AwesomeStrategyConfig& config
+	 * @return AwesomeStrategy*            owned by the host
+	 */
+	AwesomeStrategy* StrategyHost::add(const std::string& symbol, const AwesomeStrategyConfig& config) {
+		m_configs.push_back( config );
+
+		m_slots.emplace_back();
+		Slot& slot = m_slots.back();
+		slot.strategy.reset( new AwesomeStrategy( symbol, m_configs.back() ) );
+		slot.ticks   = 0;
+		slot.bars    = 0;
+		slot.signals = 0;
+		slot.cpu_ns  = 0;
+
+		auto it = m_symbol_index.find( symbol );
+		if ( it == m_symbol_index.end() ) {
+			Symbol entry;
+			entry.name   = symbol;
+			entry.worker = 0;
+			entry.graph.reset( new IndicatorGraph() );
+			entry.snapshot.setSymbol( symbol );
+			entry.warm_up_seq = 0;
+			entry.initialized = false;
+			m_symbols.push_back( std::move( entry ) );
+			it = m_symbol_index.insert( std::make_pair( symbol, m_symbols.size() - 1 ) ).first;
+		}
+		m_symbols[it->second].slots.push_back( &slot );
+
+		// the nodes are created by on_init on the worker thread
+		AwesomeStrategy* strategy = slot.strategy.get();
+		strategy->set_graph( m_symbols[it->second].graph.get() );
+
+		// strategy signals are emitted on the worker thread
+		strategy->on_bar_signal.connect( [&slot](const Bar&) {
+			slot.bars.fetch_add( 1, std::memory_order_relaxed );
+		});
+		strategy->on_entry_signal.connect( [this, &slot, strategy](const MarketSide side) {
+			slot.signals.fetch_add( 1, std::memory_order_relaxed );
+			open_position( *strategy, side );
+		});
+		strategy->on_close_all_signal.connect( [this, &slot](const std::string& symbol) {
+			slot.signals.fetch_add( 1, std::memory_order_relaxed );
+			m_fixmanager.closeAllPositions( symbol );
+			m_fixmanager.queryAccounts();
+		});
+
+		return strategy;
+	}
+
+	/*!
+	 * Strategies with warm_up_hours replay the quotes of this journal on init.
+	 * It must be the journal of the FIXManager, live ticks up to the last
+	 * replayed sequence number are dropped.
+	 *
+	 * @param const EventJournal* journal
+	 */
+	void StrategyHost::set_journal(const EventJournal* journal) {
+		m_journal = journal;
+	}
+
+	/*!
+	 * Start the workers and connect the FIXManager signals,
+	 * call before FIXManager::connect
+	 */
+	void StrategyHost::start() {
+		if ( m_running || m_symbols.empty() ) {
+			return;
+		}
+
+		unsigned int count = m_worker_count > 0 ? m_worker_count : std::max( 1u, std::thread::hardware_concurrency() );
+		count = std::min<unsigned int>( count, m_symbols.size() );
+
+		// symbols round robin
+		for ( size_t i = 0; i < m_symbols.size(); i++ ) {
+			m_symbols[i].worker = i % count;
+		}
+
+		m_running = true;
+		for ( unsigned int i = 0; i < count; i++ ) {
+			m_workers.emplace_back( new Worker() );
+			m_workers.back()->events.reserve( QUEUE_SIZE );
+			m_workers.back()->max_queued     = 0;
+			m_workers.back()->dropped        = 0;
+			m_workers.back()->queued         = Metrics::gauge( "idefix_strategy_queue", Metrics::label( "worker", std::to_string( i ) ) );
+			m_workers.back()->metric_dropped = Metrics::counter( "idefix_strategy_dropped_total", Metrics::label( "worker", std::to_string( i ) ) );
+		}
+		for ( auto& worker : m_workers ) {
+			Worker* w = worker.get();
+			w->thread = std::thread( [this, w]() { run( *w ); } );
+		}
+
+		// on_init and on_exit are emitted with FIXManager::m_mutex locked,
+		// the FIXManager calls happen right here, the strategies follow on their worker
+		m_connections.push_back( m_fixmanager.on_init.connect( [this]() {
+			for ( size_t i = 0; i < m_symbols.size(); i++ ) {
+				m_fixmanager.subscribeMarketData( m_symbols[i].name );
+				m_fixmanager.closeAllPositions( m_symbols[i].name );
+
+				Event event = Event();
+				event.type       = INIT;
+				event.symbol     = i;
+				{
+					FIXManager::Registry registry( m_fixmanager );
+					auto detail      = registry.marketDetail( m_symbols[i].name );
+					event.point_size = detail != nullptr ? detail->getSymPointsize() : 0.0001;
+				}
+				// ticks journaled until now are replayed by the warm up, the
+				// live ones queued behind this event are dropped up to here
+				event.journal_seq = m_journal != nullptr ? m_journal->last_seq() : 0;
+				post( i, event );
+			}
+			m_fixmanager.queryAccounts();
+		}) );
+
+		m_connections.push_back( m_fixmanager.on_exit.connect( [this]() {
+			for ( size_t i = 0; i < m_symbols.size(); i++ ) {
+				m_fixmanager.closeAllPositions( m_symbols[i].name );
+				m_fixmanager.unsubscribeMarketData( m_symbols[i].name );
+
+				Event event = Event();
+				event.type       = EXIT;
+				event.symbol     = i;
+				post( i, event );
+			}
+			m_fixmanager.queryAccounts();
+		}) );
+
+		m_tick_connection = m_fixmanager.on_tick.connect( [this](const MarketSnapshot& tick) {
+			if ( ! m_running || m_fixmanager.isExiting() ) {
+				return;
+			}
+
+			auto it = m_symbol_index.find( tick.getSymbol() );
+			if ( it == m_symbol_index.end() ) {
+				return;
+			}
+
+			const std::string& sending_time = tick.getSendingTime();
+
+			Event event;
+			event.type         = TICK;
+			event.symbol       = it->second;
+			event.point_size   = tick.getPointSize();
+			event.journal_seq  = m_fixmanager.getTickJournalSeq();
+			event.bid          = tick.getBid();
+			event.ask          = tick.getAsk();
+			event.spread       = tick.getSpread();
+			event.session_high = tick.getSessionHigh();
+			event.session_low  = tick.getSessionLow();
+			event.precision    = tick.getPrecision();
+			event.sending_time_length = std::min( sending_time.size(), sizeof( event.sending_time ) - 1 );
+			sending_time.copy( event.sending_time, event.sending_time_length );
+			event.sending_time[event.sending_time_length] = '\0';
+			post( it->second, event );
+		});
+
+		console()->info( "[StrategyHost] {:d} strategies, {:d} symbols, {:d} workers", m_slots.size(), m_symbols.size(), m_workers.size() );
+	}
+
+	/*!
+	 * Process all queued events and stop the workers
+	 */
+	void StrategyHost::stop() {
+		if ( ! m_running ) {
+			return;
+		}
+
+		m_connections.clear();
+		m_fixmanager.on_tick.disconnect( m_tick_connection );
+		m_running = false;
+		for ( auto& worker : m_workers ) {
+			std::lock_guard<std::mutex> lock( worker->mutex );
+			worker->wakeup.notify_all();
+		}
+		for ( auto& worker : m_workers ) {
+			if ( worker->thread.joinable() ) {
+				worker->thread.join();
+			}
+		}
+	}
+
+	/*!
+	 * Queue event for the worker of the symbol. The queue never grows beyond
+	 * QUEUE_SIZE, ticks are dropped if less than CONTROL_SLOTS are left.
+	 *
+	 * @param const size_t symbol
+	 * @param const Event& event
+	 * @return bool false if the event was dropped
+	 */
+	bool StrategyHost::post(const size_t symbol, const Event& event) {
+		Worker& worker = *m_workers[ m_symbols[symbol].worker ];
+
+		std::lock_guard<std::mutex> lock( worker.mutex );
+		const size_t limit = event.type == TICK ? QUEUE_SIZE - CONTROL_SLOTS : QUEUE_SIZE;
+		if ( worker.events.size() >= limit ) {
+			worker.dropped++;
+			worker.metric_dropped.inc();
+			if ( event.type != TICK ) {
+				console()->error( "[StrategyHost] {} queue full, event dropped", m_symbols[symbol].name );
+			}
+			return false;
+		}
+
+		worker.events.push_back( event );
+		worker.max_queued = std::max( worker.max_queued, worker.events.size() );
+		worker.queued.set( worker.events.size() );
+		worker.wakeup.notify_one();
+		return true;
+	}
+
+	/*!
+	 * Worker thread, takes all queued events at once. Both vectors keep
+	 * their capacity of QUEUE_SIZE, swapping them does not allocate.
+	 *
+	 * @param Worker& worker
+	 */
+	void StrategyHost::run(Worker& worker) {
+		std::vector<Event> events;
+		events.reserve( QUEUE_SIZE );
+
+		while ( true ) {
+			{
+				std::unique_lock<std::mutex> lock( worker.mutex );
+				worker.wakeup.wait( lock, [this, &worker]() { return ! worker.events.empty() || ! m_running; } );
+				if ( worker.events.empty() ) {
+					return;
+				}
+				events.swap( worker.events );
+				worker.queued.set( 0 );
+			}
+
+			for ( const Event& event : events ) {
+				process( event );
+			}
+			events.clear();
+		}
+	}
+
+	/*!
+	 * Pass event to the graph and all strategies of its symbol
+	 *
+	 * @param const Event& event
+	 */
+	void StrategyHost::process(const Event& event) {
+		Symbol& symbol = m_symbols[event.symbol];
+
+		switch ( event.type ) {
+			case INIT:
+				init( symbol, event );
+				break;
+			case TICK: {
+				// already seen by the warm up
+				if ( event.journal_seq != 0 && event.journal_seq <= symbol.warm_up_seq ) {
+					break;
+				}
+
+				// the snapshot keeps the capacity of its strings
+				MarketSnapshot& snapshot = symbol.snapshot;
+				snapshot.setSendingTime( event.sending_time, event.sending_time_length );
+				snapshot.setPrecision( event.precision );
+				snapshot.setPointSize( event.point_size );
+				snapshot.setBid( event.bid );
+				snapshot.setAsk( event.ask );
+				snapshot.setSpread( event.spread );
+				snapshot.setSessionHigh( event.session_high );
+				snapshot.setSessionLow( event.session_low );
+
+				// bricks and sma are built once, the strategies are called by their nodes
+				const long long start = thread_cpu_ns();
+				symbol.graph->on_tick( snapshot );
+				add_cpu_ns( symbol, thread_cpu_ns() - start );
+
+				for ( Slot* slot : symbol.slots ) {
+					const long long slot_start = thread_cpu_ns();
+					slot->strategy->on_tick( snapshot );
+					slot->ticks.fetch_add( 1, std::memory_order_relaxed );
+					slot->cpu_ns.fetch_add( thread_cpu_ns() - slot_start, std::memory_order_relaxed );
+				}
+				break;
+			}
+			case EXIT:
+				for ( Slot* slot : symbol.slots ) {
+					const long long start = thread_cpu_ns();
+					slot->strategy->on_exit();
+					slot->cpu_ns.fetch_add( thread_cpu_ns() - start, std::memory_order_relaxed );
+				}
+				break;
+		}
+	}
+
+	/*!
+	 * Initialize the strategies of the symbol. FIXManager emits on_init on
+	 * every CollateralReport, the history is replayed only the first time.
+	 * The graph is fed once with the quotes of the longest warm_up_hours of
+	 * the symbol, all its strategies are muted meanwhile.
+	 *
+	 * @param Symbol&      symbol
+	 * @param const Event& event
+	 */
+	void StrategyHost::init(Symbol& symbol, const Event& event) {
+		int hours = 0;
+		for ( Slot* slot : symbol.slots ) {
+			const long long start = thread_cpu_ns();
+			slot->strategy->on_init();
+			slot->cpu_ns.fetch_add( thread_cpu_ns() - start, std::memory_order_relaxed );
+			hours = std::max( hours, slot->strategy->get_config()->warm_up_hours );
+		}
+
+		const bool first   = ! symbol.initialized;
+		symbol.initialized = true;
+		if ( ! first || m_journal == nullptr || hours <= 0 ) {
+			return;
+		}
+
+		const long long start = thread_cpu_ns();
+
+		std::vector<TickRecord> ticks;
+		m_journal->quotes( symbol.name, EventJournal::now_ms() - hours * 3600000LL, ticks, event.journal_seq );
+
+		for ( Slot* slot : symbol.slots ) {
+			slot->strategy->set_warming_up( true );
+		}
+		const size_t bricks = warm_up( symbol, ticks, event.point_size );
+		for ( Slot* slot : symbol.slots ) {
+			slot->strategy->set_warming_up( false );
+		}
+		symbol.warm_up_seq = event.journal_seq;
+
+		add_cpu_ns( symbol, thread_cpu_ns() - start );
+		console()->info( "[StrategyHost] {} warm up with {:d} ticks, {:d} bricks", symbol.name, ticks.size(), bricks );
+	}
+
+	/*!
+	 * Feed history ticks into the graph of the symbol
+	 *
+	 * @param Symbol&                        symbol
+	 * @param const std::vector<TickRecord>& ticks sorted by time
+	 * @param const double                   point_size
+	 * @return size_t count of created bricks of all strategies
+	 */
+	size_t StrategyHost::warm_up(Symbol& symbol, const std::vector<TickRecord>& ticks, const double point_size) {
+		int bricks_before = 0;
+		for ( Slot* slot : symbol.slots ) {
+			bricks_before += slot->strategy->brick_count();
+		}
+
+		MarketSnapshot& snapshot = symbol.snapshot;
+		snapshot.setPointSize( point_size );
+
+		char sending_time[32];
+		long long last_second = -1;
+		for ( auto& tick : ticks ) {
+			times::ms_to_fix( tick.time_ms, sending_time, last_second );
+			snapshot.setSendingTime( sending_time, 21 );
+			snapshot.setBid( tick.bid );
+			snapshot.setAsk( tick.ask );
+
+			symbol.graph->on_tick( snapshot );
+		}
+
+		int bricks = 0;
+		for ( Slot* slot : symbol.slots ) {
+			bricks += slot->strategy->brick_count();
+		}
+		return bricks - bricks_before;
+	}
+
+	/*!
+	 * Split time of the shared graph between the strategies of the symbol
+	 *
+	 * @param Symbol&         symbol
+	 * @param const long long ns
+	 */
+	void StrategyHost::add_cpu_ns(Symbol& symbol, const long long ns) {
+		if ( symbol.slots.empty() ) {
+			return;
+		}
+
+		const long long share = ns / static_cast<long long>( symbol.slots.size() );
+		for ( Slot* slot : symbol.slots ) {
+			slot->cpu_ns.fetch_add( share, std::memory_order_relaxed );
+		}
+	}
+
+	/*!
+	 * Open market order with stop loss for the strategy, called on the worker thread
+	 *
+	 * @param AwesomeStrategy&  strategy
+	 * @param const MarketSide  side
+	 */
+	void StrategyHost::open_position(AwesomeStrategy& strategy, const MarketSide side) {
+		if ( m_fixmanager.isExiting() ) {
+			return;
+		}
+
+		const std::string& symbol = strategy.get_symbol();
+		AwesomeStrategyConfig* config = strategy.get_config();
+
+		// latest prices, market details and free margin, copied under one lock
+		double bid         = 0;
+		double ask         = 0;
+		double spread      = 0;
+		int precision      = 0;
+		double point_size  = 0;
+		double free_margin = 0;
+		{
+			FIXManager::Registry registry( m_fixmanager );
+			auto ms      = registry.latestSnapshot( symbol );
+			auto md      = registry.marketDetail( symbol );
+			auto account = registry.account();
+			if ( ms == nullptr || md == nullptr || account == nullptr ) {
+				console()->warn( "[StrategyHost] {} no market data, signal ignored", symbol );
+				return;
+			}
+			bid         = ms->getBid();
+			ask         = ms->getAsk();
+			spread      = ms->getSpread();
+			precision   = md->getSymPrecision();
+			point_size  = md->getSymPointsize();
+			free_margin = account->getFreeMargin();
+		}
+
+		// close all opposite trades in this symbol
+		FIX::Side opposide( ( side == MarketSide::Side_SELL ? FIX::Side_BUY : FIX::Side_SELL ) );
+		m_fixmanager.closeAllPositions( symbol, opposide.getValue() );
+
+		// spread in pips, the same rule as BacktestEngine::open_position
+		if ( config->max_spread > 0 && spread > config->max_spread ) {
+			console()->warn( "[StrategyHost] {} spread {:.1f} above max_spread {:.1f}, no position opened", symbol, spread, config->max_spread );
+			return;
+		}
+
+		double conversion_price = 0;
+		double pip_risk         = config->max_pip_risk;
+		double percent_risk     = config->max_risk;
+
+		MarketOrder mo;
+		mo.setAccountID( m_fixmanager.getAccountID() );
+		mo.setPrecision( precision );
+		mo.setPointSize( point_size );
+		mo.setSymbol( symbol );
+		FIX::Side fix_side( ( side == MarketSide::Side_SELL ? FIX::Side_SELL : FIX::Side_BUY ) );
+		mo.setSide( fix_side.getValue() );
+		mo.setQty( std::min( Math::get_unit_size( free_margin, percent_risk, pip_risk, conversion_price, mo.getPointSize() ), config->max_qty ) );
+		// MarketOrder
+		mo.setPrice( 0 );
+		if ( side == MarketSide::Side_SELL ) {
+			mo.setStopPrice( bid + ( mo.getPointSize() * pip_risk ) );
+		} else {
+			mo.setStopPrice( ask - ( mo.getPointSize() * pip_risk ) );
+		}
+
+		console()->info( "[StrategyHost] Open Position in {} on {} with size {:f}", mo.getSymbol(), mo.getSideStr(), mo.getQty() );
+
+		m_fixmanager.marketOrder( mo, FIXFactory::SingleOrderType::MARKET_ORDER_SL );
+		m_fixmanager.queryPositionReport();
+	}
+
+	size_t StrategyHost::size() const {
+		return m_slots.size();
+	}
+
+	/*!
+	 * Count of indicator nodes of all symbols, strategies with the same
+	 * symbol, brick and sma size share theirs
+	 *
+	 * @return size_t
+	 */
+	size_t StrategyHost::indicators() const {
+		size_t count = 0;
+		for ( auto& symbol : m_symbols ) {
+			count += symbol.graph->size();
+		}
+		return count;
+	}
+
+	/*!
+	 * Counters of all strategies in the order they were added
+	 *
+	 * @return std::vector<Stats>
+	 */
+	std::vector<StrategyHost::Stats> StrategyHost::stats() const {
+		std::vector<Stats> result;
+		result.reserve( m_slots.size() );
+
+		for ( auto& symbol : m_symbols ) {
+			for ( Slot* slot : symbol.slots ) {
+				Stats stats;
+				stats.symbol  = symbol.name;
+				stats.worker  = symbol.worker;
+				stats.ticks   = slot->ticks.load( std::memory_order_relaxed );
+				stats.bars    = slot->bars.load( std::memory_order_relaxed );
+				stats.signals = slot->signals.load( std::memory_order_relaxed );
+				stats.cpu_ns  = slot->cpu_ns.load( std::memory_order_relaxed );
+				result.push_back( stats );
+			}
+		}
+
+		return result;
+	}
+
+	/*!
+	 * Log counters and cpu time of every strategy and the
+	 * longest queue of every worker
+	 */
+	void StrategyHost::report() const {
+		for ( size_t i = 0; i < m_workers.size(); i++ ) {
+			std::lock_guard<std::mutex> lock( m_workers[i]->mutex );
+			console()->info( "[StrategyHost] worker {:d} queued {:d} max {:d} dropped {:d}", i, m_workers[i]->events.size(), m_workers[i]->max_queued, m_workers[i]->dropped );
+		}
+
+		for ( auto& stats : this->stats() ) {
+			console()->info( "[StrategyHost] {} worker {:d} ticks {:d} bars {:d} signals {:d} cpu {:.3f} ms ({:.2f} us/tick)",
+				stats.symbol, stats.worker, stats.ticks, stats.bars, stats.signals, stats.cpu_ns / 1e6, stats.ticks > 0 ? stats.cpu_ns / 1e3 / stats.ticks : 0.0 );
+		}
+	}
+};
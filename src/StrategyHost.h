@@ -0,0 +1,155 @@
+#ifndef IDEFIX_STRATEGYHOST_H
+#define IDEFIX_STRATEGYHOST_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <nod/nod.hpp>
+#include "FIXManager.h"
+#include "EventJournal.h"
+#include "AwesomeStrategy.h"
+#include "IndicatorGraph.h"
+#include "MarketSnapshot.h"
+#include "MarketSide.h"
+#include "Exceptions.h"
+#include "Metrics.h"
+
+namespace IDEFIX {
+	/*!
+	 * Runs any number of strategies per symbol in one process.
+	 *
+	 * Every symbol belongs to one worker thread, all strategies of the symbol
+	 * run there in the order they were added. The FIXManager thread only
+	 * copies the prices of a tick into the bounded queue of the worker, it
+	 * never waits for a strategy and the slots don't take FIXManager::m_mutex.
+	 * If the queue is full the tick is dropped and counted. Orders of the
+	 * strategies are sent from the worker, FIXManager locks itself.
+	 *
+	 * Every symbol has one IndicatorGraph, strategies of the symbol with the
+	 * same brick and sma size share their nodes, the bricks are built once.
+	 *
+	 * Per strategy the events, bars, signals and the cpu time of the worker
+	 * thread are counted, see stats() and report(). The time of the shared
+	 * graph is split between the strategies of the symbol.
+	 */
+	class StrategyHost {
+	public:
+		// events per worker queue, the last CONTROL_SLOTS are kept for init and exit
+		static const size_t QUEUE_SIZE    = 1 << 14;
+		static const size_t CONTROL_SLOTS = 64;
+
+		struct Stats {
+			std::string symbol;
+			unsigned int worker;
+			unsigned long ticks;
+			unsigned long bars;
+			unsigned long signals;
+			long long cpu_ns;
+		};
+
+	private:
+		enum EventType {
+			INIT,
+			TICK,
+			EXIT
+		};
+
+		// plain data, queued without allocation
+		struct Event {
+			EventType type;
+			size_t symbol;
+			double point_size;
+			// INIT: last journal record of the warm up, TICK: journal record of the tick
+			uint64_t journal_seq;
+			// TICK only, copied into the snapshot of the symbol by the worker
+			double bid;
+			double ask;
+			double spread;
+			double session_high;
+			double session_low;
+			unsigned int precision;
+			size_t sending_time_length;
+			char sending_time[32];
+		};
+
+		struct Slot {
+			std::unique_ptr<AwesomeStrategy> strategy;
+			std::atomic<unsigned long> ticks;
+			std::atomic<unsigned long> bars;
+			std::atomic<unsigned long> signals;
+			std::atomic<long long> cpu_ns;
+		};
+
+		struct Symbol {
+			std::string name;
+			unsigned int worker;
+			std::vector<Slot*> slots;
+			// renko and sma nodes of all strategies of the symbol
+			std::unique_ptr<IndicatorGraph> graph;
+			// tick passed to the graph and the strategies, worker only
+			MarketSnapshot snapshot;
+			// ticks up to this journal record were replayed by the warm up, worker only
+			uint64_t warm_up_seq;
+			// on_init was called and the warm up ran, worker only
+			bool initialized;
+		};
+
+		struct Worker {
+			std::mutex mutex;
+			std::condition_variable wakeup;
+			// reserved to QUEUE_SIZE, swapped with the batch of the worker
+			std::vector<Event> events;
+			std::thread thread;
+			size_t max_queued;
+			unsigned long dropped;
+			Metrics::Gauge queued;
+			Metrics::Counter metric_dropped;
+		};
+
+		FIXManager& m_fixmanager;
+		const EventJournal* m_journal;
+		unsigned int m_worker_count;
+
+		// strategies keep a pointer to their config
+		std::list<AwesomeStrategyConfig> m_configs;
+		std::list<Slot> m_slots;
+		std::vector<Symbol> m_symbols;
+		std::map<std::string, size_t> m_symbol_index;
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::vector<nod::scoped_connection> m_connections;
+		size_t m_tick_connection;
+		std::atomic<bool> m_running;
+
+		bool post(const size_t symbol, const Event& event);
+		void run(Worker& worker);
+		void process(const Event& event);
+		void init(Symbol& symbol, const Event& event);
+		size_t warm_up(Symbol& symbol, const std::vector<TickRecord>& ticks, const double point_size);
+		void add_cpu_ns(Symbol& symbol, const long long ns);
+		void open_position(AwesomeStrategy& strategy, const MarketSide side);
+
+	public:
+		StrategyHost(FIXManager& fixmanager, const unsigned int workers = 0);
+		~StrategyHost();
+
+		size_t load(const std::string& cfg_file) throw( IDEFIX::file_not_found );
+		AwesomeStrategy* add(const std::string& symbol, const AwesomeStrategyConfig& config);
+		void set_journal(const EventJournal* journal);
+
+		void start();
+		void stop();
+
+		size_t size() const;
+		size_t indicators() const;
+		std::vector<Stats> stats() const;
+		void report() const;
+	};
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef IDEFIX_TICK_H
+#define IDEFIX_TICK_H
+
+#include <string>
+#include "MarketSnapshot.h"
+#include "TimeHelper.h"
+
+namespace IDEFIX {
+	/*!
+	 * Decoded tick shared by all bar builders of a symbol.
+	 * The string pointers reference the MarketSnapshot the tick was
+	 * decoded from and are only valid during the on_tick call.
+	 */
+	struct Tick {
+		const std::string* symbol;
+		const std::string* sending_time;
+		double bid;
+		double ask;
+		double point_size;
+		long long time_ms;
+	};
+
+	/*!
+	 * Decode a market snapshot once for all bar builders
+	 *
+	 * @param const MarketSnapshot& snapshot
+	 * @return Tick
+	 */
+	inline Tick decode_tick(const MarketSnapshot& snapshot) {
+		Tick tick;
+		tick.symbol       = &snapshot.getSymbol();
+		tick.sending_time = &snapshot.getSendingTime();
+		tick.bid          = snapshot.getBid();
+		tick.ask          = snapshot.getAsk();
+		tick.point_size   = snapshot.getPointSize();
+		tick.time_ms      = times::fix_to_ms( snapshot.getSendingTime() );
+		return tick;
+	}
+};
+
+#endif
@@ -0,0 +1,371 @@
+#include "TickArchive.h"
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace IDEFIX {
+	namespace {
+		const char MAGIC[8] = { 'I', 'D', 'F', 'X', 'T', 'I', 'C', 'K' };
+
+		inline uint64_t zigzag(const int64_t value) {
+			return ( static_cast<uint64_t>( value ) << 1 ) ^ static_cast<uint64_t>( value >> 63 );
+		}
+
+		inline int64_t unzigzag(const uint64_t value) {
+			return static_cast<int64_t>( value >> 1 ) ^ -static_cast<int64_t>( value & 1 );
+		}
+
+		inline void put_varint(std::vector<unsigned char>& out, uint64_t value) {
+			while ( value >= 0x80 ) {
+				out.push_back( static_cast<unsigned char>( value | 0x80 ) );
+				value >>= 7;
+			}
+			out.push_back( static_cast<unsigned char>( value ) );
+		}
+
+		// reads no byte at or after end, a varint has at most 10 bytes
+		inline uint64_t get_varint(const unsigned char*& p, const unsigned char* end) throw( IDEFIX::out_of_range ) {
+			uint64_t value = 0;
+			int shift      = 0;
+			while ( p < end && ( *p & 0x80 ) ) {
+				if ( shift > 63 ) {
+					throw out_of_range(__FILE__, __LINE__);
+				}
+				value |= static_cast<uint64_t>( *p++ & 0x7F ) << shift;
+				shift += 7;
+			}
+			if ( p >= end || shift > 63 ) {
+				throw out_of_range(__FILE__, __LINE__);
+			}
+			value |= static_cast<uint64_t>( *p++ ) << shift;
+			return value;
+		}
+
+		inline int64_t to_units(const double price, const double price_scale) {
+			return static_cast<int64_t>( std::llround( price * price_scale ) );
+		}
+	}
+
+	TickArchive::TickArchive(const std::string& filename)
+	: m_filename( filename ), m_fd(-1), m_data(nullptr), m_size(0), m_index(nullptr) {
+		memset( &m_header, 0, sizeof( m_header ) );
+	}
+
+	TickArchive::~TickArchive() {
+		close();
+	}
+
+	/*!
+	 * Map the file into memory and check the header
+	 *
+	 * @throw IDEFIX::file_not_found
+	 * @throw IDEFIX::out_of_range if the file is no tick archive or its index is corrupt
+	 */
+	void TickArchive::open() throw( IDEFIX::file_not_found, IDEFIX::out_of_range ) {
+		close();
+
+		m_fd = ::open( m_filename.c_str(), O_RDONLY );
+		if ( m_fd < 0 ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		struct stat st;
+		if ( fstat( m_fd, &st ) != 0 || static_cast<size_t>( st.st_size ) < sizeof( Header ) ) {
+			close();
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		m_size = st.st_size;
+		void* data = mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0 );
+		if ( data == MAP_FAILED ) {
+			m_size = 0;
+			close();
+			throw file_not_found(__FILE__, __LINE__);
+		}
+		m_data = static_cast<const unsigned char*>( data );
+
+		memcpy( &m_header, m_data, sizeof( Header ) );
+		if ( memcmp( m_header.magic, MAGIC, sizeof( MAGIC ) ) != 0 || m_header.version != VERSION || m_header.block_size == 0
+			|| m_header.index_offset < sizeof( Header ) || m_header.index_offset > m_size || m_header.index_offset % 8 != 0
+			|| m_header.block_count > ( m_size - m_header.index_offset ) / sizeof( BlockIndex ) ) {
+			close();
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		m_index = reinterpret_cast<const BlockIndex*>( m_data + m_header.index_offset );
+
+		// a truncated or corrupt archive must not make the decoder write or read out of bounds,
+		// every block holds at most block_size ticks and lies between the header and the index
+		uint64_t ticks    = 0;
+		uint64_t previous = sizeof( Header );
+		for ( size_t i = 0; i < m_header.block_count; i++ ) {
+			const BlockIndex& block = m_index[i];
+			if ( block.count > m_header.block_size || block.offset < previous || block.offset >= m_header.index_offset ) {
+				close();
+				throw out_of_range(__FILE__, __LINE__);
+			}
+			ticks   += block.count;
+			previous = block.offset;
+		}
+
+		if ( ticks != m_header.tick_count ) {
+			close();
+			throw out_of_range(__FILE__, __LINE__);
+		}
+	}
+
+	/*!
+	 * Unmap file
+	 */
+	void TickArchive::close() {
+		if ( m_data != nullptr ) {
+			munmap( const_cast<unsigned char*>( m_data ), m_size );
+		}
+		if ( m_fd >= 0 ) {
+			::close( m_fd );
+		}
+
+		m_fd    = -1;
+		m_data  = nullptr;
+		m_size  = 0;
+		m_index = nullptr;
+		memset( &m_header, 0, sizeof( m_header ) );
+	}
+
+	bool TickArchive::is_open() const {
+		return m_data != nullptr;
+	}
+
+	std::string TickArchive::symbol() const {
+		return std::string( m_header.symbol, strnlen( m_header.symbol, sizeof( m_header.symbol ) ) );
+	}
+
+	double TickArchive::point_size() const {
+		return m_header.point_size;
+	}
+
+	size_t TickArchive::size() const {
+		return m_header.tick_count;
+	}
+
+	size_t TickArchive::block_count() const {
+		return m_header.block_count;
+	}
+
+	long long TickArchive::first_time() const {
+		return m_header.block_count > 0 ? m_index[0].first_time : 0;
+	}
+
+	long long TickArchive::last_time() const {
+		return m_header.block_count > 0 ? m_index[ m_header.block_count - 1 ].last_time : 0;
+	}
+
+	/*!
+	 * Append all ticks
+	 *
+	 * @param std::vector<TickRecord>& ticks
+	 * @return size_t count of ticks
+	 */
+	size_t TickArchive::load(std::vector<TickRecord>& ticks) const {
+		const size_t start = ticks.size();
+		ticks.resize( start + size() );
+
+		size_t count = 0;
+		for ( size_t i = 0; i < block_count(); i++ ) {
+			count += decode_block( i, ticks.data() + start + count );
+		}
+
+		ticks.resize( start + count );
+		return count;
+	}
+
+	/*!
+	 * Append ticks with from_ms <= time < to_ms, only the blocks
+	 * in this range are decoded.
+	 *
+	 * @param std::vector<TickRecord>& ticks
+	 * @param const long long          from_ms
+	 * @param const long long          to_ms
+	 * @return size_t count of ticks
+	 */
+	size_t TickArchive::load(std::vector<TickRecord>& ticks, const long long from_ms, const long long to_ms) const {
+		std::vector<TickRecord> block( m_header.block_size );
+		size_t count = 0;
+
+		for ( size_t i = find_block( from_ms ); i < block_count() && m_index[i].first_time < to_ms; i++ ) {
+			const size_t n = decode_block( i, block.data() );
+			for ( size_t j = 0; j < n; j++ ) {
+				if ( block[j].time_ms >= from_ms && block[j].time_ms < to_ms ) {
+					ticks.push_back( block[j] );
+					count++;
+				}
+			}
+		}
+
+		return count;
+	}
+
+	/*!
+	 * First block which may contain ticks at or after time_ms
+	 *
+	 * @param const long long time_ms
+	 * @return size_t block_count() if there is none
+	 */
+	size_t TickArchive::find_block(const long long time_ms) const {
+		const BlockIndex* end = m_index + block_count();
+		const BlockIndex* it  = std::lower_bound( m_index, end, time_ms, [](const BlockIndex& block, const long long time) {
+			return block.last_time < time;
+		});
+		return it - m_index;
+	}
+
+	/*!
+	 * Decode one block
+	 *
+	 * @param const size_t block
+	 * @param TickRecord*  out   room for block_size ticks
+	 * @return size_t count of decoded ticks
+	 * @throw IDEFIX::out_of_range if the block does not exist or its data is corrupt
+	 */
+	size_t TickArchive::decode_block(const size_t block, TickRecord* out) const throw( IDEFIX::out_of_range ) {
+		if ( block >= block_count() ) {
+			throw out_of_range(__FILE__, __LINE__);
+		}
+
+		const BlockIndex& index  = m_index[block];
+		const size_t count       = index.count;
+		const double scale       = m_header.price_scale;
+		const unsigned char* p   = m_data + index.offset;
+		const unsigned char* end = m_data + ( block + 1 < block_count() ? m_index[block + 1].offset : m_header.index_offset );
+
+		int64_t value = index.first_time;
+		for ( size_t i = 0; i < count; i++ ) {
+			value += unzigzag( get_varint( p, end ) );
+			out[i].time_ms = value;
+		}
+
+		value = 0;
+		for ( size_t i = 0; i < count; i++ ) {
+			value += unzigzag( get_varint( p, end ) );
+			out[i].bid = value / scale;
+		}
+
+		value = 0;
+		for ( size_t i = 0; i < count; i++ ) {
+			value += unzigzag( get_varint( p, end ) );
+			out[i].ask = value / scale;
+		}
+
+		return count;
+	}
+
+	/*!
+	 * Write ticks as archive, the ticks have to be sorted by time.
+	 * Prices are stored in tenths of the point size (FXCM fractional pips),
+	 * 0.0001 is stored as price * 100000.
+	 *
+	 * @param const std::string&             filename
+	 * @param const std::string&             symbol
+	 * @param const double                   point_size
+	 * @param const std::vector<TickRecord>& ticks
+	 * @param const uint32_t                 block_size
+	 * @return size_t written bytes
+	 * @throw IDEFIX::file_not_found if the file can not be created
+	 */
+	size_t TickArchive::write(const std::string& filename, const std::string& symbol, const double point_size, const std::vector<TickRecord>& ticks, const uint32_t block_size) throw( IDEFIX::file_not_found ) {
+		std::ofstream file( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+		if ( ! file.is_open() ) {
+			throw file_not_found(__FILE__, __LINE__);
+		}
+
+		Header header;
+		memset( &header, 0, sizeof( header ) );
+		memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+		header.version    = VERSION;
+		header.block_size = block_size;
+		header.point_size = point_size;
+		header.price_scale = std::pow( 10.0, std::ceil( -std::log10( point_size ) - 1e-9 ) + 1 );
+		header.tick_count = ticks.size();
+		strncpy( header.symbol, symbol.c_str(), sizeof( header.symbol ) - 1 );
+
+		// header is written again with the index offset at the end
+		file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		uint64_t offset = sizeof( header );
+
+		std::vector<BlockIndex> index;
+		std::vector<unsigned char> buffer;
+		buffer.reserve( block_size * 6 );
+
+		for ( size_t start = 0; start < ticks.size(); start += block_size ) {
+			const size_t end = std::min<size_t>( start + block_size, ticks.size() );
+
+			BlockIndex block;
+			block.first_time = ticks[start].time_ms;
+			block.last_time  = ticks[end - 1].time_ms;
+			block.offset     = offset;
+			block.count      = end - start;
+
+			buffer.clear();
+
+			int64_t previous = block.first_time;
+			for ( size_t i = start; i < end; i++ ) {
+				put_varint( buffer, zigzag( ticks[i].time_ms - previous ) );
+				previous = ticks[i].time_ms;
+			}
+
+			previous = 0;
+			for ( size_t i = start; i < end; i++ ) {
+				const int64_t bid = to_units( ticks[i].bid, header.price_scale );
+				put_varint( buffer, zigzag( bid - previous ) );
+				previous = bid;
+			}
+
+			previous = 0;
+			for ( size_t i = start; i < end; i++ ) {
+				const int64_t ask = to_units( ticks[i].ask, header.price_scale );
+				put_varint( buffer, zigzag( ask - previous ) );
+				previous = ask;
+			}
+
+			file.write( reinterpret_cast<const char*>( buffer.data() ), buffer.size() );
+			offset += buffer.size();
+			index.push_back( block );
+		}
+
+		// keep the index aligned for the mapped reader
+		const uint64_t padding = ( 8 - offset % 8 ) % 8;
+		const char zeros[8]    = { 0 };
+		file.write( zeros, padding );
+		offset += padding;
+
+		header.block_count  = index.size();
+		header.index_offset = offset;
+		file.write( reinterpret_cast<const char*>( index.data() ), index.size() * sizeof( BlockIndex ) );
+		offset += index.size() * sizeof( BlockIndex );
+
+		file.seekp( 0, std::ios::beg );
+		file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+
+		return offset;
+	}
+
+	/*!
+	 * Check the magic bytes of a file
+	 *
+	 * @param const std::string& filename
+	 * @return bool
+	 */
+	bool TickArchive::is_archive(const std::string& filename) {
+		std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+		char magic[ sizeof( MAGIC ) ];
+		if ( ! file.read( magic, sizeof( magic ) ) ) {
+			return false;
+		}
+		return memcmp( magic, MAGIC, sizeof( MAGIC ) ) == 0;
+	}
+};
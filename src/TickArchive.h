@@ -0,0 +1,81 @@
+#ifndef IDEFIX_TICKARCHIVE_H
+#define IDEFIX_TICKARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "TickRecord.h"
+#include "Exceptions.h"
+
+namespace IDEFIX {
+	/*!
+	 * Binary tick archive, one symbol per file.
+	 *
+	 * Header | Block 0 | Block 1 | ... | Block index
+	 *
+	 * Every block holds up to block_size ticks in three columns: time, bid and ask.
+	 * Prices are stored as integers, price * price_scale.
+	 * All columns are delta encoded zigzag varints, the first value of a block
+	 * is relative to the first time of the block or 0, so blocks decode on their own.
+	 * The index holds the time range and offset of every block and is used to seek by date.
+	 *
+	 * The reader maps the file into memory, nothing is read until a block is decoded.
+	 */
+	class TickArchive {
+	public:
+		static const uint32_t VERSION            = 1;
+		static const uint32_t DEFAULT_BLOCK_SIZE = 4096;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t block_size;
+			double point_size;
+			double price_scale;
+			char symbol[16];
+			uint64_t tick_count;
+			uint64_t block_count;
+			uint64_t index_offset;
+		};
+
+		struct BlockIndex {
+			int64_t first_time;
+			int64_t last_time;
+			uint64_t offset;
+			uint64_t count;
+		};
+
+	private:
+		std::string m_filename;
+		int m_fd;
+		const unsigned char* m_data;
+		size_t m_size;
+		Header m_header;
+		const BlockIndex* m_index;
+
+	public:
+		TickArchive(const std::string& filename);
+		~TickArchive();
+
+		void open() throw( IDEFIX::file_not_found, IDEFIX::out_of_range );
+		void close();
+		bool is_open() const;
+
+		std::string symbol() const;
+		double point_size() const;
+		size_t size() const;
+		size_t block_count() const;
+		long long first_time() const;
+		long long last_time() const;
+
+		size_t load(std::vector<TickRecord>& ticks) const;
+		size_t load(std::vector<TickRecord>& ticks, const long long from_ms, const long long to_ms) const;
+		size_t find_block(const long long time_ms) const;
+		size_t decode_block(const size_t block, TickRecord* out) const throw( IDEFIX::out_of_range );
+
+		static size_t write(const std::string& filename, const std::string& symbol, const double point_size, const std::vector<TickRecord>& ticks, const uint32_t block_size = DEFAULT_BLOCK_SIZE) throw( IDEFIX::file_not_found );
+		static bool is_archive(const std::string& filename);
+	};
+};
+
+#endif
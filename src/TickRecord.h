@@ -0,0 +1,17 @@
+#ifndef IDEFIX_TICKRECORD_H
+#define IDEFIX_TICKRECORD_H
+
+namespace IDEFIX {
+	/*!
+	 * Compact historical tick, no strings.
+	 * Used by FileAdapter and the backtest tools.
+	 */
+	struct TickRecord {
+		// milliseconds since epoch, UTC
+		long long time_ms;
+		double bid;
+		double ask;
+	};
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef IDEFIX_TIMEHELPER_H
+#define IDEFIX_TIMEHELPER_H
+
+#include <string>
+
+namespace IDEFIX {
+	namespace times {
+		/*!
+		 * Days since 1970-01-01 for a civil date (proleptic gregorian)
+		 * http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+		 *
+		 * @param int       year
+		 * @param unsigned  month 1-12
+		 * @param unsigned  day   1-31
+		 * @return long long
+		 */
+		inline long long days_from_civil(int year, const unsigned month, const unsigned day) {
+			year -= month <= 2;
+			const long long era = ( year >= 0 ? year : year - 399 ) / 400;
+			const unsigned yoe  = static_cast<unsigned>( year - era * 400 );
+			const unsigned doy  = ( 153 * ( month + ( month > 2 ? -3 : 9 ) ) + 2 ) / 5 + day - 1;
+			const unsigned doe  = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + static_cast<long long>( doe ) - 719468;
+		}
+
+		/*!
+		 * Read count digits from p as unsigned number, no checks
+		 *
+		 * @param const char* p
+		 * @param const int   count
+		 * @return unsigned
+		 */
+		inline unsigned digits(const char* p, const int count) {
+			unsigned value = 0;
+			for ( int i = 0; i < count; i++ ) {
+				value = value * 10 + static_cast<unsigned>( p[i] - '0' );
+			}
+			return value;
+		}
+
+		/*!
+		 * Convert a FIX UTCTimestamp yyyymmdd-HH:MM:SS[.sss] to milliseconds since epoch
+		 *
+		 * @param const std::string& timestamp
+		 * @return long long 0 if the format is unknown
+		 */
+		inline long long fix_to_ms(const std::string& timestamp) {
+			if ( timestamp.size() < 17 || timestamp[8] != '-' ) {
+				return 0;
+			}
+
+			const char* p = timestamp.c_str();
+			long long days = days_from_civil( digits( p, 4 ), digits( p + 4, 2 ), digits( p + 6, 2 ) );
+			long long ms   = ( ( days * 24 + digits( p + 9, 2 ) ) * 60 + digits( p + 12, 2 ) ) * 60 + digits( p + 15, 2 );
+			ms *= 1000;
+
+			if ( timestamp.size() >= 21 && timestamp[17] == '.' ) {
+				ms += digits( p + 18, 3 );
+			}
+
+			return ms;
+		}
+
+		/*!
+		 * Convert a FXCM tick data datetime MM/DD/YYYY HH:MM:SS.sss to milliseconds since epoch.
+		 * The caller guarantees at least 23 readable characters.
+		 *
+		 * @param const char* p
+		 * @return long long
+		 */
+		inline long long fxcm_to_ms(const char* p) {
+			long long days = days_from_civil( digits( p + 6, 4 ), digits( p, 2 ), digits( p + 3, 2 ) );
+			long long ms   = ( ( days * 24 + digits( p + 11, 2 ) ) * 60 + digits( p + 14, 2 ) ) * 60 + digits( p + 17, 2 );
+			return ms * 1000 + digits( p + 20, 3 );
+		}
+
+		/*!
+		 * Write milliseconds since epoch as FIX UTCTimestamp yyyymmdd-HH:MM:SS.sss
+		 * http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+		 *
+		 * @param const long long ms
+		 * @param char*           out at least 22 bytes, will be null terminated
+		 */
+		inline void ms_to_fix(const long long ms, char* out) {
+			long long days  = ms / 86400000;
+			long long rest  = ms % 86400000;
+			if ( rest < 0 ) {
+				rest += 86400000;
+				days -= 1;
+			}
+
+			days += 719468;
+			const long long era = ( days >= 0 ? days : days - 146096 ) / 146097;
+			const unsigned doe  = static_cast<unsigned>( days - era * 146097 );
+			const unsigned yoe  = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+			const unsigned doy  = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+			const unsigned mp   = ( 5 * doy + 2 ) / 153;
+			const unsigned day  = doy - ( 153 * mp + 2 ) / 5 + 1;
+			const unsigned mon  = mp < 10 ? mp + 3 : mp - 9;
+			const long long yr  = static_cast<long long>( yoe ) + era * 400 + ( mon <= 2 );
+
+			const unsigned values[] = {
+				static_cast<unsigned>( yr ), mon, day,
+				static_cast<unsigned>( rest / 3600000 ),
+				static_cast<unsigned>( rest / 60000 % 60 ),
+				static_cast<unsigned>( rest / 1000 % 60 ),
+				static_cast<unsigned>( rest % 1000 )
+			};
+			const int widths[] = { 4, 2, 2, 2, 2, 2, 3 };
+			const char separators[] = { 0, 0, '-', ':', ':', '.', 0 };
+
+			int pos = 0;
+			for ( int i = 0; i < 7; i++ ) {
+				unsigned v = values[i];
+				for ( int w = widths[i] - 1; w >= 0; w-- ) {
+					out[pos + w] = static_cast<char>( '0' + v % 10 );
+					v /= 10;
+				}
+				pos += widths[i];
+				if ( separators[i] != 0 ) {
+					out[pos++] = separators[i];
+				}
+			}
+			out[pos] = '\0';
+		}
+
+		/*!
+		 * Write milliseconds since epoch as FIX UTCTimestamp like ms_to_fix, for
+		 * ascending ticks. Most ticks share the second of the previous call, out
+		 * is expected to hold that timestamp and only the milliseconds are replaced.
+		 *
+		 * @param const long long ms
+		 * @param char*           out         at least 22 bytes, kept between calls
+		 * @param long long&      last_second second written to out, -1 initially
+		 */
+		inline void ms_to_fix(const long long ms, char* out, long long& last_second) {
+			const long long second = ms / 1000;
+			if ( second != last_second || ms < 0 ) {
+				ms_to_fix( ms, out );
+				last_second = second;
+				return;
+			}
+
+			const int millis = static_cast<int>( ms % 1000 );
+			out[18] = static_cast<char>( '0' + millis / 100 );
+			out[19] = static_cast<char>( '0' + millis / 10 % 10 );
+			out[20] = static_cast<char>( '0' + millis % 10 );
+		}
+	}; // - ns times
+}; // - ns idefix
+
+#endif
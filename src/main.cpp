@@ -8,14 +8,14 @@
 #include <sstream>
 #include <cstdlib>
 #include "FIXManager.h"
-// #include "AwesomeStrategy.h"
+#include "EventJournal.h"
+#include "StrategyHost.h"
+#include "Metrics.h"
 #include "MathHelper.h"
 #include "CFGParser.h"
 #include "StringHelper.h"
-
-// namespace IDEFIX {
-// 	void connect(FIXManager& fixmanager, AwesomeStrategy& strategy);	
-// };
+#include "CSVHandler.h"
+#include "Console.h"
 
 /*!
  * Check argument with option if option value exists.
@@ -54,8 +54,9 @@ int main(int argc, char** argv) {
 			cout << "Usage:" << endl;
 			cout << "   idefix <options> <broker.cfg>" << endl;
 			cout << "Options:" << endl;
-			//cout << "   -s file  \t Load strategy cfg file." << endl;
-			cout << "    -s symbol  \t The symbol like GBP/USD" << endl;
+			cout << "    -c file    \t Load strategy cfg file, can be used more than once" << endl;
+			cout << "    -w count   \t Strategy worker threads, defaults to one per core" << endl;
+			cout << "    -s symbol  \t The symbol like GBP/USD, ticks are printed" << endl;
 			cout << endl;
 			
 			return EXIT_SUCCESS;
@@ -64,7 +65,8 @@ int main(int argc, char** argv) {
 		// defaults
 		// config file
 		std::string config_file;
-		//std::string strategy_cfg_file;
+		std::vector<std::string> strategy_cfg_files;
+		unsigned int workers = 0;
 		std::string symbol_param;
 
 		// parse arguments
@@ -72,7 +74,23 @@ int main(int argc, char** argv) {
 			std::string arg = argv[ i ];
 
 			// strategy config file
-			if ( arg == "-s" ) {
+			if ( arg == "-c" ) {
+				if ( ! check_argument_option( argc, i, arg ) ) {
+					return EXIT_FAILURE;
+				}
+
+				strategy_cfg_files.push_back( argv[ ++i ] );
+			}
+			// strategy worker threads
+			else if ( arg == "-w" ) {
+				if ( ! check_argument_option( argc, i, arg ) ) {
+					return EXIT_FAILURE;
+				}
+
+				workers = atoi( argv[ ++i ] );
+			}
+			// symbol
+			else if ( arg == "-s" ) {
 				if ( ! check_argument_option( argc, i, arg ) ) {
 					return EXIT_FAILURE;
 				}
@@ -85,6 +103,9 @@ int main(int argc, char** argv) {
 			}
 		}
 
+		// metrics in shared memory for tools/metrics, before any metric is registered
+		Metrics::open();
+
 		// init fix manager, early init because of fixmanager.console()
 		FIXManager fixmanager;
 
@@ -94,85 +115,78 @@ int main(int argc, char** argv) {
 			return EXIT_FAILURE;
 		}
 
-		// check symbol
-		if ( symbol_param.empty() ) {
-			fixmanager.console()->error( "No symbol found." );
+		// check symbol and strategy config files
+		if ( symbol_param.empty() && strategy_cfg_files.empty() ) {
+			fixmanager.console()->error( "No symbol or strategy config file found." );
 			return EXIT_FAILURE;
 		}
 
-		// check strategy config file
-		// if ( strategy_cfg_file.empty() ) {
-		// 	fixmanager.console()->error( "No strategy config file found." );
-		// 	return EXIT_FAILURE;
-		// }
-
-// #ifdef CMAKE_USE_HTML_CHARTS
-// 		// purge csv files in public_html folder
-// 		std::system( "if [ \"$(ls -A public_html/*_bars.csv)\" ]; then rm public_html/*_bars.csv; fi" );
-// #endif
-				
-		// Strategy Configuration
-		// AwesomeStrategyConfig strategy_config;
-
-		// Parse strategy config file
-		// try {
-		// 	auto scfg = CFGParser( strategy_cfg_file );
-		// 	if ( ! scfg.has_error() ) {
-		// 		// overwrite strategy config
-		// 		strategy_config.max_short_pos = atoi( scfg.value( "max_short_pos" ).c_str() );
-		// 		strategy_config.max_long_pos  = atoi( scfg.value( "max_long_pos" ).c_str() );
-		// 		strategy_config.max_pip_risk  = atoi( scfg.value( "max_pip_risk" ).c_str() );
-		// 		strategy_config.max_risk      = atof( scfg.value( "max_risk" ).c_str() );
-		// 		strategy_config.max_qty       = atof( scfg.value( "max_qty" ).c_str() );
-		// 		strategy_config.max_spread    = atof( scfg.value( "max_spread" ).c_str() );
-		// 		strategy_config.renko_size    = atof( scfg.value( "renko_size" ).c_str() );
-		// 		strategy_config.sma_size      = atoi( scfg.value( "sma_size" ).c_str() );
-		// 		strategy_config.wait_bricks   = atoi( scfg.value( "wait_bricks" ).c_str() );
-
-		// 		// parse symbols
-		// 		std::string symbol_list = scfg.value( "symbols" );
-		// 		auto slist              = str::explode( symbol_list, ',' );
-		// 		strategy_config.symbols = slist;
-		// 	} 
-		// } catch(...) {
-		// 	return EXIT_FAILURE;
-		// } 
-
-		// check if symbols are configured
-		// if ( strategy_config.symbols.empty() ) {
-		// 	fixmanager.console()->error( "No symbols found in {}.", strategy_cfg_file );
-		// 	return EXIT_FAILURE;
-		// }
-
-		// // init strategy and connect with fixmanager
-		// for ( auto& symbol : strategy_config.symbols ) {
-		// 	if ( ! symbol.empty() ) {
-		// 		AwesomeStrategy* strategy = new AwesomeStrategy( symbol, strategy_config );
-		// 		connect( fixmanager, *strategy );
-		// 	}
-		// }
+		// journal of all application messages and quotes, read with tools/journal,
+		// the strategies warm up with its quotes
+		FIX::file_mkdir( "journal/" );
+		EventJournal journal( "journal/events.journal" );
+		journal.open();
+		fixmanager.setJournal( &journal );
+
+		// strategies of all cfg files, every symbol runs on one worker thread
+		StrategyHost host( fixmanager, workers );
+		host.set_journal( &journal );
+		for ( auto& strategy_cfg_file : strategy_cfg_files ) {
+			if ( host.load( strategy_cfg_file ) == 0 ) {
+				fixmanager.console()->error( "No symbols found in {}.", strategy_cfg_file );
+				return EXIT_FAILURE;
+			}
+		}
+		host.start();
+
+		// write csv files (trades, bars) in the background
+		CSVHandler::start_writer();
+
+		// prometheus text file, e.g. for the node exporter textfile collector
+		FIX::file_mkdir( "metrics/" );
+		Metrics::start_writer( "metrics/idefix.prom" );
+
+		// market details and system params of the last session, used until TradingSessionStatus arrives
+		FIX::file_mkdir( "cache/" );
+		fixmanager.setMarketCache( "cache/market.cache" );
+
+		// account, market details and positions of the last session from the journal,
+		// replaced by the answers to the requests of the new session
+		try {
+			FIX::SessionSettings settings( config_file );
+			if ( settings.get().has( "DataDictionary" ) ) {
+				FIX::DataDictionary dictionary( settings.get().getString( "DataDictionary" ) );
+				fixmanager.restore( journal, dictionary );
+			}
+		} catch ( FIX::ConfigError& e ) {
+			fixmanager.console()->warn( "Journal not restored: {}", e.what() );
+		}
 
 		// connect 
 		fixmanager.connect( config_file );
 
 		// callbacks
 		fixmanager.on_init.connect( [&]() {
-			FIX::Locker lock( fixmanager.m_mutex );
-			fixmanager.subscribeMarketData( symbol_param );
+			if ( ! symbol_param.empty() ) {
+				fixmanager.subscribeMarketData( symbol_param );
+			}
 		});
 
 		fixmanager.on_exit.connect( [&]() {
-			FIX::Locker lock( fixmanager.m_mutex );
-			fixmanager.unsubscribeMarketData( symbol_param ); 
+			if ( ! symbol_param.empty() ) {
+				fixmanager.unsubscribeMarketData( symbol_param );
+			}
 		});
 
-		fixmanager.on_tick.connect( [&](const MarketSnapshot& tick){
-			FIX::Locker lock( fixmanager.m_mutex );
-
+		// tick log, at most one line per second, formatted only if it is written
+		auto tick_console = fixmanager.console();
+		LogLimiter tick_limiter( 1000 );
+		fixmanager.on_tick.connect( [&, tick_console](const MarketSnapshot& tick){
 			if ( fixmanager.isExiting() ) return;
 
-			if ( tick.getSymbol() == symbol_param ) {
-				fixmanager.console()->info( "[ONTICK] {}", tick.toString() );
+			if ( tick.getSymbol() == symbol_param && tick_console->should_log( spdlog::level::info ) && tick_limiter.allow() ) {
+				tick_console->info( "[ONTICK] {} bid: {:.{}f} ask: {:.{}f} spread: {:.2f} ts: {} ({} suppressed)",
+					tick.getSymbol(), tick.getBid(), tick.getPrecision(), tick.getAsk(), tick.getPrecision(), tick.getSpread(), tick.getSendingTime(), tick_limiter.suppressed() );
 			}
 		});
 
@@ -186,8 +200,23 @@ int main(int argc, char** argv) {
 				fixmanager.disconnect();
 				break;
 			}
+			// strategy counters and cpu time
+			else if ( command == 1 ) {
+				host.report();
+			}
 		}
 
+		host.stop();
+		host.report();
+
+		CSVHandler::stop_writer();
+
+		Metrics::stop_writer();
+		Metrics::close();
+
+		fixmanager.setJournal( nullptr );
+		journal.close();
+
 	} catch(std::exception& e) {
 		cerr << "Damn: " << e.what() << endl;
 		return EXIT_FAILURE;
@@ -198,112 +227,3 @@ int main(int argc, char** argv) {
 
 	return EXIT_SUCCESS;
 }
-
-/*!
- * Connect fixmanager signals to strategy slots
- * 
- * @param FIXManager& fixmanager
- * @param const AwesomeStrategy& strategy
- */
-// void IDEFIX::connect(FIXManager& fixmanager, AwesomeStrategy& strategy) {
-// 	// FIXManager signals
-// 	// On Init
-// 	fixmanager.on_init.connect( [&]() { 
-// 		FIX::Locker lock( fixmanager.m_mutex );
-
-// 		fixmanager.subscribeMarketData( strategy.get_symbol() );
-// 		fixmanager.closeAllPositions( strategy.get_symbol() );
-// 		fixmanager.queryAccounts();
-
-// 		strategy.on_init();		
-// 	});
-
-// 	// On Exit
-// 	fixmanager.on_exit.connect( [&]() { 
-// 		FIX::Locker lock( fixmanager.m_mutex );
-
-// 		fixmanager.closeAllPositions( strategy.get_symbol() );
-// 		fixmanager.queryAccounts();
-
-// 		fixmanager.unsubscribeMarketData( strategy.get_symbol() ); 
-		
-// 		strategy.on_exit();
-// 	});
-
-// 	// On tick
-// 	fixmanager.on_tick.connect( [&](const MarketSnapshot& tick){
-// 		FIX::Locker lock( fixmanager.m_mutex );
-
-// 		if ( fixmanager.isExiting() ) return;
-
-// 		if ( tick.getSymbol() == strategy.get_symbol() ) {
-// 			strategy.on_tick( tick );
-// 		}
-// 	});
-	
-// 	// on entry signal open new market order
-// 	strategy.on_entry_signal.connect( [&](const MarketSide side) {
-// 		FIX::Locker lock( fixmanager.m_mutex );
-
-// 		// close all opposite trades in this symbol
-// 		FIX::Side opposide( ( side == MarketSide::Side_SELL ? FIX::Side_BUY : FIX::Side_SELL ) );
-// 		fixmanager.closeAllPositions( strategy.get_symbol(), opposide.getValue() );
-
-// 		// open new trade
-// 		double conversion_price = 0;
-// 		double free_margin      = fixmanager.getAccount()->getFreeMargin();
-// 		double pip_risk         = strategy.get_config()->max_pip_risk;
-// 		double percent_risk     = strategy.get_config()->max_risk;
-
-// 		// get latest data
-// 		// latest market snapshot
-// 		auto ms = fixmanager.getLatestSnapshot( strategy.get_symbol() );
-// 		// latest market details
-// 		auto md = fixmanager.getMarketDetails( strategy.get_symbol() );
-
-// 		// create market order
-// 		MarketOrder mo;
-// 		// set account id
-// 		mo.setAccountID( fixmanager.getAccountID() );
-// 		// set market detail precision and pointsize
-// 	    mo.setPrecision( md->getSymPrecision() );
-// 	    mo.setPointSize( md->getSymPointsize() );
-// 		// set symbol
-// 		mo.setSymbol( strategy.get_symbol() );
-// 		// set side
-// 		FIX::Side fix_side( ( side == MarketSide::Side_SELL ? FIX::Side_SELL : FIX::Side_BUY ) );
-// 		mo.setSide( fix_side.getValue() );
-// 		// set qty
-// 		mo.setQty( Math::get_unit_size( free_margin, percent_risk, pip_risk, conversion_price, mo.getPointSize() ) );
-// 		// set qty to maximum in strategy config		
-// 		if ( mo.getQty() > strategy.get_config()->max_qty ) {
-// 			mo.setQty( strategy.get_config()->max_qty );
-// 		}
-// 		// set entry price
-// 		mo.setPrice( 0 ); // MarketOrder
-// 		// set stoploss
-// 		// for sell
-// 		if ( side == MarketSide::Side_SELL ) {
-// 			mo.setStopPrice( ms->getBid() + ( mo.getPointSize() * pip_risk ) );
-// 		} 
-// 		// for buy
-// 		else if ( side == MarketSide::Side_BUY ) {
-// 			mo.setStopPrice( ms->getAsk() - ( mo.getPointSize() * pip_risk ) );
-// 		}
-		
-// 		fixmanager.console()->info("[on_entry_signal] Open Position in {} on {} with size {:f}", mo.getSymbol(), mo.getSideStr(), mo.getQty() );
-// 		//cout << "[on_entry_signal] Open Position in " << mo.getSymbol() << " on " << mo.getSideStr() << " with size " << mo.getQty() << endl;
-
-// 		fixmanager.marketOrder( mo, FIXFactory::SingleOrderType::MARKET_ORDER_SL );
-// 		// fixmanager.marketOrder( mo );
-// 		fixmanager.queryPositionReport();
-// 	});
-
-// 	// on close all signal close all positions for symbol
-// 	strategy.on_close_all_signal.connect( [&](const std::string& symbol) {
-// 		FIX::Locker lock( fixmanager.m_mutex );
-// 		fixmanager.closeAllPositions( symbol );
-// 		fixmanager.queryAccounts();
-// 	});
-	
-// }
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include "MarketSnapshot.h"
+#include "TimeHelper.h"
+#include "BarBuilder.h"
+#include "BarPipeline.h"
+#include "BarStore.h"
+#include "RenkoChart.h"
+#include "Exceptions.h"
+
+// Output of the bar builders behind BarPipeline and the BarStore ring:
+// time, tick, range, renko and Heikin-Ashi bars from synthetic ticks,
+// ring wrap of a small store and the default capacity of RenkoChart.
+//
+// Runs with ctest, fails if a check fails.
+//
+// bartest
+
+using namespace IDEFIX;
+
+static int failed = 0;
+
+void check(const bool condition, const std::string& what) {
+	if ( ! condition ) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failed++;
+	}
+}
+
+bool equal(const double a, const double b) {
+	return std::fabs( a - b ) < 1e-9;
+}
+
+// 2018-04-23 00:00:00 UTC
+const long long START_MS = 1524441600000LL;
+
+MarketSnapshot snapshot(const long long time_ms, const double bid) {
+	char sending_time[32];
+	times::ms_to_fix( time_ms, sending_time );
+
+	MarketSnapshot s;
+	s.setSymbol( "EUR/USD" );
+	s.setPointSize( 0.0001 );
+	s.setSendingTime( sending_time );
+	s.setBid( bid );
+	s.setAsk( bid + 0.0002 );
+	return s;
+}
+
+void test_tick_bars() {
+	BarPipeline pipeline( "EUR/USD" );
+	AbstractBarBuilder* builder = pipeline.add( new TickBarBuilder( 10 ) );
+
+	for ( int i = 0; i < 25; i++ ) {
+		pipeline.on_tick( snapshot( START_MS + i * 1000, 1.1 + i * 0.0001 ) );
+	}
+
+	std::vector<Bar> bars = pipeline.store().list( builder->series() );
+	check( bars.size() == 2, "tick bars: two bars from 25 ticks" );
+	if ( bars.size() != 2 ) return;
+
+	check( bars[0].volume == 10 && bars[1].volume == 10, "tick bars: volume is the tick count" );
+	check( equal( bars[0].open_price, 1.1 ) && equal( bars[0].close_price, 1.1009 ), "tick bars: open and close of the first bar" );
+	check( equal( bars[1].open_price, 1.101 ), "tick bars: second bar opens with the eleventh tick" );
+	check( bars[0].status == Bar::STATUS::LONG, "tick bars: rising bar is long" );
+}
+
+void test_time_bars() {
+	BarPipeline pipeline( "EUR/USD" );
+	TimeBarBuilder* builder = static_cast<TimeBarBuilder*>( pipeline.add( new TimeBarBuilder( 60 ) ) );
+
+	for ( int i = 0; i < 150; i++ ) {
+		pipeline.on_tick( snapshot( START_MS + i * 1000, i < 60 ? 1.1 : 1.09 ) );
+	}
+
+	check( pipeline.store().count( builder->series() ) == 2, "time bars: minute bars closed by the next minute" );
+	builder->flush();
+
+	std::vector<Bar> bars = pipeline.store().list( builder->series() );
+	check( bars.size() == 3, "time bars: flush emits the open bar" );
+	if ( bars.size() != 3 ) return;
+
+	check( bars[0].volume == 60 && bars[1].volume == 60 && bars[2].volume == 30, "time bars: ticks per minute" );
+	check( bars[0].open_time == "20180423-00:00:00.000" && bars[0].close_time == "20180423-00:00:59.000", "time bars: open and close time" );
+	check( bars[1].open_time == "20180423-00:01:00.000", "time bars: next bar starts at the minute" );
+}
+
+void test_range_bars() {
+	BarPipeline pipeline( "EUR/USD" );
+	AbstractBarBuilder* builder = pipeline.add( new RangeBarBuilder( 10 ) );
+
+	// 3 pips per tick, the fifth tick exceeds the range
+	for ( int i = 0; i < 5; i++ ) {
+		pipeline.on_tick( snapshot( START_MS + i * 1000, 1.1 + i * 0.0003 ) );
+	}
+
+	std::vector<Bar> bars = pipeline.store().list( builder->series() );
+	check( bars.size() == 1, "range bars: one bar" );
+	if ( bars.size() != 1 ) return;
+
+	check( equal( bars[0].open_price, 1.1 ) && equal( bars[0].close_price, 1.101 ), "range bars: close capped to one range" );
+	check( equal( bars[0].high_price, 1.101 ) && equal( bars[0].low_price, 1.1 ), "range bars: high and low" );
+	check( bars[0].volume == 5, "range bars: volume" );
+}
+
+void test_renko_bars() {
+	BarPipeline pipeline( "EUR/USD" );
+	AbstractBarBuilder* builder = pipeline.add( new RenkoBarBuilder( 10 ) );
+
+	const double prices[] = { 1.1, 1.1012, 1.1015, 1.1022, 1.0998 };
+	for ( int i = 0; i < 5; i++ ) {
+		pipeline.on_tick( snapshot( START_MS + i * 1000, prices[i] ) );
+	}
+
+	std::vector<Bar> bars = pipeline.store().list( builder->series() );
+	check( bars.size() == 3, "renko: init, trend and reverse brick" );
+	if ( bars.size() != 3 ) return;
+
+	check( bars[0].status == Bar::STATUS::LONG && equal( bars[0].open_price, 1.1 ) && equal( bars[0].close_price, 1.101 ), "renko: first brick capped to the brick size" );
+	check( bars[1].status == Bar::STATUS::LONG && equal( bars[1].open_price, 1.101 ) && equal( bars[1].close_price, 1.102 ), "renko: trend brick opens at the last close" );
+	check( bars[2].status == Bar::STATUS::SHORT && equal( bars[2].open_price, 1.101 ) && equal( bars[2].close_price, 1.1 ), "renko: reverse brick opens at the last open" );
+	check( equal( bars[2].diff, 10 ), "renko: diff is the brick size" );
+}
+
+void test_heikin_ashi_bars() {
+	BarPipeline pipeline( "EUR/USD" );
+	AbstractBarBuilder* time_bars = pipeline.add( new TimeBarBuilder( 60 ) );
+	AbstractBarBuilder* ha_bars   = pipeline.add( new HeikinAshiBarBuilder( 60 ) );
+
+	for ( int i = 0; i < 121; i++ ) {
+		pipeline.on_tick( snapshot( START_MS + i * 1000, 1.1 + ( i % 7 ) * 0.0001 + ( i / 60 ) * 0.001 ) );
+	}
+
+	std::vector<Bar> bars = pipeline.store().list( time_bars->series() );
+	std::vector<Bar> ha   = pipeline.store().list( ha_bars->series() );
+	check( bars.size() == 2 && ha.size() == 2, "heikin-ashi: one bar per time bar" );
+	if ( bars.size() != 2 || ha.size() != 2 ) return;
+
+	const Bar& b = bars[1];
+	check( equal( ha[1].close_price, ( b.open_price + b.high_price + b.low_price + b.close_price ) / 4 ), "heikin-ashi: close is the ohlc average" );
+	check( equal( ha[1].open_price, ( ha[0].open_price + ha[0].close_price ) / 2 ), "heikin-ashi: open from the previous bar" );
+	check( ha[1].high_price >= b.high_price && ha[1].low_price <= b.low_price, "heikin-ashi: high and low include the time bar" );
+}
+
+void test_store_wrap() {
+	BarPipeline pipeline( "EUR/USD", 8 );
+	AbstractBarBuilder* builder = pipeline.add( new TickBarBuilder( 1 ) );
+	const int series = builder->series();
+
+	for ( int i = 0; i < 20; i++ ) {
+		pipeline.on_tick( snapshot( START_MS + i * 1000, 1.1 + i * 0.0001 ) );
+	}
+
+	BarStore& store = pipeline.store();
+	check( store.count( series ) == 20, "ring: count includes dropped bars" );
+
+	std::vector<Bar> bars = store.list( series );
+	check( bars.size() == 8, "ring: list holds the capacity" );
+	if ( bars.size() == 8 ) {
+		check( equal( bars.front().open_price, 1.1012 ) && equal( bars.back().open_price, 1.1019 ), "ring: list is oldest first after the wrap" );
+	}
+
+	check( equal( store.at( series, 0 ).open_price, 1.1019 ), "ring: at(0) is the newest bar" );
+	check( equal( store.at( series, 7 ).open_price, 1.1012 ), "ring: at(capacity - 1) is the oldest kept bar" );
+
+	bool dropped = false;
+	try {
+		store.at( series, 8 );
+	} catch ( IDEFIX::element_not_found& ) {
+		dropped = true;
+	}
+	check( dropped, "ring: dropped bar throws element_not_found" );
+
+	bool never = false;
+	try {
+		store.at( series, 20 );
+	} catch ( IDEFIX::out_of_range& ) {
+		never = true;
+	}
+	check( never, "ring: never added bar throws out_of_range" );
+
+	store.clear();
+	check( store.count( series ) == 0 && store.list( series ).empty(), "ring: clear empties the series" );
+}
+
+void test_renko_chart_capacity() {
+	RenkoChart chart( 1 );
+
+	// every tick adds one long brick, capped to one pip
+	const int bricks = BarStore::DEFAULT_CAPACITY + 100;
+	for ( int i = 0; i <= bricks; i++ ) {
+		chart.on_tick( snapshot( START_MS + i * 1000, 1.0 + i * 0.0002 ) );
+	}
+
+	check( chart.brick_count() == bricks, "renko chart: brick count" );
+	check( chart.brick_list().size() == BarStore::DEFAULT_CAPACITY, "renko chart: ring holds the default capacity" );
+
+	bool kept = true;
+	try {
+		chart.at( BarStore::DEFAULT_CAPACITY - 1 );
+	} catch ( ... ) {
+		kept = false;
+	}
+	check( kept, "renko chart: oldest kept brick" );
+
+	bool dropped = false;
+	try {
+		chart.at( BarStore::DEFAULT_CAPACITY );
+	} catch ( IDEFIX::element_not_found& ) {
+		dropped = true;
+	}
+	check( dropped, "renko chart: older bricks throw element_not_found" );
+}
+
+int main() {
+	test_tick_bars();
+	test_time_bars();
+	test_range_bars();
+	test_renko_bars();
+	test_heikin_ashi_bars();
+	test_store_wrap();
+	test_renko_chart_capacity();
+
+	if ( failed > 0 ) {
+		std::cerr << failed << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "all bar checks passed" << std::endl;
+	return EXIT_SUCCESS;
+}
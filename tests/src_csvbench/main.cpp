@@ -0,0 +1,230 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include "FileAdapter.h"
+#include "TickArchive.h"
+#include "TickRecord.h"
+#include "TimeHelper.h"
+
+// Tick csv throughput of an FXCM export:
+// legacy: getline per line, stringstream and getline per cell, atof per price,
+//         as the old renko test did after scripts/convert.sh
+// FileAdapter with 1 thread and with all cores, UTF-16 and 8 bit input
+//
+// Without file the parsers are compared on generated ticks and a corrupt
+// archive must throw file_not_found, this runs with ctest.
+
+using namespace IDEFIX;
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since(const Clock::time_point start) {
+	return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+size_t legacy_parse(const std::string& text, std::vector<TickRecord>& ticks) {
+	std::istringstream input( text );
+	std::string line;
+	while ( std::getline( input, line ) ) {
+		std::stringstream line_stream( line );
+		std::string cell;
+		TickRecord tick = { 0, 0, 0 };
+
+		int cell_i = 0;
+		while ( std::getline( line_stream, cell, ',' ) ) {
+			if ( cell_i == 0 && cell.size() >= 23 ) {
+				tick.time_ms = times::fxcm_to_ms( cell.c_str() );
+			} else if ( cell_i == 1 ) {
+				tick.bid = atof( cell.c_str() );
+			} else if ( cell_i == 2 ) {
+				tick.ask = atof( cell.c_str() );
+			}
+			cell_i++;
+		}
+
+		if ( tick.bid > 0 && tick.ask > 0 ) {
+			ticks.push_back( tick );
+		}
+	}
+	return ticks.size();
+}
+
+void report(const std::string& name, const size_t bytes, const size_t ticks, const double seconds) {
+	std::cout << std::left << std::setw(32) << name << std::right
+			  << std::setw(10) << ticks << " ticks"
+			  << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+			  << std::setw(10) << std::setprecision(3) << bytes / seconds / 1e9 << " GB/s" << std::endl;
+}
+
+static int failed = 0;
+
+void check(const bool condition, const std::string& what) {
+	if ( ! condition ) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failed++;
+	}
+}
+
+bool same_ticks(const std::vector<TickRecord>& a, const std::vector<TickRecord>& b) {
+	if ( a.size() != b.size() ) {
+		return false;
+	}
+	for ( size_t i = 0; i < a.size(); i++ ) {
+		if ( a[i].time_ms != b[i].time_ms || std::fabs( a[i].bid - b[i].bid ) > 1e-9 || std::fabs( a[i].ask - b[i].ask ) > 1e-9 ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// FXCM export of one day, large enough for more than one chunk
+std::string generate_csv(const size_t lines) {
+	std::string text = "DateTime,Bid,Ask\n";
+	char line[64];
+	for ( size_t i = 0; i < lines; i++ ) {
+		const long long ms = i * 250;
+		const double bid   = 1.2 + 0.001 * std::sin( i / 1000.0 );
+		snprintf( line, sizeof( line ), "04/22/2018 %02lld:%02lld:%02lld.%03lld,%.5f,%.5f\n",
+			ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000, bid, bid + 0.00012 );
+		text += line;
+	}
+	return text;
+}
+
+int self_check() {
+	const std::string text = generate_csv( 300000 );
+
+	// UTF-16 LE with BOM, as downloaded
+	std::string utf16 = "\xFF\xFE";
+	for ( char c : text ) {
+		utf16.push_back( c );
+		utf16.push_back( '\0' );
+	}
+
+	std::vector<TickRecord> legacy;
+	legacy_parse( text, legacy );
+	check( legacy.size() == 300000, "legacy parser reads every line" );
+
+	for ( unsigned int threads : { 1u, 4u } ) {
+		std::vector<TickRecord> ticks;
+		FileAdapter::parse( text.data(), text.size(), ticks, threads );
+		check( same_ticks( legacy, ticks ), "8 bit ticks with " + std::to_string( threads ) + " threads" );
+
+		ticks.clear();
+		FileAdapter::parse( utf16.data(), utf16.size(), ticks, threads );
+		check( same_ticks( legacy, ticks ), "UTF-16 ticks with " + std::to_string( threads ) + " threads" );
+	}
+
+	const std::string filename = "csvbench_check.tick";
+	TickArchive::write( filename, "EUR/USD", 0.0001, legacy );
+
+	std::vector<TickRecord> archived;
+	FileAdapter( filename ).load( archived );
+	check( same_ticks( legacy, archived ), "archive ticks" );
+
+	// continuation bits in the first block, its varints run past the block
+	{
+		std::fstream file( filename.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+		file.seekp( sizeof( TickArchive::Header ) );
+		const std::string garbage( 64, '\x80' );
+		file.write( garbage.data(), garbage.size() );
+	}
+
+	std::vector<TickRecord> corrupt;
+	bool thrown = false;
+	try {
+		FileAdapter( filename ).load( corrupt );
+	} catch ( IDEFIX::file_not_found& e ) {
+		thrown = true;
+	}
+	check( thrown && corrupt.empty(), "corrupt archive throws file_not_found" );
+	std::remove( filename.c_str() );
+
+	if ( failed > 0 ) {
+		std::cerr << failed << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "all csv checks passed, usage: csvbench tickdata.csv [rounds=3]" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		return self_check();
+	}
+
+	const std::string filename = argv[1];
+	const int rounds           = argc > 2 ? atoi( argv[2] ) : 3;
+	const unsigned int cores   = std::max( 1u, std::thread::hardware_concurrency() );
+
+	std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+	if ( ! file.is_open() ) {
+		std::cerr << "File not found: " << filename << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::string raw( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+	// 8 bit copy like scripts/convert.sh, the legacy loop needs it
+	std::string text;
+	text.reserve( raw.size() );
+	for ( char c : raw ) {
+		const unsigned char u = c;
+		if ( u != 0 && u != 0xFF && u != 0xFE ) {
+			text.push_back( c );
+		}
+	}
+
+	std::cout << filename << ": " << raw.size() << " bytes, " << ( FileAdapter::is_utf16( raw.data(), raw.size() ) ? "UTF-16" : "8 bit" )
+			  << ", " << cores << " cores, best of " << rounds << std::endl;
+
+	struct Case {
+		std::string name;
+		const std::string* data;
+		unsigned int threads;
+		bool legacy;
+	};
+	std::vector<Case> cases = {
+		{ "legacy getline (8 bit)", &text, 1, true },
+		{ "FileAdapter 1 thread", &raw, 1, false },
+		{ "FileAdapter all cores", &raw, cores, false },
+		{ "FileAdapter 1 thread (8 bit)", &text, 1, false },
+		{ "FileAdapter all cores (8 bit)", &text, cores, false },
+	};
+
+	for ( auto& c : cases ) {
+		double best  = 0;
+		size_t count = 0;
+		for ( int r = 0; r < rounds; r++ ) {
+			std::vector<TickRecord> ticks;
+			auto start = Clock::now();
+			count = c.legacy ? legacy_parse( *c.data, ticks ) : FileAdapter::parse( c.data->data(), c.data->size(), ticks, c.threads );
+			const double elapsed = seconds_since( start );
+			best = r == 0 ? elapsed : std::min( best, elapsed );
+		}
+		report( c.name, c.data->size(), count, best );
+	}
+
+	// whole load path: mmap, parse, chunks
+	double best  = 0;
+	size_t count = 0;
+	for ( int r = 0; r < rounds; r++ ) {
+		std::vector<TickRecord> ticks;
+		auto start = Clock::now();
+		FileAdapter adapter( filename );
+		count = adapter.load( ticks );
+		const double elapsed = seconds_since( start );
+		best = r == 0 ? elapsed : std::min( best, elapsed );
+	}
+	report( "FileAdapter::load", raw.size(), count, best );
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include "Bar.h"
+#include "AbstractMovingAverage.h"
+#include "SimpleMovingAverage.h"
+#include "IndicatorPipeline.h"
+
+// Compares the per brick path of AwesomeStrategy:
+// legacy: virtual moving averages and std::vector arguments by value
+// fused:  indicator::Pipeline<Renko, SMA<5>, SMA<10>> with inline state
+//
+// Runs with ctest, fails if both paths don't emit the same signals.
+//
+// indicatorbench [bricks=5000000]
+
+using namespace IDEFIX;
+
+// legacy signal check, as used by AwesomeStrategy before the fused pipeline
+bool legacy_is_entry(const std::vector<double> open_price, const std::vector<double> close_price, const double moving_average) {
+	return open_price[0] < close_price[0] && open_price[1] < close_price[1] && open_price[2] > close_price[2]
+		&& open_price[0] > moving_average && close_price[0] > moving_average;
+}
+
+bool legacy_is_exit(const std::vector<double> open_price, const std::vector<double> close_price, const double moving_average) {
+	return open_price[0] > close_price[0] && open_price[1] < close_price[1] && close_price[0] < moving_average;
+}
+
+template<typename T>
+bool fused_is_entry(const T& p) {
+	const indicator::Renko& b = p.source();
+	const double ma = p.template get<0>().value();
+	return b.is_long( 0 ) && b.is_long( 1 ) && b.is_short( 2 ) && b.open( 0 ) > ma && b.close( 0 ) > ma;
+}
+
+template<typename T>
+bool fused_is_exit(const T& p) {
+	const indicator::Renko& b = p.source();
+	return b.is_short( 0 ) && b.is_long( 1 ) && b.close( 0 ) < p.template get<0>().value();
+}
+
+int main(int argc, char** argv) {
+	const int count = argc > 1 ? atoi( argv[1] ) : 5000000;
+
+	// random walk renko bricks
+	std::vector<Bar> bricks( count );
+	double price = 1.2;
+	srand( 1 );
+	for ( auto& b : bricks ) {
+		b.clear();
+		b.open_price  = price;
+		price        += ( rand() % 2 ? 1 : -1 ) * 0.0005;
+		b.close_price = price;
+	}
+
+	// legacy path
+	long legacy_signals = 0;
+	auto start = std::chrono::steady_clock::now();
+	{
+		std::unique_ptr<AbstractMovingAverage> sma5( new SimpleMovingAverage( 5 ) );
+		std::unique_ptr<AbstractMovingAverage> sma10( new SimpleMovingAverage( 10 ) );
+		for ( int i = 2; i < count; i++ ) {
+			const Bar& b = bricks[i];
+			sma5->add( ( b.open_price + b.close_price ) / 2 );
+			sma10->add( ( b.open_price + b.close_price ) / 2 );
+
+			const std::vector<double> open_price  = { b.open_price, bricks[i - 1].open_price, bricks[i - 2].open_price };
+			const std::vector<double> close_price = { b.close_price, bricks[i - 1].close_price, bricks[i - 2].close_price };
+			legacy_signals += legacy_is_entry( open_price, close_price, sma5->value() );
+			legacy_signals += legacy_is_exit( open_price, close_price, sma5->value() );
+			legacy_signals += sma10->value() > 0;
+		}
+	}
+	double legacy_ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	// fused path
+	long fused_signals = 0;
+	start = std::chrono::steady_clock::now();
+	{
+		indicator::Pipeline<indicator::Renko, indicator::SMA<5>, indicator::SMA<10> > pipeline;
+		pipeline.on_bar( bricks[0] );
+		pipeline.on_bar( bricks[1] );
+		for ( int i = 2; i < count; i++ ) {
+			pipeline.on_bar( bricks[i] );
+			fused_signals += fused_is_entry( pipeline );
+			fused_signals += fused_is_exit( pipeline );
+			fused_signals += pipeline.get<1>().value() > 0;
+		}
+	}
+	double fused_ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "bricks " << count << std::endl;
+	std::cout << "legacy " << legacy_ms << " ms " << ( legacy_ms * 1e6 / count ) << " ns/brick signals " << legacy_signals << std::endl;
+	std::cout << "fused  " << fused_ms << " ms " << ( fused_ms * 1e6 / count ) << " ns/brick signals " << fused_signals << std::endl;
+	std::cout << "speedup " << ( legacy_ms / fused_ms ) << "x" << std::endl;
+
+	if ( legacy_signals != fused_signals ) {
+		std::cerr << "FAILED: fused pipeline signals differ from the legacy path" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
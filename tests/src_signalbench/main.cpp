@@ -0,0 +1,87 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <functional>
+#include <nod/nod.hpp>
+#include "FastSignal.h"
+
+// Emit cost of nod::signal and FastSignal with the same slots:
+// one member function, one lambda, one free function.
+//
+// signalbench [emits]
+
+using namespace IDEFIX;
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since(const Clock::time_point start) {
+	return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+struct Quote {
+	double bid;
+	double ask;
+};
+
+struct Receiver {
+	double sum;
+	Receiver(): sum( 0 ) {}
+
+	void on_quote(const Quote& quote) {
+		sum += quote.bid;
+	}
+};
+
+static double g_spread = 0;
+
+void on_quote(const Quote& quote) {
+	g_spread += quote.ask - quote.bid;
+}
+
+int main(int argc, char const *argv[]) {
+	const long emits = argc > 1 ? atol( argv[1] ) : 10000000;
+
+	Receiver nod_receiver;
+	long nod_count = 0;
+	nod::signal<void(const Quote&)> nod_signal;
+	nod_signal.connect( std::bind( &Receiver::on_quote, &nod_receiver, std::placeholders::_1 ) );
+	nod_signal.connect( [&nod_count](const Quote&) { nod_count++; } );
+	nod_signal.connect( &on_quote );
+
+	Receiver fast_receiver;
+	long fast_count = 0;
+	FastSignal<const Quote&> fast_signal;
+	fast_signal.connect<Receiver, &Receiver::on_quote>( &fast_receiver );
+	fast_signal.connect( [&fast_count](const Quote&) { fast_count++; } );
+	fast_signal.connect<&on_quote>();
+
+	Quote quote;
+	quote.bid = 1.1;
+	quote.ask = 1.1001;
+
+	auto start = Clock::now();
+	for ( long i = 0; i < emits; i++ ) {
+		nod_signal( quote );
+	}
+	const double nod_seconds = seconds_since( start );
+
+	start = Clock::now();
+	for ( long i = 0; i < emits; i++ ) {
+		fast_signal( quote );
+	}
+	const double fast_seconds = seconds_since( start );
+
+	if ( nod_count != fast_count || nod_receiver.sum != fast_receiver.sum ) {
+		std::cerr << "slots were not called equally" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << std::fixed << std::setprecision( 1 );
+	std::cout << "emits:       " << emits << " with 3 slots" << std::endl;
+	std::cout << "nod::signal: " << nod_seconds * 1e9 / emits << " ns/emit" << std::endl;
+	std::cout << "FastSignal:  " << fast_seconds * 1e9 / emits << " ns/emit" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <quickfix/FileStore.h>
+#include <quickfix/MessageStore.h>
+#include "MappedStore.h"
+
+// Sent message path of a quickfix session: set + incrNextSenderMsgSeqNum per
+// message, then resend requests of 100 messages.
+// FileStoreFactory, MemoryStoreFactory and MappedStoreFactory with every durability.
+// A MappedStore with small segments is reopened and read back.
+//
+// Runs with ctest, fails if a check fails.
+//
+// storebench [count=100000] [path=./StoreBench]
+
+using namespace IDEFIX;
+
+typedef std::chrono::steady_clock Clock;
+
+static int failed = 0;
+
+void check(const bool condition, const std::string& what) {
+	if ( ! condition ) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failed++;
+	}
+}
+
+double seconds_since(const Clock::time_point start) {
+	return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+void report(const std::string& name, const std::string& what, const size_t count, const double seconds) {
+	std::cout << std::left << std::setw(24) << name << std::setw(8) << what << std::right
+			  << std::setw(10) << count << " msgs"
+			  << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+			  << std::setw(12) << std::setprecision(0) << count / seconds << " msgs/s" << std::endl;
+}
+
+void run(const std::string& name, FIX::MessageStoreFactory& factory, const FIX::SessionID& session_ID, const std::string& message, const int count) {
+	FIX::MessageStore* store = factory.create( session_ID );
+	store->reset();
+
+	auto start = Clock::now();
+	for ( int i = 0; i < count; i++ ) {
+		store->set( store->getNextSenderMsgSeqNum(), message );
+		store->incrNextSenderMsgSeqNum();
+	}
+	report( name, "set", count, seconds_since( start ) );
+
+	std::vector<std::string> messages;
+	size_t resent = 0;
+	start = Clock::now();
+	for ( int begin = 1; begin + 99 <= count; begin += 100 ) {
+		store->get( begin, begin + 99, messages );
+		resent += messages.size();
+	}
+	report( name, "resend", resent, seconds_since( start ) );
+
+	check( resent == static_cast<size_t>( count / 100 * 100 ), name + ": every message is resent" );
+	check( messages.empty() || messages.back() == message, name + ": resent message" );
+
+	factory.destroy( store );
+}
+
+int main(int argc, char** argv) {
+	const int count          = argc > 1 ? atoi( argv[1] ) : 100000;
+	const std::string path   = argc > 2 ? argv[2] : "./StoreBench";
+	const FIX::SessionID session_ID( "FIX.4.4", "storebench", "FXCM" );
+
+	// typical NewOrderSingle of FIXManager
+	const std::string message = "8=FIX.4.4\0019=188\00135=D\00134=2\00149=storebench\00150=U100D2\00152=20180423-08:00:00.000\00156=FXCM\00157=U100D2\001"
+		"1=01234567\00111=1524470400000\00138=10000\00140=1\00154=1\00155=EUR/USD\00159=1\00160=20180423-08:00:00.000\001453=1\001448=FXCM ID\001447=D\001452=3\00110=123\001";
+
+	std::cout << count << " messages of " << message.size() << " bytes in " << path << std::endl;
+
+	FIX::MemoryStoreFactory memory;
+	run( "MemoryStore", memory, session_ID, message, count );
+
+	FIX::FileStoreFactory file( path + "/file" );
+	run( "FileStore", file, session_ID, message, count );
+
+	MappedStoreFactory mapped_none( path + "/none", MappedStore::DURABILITY_NONE );
+	run( "MappedStore none", mapped_none, session_ID, message, count );
+
+	MappedStoreFactory mapped_async( path + "/async", MappedStore::DURABILITY_ASYNC );
+	run( "MappedStore async", mapped_async, session_ID, message, count );
+
+	// msync per message is slow, a tenth is enough
+	MappedStoreFactory mapped_sync( path + "/sync", MappedStore::DURABILITY_SYNC );
+	run( "MappedStore sync", mapped_sync, session_ID, message, std::max( 1, count / 10 ) );
+
+	// messages of all segments are kept after the store is destroyed
+	MappedStoreFactory mapped_segments( path + "/segments", MappedStore::DURABILITY_ASYNC, 1 << 16 );
+	run( "MappedStore 64k segments", mapped_segments, session_ID, message, count );
+
+	FIX::MessageStore* store = mapped_segments.create( session_ID );
+	std::vector<std::string> messages;
+	store->get( 1, count, messages );
+	check( store->getNextSenderMsgSeqNum() == count + 1, "reopened store keeps the sequence number" );
+	check( messages.size() == static_cast<size_t>( count ) && messages.back() == message, "reopened store keeps the messages of every segment" );
+	mapped_segments.destroy( store );
+
+	if ( failed > 0 ) {
+		std::cerr << failed << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "FIXManager.h"
+#include "SimulatedBroker.h"
+#include "StrategyHost.h"
+#include "EventJournal.h"
+#include "TickRecord.h"
+
+// StrategyHost with the shared IndicatorGraph of every symbol:
+// strategies of one symbol with the same brick and sma size share their
+// nodes, the journaled history is replayed once per symbol and no signal
+// is emitted while it is replayed.
+//
+// Runs with ctest, fails if a check fails.
+//
+// strategyhost
+
+using namespace IDEFIX;
+
+static int failed = 0;
+
+void check(const bool condition, const std::string& what) {
+	if ( ! condition ) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failed++;
+	}
+}
+
+AwesomeStrategyConfig config(const double renko_size) {
+	AwesomeStrategyConfig config;
+	config.max_short_pos = 1;
+	config.max_long_pos  = 1;
+	config.wait_bricks   = 0;
+	config.sma_size      = 5;
+	config.max_pip_risk  = 30;
+	config.max_risk      = 1;
+	config.max_qty       = 10000;
+	config.max_spread    = 5;
+	config.renko_size    = renko_size;
+	config.warm_up_hours = 1;
+	return config;
+}
+
+int main() {
+	const std::string filename = "strategyhost_test.journal";
+	std::remove( filename.c_str() );
+
+	FIXManager manager;
+	manager.console()->set_level( spdlog::level::off );
+
+	EventJournal journal( filename );
+	journal.open();
+	manager.setJournal( &journal );
+
+	const std::vector<std::string> symbols = { "EUR/USD", "GBP/USD" };
+	SimulatedBroker broker( manager );
+	for ( auto& symbol : symbols ) {
+		broker.add_symbol( symbol );
+	}
+	broker.start();
+
+	// history, the quotes are journaled, bricks in both directions
+	for ( auto& symbol : symbols ) {
+		manager.subscribeMarketData( symbol );
+	}
+	broker.process();
+
+	long long time_ms = 1524441600000LL;
+	for ( int i = 0; i < 3000; i++, time_ms += 1000 ) {
+		const double bid = 1.1 + 0.005 * std::sin( i / 100.0 );
+		for ( auto& symbol : symbols ) {
+			broker.on_tick( symbol, TickRecord{ time_ms, bid, bid + 0.0001 } );
+		}
+	}
+
+	// FIXManager emits on_init only without subscriptions
+	for ( auto& symbol : symbols ) {
+		manager.unsubscribeMarketData( symbol );
+	}
+	broker.process();
+
+	StrategyHost host( manager, 2 );
+	host.set_journal( &journal );
+	AwesomeStrategy* first  = host.add( "EUR/USD", config( 5 ) );
+	AwesomeStrategy* second = host.add( "EUR/USD", config( 5 ) );
+	AwesomeStrategy* other  = host.add( "EUR/USD", config( 10 ) );
+	host.add( "GBP/USD", config( 5 ) );
+	host.start();
+
+	// the CollateralReport emits on_init, the strategies warm up on their worker
+	manager.queryAccounts();
+	broker.process();
+
+	// live ticks within one brick, no new bar and no signal
+	const int live = 500;
+	const double last_bid = 1.1 + 0.005 * std::sin( 2999 / 100.0 );
+	for ( int i = 0; i < live; i++, time_ms += 1000 ) {
+		for ( auto& symbol : symbols ) {
+			broker.on_tick( symbol, TickRecord{ time_ms, last_bid, last_bid + 0.0001 } );
+		}
+	}
+
+	// a second init must not create new nodes or replay the history again
+	for ( auto& symbol : symbols ) {
+		manager.unsubscribeMarketData( symbol );
+	}
+	broker.process();
+	manager.queryAccounts();
+	broker.process();
+
+	host.stop();
+	broker.stop();
+
+	// renko(5) and sma(5) shared by two strategies, renko(10) and its sma, GBP/USD renko(5) and sma
+	check( host.indicators() == 6, "same symbol strategies share their nodes" );
+	check( first->brick_count() > 0, "warm up built bricks" );
+	check( first->brick_count() == second->brick_count(), "shared bricks" );
+	check( other->brick_count() > 0 && other->brick_count() < first->brick_count(), "other brick size has its own bricks" );
+
+	for ( auto& stats : host.stats() ) {
+		check( stats.ticks >= static_cast<unsigned long>( live ), stats.symbol + ": live ticks reach the strategy" );
+		check( stats.bars == 0, stats.symbol + ": no bar signal during the warm up" );
+		check( stats.signals == 0, stats.symbol + ": no entry or exit signal during the warm up" );
+	}
+
+	journal.close();
+	std::remove( filename.c_str() );
+
+	if ( failed > 0 ) {
+		std::cerr << failed << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << host.indicators() << " indicators, " << first->brick_count() << " bricks shared" << std::endl;
+	return EXIT_SUCCESS;
+}
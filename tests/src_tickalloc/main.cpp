@@ -0,0 +1,135 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdlib>
+#include <quickfix/fix44/MarketDataSnapshotFullRefresh.h>
+#include <quickfix/fix44/ExecutionReport.h>
+#include "FIXManager.h"
+#include "SimulatedBroker.h"
+#include "RenkoChart.h"
+#include "FXCMFields.h"
+#include "AllocationCounter.h"
+
+// The tick path must not allocate in steady state:
+// fromApp -> onMessage(MarketDataSnapshotFullRefresh) -> processMarketOrders
+// -> on_tick -> RenkoChart::on_tick
+//
+// Runs with ctest, fails if a tick allocates. Parsing the raw FIX string
+// into a FIX::Message is done by quickfix and is not part of the test.
+//
+// tickalloc [ticks]
+
+using namespace IDEFIX;
+
+FIX44::MarketDataSnapshotFullRefresh market_data(const std::string& symbol, const double bid) {
+	FIX44::MarketDataSnapshotFullRefresh mds;
+	mds.getHeader().setField( FIX::FIELD::SendingTime, "20181018-10:00:00.000" );
+	mds.setField( FIX::MDReqID( "Request_" + symbol ) );
+	mds.setField( FIX::Symbol( symbol ) );
+
+	FIX44::MarketDataSnapshotFullRefresh::NoMDEntries entry;
+	entry.setField( FIX::MDEntryType( FIX::MDEntryType_BID ) );
+	entry.setField( FIX::MDEntryPx( bid ) );
+	mds.addGroup( entry );
+	entry.setField( FIX::MDEntryType( FIX::MDEntryType_OFFER ) );
+	entry.setField( FIX::MDEntryPx( bid + 0.0002 ) );
+	mds.addGroup( entry );
+	entry.setField( FIX::MDEntryType( FIX::MDEntryType_TRADING_SESSION_HIGH_PRICE ) );
+	entry.setField( FIX::MDEntryPx( bid + 0.01 ) );
+	mds.addGroup( entry );
+	entry.setField( FIX::MDEntryType( FIX::MDEntryType_TRADING_SESSION_LOW_PRICE ) );
+	entry.setField( FIX::MDEntryPx( bid - 0.01 ) );
+	mds.addGroup( entry );
+
+	return mds;
+}
+
+FIX44::ExecutionReport open_position(const std::string& pos_id, const std::string& symbol) {
+	FIX44::ExecutionReport er;
+	er.getHeader().setField( FIX::FIELD::SendingTime, "20181018-10:00:00.000" );
+	er.setField( FIX::OrderID( "O" + pos_id ) );
+	er.setField( FIX::ExecID( "E" + pos_id ) );
+	er.setField( FIX::ExecType( FIX::ExecType_TRADE ) );
+	er.setField( FIX::OrdStatus( FIX::OrdStatus_FILLED ) );
+	er.setField( FIX::OrdType( FIX::OrdType_MARKET ) );
+	er.setField( FIX::ClOrdID( "C" + pos_id ) );
+	er.setField( FIX::Side( FIX::Side_BUY ) );
+	er.setField( FIX::Symbol( symbol ) );
+	er.setField( FIX::Account( "SIMULATED" ) );
+	er.setField( FIX::OrderQty( 10000 ) );
+	er.setField( FIX::LastQty( 10000 ) );
+	er.setField( FIX::LastPx( 1.1 ) );
+	er.setField( FIX::CumQty( 10000 ) );
+	er.setField( FIX::LeavesQty( 0 ) );
+	er.setField( FIX::AvgPx( 1.1 ) );
+	er.setField( FXCM_FIX_FIELDS::FXCM_POS_ID, pos_id );
+	return er;
+}
+
+int main(int argc, char const *argv[]) {
+	const int ticks = argc > 1 ? atoi( argv[1] ) : 10000;
+
+	FIXManager manager;
+	manager.console()->set_level( spdlog::level::off );
+
+	// market details and account
+	const std::vector<std::string> symbols = { "EUR/USD", "GBP/USD", "USD/JPY" };
+	SimulatedBroker broker( manager );
+	for ( auto& symbol : symbols ) {
+		broker.add_symbol( symbol, symbol == "USD/JPY" ? 0.01 : 0.0001, symbol == "USD/JPY" ? 3 : 5 );
+	}
+	broker.start();
+	broker.stop();
+	manager.setOutbound( [](const FIX::Message&) {} );
+
+	const FIX::SessionID session_ID( "FIX.4.4", "IDEFIX", "FXCM" );
+
+	// two open positions per symbol, every tick updates their profit loss
+	for ( size_t p = 0; p < symbols.size() * 2; p++ ) {
+		manager.fromApp( open_position( "P" + std::to_string( p ), symbols[p % symbols.size()] ), session_ID );
+	}
+
+	// one renko chart per symbol, prices stay within one brick
+	std::map<std::string, std::unique_ptr<RenkoChart>> charts;
+	for ( auto& symbol : symbols ) {
+		charts[symbol] = std::unique_ptr<RenkoChart>( new RenkoChart( 50 ) );
+	}
+	manager.on_tick.connect( [&charts](const MarketSnapshot& tick) {
+		auto it = charts.find( tick.getSymbol() );
+		if ( it != charts.end() ) {
+			it->second->on_tick( tick );
+		}
+	});
+
+	std::vector<FIX44::MarketDataSnapshotFullRefresh> messages;
+	for ( int v = 0; v < 16; v++ ) {
+		for ( auto& symbol : symbols ) {
+			messages.push_back( market_data( symbol, ( symbol == "USD/JPY" ? 112.1 : 1.1 ) + ( v % 8 ) * 0.00001 ) );
+		}
+	}
+
+	// warm up until the market history of every symbol is full
+	const size_t warm_up = ( Market::HISTORY + 1 ) * symbols.size() * 2;
+	for ( size_t i = 0; i < warm_up; i++ ) {
+		manager.fromApp( messages[i % messages.size()], session_ID );
+	}
+
+	const unsigned long long before = allocations::thread_count();
+	for ( int i = 0; i < ticks; i++ ) {
+		manager.fromApp( messages[i % messages.size()], session_ID );
+	}
+	const unsigned long long allocated = allocations::thread_count() - before;
+
+	manager.setOutbound( nullptr );
+
+	std::cout << ticks << " ticks, " << allocated << " allocations, " << static_cast<double>( allocated ) / ticks << " per tick" << std::endl;
+
+	if ( allocated > 0 ) {
+		std::cerr << "FAILED: the tick path allocates" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
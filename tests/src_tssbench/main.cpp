@@ -0,0 +1,190 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <quickfix/Message.h>
+#include <quickfix/DataDictionary.h>
+#include <quickfix/FieldConvertors.h>
+#include <quickfix/fix44/TradingSessionStatus.h>
+#include <quickfix/fix44/SecurityList.h>
+#include "FIXGroupWalker.h"
+#include "FXCMFields.h"
+#include "MarketDetail.h"
+
+// TradingSessionStatus parsing of FIXManager:
+// legacy: getGroup copy per symbol, getField and convertor per field,
+//         FieldMap copy per param
+// walker: fixgroup::read_market_details and read_params, one pass, no copies
+// The message is a recorded one (quickfix FileLog line) or a generated one.
+
+using namespace IDEFIX;
+using namespace FIX;
+
+typedef std::chrono::steady_clock Clock;
+
+double seconds_since(const Clock::time_point start) {
+	return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
+void legacy_parse(const FIX44::TradingSessionStatus& tss, std::map<std::string, MarketDetail>& details, std::map<std::string, std::string>& params) {
+	int symbols_count = IntConvertor::convert( tss.getField( FIELD::NoRelatedSym ) );
+	for ( int i = 1; i <= symbols_count; i++ ) {
+		FIX44::SecurityList::NoRelatedSym symbols_group;
+		tss.getGroup( i, symbols_group );
+
+		MarketDetail marketDetail;
+		marketDetail.setSymbol( symbols_group.getField( FIELD::Symbol ) );
+		marketDetail.setCurrency( symbols_group.getField( FIELD::Currency ) );
+		marketDetail.setFactor( DoubleConvertor::convert( symbols_group.getField( FIELD::Factor ) ) );
+		marketDetail.setContractMultiplier( DoubleConvertor::convert( symbols_group.getField( FIELD::ContractMultiplier ) ) );
+		marketDetail.setProduct( IntConvertor::convert( symbols_group.getField( FIELD::Product ) ) );
+		marketDetail.setRoundlot( DoubleConvertor::convert( symbols_group.getField( FIELD::RoundLot ) ) );
+		marketDetail.setSymID( IntConvertor::convert( symbols_group.getField( FXCM_SYM_ID ) ) );
+		marketDetail.setSymPrecision( IntConvertor::convert( symbols_group.getField( FXCM_SYM_PRECISION ) ) );
+		marketDetail.setSymPointsize( DoubleConvertor::convert( symbols_group.getField( FXCM_SYM_POINT_SIZE ) ) );
+		marketDetail.setSymInterestBuy( DoubleConvertor::convert( symbols_group.getField( FXCM_SYM_INTEREST_BUY ) ) );
+		marketDetail.setSymInterestSell( DoubleConvertor::convert( symbols_group.getField( FXCM_SYM_INTEREST_SELL ) ) );
+		marketDetail.setSymSortOrder( IntConvertor::convert( symbols_group.getField( FXCM_SYM_SORT_ORDER ) ) );
+		marketDetail.setSubscriptionStatus( symbols_group.getField( FXCM_SUBSCRIPTION_STATUS ) );
+		marketDetail.setFieldProductID( IntConvertor::convert( symbols_group.getField( FXCM_FIELD_PRODUCT_ID ) ) );
+		marketDetail.setCondDistStop( DoubleConvertor::convert( symbols_group.getField( FXCM_COND_DIST_STOP ) ) );
+		marketDetail.setCondDistLimit( DoubleConvertor::convert( symbols_group.getField( FXCM_COND_DIST_LIMIT ) ) );
+		marketDetail.setCondDistEntryStop( DoubleConvertor::convert( symbols_group.getField( FXCM_COND_DIST_ENTRY_STOP ) ) );
+		marketDetail.setCondDistEntryLimit( DoubleConvertor::convert( symbols_group.getField( FXCM_COND_DIST_ENTRY_LIMIT ) ) );
+		marketDetail.setTradingStatus( symbols_group.getField( FXCM_TRADING_STATUS ) );
+
+		details[marketDetail.getSymbol()] = marketDetail;
+	}
+
+	int params_count = IntConvertor::convert( tss.getField( FXCM_NO_PARAMS ) );
+	for ( int i = 1; i <= params_count; i++ ) {
+		FIX::FieldMap field_map = tss.getGroupRef( i, FXCM_NO_PARAMS );
+		params.insert( std::pair<std::string, std::string>( field_map.getField( FXCM_PARAM_NAME ), field_map.getField( FXCM_PARAM_VALUE ) ) );
+	}
+}
+
+/*!
+ * TradingSessionStatus like FXCM sends it, symbols * 21 fields and params
+ */
+std::string generate(const int symbols, const int param_count) {
+	FIX44::TradingSessionStatus tss;
+	tss.setField( FIELD::TradingSessionID, "FXCM" );
+	tss.setField( FIELD::TradSesStatus, "2" );
+
+	for ( int i = 0; i < symbols; i++ ) {
+		FIX::Group group( FIELD::NoRelatedSym, FIELD::Symbol );
+		group.setField( FIELD::Symbol, "SYM" + std::to_string( i ) + "/USD" );
+		group.setField( FIELD::Currency, "USD" );
+		group.setField( FIELD::Factor, "1" );
+		group.setField( FIELD::ContractMultiplier, "1" );
+		group.setField( FIELD::Product, "4" );
+		group.setField( FIELD::RoundLot, "1000" );
+		group.setField( FXCM_SYM_ID, std::to_string( i + 1 ) );
+		group.setField( FXCM_SYM_PRECISION, "5" );
+		group.setField( FXCM_SYM_POINT_SIZE, "0.0001" );
+		group.setField( FXCM_SYM_INTEREST_BUY, "-0.61" );
+		group.setField( FXCM_SYM_INTEREST_SELL, "0.12" );
+		group.setField( FXCM_SYM_SORT_ORDER, std::to_string( i ) );
+		group.setField( FXCM_SUBSCRIPTION_STATUS, "T" );
+		group.setField( FXCM_FIELD_PRODUCT_ID, "1" );
+		group.setField( FXCM_COND_DIST_STOP, "0.1" );
+		group.setField( FXCM_COND_DIST_LIMIT, "0.1" );
+		group.setField( FXCM_COND_DIST_ENTRY_STOP, "0.1" );
+		group.setField( FXCM_COND_DIST_ENTRY_LIMIT, "0.1" );
+		group.setField( FXCM_MAX_QUANTITY, "50000000" );
+		group.setField( FXCM_MIN_QUANTITY, "1000" );
+		group.setField( FXCM_TRADING_STATUS, "O" );
+		tss.addGroup( group );
+	}
+
+	for ( int i = 0; i < param_count; i++ ) {
+		FIX::Group group( FXCM_NO_PARAMS, FXCM_PARAM_NAME );
+		group.setField( FXCM_PARAM_NAME, "PARAM_" + std::to_string( i ) );
+		group.setField( FXCM_PARAM_VALUE, std::to_string( i ) );
+		tss.addGroup( group );
+	}
+
+	return tss.toString();
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		std::cout << "Usage: tssbench FIXFXCM10.xml [recorded TradingSessionStatus log line or -] [rounds=100]" << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	const std::string recorded = argc > 2 ? argv[2] : "-";
+	const int rounds           = argc > 3 ? atoi( argv[3] ) : 100;
+
+	std::string raw;
+	if ( recorded != "-" ) {
+		std::ifstream file( recorded.c_str() );
+		if ( ! file.is_open() ) {
+			std::cerr << "File not found: " << recorded << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// first TradingSessionStatus, quickfix FileLog lines are "time : message"
+		std::string line;
+		while ( std::getline( file, line ) ) {
+			const size_t pos = line.find( "8=FIX" );
+			if ( pos != std::string::npos && line.find( "\00135=h\001" ) != std::string::npos ) {
+				raw = line.substr( pos );
+				break;
+			}
+		}
+		if ( raw.empty() ) {
+			std::cerr << "No TradingSessionStatus in " << recorded << std::endl;
+			return EXIT_FAILURE;
+		}
+	} else {
+		raw = generate( 400, 60 );
+	}
+
+	try {
+		DataDictionary dictionary( argv[1] );
+		FIX44::TradingSessionStatus tss;
+		tss.setString( raw, false, &dictionary );
+
+		std::cout << raw.size() << " bytes, " << tss.groupCount( FIELD::NoRelatedSym ) << " symbols, " << tss.groupCount( FXCM_NO_PARAMS )
+				  << " params, best of " << rounds << std::endl;
+
+		double best_legacy = 0, best_walker = 0;
+		size_t legacy_count = 0, walker_count = 0;
+		for ( int r = 0; r < rounds; r++ ) {
+			std::map<std::string, MarketDetail> details;
+			std::map<std::string, std::string> params;
+			auto start = Clock::now();
+			legacy_parse( tss, details, params );
+			const double elapsed = seconds_since( start );
+			best_legacy  = r == 0 ? elapsed : std::min( best_legacy, elapsed );
+			legacy_count = details.size() + params.size();
+		}
+
+		for ( int r = 0; r < rounds; r++ ) {
+			std::map<std::string, MarketDetail> details;
+			std::map<std::string, std::string> params;
+			auto start = Clock::now();
+			fixgroup::read_market_details( tss, details );
+			fixgroup::read_params( tss, params );
+			const double elapsed = seconds_since( start );
+			best_walker  = r == 0 ? elapsed : std::min( best_walker, elapsed );
+			walker_count = details.size() + params.size();
+		}
+
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout << "legacy getGroup   " << std::setw(10) << best_legacy * 1e6 << " us  " << legacy_count << " entries" << std::endl;
+		std::cout << "fixgroup walker   " << std::setw(10) << best_walker * 1e6 << " us  " << walker_count << " entries" << std::endl;
+		std::cout << "speedup           " << std::setw(10) << best_legacy / best_walker << " x" << std::endl;
+
+	} catch ( std::exception& e ) {
+		std::cerr << "Damn: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*!
+ * Backtest AwesomeStrategy against FXCM tick data files
+ * without a FIX session.
+ */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include "FileAdapter.h"
+#include "TickArchive.h"
+#include "TimeHelper.h"
+#include "BacktestEngine.h"
+#include "AwesomeStrategy.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ * 
+ * @param const int         argc        
+ * @param const int         i           
+ * @param const std::string arg
+ * @param const std::string failure_msg 
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	} 
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		cout << "Backtest AwesomeStrategy with FXCM tick data." << endl;
+		cout << "Usage:" << endl;
+		cout << "   backtest <options> tickdata.csv [tickdata.csv ...]" << endl;
+		cout << "Options:" << endl;
+		cout << "    -c file   \t Strategy cfg file, defaults to awesome.cfg" << endl;
+		cout << "    -s symbol \t The symbol like EUR/USD, defaults to the first symbol in cfg" << endl;
+		cout << "    -p value  \t Point size, defaults to 0.0001" << endl;
+		cout << "    -r value  \t Overwrite renko_size" << endl;
+		cout << "    -m value  \t Overwrite sma_size" << endl;
+		cout << "    -f time   \t Start at yyyymmdd-HH:MM:SS" << endl;
+		cout << "    -u time   \t Stop before yyyymmdd-HH:MM:SS" << endl;
+		cout << "    -v        \t Verbose, show strategy output" << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	// defaults
+	std::string strategy_cfg_file = "awesome.cfg";
+	std::string symbol;
+	std::vector<std::string> files;
+	double point_size = 0.0001;
+	double renko_size = 0;
+	int sma_size      = 0;
+	bool verbose      = false;
+	long long from_ms = 0;
+	long long to_ms   = 0;
+
+	// parse arguments
+	for ( int i = 1; i < argc; i++ ) {
+		std::string arg = argv[ i ];
+
+		if ( arg == "-c" || arg == "-s" || arg == "-p" || arg == "-r" || arg == "-m" || arg == "-f" || arg == "-u" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			std::string value = argv[ ++i ];
+			if ( arg == "-c" ) strategy_cfg_file = value;
+			if ( arg == "-s" ) symbol            = value;
+			if ( arg == "-p" ) point_size        = atof( value.c_str() );
+			if ( arg == "-r" ) renko_size        = atof( value.c_str() );
+			if ( arg == "-m" ) sma_size          = atoi( value.c_str() );
+			if ( arg == "-f" ) from_ms           = times::fix_to_ms( value );
+			if ( arg == "-u" ) to_ms             = times::fix_to_ms( value );
+		} else if ( arg == "-v" ) {
+			verbose = true;
+		} else {
+			files.push_back( arg );
+		}
+	}
+
+	// file which is read at the moment
+	std::string current_file = strategy_cfg_file;
+
+	try {
+		AwesomeStrategyConfig config = AwesomeStrategyConfig::load( strategy_cfg_file );
+		if ( renko_size > 0 ) config.renko_size = renko_size;
+		if ( sma_size > 0 ) config.sma_size = sma_size;
+
+		if ( symbol.empty() && ! config.symbols.empty() ) {
+			symbol = config.symbols.front();
+		}
+		if ( symbol.empty() ) {
+			cerr << "No symbol found." << endl;
+			return EXIT_FAILURE;
+		}
+
+		const bool has_range = from_ms > 0 || to_ms > 0;
+		if ( to_ms == 0 ) {
+			to_ms = std::numeric_limits<long long>::max();
+		}
+
+		// read all tick files
+		std::vector<TickRecord> ticks;
+		for ( auto& file : files ) {
+			current_file = file;
+			size_t count = 0;
+
+			if ( has_range && TickArchive::is_archive( file ) ) {
+				// seek by block index, only the blocks in range are decoded
+				TickArchive archive( file );
+				archive.open();
+				count = archive.load( ticks, from_ms, to_ms );
+			} else {
+				const size_t start = ticks.size();
+				FileAdapter adapter( file );
+				adapter.load( ticks );
+
+				if ( has_range ) {
+					ticks.erase( std::remove_if( ticks.begin() + start, ticks.end(), [from_ms, to_ms](const TickRecord& tick) {
+						return tick.time_ms < from_ms || tick.time_ms >= to_ms;
+					}), ticks.end() );
+				}
+				count = ticks.size() - start;
+			}
+
+			cout << file << ": " << count << " ticks" << endl;
+		}
+
+		if ( ticks.empty() ) {
+			cerr << "No ticks found." << endl;
+			return EXIT_FAILURE;
+		}
+
+		BacktestEngine::init_console( verbose );
+		BacktestEngine engine( symbol, config, point_size );
+		BacktestResult result = engine.run( ticks );
+
+		cout << std::fixed << std::setprecision(2);
+		cout << "symbol       " << symbol << endl;
+		cout << "renko_size   " << config.renko_size << endl;
+		cout << "sma_size     " << config.sma_size << endl;
+		cout << "ticks        " << result.ticks << endl;
+		cout << "bars         " << result.bars << endl;
+		cout << "trades       " << result.trades << endl;
+		cout << "wins         " << result.wins << endl;
+		cout << "profit_loss  " << result.profit_loss << endl;
+		cout << "max_drawdown " << result.max_drawdown << endl;
+		cout << "elapsed_ms   " << result.elapsed_ms << endl;
+		cout << "ticks/s      " << ( result.elapsed_ms > 0 ? result.ticks / result.elapsed_ms * 1000 : 0 ) << endl;
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,293 @@
+/*!
+ * Microbenchmarks of the hot path components.
+ * Every benchmark runs the operation n times and reports the time and
+ * the heap allocations per operation, as csv or json for scripts and CI.
+ * Allocations are counted by src/AllocationCounter.cpp.
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <quickfix/fix44/MarketDataSnapshotFullRefresh.h>
+#include "MarketSnapshot.h"
+#include "MarketOrder.h"
+#include "RenkoChart.h"
+#include "SimpleMovingAverage.h"
+#include "MathHelper.h"
+#include "FIXFactory.h"
+#include "FIXManager.h"
+#include "SimulatedBroker.h"
+#include "CSVHandler.h"
+#include "AllocationCounter.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+// results are added here, so the compiler keeps the operations
+static volatile double g_sink = 0;
+
+struct Result {
+	std::string name;
+	long iterations;
+	double ns_per_op;
+	double allocs_per_op;
+	double bytes_per_op;
+};
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+/*!
+ * Run operation, the first 1% of the iterations warm up caches and
+ * buffers and are not measured
+ *
+ * @param const std::string&              name
+ * @param const long                      iterations
+ * @param const std::function<void(long)> operation called with the iteration index
+ * @return Result
+ */
+Result run(const std::string& name, const long iterations, const std::function<void(long)>& operation) {
+	const long warm_up = iterations / 100 + 1;
+	for ( long i = 0; i < warm_up; i++ ) {
+		operation( i );
+	}
+
+	const unsigned long long allocs = allocations::count();
+	const unsigned long long bytes  = allocations::bytes();
+	const auto start = std::chrono::steady_clock::now();
+
+	for ( long i = 0; i < iterations; i++ ) {
+		operation( warm_up + i );
+	}
+
+	const double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+
+	Result result;
+	result.name          = name;
+	result.iterations    = iterations;
+	result.ns_per_op     = ns / iterations;
+	result.allocs_per_op = static_cast<double>( allocations::count() - allocs ) / iterations;
+	result.bytes_per_op  = static_cast<double>( allocations::bytes() - bytes ) / iterations;
+	return result;
+}
+
+void write_csv(std::ostream& out, const std::vector<Result>& results) {
+	char line[256];
+	out << "name,iterations,ns_per_op,allocs_per_op,bytes_per_op" << "\n";
+	for ( auto& r : results ) {
+		snprintf( line, sizeof( line ), "%s,%ld,%.2f,%.3f,%.1f", r.name.c_str(), r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op );
+		out << line << "\n";
+	}
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results) {
+	char line[256];
+	out << "[" << "\n";
+	for ( size_t i = 0; i < results.size(); i++ ) {
+		const Result& r = results[i];
+		snprintf( line, sizeof( line ), "  {\"name\": \"%s\", \"iterations\": %ld, \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f}%s",
+			r.name.c_str(), r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op, i + 1 < results.size() ? "," : "" );
+		out << line << "\n";
+	}
+	out << "]" << "\n";
+}
+
+int main(int argc, char** argv) {
+	long iterations = 1000000;
+	std::string filter;
+	std::string output;
+	bool json = false;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-n" || arg == "-f" || arg == "-o" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-n" ) iterations = std::max( 1L, atol( value.c_str() ) );
+			if ( arg == "-f" ) filter     = value;
+			if ( arg == "-o" ) output     = value;
+		} else if ( arg == "-j" ) {
+			json = true;
+		} else {
+			cout << "Microbenchmarks of the hot path components." << endl;
+			cout << "Usage:" << endl;
+			cout << "   bench [options]" << endl;
+			cout << "Options:" << endl;
+			cout << "    -n count  \t Iterations per benchmark, defaults to 1000000" << endl;
+			cout << "    -f text   \t Only benchmarks whose name contains text" << endl;
+			cout << "    -o file   \t Output file, defaults to stdout" << endl;
+			cout << "    -j        \t JSON instead of csv" << endl;
+			cout << endl;
+
+			return arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	try {
+		std::vector<std::pair<std::string, std::function<void(long)>>> benchmarks;
+
+		const std::string symbol       = "EUR/USD";
+		const std::string sending_time = "20181018-10:00:00.000";
+
+		// MarketSnapshot
+		benchmarks.push_back( std::make_pair( "marketsnapshot_construct", [&](long i) {
+			MarketSnapshot snapshot( symbol, 1.14 + i % 10 * 0.00001, 1.14002, 0.2, 1.145, 1.135, sending_time );
+			g_sink = g_sink + snapshot.getAsk();
+		}));
+
+		MarketSnapshot snapshot;
+		const std::string symbols[2] = { "EUR/USD", "GBP/USD" };
+		benchmarks.push_back( std::make_pair( "marketsnapshot_setsymbol", [&](long i) {
+			snapshot.setSymbol( symbols[i & 1] );
+		}));
+
+		// RenkoChart, 10 pip bricks
+		long bricks = 0;
+		RenkoChart steady_chart( 10 );
+		steady_chart.on_brick.connect( [&bricks](const Bar&) { bricks++; } );
+		MarketSnapshot tick( symbol, 1.14, 1.14002, 0.2, 1.145, 1.135, sending_time );
+		benchmarks.push_back( std::make_pair( "renkochart_on_tick_steady", [&](long i) {
+			// moves less than a brick around the first price
+			tick.setBid( 1.14 + ( i % 8 ) * 0.0001 );
+			steady_chart.on_tick( tick );
+		}));
+
+		RenkoChart brick_chart( 10 );
+		brick_chart.on_brick.connect( [&bricks](const Bar&) { bricks++; } );
+		double price = 1.14;
+		benchmarks.push_back( std::make_pair( "renkochart_on_tick_brick", [&](long) {
+			// every tick closes a brick
+			price += 0.0011;
+			tick.setBid( price );
+			brick_chart.on_tick( tick );
+		}));
+
+		// SimpleMovingAverage
+		SimpleMovingAverage sma( 50 );
+		benchmarks.push_back( std::make_pair( "sma_add", [&](long i) {
+			sma.add( 1.14 + ( i % 100 ) * 0.00001 );
+			g_sink = g_sink + sma.value();
+		}));
+
+		// Math
+		MarketOrder position( symbol );
+		position.setQty( 10000 );
+		position.setPrice( 1.139 );
+		position.setPointSize( 0.0001 );
+		benchmarks.push_back( std::make_pair( "math_get_pip_value", [&](long) {
+			g_sink = g_sink + Math::get_pip_value( tick, 10000, "USD" );
+		}));
+		benchmarks.push_back( std::make_pair( "math_get_profit_loss", [&](long) {
+			g_sink = g_sink + Math::get_profit_loss( 1, tick, position );
+		}));
+		benchmarks.push_back( std::make_pair( "math_get_unit_size", [&](long i) {
+			g_sink = g_sink + Math::get_unit_size( 50000, 0.01, 10 + i % 10 );
+		}));
+
+		// FIXFactory
+		benchmarks.push_back( std::make_pair( "fixfactory_market_data_request", [&](long) {
+			FIX44::MarketDataRequest request = FIXFactory::MarketDataRequest( symbol, FIX::SubscriptionRequestType_SNAPSHOT_PLUS_UPDATES );
+			g_sink = g_sink + request.totalFields();
+		}));
+		benchmarks.push_back( std::make_pair( "fixfactory_new_order_single", [&](long) {
+			FIX44::NewOrderSingle order = FIXFactory::NewOrderSingle( "Order_1", position );
+			g_sink = g_sink + order.totalFields();
+		}));
+		benchmarks.push_back( std::make_pair( "fixfactory_request_for_positions", [&](long) {
+			FIX44::RequestForPositions request = FIXFactory::RequestForPositions( "Request_1", "SIMULATED", FIX::PosReqType_POSITIONS );
+			g_sink = g_sink + request.totalFields();
+		}));
+
+		// FIXManager with market details from the simulated broker, no session
+		FIXManager manager;
+		manager.console()->set_level( spdlog::level::off );
+		SimulatedBroker broker( manager );
+		broker.add_symbol( symbol );
+		broker.start();
+
+		FIX44::MarketDataSnapshotFullRefresh mds;
+		mds.getHeader().setField( FIX::FIELD::SendingTime, sending_time );
+		mds.setField( FIX::MDReqID( "Request_1" ) );
+		mds.setField( FIX::Symbol( symbol ) );
+		FIX44::MarketDataSnapshotFullRefresh::NoMDEntries entry;
+		entry.setField( FIX::MDEntryType( FIX::MDEntryType_BID ) );
+		entry.setField( FIX::MDEntryPx( 1.14 ) );
+		mds.addGroup( entry );
+		entry.setField( FIX::MDEntryType( FIX::MDEntryType_OFFER ) );
+		entry.setField( FIX::MDEntryPx( 1.14002 ) );
+		mds.addGroup( entry );
+		entry.setField( FIX::MDEntryType( FIX::MDEntryType_TRADING_SESSION_HIGH_PRICE ) );
+		entry.setField( FIX::MDEntryPx( 1.145 ) );
+		mds.addGroup( entry );
+		entry.setField( FIX::MDEntryType( FIX::MDEntryType_TRADING_SESSION_LOW_PRICE ) );
+		entry.setField( FIX::MDEntryPx( 1.135 ) );
+		mds.addGroup( entry );
+
+		const FIX::SessionID session_ID( "FIX.4.4", "bench_client", "FXCM" );
+		benchmarks.push_back( std::make_pair( "fixmanager_on_market_data_snapshot", [&](long) {
+			manager.onMessage( mds, session_ID );
+		}));
+
+		// CSVHandler with background writer, as in idefix
+		FIX::file_mkdir( "bench/" );
+		CSVHandler::start_writer();
+		CSVHandler csv;
+		csv.set_path( "bench/" );
+		csv.set_filename( "bench.csv" );
+		const std::string line = "20181018-10:00:00.000,EUR/USD,1.14000,1.14002";
+		benchmarks.push_back( std::make_pair( "csvhandler_add_line", [&](long) {
+			csv.add_line( line );
+		}));
+
+		std::vector<Result> results;
+		for ( auto& benchmark : benchmarks ) {
+			if ( filter.empty() || benchmark.first.find( filter ) != std::string::npos ) {
+				results.push_back( run( benchmark.first, iterations, benchmark.second ) );
+			}
+		}
+
+		CSVHandler::stop_writer();
+		broker.stop();
+
+		if ( output.empty() ) {
+			json ? write_json( cout, results ) : write_csv( cout, results );
+		} else {
+			std::ofstream file( output.c_str(), std::ios::out | std::ios::trunc );
+			if ( ! file.is_open() ) {
+				cerr << "File not found: " << output << endl;
+				return EXIT_FAILURE;
+			}
+			json ? write_json( file, results ) : write_csv( file, results );
+		}
+
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
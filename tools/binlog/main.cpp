@@ -0,0 +1,140 @@
+/*!
+ * Decode binary FIX message logs written by BinaryLogFactory.
+ * The output has the format of the quickfix FileLog, so it can be
+ * read by fixreplay again.
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include "BinaryLog.h"
+#include "TimeHelper.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		cout << "Decode binary FIX message logs." << endl;
+		cout << "Usage:" << endl;
+		cout << "   binlog [options] Logs/FIX.4.4-*.binlog [...]" << endl;
+		cout << "Options:" << endl;
+		cout << "    -k kind   \t incoming, outgoing or event, can be repeated, defaults to incoming and outgoing" << endl;
+		cout << "    -o file   \t Output file, defaults to stdout" << endl;
+		cout << "    -p        \t Print the FIX field separator as |" << endl;
+		cout << "    -s        \t Summary only" << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<std::string> files;
+	std::vector<std::string> kinds;
+	std::string output_file;
+	bool pipe    = false;
+	bool summary = false;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-k" || arg == "-o" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-k" ) kinds.push_back( value );
+			if ( arg == "-o" ) output_file = value;
+		} else if ( arg == "-p" ) {
+			pipe = true;
+		} else if ( arg == "-s" ) {
+			summary = true;
+		} else {
+			files.push_back( arg );
+		}
+	}
+
+	if ( kinds.empty() ) {
+		kinds = { "incoming", "outgoing" };
+	}
+
+	std::ofstream file;
+	std::ostream* out = &cout;
+	if ( ! output_file.empty() ) {
+		file.open( output_file, std::ios::out | std::ios::trunc );
+		if ( ! file.is_open() ) {
+			cerr << "Can not write " << output_file << endl;
+			return EXIT_FAILURE;
+		}
+		out = &file;
+	}
+
+	// file which is read at the moment
+	std::string current_file;
+
+	try {
+		char time_buffer[32];
+		std::string data;
+
+		for ( auto& filename : files ) {
+			current_file = filename;
+			size_t counts[3] = { 0, 0, 0 };
+
+			BinaryLog::read( filename, [&](const BinaryLog::Record& record) {
+				if ( record.kind <= BinaryLog::EVENT ) {
+					counts[record.kind]++;
+				}
+				if ( summary || std::find( kinds.begin(), kinds.end(), BinaryLog::kind_name( record.kind ) ) == kinds.end() ) {
+					return true;
+				}
+
+				data.assign( record.data, record.size );
+				if ( pipe ) {
+					std::replace( data.begin(), data.end(), '\x01', '|' );
+				}
+
+				times::ms_to_fix( record.time_ms, time_buffer );
+				*out << time_buffer << " : " << data << "\n";
+				return true;
+			});
+
+			cerr << filename << ": " << counts[BinaryLog::INCOMING] << " incoming, " << counts[BinaryLog::OUTGOING] << " outgoing, "
+				 << counts[BinaryLog::EVENT] << " events" << endl;
+		}
+
+		out->flush();
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( IDEFIX::out_of_range& e ) {
+		cerr << "No binary log: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/*!
+ * Replay recorded FIX message logs into FIXManager, without network.
+ * Reproduces a recorded trading day and measures the throughput of the
+ * whole path from decoding to the strategy.
+ */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <quickfix/DataDictionary.h>
+#include "FIXManager.h"
+#include "FIXReplay.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		cout << "Replay recorded FIX message logs into FIXManager." << endl;
+		cout << "Usage:" << endl;
+		cout << "   fixreplay [options] Logs/FIX.4.4-*.messages.current.log [...]" << endl;
+		cout << "Options:" << endl;
+		cout << "    -d file   \t Data dictionary, defaults to FIXFXCM10.xml" << endl;
+		cout << "    -t compid \t SenderCompID of inbound messages, defaults to FXCM" << endl;
+		cout << "    -x value  \t Speed, 1 = original timing, 0 = as fast as possible (default)" << endl;
+		cout << "    -v        \t Show FIXManager output" << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	std::string dictionary_file = "FIXFXCM10.xml";
+	std::string sender          = "FXCM";
+	std::vector<std::string> files;
+	double speed = 0;
+	bool verbose = false;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-d" || arg == "-t" || arg == "-x" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-d" ) dictionary_file = value;
+			if ( arg == "-t" ) sender          = value;
+			if ( arg == "-x" ) speed           = atof( value.c_str() );
+		} else if ( arg == "-v" ) {
+			verbose = true;
+		} else {
+			files.push_back( arg );
+		}
+	}
+
+	// file which is read at the moment
+	std::string current_file = dictionary_file;
+
+	try {
+		FIX::DataDictionary dictionary( dictionary_file );
+
+		FIXReplay replay( sender );
+		for ( auto& file : files ) {
+			current_file = file;
+			cout << file << ": " << replay.load( file ) << " messages" << endl;
+		}
+
+		if ( replay.size() == 0 ) {
+			cerr << "No messages found." << endl;
+			return EXIT_FAILURE;
+		}
+
+		// outgoing messages are counted, there is no session
+		FIXManager manager;
+		manager.console()->set_level( verbose ? spdlog::level::info : spdlog::level::off );
+		size_t outgoing = 0;
+		manager.setOutbound( [&outgoing](const FIX::Message&) {
+			outgoing++;
+		});
+
+		FIXReplayResult result = replay.replay( manager, dictionary, speed );
+		manager.setOutbound( nullptr );
+
+		cout << std::fixed << std::setprecision(2);
+		cout << "messages     " << result.messages << endl;
+		cout << "admin        " << result.admin << endl;
+		cout << "app          " << result.app << endl;
+		cout << "errors       " << result.errors << endl;
+		cout << "outgoing     " << outgoing << endl;
+		cout << "elapsed_ms   " << result.elapsed_ms << endl;
+		cout << "messages/s   " << ( result.elapsed_ms > 0 ? result.messages / result.elapsed_ms * 1000 : 0 ) << endl;
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*!
+ * Local FIX acceptor speaking the FXCM dialect. Start it and run idefix
+ * with specs/local.cfg to test the whole application on one machine.
+ * Quotes are replayed from tick files or generated at a fixed rate.
+ */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <csignal>
+#include <quickfix/NullStore.h>
+#include <quickfix/FileLog.h>
+#include <quickfix/SessionSettings.h>
+#include <quickfix/ThreadedSocketAcceptor.h>
+#include "Console.h"
+#include "FileAdapter.h"
+#include "FXCMAcceptor.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+static std::atomic<bool> running( true );
+
+void stop_handler(int) {
+	running = false;
+}
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if ( argc > 1 && ( std::string( argv[1] ) == "-h" || std::string( argv[1] ) == "--help" ) ) {
+		cout << "Local FIX acceptor speaking the FXCM dialect." << endl;
+		cout << "Usage:" << endl;
+		cout << "   fxcmsim -c fxcmsim.cfg -r 1000 [tickdata.csv ...]" << endl;
+		cout << "Options:" << endl;
+		cout << "    -c file   \t Acceptor settings, defaults to fxcmsim.cfg" << endl;
+		cout << "    -s symbol \t Symbol, can be repeated, defaults to EUR/USD" << endl;
+		cout << "    -p value  \t Point size, defaults to 0.0001" << endl;
+		cout << "    -r value  \t Quotes per second, 1 to 1000000, 0 = unlimited, defaults to 10" << endl;
+		cout << "    -g value  \t Synthetic quotes if no tick file is given, 0 = endless" << endl;
+		cout << "    -b value  \t Account balance, defaults to 50000" << endl;
+		cout << "    -l        \t Loop the tick files" << endl;
+		cout << "    -v        \t Log FIX messages to screen" << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	std::string settings_file = "fxcmsim.cfg";
+	std::vector<std::string> symbols;
+	std::vector<std::string> files;
+	double point_size = 0.0001;
+	double rate       = 10;
+	long long count   = 0;
+	double balance    = 50000;
+	bool loop         = false;
+	bool verbose      = false;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-c" || arg == "-s" || arg == "-p" || arg == "-r" || arg == "-g" || arg == "-b" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-c" ) settings_file = value;
+			if ( arg == "-s" ) symbols.push_back( value );
+			if ( arg == "-p" ) point_size    = atof( value.c_str() );
+			if ( arg == "-r" ) rate          = atof( value.c_str() );
+			if ( arg == "-g" ) count         = atoll( value.c_str() );
+			if ( arg == "-b" ) balance       = atof( value.c_str() );
+		} else if ( arg == "-l" ) {
+			loop = true;
+		} else if ( arg == "-v" ) {
+			verbose = true;
+		} else {
+			files.push_back( arg );
+		}
+	}
+
+	if ( symbols.empty() ) {
+		symbols.push_back( "EUR/USD" );
+	}
+	if ( rate < 0 || rate > 1000000 ) {
+		cerr << "-r must be between 0 and 1000000." << endl;
+		return EXIT_FAILURE;
+	}
+
+	auto logger = spdlog::stdout_color_mt( "console" );
+	logger->set_pattern( "%Y-%m-%d %T.%e: %^%v%$" );
+
+	// file which is read at the moment
+	std::string current_file = settings_file;
+
+	try {
+		// recorded quotes for the first symbol
+		std::vector<TickRecord> ticks;
+		for ( auto& file : files ) {
+			current_file = file;
+			FileAdapter adapter( file );
+			cout << file << ": " << adapter.load( ticks ) << " ticks" << endl;
+		}
+
+		FIX::SessionSettings settings( settings_file );
+		FXCMAcceptor application( settings, "SIMULATED", balance );
+		const int precision = std::max( 0, static_cast<int>( std::round( -std::log10( point_size ) ) ) ) + 1;
+		for ( auto& symbol : symbols ) {
+			application.add_symbol( symbol, point_size, precision );
+		}
+
+		FIX::NullStoreFactory store_factory;
+		FIX::ScreenLogFactory log_factory( settings );
+		std::unique_ptr<FIX::ThreadedSocketAcceptor> acceptor;
+		if ( verbose ) {
+			acceptor.reset( new FIX::ThreadedSocketAcceptor( application, store_factory, settings, log_factory ) );
+		} else {
+			acceptor.reset( new FIX::ThreadedSocketAcceptor( application, store_factory, settings ) );
+		}
+
+		std::signal( SIGINT, stop_handler );
+		std::signal( SIGTERM, stop_handler );
+
+		acceptor->start();
+		console()->info( "Waiting for the order and market data session. Press Ctrl-C to quit." );
+		while ( running && ! application.is_logged_on() ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds(100) );
+		}
+
+		// synthetic quotes: random walk with fixed seed, spread of 1.5 points
+		std::mt19937 random( 42 );
+		std::vector<double> bids( symbols.size(), 1.1 );
+		const double spread = point_size * 1.5;
+
+		const auto period = std::chrono::nanoseconds( rate > 0 ? static_cast<long long>( 1e9 / rate ) : 0 );
+		auto start        = std::chrono::steady_clock::now();
+		auto next_report  = start + std::chrono::seconds(1);
+		long long quotes  = 0;
+		long long last    = 0;
+		size_t index      = 0;
+
+		while ( running ) {
+			TickRecord tick;
+			size_t symbol_index = 0;
+
+			if ( ! ticks.empty() ) {
+				if ( index == ticks.size() ) {
+					if ( ! loop ) {
+						break;
+					}
+					index = 0;
+				}
+				tick = ticks[index++];
+			} else {
+				if ( count > 0 && quotes >= count ) {
+					break;
+				}
+				symbol_index        = quotes % symbols.size();
+				bids[symbol_index] += ( random() % 3 - 1.0 ) * point_size;
+				tick.time_ms        = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+				tick.bid            = bids[symbol_index];
+				tick.ask            = tick.bid + spread;
+			}
+
+			application.on_tick( symbols[symbol_index], tick );
+			quotes++;
+
+			// constant rate, late quotes catch up without sleeping
+			if ( rate > 0 ) {
+				const auto due = start + period * quotes;
+				if ( std::chrono::steady_clock::now() < due ) {
+					std::this_thread::sleep_until( due );
+				}
+			}
+
+			const auto now = std::chrono::steady_clock::now();
+			if ( now >= next_report ) {
+				console()->info( "quotes/s {} sent {} received {}", quotes - last, application.sent(), application.received() );
+				last        = quotes;
+				next_report = now + std::chrono::seconds(1);
+			}
+		}
+
+		console()->info( "quotes {} sent {} received {}", quotes, application.sent(), application.received() );
+		acceptor->stop();
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
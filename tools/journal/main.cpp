@@ -0,0 +1,180 @@
+/*!
+ * Show and export the event journal written by idefix.
+ * Events can be selected by sequence number, time and type.
+ */
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include "EventJournal.h"
+#include "TimeHelper.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		cout << "Show and export the idefix event journal." << endl;
+		cout << "Usage:" << endl;
+		cout << "   journal [options] journal/events.journal" << endl;
+		cout << "Options:" << endl;
+		cout << "    -f seq    \t First sequence number" << endl;
+		cout << "    -u seq    \t Last sequence number" << endl;
+		cout << "    -s time   \t Start time, yyyymmdd-HH:MM:SS[.sss] UTC" << endl;
+		cout << "    -e time   \t End time, yyyymmdd-HH:MM:SS[.sss] UTC" << endl;
+		cout << "    -t type   \t quote, execution_report, position_report, collateral_report, order or message" << endl;
+		cout << "    -o file   \t Export selected events as csv, - for stdout" << endl;
+		cout << "Without -o only a summary is shown." << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	std::string journal_file;
+	std::string output_file;
+	std::string type_filter;
+	uint64_t from_seq = 0;
+	uint64_t to_seq   = std::numeric_limits<uint64_t>::max();
+	long long from_ms = std::numeric_limits<long long>::min();
+	long long to_ms   = std::numeric_limits<long long>::max();
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-f" || arg == "-u" || arg == "-s" || arg == "-e" || arg == "-t" || arg == "-o" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-f" ) from_seq    = strtoull( value.c_str(), nullptr, 10 );
+			if ( arg == "-u" ) to_seq      = strtoull( value.c_str(), nullptr, 10 );
+			if ( arg == "-s" ) from_ms     = times::fix_to_ms( value );
+			if ( arg == "-e" ) to_ms       = times::fix_to_ms( value );
+			if ( arg == "-t" ) type_filter = value;
+			if ( arg == "-o" ) output_file = value;
+		} else {
+			journal_file = arg;
+		}
+	}
+
+	if ( journal_file.empty() ) {
+		cerr << "No journal file given." << endl;
+		return EXIT_FAILURE;
+	}
+
+	try {
+		EventJournal journal( journal_file );
+		journal.open( false );
+
+		std::ofstream file;
+		std::ostream* out = nullptr;
+		if ( output_file == "-" ) {
+			out = &cout;
+		} else if ( ! output_file.empty() ) {
+			file.open( output_file, std::ios::out | std::ios::trunc );
+			if ( ! file.is_open() ) {
+				cerr << "Can not write " << output_file << endl;
+				return EXIT_FAILURE;
+			}
+			out = &file;
+		}
+
+		if ( out != nullptr ) {
+			*out << "seq,time,direction,type,data" << endl;
+		}
+
+		size_t selected   = 0;
+		int64_t first_ms  = 0;
+		int64_t last_ms   = 0;
+		char time_buffer[32];
+		std::string symbol, data;
+		double bid, ask;
+
+		journal.for_each( [&](const EventJournal::Event& event) {
+			if ( event.time_ms < from_ms || event.time_ms > to_ms ) {
+				return true;
+			}
+			if ( ! type_filter.empty() && EventJournal::type_name( event.type ) != type_filter ) {
+				return true;
+			}
+
+			if ( selected == 0 ) {
+				first_ms = event.time_ms;
+			}
+			last_ms = event.time_ms;
+			selected++;
+
+			if ( out == nullptr ) {
+				return true;
+			}
+
+			if ( EventJournal::parse_quote( event, symbol, bid, ask ) ) {
+				std::ostringstream quote;
+				quote << symbol << " " << std::setprecision(10) << bid << " " << ask;
+				data = quote.str();
+			} else {
+				// FIX separator, the data is quoted for csv
+				data.assign( event.data, event.size );
+				std::replace( data.begin(), data.end(), '\x01', '|' );
+				std::replace( data.begin(), data.end(), '"', '\'' );
+			}
+
+			times::ms_to_fix( event.time_ms, time_buffer );
+			*out << event.seq << "," << time_buffer << "," << ( event.direction == EventJournal::INBOUND ? "in" : "out" )
+				<< "," << EventJournal::type_name( event.type ) << ",\"" << data << "\"\n";
+			return true;
+		}, from_seq, to_seq );
+
+		if ( out != nullptr ) {
+			out->flush();
+		}
+
+		// summary
+		std::ostream& info = out == &cout ? cerr : cout;
+		info << "events       " << journal.size() << endl;
+		info << "last_seq     " << journal.last_seq() << endl;
+		info << "selected     " << selected << endl;
+		if ( selected > 0 ) {
+			times::ms_to_fix( first_ms, time_buffer );
+			info << "first        " << time_buffer << endl;
+			times::ms_to_fix( last_ms, time_buffer );
+			info << "last         " << time_buffer << endl;
+		}
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << journal_file << endl;
+		return EXIT_FAILURE;
+	} catch ( IDEFIX::out_of_range& e ) {
+		cerr << "No event journal: " << journal_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
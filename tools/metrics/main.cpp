@@ -0,0 +1,189 @@
+/*!
+ * Live view of the metrics segment written by idefix, see Metrics.h.
+ * Counters are shown with their rate per second, histograms with rate,
+ * mean and percentiles.
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+#include "Metrics.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+struct Sample {
+	int64_t value;
+	uint64_t count;
+	uint64_t sum;
+	uint64_t buckets[Metrics::BUCKETS];
+};
+
+Sample sample(const Metrics::Entry* entry) {
+	Sample s;
+	s.value = entry->value.load( std::memory_order_relaxed );
+	s.count = entry->count.load( std::memory_order_relaxed );
+	s.sum   = entry->sum.load( std::memory_order_relaxed );
+	for ( size_t b = 0; b < Metrics::BUCKETS; b++ ) {
+		s.buckets[b] = entry->buckets[b].load( std::memory_order_relaxed );
+	}
+	return s;
+}
+
+/*!
+ * Upper bound of the bucket holding the quantile, as text in us
+ *
+ * @param const Sample& s
+ * @param const double  quantile
+ * @return std::string
+ */
+std::string percentile(const Sample& s, const double quantile) {
+	uint64_t total = 0;
+	for ( size_t b = 0; b < Metrics::BUCKETS; b++ ) {
+		total += s.buckets[b];
+	}
+	if ( total == 0 ) {
+		return "-";
+	}
+
+	uint64_t cumulative = 0;
+	for ( size_t b = 0; b < Metrics::BUCKETS - 1; b++ ) {
+		cumulative += s.buckets[b];
+		if ( cumulative >= quantile * total ) {
+			return "<=" + std::to_string( static_cast<long long>( Metrics::bucket_bound( b ) * 1e6 ) ) + "us";
+		}
+	}
+	return ">" + std::to_string( static_cast<long long>( Metrics::bucket_bound( Metrics::BUCKETS - 2 ) * 1e6 ) ) + "us";
+}
+
+int main(int argc, char** argv) {
+	std::string name = Metrics::DEFAULT_NAME;
+	std::string filter;
+	int interval_ms  = 1000;
+	bool once        = false;
+	bool prometheus  = false;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-n" || arg == "-i" || arg == "-f" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-n" ) name = value;
+			if ( arg == "-i" ) interval_ms = std::max( 100, atoi( value.c_str() ) );
+			if ( arg == "-f" ) filter = value;
+		} else if ( arg == "-1" ) {
+			once = true;
+		} else if ( arg == "-p" ) {
+			prometheus = true;
+		} else {
+			cout << "Live view of the idefix metrics." << endl;
+			cout << "Usage:" << endl;
+			cout << "   metrics [options]" << endl;
+			cout << "Options:" << endl;
+			cout << "    -n name   \t Shared memory segment, defaults to " << Metrics::DEFAULT_NAME << endl;
+			cout << "    -i ms     \t Refresh interval, defaults to 1000" << endl;
+			cout << "    -f prefix \t Only metrics starting with prefix" << endl;
+			cout << "    -1        \t Print once, without rates" << endl;
+			cout << "    -p        \t Print once in Prometheus text format" << endl;
+			cout << endl;
+
+			return arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	size_t size = 0;
+	const Metrics::Header* header = Metrics::attach( name, size );
+	if ( header == nullptr ) {
+		cerr << "No metrics segment: " << name << endl;
+		return EXIT_FAILURE;
+	}
+
+	if ( prometheus ) {
+		Metrics::write_prometheus( cout, header );
+		Metrics::detach( header, size );
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<Sample> previous;
+	auto last = std::chrono::steady_clock::now();
+	char line[256];
+
+	while ( true ) {
+		const auto now       = std::chrono::steady_clock::now();
+		const double seconds = std::chrono::duration<double>( now - last ).count();
+		last = now;
+
+		const uint32_t count = header->count.load( std::memory_order_acquire );
+		std::vector<Sample> samples( count );
+
+		if ( ! once ) {
+			cout << "\033[H\033[2J";
+		}
+		cout << "idefix pid " << header->pid << ", " << count << " metrics" << endl << endl;
+
+		for ( uint32_t i = 0; i < count; i++ ) {
+			const Metrics::Entry* entry = Metrics::entry( header, i );
+			samples[i] = sample( entry );
+
+			std::string id = entry->name;
+			if ( ! filter.empty() && id.compare( 0, filter.size(), filter ) != 0 ) {
+				continue;
+			}
+			if ( entry->labels[0] != '\0' ) {
+				id += std::string( "{" ) + entry->labels + "}";
+			}
+
+			const Sample& s     = samples[i];
+			const bool has_rate = i < previous.size() && seconds > 0;
+
+			if ( entry->type == Metrics::HISTOGRAM ) {
+				const double rate = has_rate ? ( s.count - previous[i].count ) / seconds : 0;
+				const double mean = s.count > 0 ? s.sum / 1e3 / s.count : 0;
+				snprintf( line, sizeof( line ), "%-70s %12llu %10.1f/s  mean %9.2fus  p50 %10s  p99 %10s",
+					id.c_str(), static_cast<unsigned long long>( s.count ), rate, mean, percentile( s, 0.5 ).c_str(), percentile( s, 0.99 ).c_str() );
+			} else if ( entry->type == Metrics::COUNTER ) {
+				const double rate = has_rate ? ( s.value - previous[i].value ) / seconds : 0;
+				snprintf( line, sizeof( line ), "%-70s %12lld %10.1f/s", id.c_str(), static_cast<long long>( s.value ), rate );
+			} else {
+				snprintf( line, sizeof( line ), "%-70s %12lld", id.c_str(), static_cast<long long>( s.value ) );
+			}
+			cout << line << endl;
+		}
+
+		if ( once ) {
+			break;
+		}
+
+		previous.swap( samples );
+		std::this_thread::sleep_for( std::chrono::milliseconds( interval_ms ) );
+	}
+
+	Metrics::detach( header, size );
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,377 @@
+/*!
+ * Tick storm against FIXManager, without network.
+ * Synthesised MarketDataSnapshotFullRefresh and ExecutionReport messages
+ * for N symbols and M open positions are passed to fromApp from one or
+ * more threads as fast as possible. Reports throughput, the latency of
+ * fromApp and the growth of the resident memory.
+ */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
+#include <quickfix/fix44/MarketDataSnapshotFullRefresh.h>
+#include <quickfix/fix44/ExecutionReport.h>
+#include "FIXManager.h"
+#include "SimulatedBroker.h"
+#include "FXCMFields.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ *
+ * @param const int         argc
+ * @param const int         i
+ * @param const std::string arg
+ * @param const std::string failure_msg
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	}
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+/*!
+ * Latency histogram in ns, 8 buckets per power of two
+ */
+struct LatencyHistogram {
+	static const size_t SIZE = 512;
+
+	unsigned long long counts[SIZE];
+	unsigned long long total;
+	unsigned long long max;
+
+	LatencyHistogram(): total( 0 ), max( 0 ) {
+		std::fill( counts, counts + SIZE, 0ULL );
+	}
+
+	static inline size_t index(const unsigned long long ns) {
+		if ( ns < 8 ) {
+			return ns;
+		}
+		const int msb = 63 - __builtin_clzll( ns );
+		return 8 + ( msb - 3 ) * 8 + ( ( ns >> ( msb - 3 ) ) & 7 );
+	}
+
+	static inline unsigned long long upper_bound(const size_t index) {
+		if ( index < 8 ) {
+			return index;
+		}
+		const int shift = ( index - 8 ) / 8;
+		return ( ( 8 + ( index - 8 ) % 8 + 1ULL ) << shift ) - 1;
+	}
+
+	inline void add(const unsigned long long ns) {
+		counts[index( ns )]++;
+		total++;
+		if ( ns > max ) {
+			max = ns;
+		}
+	}
+
+	void merge(const LatencyHistogram& other) {
+		for ( size_t i = 0; i < SIZE; i++ ) {
+			counts[i] += other.counts[i];
+		}
+		total += other.total;
+		max    = std::max( max, other.max );
+	}
+
+	unsigned long long percentile(const double quantile) const {
+		unsigned long long cumulative = 0;
+		for ( size_t i = 0; i < SIZE; i++ ) {
+			cumulative += counts[i];
+			if ( cumulative > 0 && cumulative >= quantile * total ) {
+				return std::min( upper_bound( i ), max );
+			}
+		}
+		return max;
+	}
+};
+
+struct Worker {
+	std::vector<const FIX::Message*> messages;
+	std::vector<bool> is_tick;
+	LatencyHistogram ticks;
+	LatencyHistogram reports;
+	std::atomic<unsigned long long> count;
+	unsigned long long errors;
+
+	Worker(): count( 0 ), errors( 0 ) {}
+};
+
+/*!
+ * Resident set size of the process in bytes
+ *
+ * @return long long
+ */
+long long resident_bytes() {
+	long long pages = 0;
+	long long resident = 0;
+	std::ifstream statm( "/proc/self/statm" );
+	statm >> pages >> resident;
+	return resident * sysconf( _SC_PAGESIZE );
+}
+
+FIX44::MarketDataSnapshotFullRefresh market_data(const std::string& symbol, const double bid, const double spread) {
+	FIX44::MarketDataSnapshotFullRefresh mds;
+	mds.getHeader().setField( FIX::FIELD::SendingTime, "20181018-10:00:00.000" );
+	mds.setField( FIX::MDReqID( "Request_" + symbol ) );
+	mds.setField( FIX::Symbol( symbol ) );
+
+	FIX44::MarketDataSnapshotFullRefresh::NoMDEntries entry;
+	entry.setField( FIX::MDEntryType( FIX::MDEntryType_BID ) );
+	entry.setField( FIX::MDEntryPx( bid ) );
+	mds.addGroup( entry );
+	entry.setField( FIX::MDEntryType( FIX::MDEntryType_OFFER ) );
+	entry.setField( FIX::MDEntryPx( bid + spread ) );
+	mds.addGroup( entry );
+
+	return mds;
+}
+
+FIX44::ExecutionReport execution_report(const std::string& pos_id, const std::string& symbol, const char exec_type, const char ord_status, const char ord_type, const double price) {
+	FIX44::ExecutionReport er;
+	er.getHeader().setField( FIX::FIELD::SendingTime, "20181018-10:00:00.000" );
+	er.setField( FIX::OrderID( "O" + pos_id ) );
+	er.setField( FIX::ExecID( "E" + pos_id ) );
+	er.setField( FIX::ExecType( exec_type ) );
+	er.setField( FIX::OrdStatus( ord_status ) );
+	er.setField( FIX::OrdType( ord_type ) );
+	er.setField( FIX::ClOrdID( "C" + pos_id ) );
+	er.setField( FIX::Side( FIX::Side_BUY ) );
+	er.setField( FIX::Symbol( symbol ) );
+	er.setField( FIX::Account( "SIMULATED" ) );
+	er.setField( FIX::OrderQty( 10000 ) );
+	er.setField( FIX::LastQty( 10000 ) );
+	er.setField( FIX::LastPx( price ) );
+	er.setField( FIX::CumQty( ord_status == FIX::OrdStatus_FILLED ? 10000 : 0 ) );
+	er.setField( FIX::LeavesQty( ord_status == FIX::OrdStatus_FILLED ? 0 : 10000 ) );
+	er.setField( FIX::AvgPx( price ) );
+	er.setField( FXCM_FIX_FIELDS::FXCM_POS_ID, pos_id );
+	return er;
+}
+
+int main(int argc, char** argv) {
+	int symbol_count   = 10;
+	int position_count = 100;
+	int thread_count   = 1;
+	int seconds        = 10;
+	int report_every   = 100;
+	double max_growth  = 0;
+	bool verbose       = false;
+
+	for ( int i = 1; i < argc; i++ ) {
+		const std::string arg = argv[i];
+
+		if ( arg == "-s" || arg == "-p" || arg == "-t" || arg == "-d" || arg == "-e" || arg == "-m" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			const std::string value = argv[++i];
+			if ( arg == "-s" ) symbol_count   = std::max( 1, atoi( value.c_str() ) );
+			if ( arg == "-p" ) position_count = std::max( 0, atoi( value.c_str() ) );
+			if ( arg == "-t" ) thread_count   = std::max( 1, atoi( value.c_str() ) );
+			if ( arg == "-d" ) seconds        = std::max( 1, atoi( value.c_str() ) );
+			if ( arg == "-e" ) report_every   = std::max( 0, atoi( value.c_str() ) );
+			if ( arg == "-m" ) max_growth     = atof( value.c_str() );
+		} else if ( arg == "-v" ) {
+			verbose = true;
+		} else {
+			cout << "Tick storm against FIXManager, without network." << endl;
+			cout << "Usage:" << endl;
+			cout << "   stress [options]" << endl;
+			cout << "Options:" << endl;
+			cout << "    -s count  \t Symbols, defaults to 10" << endl;
+			cout << "    -p count  \t Open positions, defaults to 100" << endl;
+			cout << "    -t count  \t Threads calling fromApp, defaults to 1" << endl;
+			cout << "    -d sec    \t Duration, defaults to 10" << endl;
+			cout << "    -e n      \t Every nth message is an ExecutionReport, 0 = none, defaults to 100" << endl;
+			cout << "    -m MB     \t Fail if the resident memory grows more than MB" << endl;
+			cout << "    -v        \t Show FIXManager output" << endl;
+			cout << endl;
+
+			return arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	try {
+		FIXManager manager;
+		manager.console()->set_level( verbose ? spdlog::level::info : spdlog::level::off );
+
+		// market details and account from the simulated logon sequence
+		std::vector<std::string> symbols;
+		SimulatedBroker broker( manager );
+		for ( int s = 0; s < symbol_count; s++ ) {
+			char name[16];
+			snprintf( name, sizeof( name ), "S%02d/USD", s );
+			symbols.push_back( name );
+			broker.add_symbol( name );
+		}
+		broker.start();
+		broker.stop();
+
+		std::atomic<size_t> outgoing( 0 );
+		manager.setOutbound( [&outgoing](const FIX::Message&) {
+			outgoing++;
+		});
+
+		const FIX::SessionID session_ID( "FIX.4.4", "IDEFIX", "FXCM" );
+
+		// 64 prebuilt snapshots per symbol, the price walks up and down
+		const size_t variants = 64;
+		std::vector<FIX44::MarketDataSnapshotFullRefresh> snapshots;
+		snapshots.reserve( symbols.size() * variants );
+		for ( auto& symbol : symbols ) {
+			for ( size_t v = 0; v < variants; v++ ) {
+				const double offset = ( v < variants / 2 ? v : variants - v ) * 0.0001;
+				snapshots.push_back( market_data( symbol, 1.1 + offset, 0.0002 ) );
+			}
+		}
+
+		// the first tick of every symbol is sent from here, the tick counters
+		// of FIXManager are created by the market data session only
+		for ( size_t s = 0; s < symbols.size(); s++ ) {
+			manager.fromApp( snapshots[s * variants], session_ID );
+		}
+
+		// open positions and the stop updates sent during the storm
+		std::vector<FIX44::ExecutionReport> stop_updates;
+		stop_updates.reserve( position_count );
+		for ( int p = 0; p < position_count; p++ ) {
+			const std::string pos_id = "P" + std::to_string( p );
+			const std::string symbol = symbols[p % symbols.size()];
+			manager.fromApp( execution_report( pos_id, symbol, FIX::ExecType_TRADE, FIX::OrdStatus_FILLED, FIX::OrdType_MARKET, 1.1 ), session_ID );
+			stop_updates.push_back( execution_report( pos_id, symbol, FIX::ExecType_NEW, FIX::OrdStatus_NEW, FIX::OrdType_STOP, 1.09 ) );
+		}
+
+		// symbols are assigned round robin, like sessions of a process
+		std::vector<std::unique_ptr<Worker>> workers;
+		for ( int t = 0; t < thread_count; t++ ) {
+			workers.push_back( std::unique_ptr<Worker>( new Worker() ) );
+		}
+		for ( size_t v = 0; v < variants; v++ ) {
+			for ( size_t s = 0; s < symbols.size(); s++ ) {
+				Worker& worker = *workers[s % workers.size()];
+				worker.messages.push_back( &snapshots[s * variants + v] );
+				worker.is_tick.push_back( true );
+
+				if ( report_every > 0 && ! stop_updates.empty() && worker.messages.size() % report_every == 0 ) {
+					worker.messages.push_back( &stop_updates[worker.messages.size() / report_every % stop_updates.size()] );
+					worker.is_tick.push_back( false );
+				}
+			}
+		}
+
+		const long long rss_start = resident_bytes();
+		std::atomic<bool> running( true );
+		std::vector<std::thread> threads;
+
+		for ( auto& w : workers ) {
+			Worker* worker = w.get();
+			threads.push_back( std::thread( [worker, &manager, &session_ID, &running]() {
+				const size_t size = worker->messages.size();
+				size_t i = 0;
+				while ( running.load( std::memory_order_relaxed ) ) {
+					const auto start = std::chrono::steady_clock::now();
+					try {
+						manager.fromApp( *worker->messages[i], session_ID );
+					} catch ( std::exception& e ) {
+						worker->errors++;
+					}
+					const unsigned long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+
+					( worker->is_tick[i] ? worker->ticks : worker->reports ).add( ns );
+					worker->count.fetch_add( 1, std::memory_order_relaxed );
+
+					if ( ++i == size ) {
+						i = 0;
+					}
+				}
+			}));
+		}
+
+		cout << symbol_count << " symbols, " << position_count << " positions, " << thread_count << " threads, " << seconds << " s" << endl;
+		cout << "  sec    messages/s   rss MB" << endl;
+
+		const auto start = std::chrono::steady_clock::now();
+		unsigned long long last_count = 0;
+		char line[128];
+		for ( int s = 1; s <= seconds; s++ ) {
+			std::this_thread::sleep_until( start + std::chrono::seconds( s ) );
+
+			unsigned long long count = 0;
+			for ( auto& worker : workers ) {
+				count += worker->count.load( std::memory_order_relaxed );
+			}
+
+			snprintf( line, sizeof( line ), "%5d %13llu %8.1f", s, count - last_count, resident_bytes() / 1048576.0 );
+			cout << line << endl;
+			last_count = count;
+		}
+
+		running = false;
+		for ( auto& thread : threads ) {
+			thread.join();
+		}
+
+		const double elapsed   = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+		const long long growth = resident_bytes() - rss_start;
+
+		LatencyHistogram ticks;
+		LatencyHistogram reports;
+		unsigned long long errors = 0;
+		for ( auto& worker : workers ) {
+			ticks.merge( worker->ticks );
+			reports.merge( worker->reports );
+			errors += worker->errors;
+		}
+		const unsigned long long messages = ticks.total + reports.total;
+
+		manager.setOutbound( nullptr );
+
+		cout << std::fixed << std::setprecision(2);
+		cout << "messages     " << messages << endl;
+		cout << "ticks        " << ticks.total << endl;
+		cout << "reports      " << reports.total << endl;
+		cout << "errors       " << errors << endl;
+		cout << "outgoing     " << outgoing.load() << endl;
+		cout << "messages/s   " << messages / elapsed << endl;
+		cout << "tick ns      p50 " << ticks.percentile( 0.5 ) << "  p90 " << ticks.percentile( 0.9 ) << "  p99 " << ticks.percentile( 0.99 )
+			<< "  p99.9 " << ticks.percentile( 0.999 ) << "  max " << ticks.max << endl;
+		if ( reports.total > 0 ) {
+			cout << "report ns    p50 " << reports.percentile( 0.5 ) << "  p90 " << reports.percentile( 0.9 ) << "  p99 " << reports.percentile( 0.99 )
+				<< "  p99.9 " << reports.percentile( 0.999 ) << "  max " << reports.max << endl;
+		}
+		cout << "rss MB       " << resident_bytes() / 1048576.0 << endl;
+		cout << "growth MB    " << growth / 1048576.0 << endl;
+		cout << "growth B/msg " << ( messages > 0 ? static_cast<double>( growth ) / messages : 0 ) << endl;
+
+		if ( max_growth > 0 && growth / 1048576.0 > max_growth ) {
+			cerr << "Memory grew " << growth / 1048576.0 << " MB, limit " << max_growth << " MB" << endl;
+			return EXIT_FAILURE;
+		}
+
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*!
+ * Parallel parameter sweep of AwesomeStrategy against FXCM tick data files.
+ * The tick files are loaded once and shared by all backtests.
+ */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include "FileAdapter.h"
+#include "ParameterSweep.h"
+#include "AwesomeStrategy.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ * 
+ * @param const int         argc        
+ * @param const int         i           
+ * @param const std::string arg
+ * @param const std::string failure_msg 
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	} 
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		cout << "Parameter sweep of AwesomeStrategy with FXCM tick data." << endl;
+		cout << "Usage:" << endl;
+		cout << "   sweep <options> -r name=from:to:step [-r ...] tickdata.csv [tickdata.csv ...]" << endl;
+		cout << "Options:" << endl;
+		cout << "    -c file   \t Strategy cfg file, defaults to awesome.cfg" << endl;
+		cout << "    -s symbol \t The symbol like EUR/USD, defaults to the first symbol in cfg" << endl;
+		cout << "    -p value  \t Point size, defaults to 0.0001" << endl;
+		cout << "    -r range  \t Parameter range like renko_size=5:20:5 or sma_size=10" << endl;
+		cout << "              \t renko_size, sma_size, wait_bricks, max_pip_risk, max_spread," << endl;
+		cout << "              \t max_long_pos, max_short_pos" << endl;
+		cout << "    -j value  \t Threads, defaults to all cores" << endl;
+		cout << "    -o file   \t Write ranked results to csv file, defaults to sweep.csv" << endl;
+		cout << "    -n value  \t Show the n best results, defaults to 10" << endl;
+		cout << "    -d value  \t Prune runs with a drawdown above value points" << endl;
+		cout << "    -k value  \t Prune runs without trade after this part of the ticks, defaults to 0.5" << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	// defaults
+	std::string strategy_cfg_file = "awesome.cfg";
+	std::string output_file       = "sweep.csv";
+	std::string symbol;
+	std::vector<std::string> files;
+	std::vector<std::string> ranges;
+	double point_size   = 0.0001;
+	double max_drawdown = 0;
+	double checkpoint   = 0.5;
+	unsigned int threads = 0;
+	int show            = 10;
+
+	// parse arguments
+	for ( int i = 1; i < argc; i++ ) {
+		std::string arg = argv[ i ];
+
+		if ( arg == "-c" || arg == "-s" || arg == "-p" || arg == "-r" || arg == "-j" || arg == "-o" || arg == "-n" || arg == "-d" || arg == "-k" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			std::string value = argv[ ++i ];
+			if ( arg == "-c" ) strategy_cfg_file = value;
+			if ( arg == "-s" ) symbol            = value;
+			if ( arg == "-p" ) point_size        = atof( value.c_str() );
+			if ( arg == "-r" ) ranges.push_back( value );
+			if ( arg == "-j" ) threads           = atoi( value.c_str() );
+			if ( arg == "-o" ) output_file       = value;
+			if ( arg == "-n" ) show              = atoi( value.c_str() );
+			if ( arg == "-d" ) max_drawdown      = atof( value.c_str() );
+			if ( arg == "-k" ) checkpoint        = atof( value.c_str() );
+		} else {
+			files.push_back( arg );
+		}
+	}
+
+	// file which is read at the moment
+	std::string current_file = strategy_cfg_file;
+
+	try {
+		AwesomeStrategyConfig config = AwesomeStrategyConfig::load( strategy_cfg_file );
+
+		if ( symbol.empty() && ! config.symbols.empty() ) {
+			symbol = config.symbols.front();
+		}
+		if ( symbol.empty() ) {
+			cerr << "No symbol found." << endl;
+			return EXIT_FAILURE;
+		}
+
+		ParameterSweep sweep( symbol, config, point_size );
+		sweep.set_pruning( max_drawdown, checkpoint );
+
+		for ( auto& range : ranges ) {
+			try {
+				sweep.add_range( SweepRange::parse( range ) );
+			} catch ( IDEFIX::out_of_range& e ) {
+				cerr << "Invalid range: " << range << endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		// read all tick files once
+		std::vector<TickRecord> ticks;
+		for ( auto& file : files ) {
+			current_file = file;
+			FileAdapter adapter( file );
+			size_t count = adapter.load( ticks );
+			cout << file << ": " << count << " ticks" << endl;
+		}
+
+		if ( ticks.empty() ) {
+			cerr << "No ticks found." << endl;
+			return EXIT_FAILURE;
+		}
+
+		cout << sweep.combinations().size() << " combinations" << endl;
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<SweepResult> results = sweep.run( ticks, threads );
+		double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+		ParameterSweep::write_csv( output_file, results );
+
+		int pruned = 0;
+		for ( auto& r : results ) {
+			if ( r.result.pruned ) pruned++;
+		}
+
+		cout << std::fixed << std::setprecision(2);
+		cout << results.size() << " backtests, " << pruned << " pruned, " << elapsed << "s" << endl;
+		cout << endl;
+		cout << "rank  renko  sma  wait  risk  spread  trades  wins    profit_loss  max_drawdown" << endl;
+
+		for ( int i = 0; i < show && i < static_cast<int>( results.size() ); i++ ) {
+			const SweepResult& r = results[i];
+			cout << std::setw(4) << ( i + 1 )
+				 << std::setw(7) << r.config.renko_size
+				 << std::setw(5) << r.config.sma_size
+				 << std::setw(6) << r.config.wait_bricks
+				 << std::setw(6) << r.config.max_pip_risk
+				 << std::setw(8) << r.config.max_spread
+				 << std::setw(8) << r.result.trades
+				 << std::setw(6) << r.result.wins
+				 << std::setw(15) << r.result.profit_loss
+				 << std::setw(14) << r.result.max_drawdown
+				 << ( r.result.pruned ? "  pruned" : "" ) << endl;
+		}
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
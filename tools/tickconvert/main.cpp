@@ -0,0 +1,159 @@
+/*!
+ * Convert FXCM tick data csv files into a binary tick archive
+ * and show information about existing archives.
+ */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include "FileAdapter.h"
+#include "TickArchive.h"
+#include "TimeHelper.h"
+
+using namespace std;
+using namespace IDEFIX;
+
+/*!
+ * Check argument with option if option value exists.
+ * If not show cerr message
+ * 
+ * @param const int         argc        
+ * @param const int         i           
+ * @param const std::string arg
+ * @param const std::string failure_msg 
+ * @return bool
+ */
+inline bool check_argument_option(const int argc, const int i, const std::string arg, const std::string failure_msg = " option requires one argument.") {
+	if ( i + 1 < argc ) {
+		return true;
+	} 
+
+	cerr << arg << failure_msg << endl;
+	return false;
+}
+
+/*!
+ * Show header of tick archive and measure the load time
+ *
+ * @param const std::string& filename
+ */
+void show_info(const std::string& filename) {
+	TickArchive archive( filename );
+
+	auto start = std::chrono::steady_clock::now();
+	archive.open();
+	std::vector<TickRecord> ticks;
+	archive.load( ticks );
+	double elapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	char first[32], last[32];
+	times::ms_to_fix( archive.first_time(), first );
+	times::ms_to_fix( archive.last_time(), last );
+
+	cout << filename << endl;
+	cout << "symbol      " << archive.symbol() << endl;
+	cout << "point_size  " << archive.point_size() << endl;
+	cout << "ticks       " << archive.size() << endl;
+	cout << "blocks      " << archive.block_count() << endl;
+	cout << "first       " << first << endl;
+	cout << "last        " << last << endl;
+	cout << "load_ms     " << std::fixed << std::setprecision(2) << elapsed << endl;
+}
+
+int main(int argc, char** argv) {
+	if ( argc < 2 ) {
+		cout << "Convert FXCM tick data csv files into a binary tick archive." << endl;
+		cout << "Usage:" << endl;
+		cout << "   tickconvert -s symbol -o archive.ticks tickdata.csv [tickdata.csv ...]" << endl;
+		cout << "   tickconvert -i archive.ticks" << endl;
+		cout << "Options:" << endl;
+		cout << "    -s symbol \t The symbol like EUR/USD" << endl;
+		cout << "    -p value  \t Point size, defaults to 0.0001" << endl;
+		cout << "    -o file   \t Output archive" << endl;
+		cout << "    -b value  \t Ticks per block, defaults to " << TickArchive::DEFAULT_BLOCK_SIZE << endl;
+		cout << "    -i file   \t Show archive information" << endl;
+		cout << endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	// defaults
+	std::string symbol;
+	std::string output_file;
+	std::string info_file;
+	std::vector<std::string> files;
+	double point_size   = 0.0001;
+	uint32_t block_size = TickArchive::DEFAULT_BLOCK_SIZE;
+
+	// parse arguments
+	for ( int i = 1; i < argc; i++ ) {
+		std::string arg = argv[ i ];
+
+		if ( arg == "-s" || arg == "-p" || arg == "-o" || arg == "-b" || arg == "-i" ) {
+			if ( ! check_argument_option( argc, i, arg ) ) {
+				return EXIT_FAILURE;
+			}
+
+			std::string value = argv[ ++i ];
+			if ( arg == "-s" ) symbol      = value;
+			if ( arg == "-p" ) point_size  = atof( value.c_str() );
+			if ( arg == "-o" ) output_file = value;
+			if ( arg == "-b" ) block_size  = atoi( value.c_str() );
+			if ( arg == "-i" ) info_file   = value;
+		} else {
+			files.push_back( arg );
+		}
+	}
+
+	// file which is read at the moment
+	std::string current_file = info_file;
+
+	try {
+		if ( ! info_file.empty() ) {
+			show_info( info_file );
+			return EXIT_SUCCESS;
+		}
+
+		if ( symbol.empty() || output_file.empty() || files.empty() || block_size == 0 ) {
+			cerr << "Symbol, output file and at least one csv file are required." << endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector<TickRecord> ticks;
+		for ( auto& file : files ) {
+			current_file = file;
+			FileAdapter adapter( file );
+			size_t count = adapter.load( ticks );
+			cout << file << ": " << count << " ticks" << endl;
+		}
+
+		// files may be passed in any order
+		auto by_time = [](const TickRecord& l, const TickRecord& r) {
+			return l.time_ms < r.time_ms;
+		};
+		if ( ! std::is_sorted( ticks.begin(), ticks.end(), by_time ) ) {
+			std::stable_sort( ticks.begin(), ticks.end(), by_time );
+		}
+
+		current_file = output_file;
+		size_t bytes = TickArchive::write( output_file, symbol, point_size, ticks, block_size );
+
+		cout << output_file << ": " << ticks.size() << " ticks, " << bytes << " bytes, "
+			 << std::fixed << std::setprecision(2) << ( ticks.empty() ? 0.0 : static_cast<double>( bytes ) / ticks.size() ) << " bytes/tick" << endl;
+
+	} catch ( IDEFIX::file_not_found& e ) {
+		cerr << "File not found: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( IDEFIX::out_of_range& e ) {
+		cerr << "No tick archive: " << current_file << endl;
+		return EXIT_FAILURE;
+	} catch ( std::exception& e ) {
+		cerr << "Damn: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}